@@ -0,0 +1,204 @@
+//
+//  bindless_table.cpp
+//  Vulkan_test
+//
+//  Created by Danny on 17/10/2026.
+//  Copyright © 2026 Danny. All rights reserved.
+//
+
+#include "bindless_table.hpp"
+
+#include <algorithm>
+#include <array>
+
+namespace {
+
+	// What we ask for, the device limits may lower it.
+	const uint32_t maximumImages = 1 << 16;
+	const uint32_t maximumSamplers = 1 << 10;
+	const uint32_t maximumBuffers = 1 << 16;
+}
+
+BindlessTable::BindlessTable(const vk::PhysicalDevice& physicalDevice, const vk::Device& logicalDevice)
+: logicalDevice(logicalDevice) {
+
+	const auto properties = physicalDevice.getProperties2<vk::PhysicalDeviceProperties2, vk::PhysicalDeviceVulkan12Properties>();
+	const auto& limits = properties.get<vk::PhysicalDeviceVulkan12Properties>();
+
+	auto& images = arrays[static_cast<uint32_t>(BindlessResourceType::SAMPLED_IMAGE)];
+	auto& samplers = arrays[static_cast<uint32_t>(BindlessResourceType::SAMPLER)];
+	auto& buffers = arrays[static_cast<uint32_t>(BindlessResourceType::STORAGE_BUFFER)];
+
+	samplers.capacity = std::min({maximumSamplers, limits.maxDescriptorSetUpdateAfterBindSamplers, limits.maxPerStageDescriptorUpdateAfterBindSamplers});
+	images.capacity = std::min({maximumImages, limits.maxDescriptorSetUpdateAfterBindSampledImages, limits.maxPerStageDescriptorUpdateAfterBindSampledImages});
+	buffers.capacity = std::min({maximumBuffers, limits.maxDescriptorSetUpdateAfterBindStorageBuffers, limits.maxPerStageDescriptorUpdateAfterBindStorageBuffers});
+
+	// A single stage sees all three arrays, together they have to fit its resource limit.
+	const auto resources = limits.maxPerStageUpdateAfterBindResources;
+	if(samplers.capacity + images.capacity + buffers.capacity > resources) {
+		const auto remaining = resources > samplers.capacity ? resources - samplers.capacity : 0;
+		images.capacity = std::min(images.capacity, remaining / 2);
+		buffers.capacity = std::min(buffers.capacity, remaining - images.capacity);
+	}
+
+	std::array<vk::DescriptorSetLayoutBinding, 3> bindings;
+	std::array<vk::DescriptorBindingFlags, 3> bindingFlags;
+	std::array<vk::DescriptorPoolSize, 3> poolSizes;
+	for(uint32_t i = 0; i < 3; ++i) {
+		const auto type = getDescriptorType(static_cast<BindlessResourceType>(i));
+		bindings[i].setBinding(i);
+		bindings[i].setDescriptorType(type);
+		bindings[i].setDescriptorCount(arrays[i].capacity);
+		bindings[i].setStageFlags(getStages());
+
+		// Slots nobody uses may hold stale descriptors, and are written while earlier frames are still in flight.
+		bindingFlags[i] = vk::DescriptorBindingFlagBits::ePartiallyBound | vk::DescriptorBindingFlagBits::eUpdateAfterBind |
+			vk::DescriptorBindingFlagBits::eUpdateUnusedWhilePending;
+
+		poolSizes[i] = vk::DescriptorPoolSize(type, arrays[i].capacity);
+	}
+
+	vk::DescriptorSetLayoutBindingFlagsCreateInfo flagsInfo;
+	flagsInfo.setBindingCount(static_cast<uint32_t>(bindingFlags.size()));
+	flagsInfo.setPBindingFlags(bindingFlags.data());
+
+	vk::DescriptorSetLayoutCreateInfo layoutInfo;
+	layoutInfo.setPNext(&flagsInfo);
+	layoutInfo.setFlags(vk::DescriptorSetLayoutCreateFlagBits::eUpdateAfterBindPool);
+	layoutInfo.setBindingCount(static_cast<uint32_t>(bindings.size()));
+	layoutInfo.setPBindings(bindings.data());
+	setLayout = logicalDevice.createDescriptorSetLayout(layoutInfo);
+
+	vk::DescriptorPoolCreateInfo poolInfo;
+	poolInfo.setFlags(vk::DescriptorPoolCreateFlagBits::eUpdateAfterBind);
+	poolInfo.setMaxSets(1);
+	poolInfo.setPoolSizeCount(static_cast<uint32_t>(poolSizes.size()));
+	poolInfo.setPPoolSizes(poolSizes.data());
+	pool = logicalDevice.createDescriptorPool(poolInfo);
+
+	vk::DescriptorSetAllocateInfo allocateInfo;
+	allocateInfo.setDescriptorPool(pool);
+	allocateInfo.setDescriptorSetCount(1);
+	allocateInfo.setPSetLayouts(&setLayout);
+	descriptorSet = logicalDevice.allocateDescriptorSets(allocateInfo).front();
+
+	const vk::PushConstantRange pushConstants(getStages(), 0, pushConstantSize);
+	vk::PipelineLayoutCreateInfo pipelineLayoutInfo;
+	pipelineLayoutInfo.setSetLayoutCount(1);
+	pipelineLayoutInfo.setPSetLayouts(&setLayout);
+	pipelineLayoutInfo.setPushConstantRangeCount(1);
+	pipelineLayoutInfo.setPPushConstantRanges(&pushConstants);
+	pipelineLayout = logicalDevice.createPipelineLayout(pipelineLayoutInfo);
+}
+
+BindlessTable::~BindlessTable() {
+	logicalDevice.destroyPipelineLayout(pipelineLayout);
+	logicalDevice.destroyDescriptorPool(pool);
+	logicalDevice.destroyDescriptorSetLayout(setLayout);
+}
+
+bool BindlessTable::isSupported(const vk::PhysicalDevice& physicalDevice) {
+	const auto features = physicalDevice.getFeatures2<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceVulkan12Features>();
+	const auto& f = features.get<vk::PhysicalDeviceVulkan12Features>();
+	return f.runtimeDescriptorArray && f.descriptorBindingPartiallyBound && f.descriptorBindingUpdateUnusedWhilePending &&
+		f.descriptorBindingSampledImageUpdateAfterBind && f.descriptorBindingStorageBufferUpdateAfterBind &&
+		f.shaderSampledImageArrayNonUniformIndexing && f.shaderStorageBufferArrayNonUniformIndexing;
+}
+
+vk::DescriptorType BindlessTable::getDescriptorType(BindlessResourceType type) {
+	switch(type) {
+		case BindlessResourceType::SAMPLED_IMAGE: return vk::DescriptorType::eSampledImage;
+		case BindlessResourceType::SAMPLER: return vk::DescriptorType::eSampler;
+		case BindlessResourceType::STORAGE_BUFFER: return vk::DescriptorType::eStorageBuffer;
+	}
+	return vk::DescriptorType::eSampledImage;
+}
+
+uint32_t BindlessTable::allocate(BindlessResourceType type) {
+	auto& array = arrays[static_cast<uint32_t>(type)];
+	if(!array.free.empty()) {
+		const auto index = array.free.back();
+		array.free.pop_back();
+		return index;
+	}
+
+	return array.next < array.capacity ? array.next++ : invalid_bindless_index;
+}
+
+uint32_t BindlessTable::addTexture(vk::ImageView view, vk::ImageLayout layout) {
+	std::lock_guard<std::mutex> lock(mutex);
+	const auto index = allocate(BindlessResourceType::SAMPLED_IMAGE);
+	if(index == invalid_bindless_index)
+		return index;
+
+	const vk::DescriptorImageInfo info(nullptr, view, layout);
+	vk::WriteDescriptorSet write;
+	write.setDstSet(descriptorSet);
+	write.setDstBinding(static_cast<uint32_t>(BindlessResourceType::SAMPLED_IMAGE));
+	write.setDstArrayElement(index);
+	write.setDescriptorCount(1);
+	write.setDescriptorType(vk::DescriptorType::eSampledImage);
+	write.setPImageInfo(&info);
+	logicalDevice.updateDescriptorSets(write, nullptr);
+	return index;
+}
+
+uint32_t BindlessTable::addSampler(vk::Sampler sampler) {
+	std::lock_guard<std::mutex> lock(mutex);
+	const auto index = allocate(BindlessResourceType::SAMPLER);
+	if(index == invalid_bindless_index)
+		return index;
+
+	const vk::DescriptorImageInfo info(sampler, nullptr, vk::ImageLayout::eUndefined);
+	vk::WriteDescriptorSet write;
+	write.setDstSet(descriptorSet);
+	write.setDstBinding(static_cast<uint32_t>(BindlessResourceType::SAMPLER));
+	write.setDstArrayElement(index);
+	write.setDescriptorCount(1);
+	write.setDescriptorType(vk::DescriptorType::eSampler);
+	write.setPImageInfo(&info);
+	logicalDevice.updateDescriptorSets(write, nullptr);
+	return index;
+}
+
+uint32_t BindlessTable::addBuffer(vk::Buffer buffer, vk::DeviceSize offset, vk::DeviceSize range) {
+	std::lock_guard<std::mutex> lock(mutex);
+	const auto index = allocate(BindlessResourceType::STORAGE_BUFFER);
+	if(index == invalid_bindless_index)
+		return index;
+
+	const vk::DescriptorBufferInfo info(buffer, offset, range);
+	vk::WriteDescriptorSet write;
+	write.setDstSet(descriptorSet);
+	write.setDstBinding(static_cast<uint32_t>(BindlessResourceType::STORAGE_BUFFER));
+	write.setDstArrayElement(index);
+	write.setDescriptorCount(1);
+	write.setDescriptorType(vk::DescriptorType::eStorageBuffer);
+	write.setPBufferInfo(&info);
+	logicalDevice.updateDescriptorSets(write, nullptr);
+	return index;
+}
+
+void BindlessTable::remove(BindlessResourceType type, uint32_t index, uint64_t frameNumber) {
+	if(index == invalid_bindless_index)
+		return;
+
+	std::lock_guard<std::mutex> lock(mutex);
+	arrays[static_cast<uint32_t>(type)].retired.push_back({index, frameNumber});
+}
+
+void BindlessTable::recycle(uint64_t completedFrameNumber) {
+	std::lock_guard<std::mutex> lock(mutex);
+	for(auto& array: arrays) {
+		auto done = std::partition(array.retired.begin(), array.retired.end(), [=](const Retired& r) { return r.frameNumber > completedFrameNumber; });
+		for(auto it = done; it != array.retired.end(); ++it)
+			array.free.emplace_back(it->index);
+		array.retired.erase(done, array.retired.end());
+	}
+}
+
+void BindlessTable::bind(vk::CommandBuffer commandBuffer, bool graphics) const {
+	if(graphics)
+		commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, pipelineLayout, set, descriptorSet, nullptr);
+	commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eCompute, pipelineLayout, set, descriptorSet, nullptr);
+}
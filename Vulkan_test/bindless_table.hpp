@@ -0,0 +1,97 @@
+//
+//  bindless_table.hpp
+//  Vulkan_test
+//
+//  Created by Danny on 17/10/2026.
+//  Copyright © 2026 Danny. All rights reserved.
+//
+
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+enum class BindlessResourceType : uint32_t
+{
+	SAMPLED_IMAGE,
+	SAMPLER,
+	STORAGE_BUFFER
+};
+
+constexpr uint32_t invalid_bindless_index = ~0u;
+
+// One descriptor set of large partially bound arrays every shader indexes into, bound once per frame:
+//
+//	layout(set = 0, binding = 0) uniform texture2D textures[];
+//	layout(set = 0, binding = 1) uniform sampler samplers[];
+//	layout(set = 0, binding = 2) buffer Buffers { uint data[]; } buffers[];
+//
+// Resources keep their index for as long as they live. Pipelines using the table share set 0 and a single
+// push constant range, which keeps their layouts compatible, so switching pipelines never disturbs the set.
+class BindlessTable {
+public:
+	static constexpr uint32_t set = 0;
+	static constexpr uint32_t pushConstantSize = 128;
+
+	BindlessTable(const vk::PhysicalDevice&, const vk::Device&);
+	~BindlessTable();
+
+	BindlessTable(const BindlessTable&) = delete;
+	BindlessTable& operator=(const BindlessTable&) = delete;
+
+	// Needs the descriptor indexing features of Vulkan 1.2 for all three arrays.
+	static bool isSupported(const vk::PhysicalDevice&);
+
+	// All return invalid_bindless_index once the array is full. Thread safe.
+	uint32_t addTexture(vk::ImageView, vk::ImageLayout);
+	uint32_t addSampler(vk::Sampler);
+	uint32_t addBuffer(vk::Buffer, vk::DeviceSize offset = 0, vk::DeviceSize range = VK_WHOLE_SIZE);
+
+	// The index is handed out again once frameNumber has completed on the gpu.
+	void remove(BindlessResourceType, uint32_t index, uint64_t frameNumber);
+	void recycle(uint64_t completedFrameNumber);
+
+	// Binds the table for both graphics and compute, only for compute on command buffers of a compute only queue.
+	void bind(vk::CommandBuffer, bool graphics = true) const;
+
+	const vk::DescriptorSetLayout& getSetLayout() const { return setLayout; }
+	const vk::DescriptorSet& getDescriptorSet() const { return descriptorSet; }
+	static vk::ShaderStageFlags getStages() { return vk::ShaderStageFlagBits::eAllGraphics | vk::ShaderStageFlagBits::eCompute; }
+	static vk::DescriptorType getDescriptorType(BindlessResourceType);
+
+	uint32_t getCapacity(BindlessResourceType type) const { return arrays[static_cast<uint32_t>(type)].capacity; }
+
+private:
+
+	struct Retired
+	{
+		uint32_t index;
+		uint64_t frameNumber;
+	};
+
+	struct Array
+	{
+		uint32_t capacity = 0;
+		uint32_t next = 0;
+		std::vector<uint32_t> free;
+		std::vector<Retired> retired;
+	};
+
+	uint32_t allocate(BindlessResourceType);
+
+private:
+
+	vk::Device logicalDevice;
+	vk::DescriptorPool pool;
+	vk::DescriptorSetLayout setLayout;
+	vk::DescriptorSet descriptorSet;
+
+	// Layout with only the table and the push constants, used to bind the set outside of any pipeline.
+	vk::PipelineLayout pipelineLayout;
+
+	std::mutex mutex;
+	Array arrays[3];
+};
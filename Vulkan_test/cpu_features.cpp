@@ -0,0 +1,46 @@
+//
+//  cpu_features.cpp
+//  Vulkan_test
+//
+//  Created by Danny on 17/10/2026.
+//  Copyright © 2026 Danny. All rights reserved.
+//
+
+#include "cpu_features.hpp"
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+namespace {
+
+	bool detectAvx2Fma() {
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+		// Also checks that the OS enabled the ymm state.
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+		int info[4];
+		__cpuid(info, 0);
+		if(info[0] < 7)
+			return false;
+
+		__cpuid(info, 1);
+		const bool fma = (info[2] & (1 << 12)) != 0;
+		const bool osxsave = (info[2] & (1 << 27)) != 0;
+		if(!fma || !osxsave || (_xgetbv(0) & 0x6) != 0x6)
+			return false;
+
+		__cpuidex(info, 7, 0);
+		return (info[1] & (1 << 5)) != 0;
+#else
+		return false;
+#endif
+	}
+}
+
+bool cpuHasAvx2Fma() {
+	static const bool supported = detectAvx2Fma();
+	return supported;
+}
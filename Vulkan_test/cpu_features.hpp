@@ -0,0 +1,15 @@
+//
+//  cpu_features.hpp
+//  Vulkan_test
+//
+//  Created by Danny on 17/10/2026.
+//  Copyright © 2026 Danny. All rights reserved.
+//
+
+#pragma once
+
+// Instruction sets the running cpu has beyond what the whole app is built for. Kernels that use them live in
+// their own files, built with the matching flags, and are only called once these say it's safe.
+
+// AVX2 and FMA, with the OS saving the ymm registers. Always false off x86.
+bool cpuHasAvx2Fma();
@@ -0,0 +1,252 @@
+//
+//  descriptor_allocator.cpp
+//  Vulkan_test
+//
+//  Created by Danny on 17/10/2026.
+//  Copyright © 2026 Danny. All rights reserved.
+//
+
+#include "descriptor_allocator.hpp"
+
+#include <algorithm>
+
+namespace {
+
+	// Descriptors of each type per set, scaled by the number of sets in the pool.
+	const std::vector<std::pair<vk::DescriptorType, float>> poolRatios {
+		{vk::DescriptorType::eUniformBuffer, 2.f},
+		{vk::DescriptorType::eUniformBufferDynamic, 1.f},
+		{vk::DescriptorType::eSampler, 1.f},
+		{vk::DescriptorType::eSampledImage, 4.f},
+		{vk::DescriptorType::eCombinedImageSampler, 4.f},
+		{vk::DescriptorType::eStorageImage, 1.f},
+		{vk::DescriptorType::eStorageBuffer, 2.f},
+		{vk::DescriptorType::eStorageBufferDynamic, 1.f}
+	};
+
+	const uint32_t maximumSetsPerPool = 4096;
+
+	template<typename T>
+	void append(std::string& key, const T& value) {
+		key.append(reinterpret_cast<const char*>(&value), sizeof(T));
+	}
+}
+
+DescriptorAllocator::DescriptorAllocator(const vk::Device& logicalDevice, uint32_t initialSetsPerPool)
+: logicalDevice(logicalDevice), setsPerPool(initialSetsPerPool) {
+
+}
+
+DescriptorAllocator::~DescriptorAllocator() {
+	for(auto& pool: usedPools)
+		logicalDevice.destroyDescriptorPool(pool);
+	for(auto& pool: freePools)
+		logicalDevice.destroyDescriptorPool(pool);
+}
+
+vk::DescriptorSet DescriptorAllocator::allocate(const vk::DescriptorSetLayout& layout) {
+	if(!currentPool) {
+		currentPool = grabPool();
+		usedPools.emplace_back(currentPool);
+	}
+
+	vk::DescriptorSetAllocateInfo info;
+	info.setDescriptorPool(currentPool);
+	info.setDescriptorSetCount(1);
+	info.setPSetLayouts(&layout);
+
+	statistics.allocateCalls++;
+	try {
+		return logicalDevice.allocateDescriptorSets(info).front();
+	} catch(const vk::OutOfPoolMemoryError&) {
+	} catch(const vk::FragmentedPoolError&) {
+	}
+
+	// The current pool is exhausted, continue in a fresh one.
+	currentPool = grabPool();
+	usedPools.emplace_back(currentPool);
+	info.setDescriptorPool(currentPool);
+
+	statistics.allocateCalls++;
+	return logicalDevice.allocateDescriptorSets(info).front();
+}
+
+void DescriptorAllocator::reset() {
+	for(auto& pool: usedPools) {
+		logicalDevice.resetDescriptorPool(pool);
+		freePools.emplace_back(pool);
+	}
+
+	usedPools.clear();
+	currentPool = nullptr;
+}
+
+vk::DescriptorPool DescriptorAllocator::grabPool() {
+	if(!freePools.empty()) {
+		auto pool = freePools.back();
+		freePools.pop_back();
+		return pool;
+	}
+
+	std::vector<vk::DescriptorPoolSize> poolSizes;
+	for(const auto& ratio: poolRatios)
+		poolSizes.emplace_back(ratio.first, static_cast<uint32_t>(ratio.second * setsPerPool));
+
+	vk::DescriptorPoolCreateInfo info;
+	info.setPPoolSizes(poolSizes.data());
+	info.setPoolSizeCount(static_cast<uint32_t>(poolSizes.size()));
+	info.setMaxSets(setsPerPool);
+
+	// Each new pool is bigger than the last, content that needs many sets stops hitting this quickly.
+	setsPerPool = std::min(setsPerPool * 2, maximumSetsPerPool);
+	statistics.poolsCreated++;
+
+	return logicalDevice.createDescriptorPool(info);
+}
+
+TransientDescriptorSets::TransientDescriptorSets(const vk::Device& logicalDevice)
+: allocator(logicalDevice) {
+
+}
+
+vk::DescriptorSet TransientDescriptorSets::acquire(const vk::DescriptorSetLayout& layout) {
+	auto& entry = recycled[static_cast<VkDescriptorSetLayout>(layout)];
+	if(entry.used < entry.sets.size()) {
+		allocator.getStatistics().cacheHits++;
+		return entry.sets[entry.used++];
+	}
+
+	allocator.getStatistics().cacheMisses++;
+	entry.sets.emplace_back(allocator.allocate(layout));
+	entry.used++;
+	cachedSets++;
+	return entry.sets.back();
+}
+
+void TransientDescriptorSets::reset() {
+	size_t usedSets = 0;
+	for(auto& entry: recycled) {
+		usedSets += entry.second.used;
+		entry.second.used = 0;
+	}
+
+	if(cachedSets > 2 * usedSets + 64) {
+		allocator.reset();
+		recycled.clear();
+		cachedSets = 0;
+	}
+}
+
+DescriptorSetCache::DescriptorSetCache(const vk::Device& logicalDevice)
+: logicalDevice(logicalDevice), allocator(logicalDevice) {
+
+}
+
+vk::DescriptorSet DescriptorSetCache::get(const vk::DescriptorSetLayout& layout, const std::vector<DescriptorBinding>& bindings) {
+	std::string key;
+	key.reserve(sizeof(VkDescriptorSetLayout) + bindings.size() * sizeof(DescriptorBinding));
+	append(key, static_cast<VkDescriptorSetLayout>(layout));
+	for(const auto& b: bindings) {
+		append(key, b.binding);
+		append(key, b.type);
+		append(key, static_cast<VkBuffer>(b.buffer));
+		append(key, b.offset);
+		append(key, b.range);
+		append(key, static_cast<VkImageView>(b.imageView));
+		append(key, b.imageLayout);
+		append(key, static_cast<VkSampler>(b.sampler));
+	}
+
+	auto existing = sets.find(key);
+	if(existing != sets.end()) {
+		allocator.getStatistics().cacheHits++;
+		return existing->second.set;
+	}
+
+	allocator.getStatistics().cacheMisses++;
+
+	CachedSet cached;
+	cached.layout = layout;
+	auto& reusable = freeSets[static_cast<VkDescriptorSetLayout>(layout)];
+	if(reusable.empty()) {
+		cached.set = allocator.allocate(layout);
+	} else {
+		cached.set = reusable.back();
+		reusable.pop_back();
+	}
+
+	for(const auto& b: bindings) {
+		if(b.imageView)
+			cached.imageViews.emplace_back(b.imageView);
+		if(b.buffer)
+			cached.buffers.emplace_back(b.buffer);
+		if(b.sampler)
+			cached.samplers.emplace_back(b.sampler);
+	}
+
+	writeDescriptorSet(logicalDevice, cached.set, bindings);
+	sets.emplace(std::move(key), cached);
+	return cached.set;
+}
+
+void DescriptorSetCache::clear() {
+	allocator.reset();
+	sets.clear();
+	freeSets.clear();
+}
+
+void DescriptorSetCache::release(vk::ImageView view) {
+	release(&CachedSet::imageViews, view);
+}
+
+void DescriptorSetCache::release(vk::Buffer buffer) {
+	release(&CachedSet::buffers, buffer);
+}
+
+void DescriptorSetCache::release(vk::Sampler sampler) {
+	release(&CachedSet::samplers, sampler);
+}
+
+template<typename T>
+void DescriptorSetCache::release(std::vector<T> CachedSet::* resources, T resource) {
+	for(auto it = sets.begin(); it != sets.end();) {
+		const auto& used = it->second.*resources;
+		if(std::find(used.begin(), used.end(), resource) == used.end()) {
+			++it;
+			continue;
+		}
+
+		freeSets[static_cast<VkDescriptorSetLayout>(it->second.layout)].emplace_back(it->second.set);
+		it = sets.erase(it);
+	}
+}
+
+void writeDescriptorSet(const vk::Device& logicalDevice, const vk::DescriptorSet& set, const std::vector<DescriptorBinding>& bindings)
+{
+	// Reserve up front, the writes point into these.
+	std::vector<vk::DescriptorBufferInfo> bufferInfos;
+	std::vector<vk::DescriptorImageInfo> imageInfos;
+	bufferInfos.reserve(bindings.size());
+	imageInfos.reserve(bindings.size());
+
+	std::vector<vk::WriteDescriptorSet> writes;
+	for(const auto& b: bindings) {
+		vk::WriteDescriptorSet write;
+		write.setDstSet(set);
+		write.setDstBinding(b.binding);
+		write.setDescriptorType(b.type);
+		write.setDescriptorCount(1);
+
+		if(b.buffer) {
+			bufferInfos.emplace_back(b.buffer, b.offset, b.range);
+			write.setPBufferInfo(&bufferInfos.back());
+		} else {
+			imageInfos.emplace_back(b.sampler, b.imageView, b.imageLayout);
+			write.setPImageInfo(&imageInfos.back());
+		}
+
+		writes.emplace_back(write);
+	}
+
+	logicalDevice.updateDescriptorSets(writes, nullptr);
+}
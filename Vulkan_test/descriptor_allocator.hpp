@@ -0,0 +1,140 @@
+//
+//  descriptor_allocator.hpp
+//  Vulkan_test
+//
+//  Created by Danny on 17/10/2026.
+//  Copyright © 2026 Danny. All rights reserved.
+//
+
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct DescriptorStatistics
+{
+	// vkAllocateDescriptorSets calls since the counters were last cleared.
+	uint32_t allocateCalls 	= 0;
+	uint32_t poolsCreated 	= 0;
+	uint32_t cacheHits 		= 0;
+	uint32_t cacheMisses 	= 0;
+};
+
+// Allocates descriptor sets from a chain of pools. When a pool runs out (eOutOfPoolMemory or
+// eFragmentedPool) a new, larger one is started, so allocation never fails for lack of space.
+class DescriptorAllocator {
+public:
+	explicit DescriptorAllocator(const vk::Device& logicalDevice, uint32_t initialSetsPerPool = 64);
+	~DescriptorAllocator();
+
+	DescriptorAllocator(const DescriptorAllocator&) = delete;
+	DescriptorAllocator& operator=(const DescriptorAllocator&) = delete;
+
+	vk::DescriptorSet allocate(const vk::DescriptorSetLayout&);
+
+	// Returns every set to the pools. Pools are kept around for reuse.
+	void reset();
+
+	DescriptorStatistics& getStatistics() { return statistics; }
+
+private:
+
+	vk::DescriptorPool grabPool();
+
+private:
+
+	vk::Device logicalDevice;
+	vk::DescriptorPool currentPool;
+	std::vector<vk::DescriptorPool> usedPools;
+	std::vector<vk::DescriptorPool> freePools;
+	uint32_t setsPerPool;
+
+	DescriptorStatistics statistics;
+};
+
+// Per frame sets that are rewritten every time they're used. Sets handed out in a frame are recycled
+// when the frame context comes around again, so steady state frames allocate nothing.
+class TransientDescriptorSets {
+public:
+	explicit TransientDescriptorSets(const vk::Device& logicalDevice);
+
+	vk::DescriptorSet acquire(const vk::DescriptorSetLayout&);
+
+	// Makes all sets acquired since the last reset available again. If far more sets are cached than
+	// the last frame needed the pools are reset to give the memory back.
+	void reset();
+
+	DescriptorStatistics& getStatistics() { return allocator.getStatistics(); }
+
+private:
+
+	struct RecycledSets
+	{
+		std::vector<vk::DescriptorSet> sets;
+		size_t used = 0;
+	};
+
+	DescriptorAllocator allocator;
+	std::unordered_map<VkDescriptorSetLayout, RecycledSets> recycled;
+	size_t cachedSets = 0;
+};
+
+// A resource bound to one binding of a descriptor set.
+struct DescriptorBinding
+{
+	uint32_t binding = 0;
+	vk::DescriptorType type = vk::DescriptorType::eUniformBuffer;
+
+	vk::Buffer buffer;
+	vk::DeviceSize offset = 0;
+	vk::DeviceSize range = VK_WHOLE_SIZE;
+
+	vk::ImageView imageView;
+	vk::ImageLayout imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
+	vk::Sampler sampler;
+};
+
+// Persistent sets, keyed by layout and the resources bound to them. A set is written once, the first
+// time its combination is requested.
+class DescriptorSetCache {
+public:
+	explicit DescriptorSetCache(const vk::Device& logicalDevice);
+
+	vk::DescriptorSet get(const vk::DescriptorSetLayout&, const std::vector<DescriptorBinding>&);
+
+	// Drops every cached set, e.g. after resources they reference were destroyed.
+	void clear();
+	// Drops the sets that reference a resource that is about to be destroyed. The gpu has to be done with
+	// them, their memory is reused for sets with the same layout.
+	void release(vk::ImageView);
+	void release(vk::Buffer);
+	void release(vk::Sampler);
+
+	DescriptorStatistics& getStatistics() { return allocator.getStatistics(); }
+
+private:
+
+	struct CachedSet
+	{
+		vk::DescriptorSet set;
+		vk::DescriptorSetLayout layout;
+		std::vector<vk::ImageView> imageViews;
+		std::vector<vk::Buffer> buffers;
+		std::vector<vk::Sampler> samplers;
+	};
+
+	template<typename T>
+	void release(std::vector<T> CachedSet::* resources, T resource);
+
+private:
+
+	vk::Device logicalDevice;
+	DescriptorAllocator allocator;
+	std::unordered_map<std::string, CachedSet> sets;
+	std::unordered_map<VkDescriptorSetLayout, std::vector<vk::DescriptorSet>> freeSets;
+};
+
+void writeDescriptorSet(const vk::Device&, const vk::DescriptorSet&, const std::vector<DescriptorBinding>&);
@@ -0,0 +1,81 @@
+//
+//  device_cache.cpp
+//  Vulkan_test
+//
+//  Created by Danny on 17/10/2026.
+//  Copyright © 2026 Danny. All rights reserved.
+//
+
+#include "device_cache.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+namespace {
+
+	struct DeviceCacheHeader
+	{
+		char magic[4] = {'V', 'K', 'D', 'C'};
+		// Bumped whenever DeviceCacheEntry changes.
+		uint32_t version = 1;
+		uint32_t entrySize = sizeof(DeviceCacheEntry);
+	};
+}
+
+uint32_t getDeviceCacheRequirements(const DeviceRequirements& reqs) {
+	return uint32_t(reqs.swapchainSupport) | uint32_t(reqs.graphicsQueueSupport) << 1 | uint32_t(reqs.headless) << 2 | uint32_t(reqs.bindless) << 3;
+}
+
+DeviceCacheEntry getDeviceCacheEntry(const vk::PhysicalDevice& device) {
+	const auto properties = device.getProperties2<vk::PhysicalDeviceProperties2, vk::PhysicalDeviceIDProperties>();
+	const auto& ids = properties.get<vk::PhysicalDeviceIDProperties>();
+
+	DeviceCacheEntry entry;
+	std::memcpy(entry.deviceUUID, &ids.deviceUUID[0], VK_UUID_SIZE);
+	std::memcpy(entry.driverUUID, &ids.driverUUID[0], VK_UUID_SIZE);
+	return entry;
+}
+
+vk::PhysicalDevice findCachedDevice(const std::vector<vk::PhysicalDevice>& devices, const DeviceCacheEntry& entry) {
+	for(const auto& device: devices) {
+		const auto ids = getDeviceCacheEntry(device);
+		if(std::memcmp(ids.deviceUUID, entry.deviceUUID, VK_UUID_SIZE) == 0 && std::memcmp(ids.driverUUID, entry.driverUUID, VK_UUID_SIZE) == 0)
+			return device;
+	}
+
+	return nullptr;
+}
+
+bool loadDeviceCache(const std::string& path, DeviceCacheEntry& entry) {
+	std::ifstream file(path, std::ios::binary);
+	if(!file)
+		return false;
+
+	const DeviceCacheHeader expected;
+	DeviceCacheHeader header;
+	file.read(reinterpret_cast<char*>(&header), sizeof(header));
+	if(!file || std::memcmp(header.magic, expected.magic, sizeof(header.magic)) != 0 || header.version != expected.version || header.entrySize != expected.entrySize)
+		return false;
+
+	file.read(reinterpret_cast<char*>(&entry), sizeof(entry));
+	return static_cast<bool>(file);
+}
+
+bool saveDeviceCache(const std::string& path, const DeviceCacheEntry& entry) {
+	// Like the pipeline cache, never leave a truncated file behind.
+	const auto temporaryPath = path + ".tmp";
+	{
+		std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+		if(!file)
+			return false;
+
+		const DeviceCacheHeader header;
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(reinterpret_cast<const char*>(&entry), sizeof(entry));
+		if(!file)
+			return false;
+	}
+
+	return std::rename(temporaryPath.c_str(), path.c_str()) == 0;
+}
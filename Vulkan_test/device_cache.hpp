@@ -0,0 +1,41 @@
+//
+//  device_cache.hpp
+//  Vulkan_test
+//
+//  Created by Danny on 17/10/2026.
+//  Copyright © 2026 Danny. All rights reserved.
+//
+
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+
+#include <string>
+#include <vector>
+
+#include "resource_descriptors.hpp"
+
+// The device an earlier run picked and what it worked out about it, so startup can skip probing every device.
+// Entries are matched by device and driver UUID, a new gpu or driver update probes again.
+struct DeviceCacheEntry
+{
+	uint8_t deviceUUID[VK_UUID_SIZE] = {};
+	uint8_t driverUUID[VK_UUID_SIZE] = {};
+	// The requirements that went into the choice, from getDeviceCacheRequirements.
+	uint32_t requirements = 0;
+	uint32_t graphicsQueueIndex = 0;
+	uint32_t transferQueueIndex = 0;
+	uint32_t computeQueueIndex = 0;
+	bool bindless = false;
+};
+
+uint32_t getDeviceCacheRequirements(const DeviceRequirements&);
+
+// Fills in the UUIDs of the device, the rest is up to the caller.
+DeviceCacheEntry getDeviceCacheEntry(const vk::PhysicalDevice&);
+
+// The device the entry was written for, or a null handle if it is gone or its driver changed.
+vk::PhysicalDevice findCachedDevice(const std::vector<vk::PhysicalDevice>&, const DeviceCacheEntry&);
+
+bool loadDeviceCache(const std::string& path, DeviceCacheEntry&);
+bool saveDeviceCache(const std::string& path, const DeviceCacheEntry&);
@@ -0,0 +1,242 @@
+//
+//  draw_queue.cpp
+//  Vulkan_test
+//
+//  Created by Danny on 17/10/2026.
+//  Copyright © 2026 Danny. All rights reserved.
+//
+
+#include "draw_queue.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+
+#include "job_system.hpp"
+#include "profiler.hpp"
+#include "vulkan_renderer.hpp"
+
+namespace {
+
+	const uint32_t radixBits = 8;
+	const uint32_t radixSize = 1 << radixBits;
+	const uint32_t radixPasses = 64 / radixBits;
+	// Fewer items than this per chunk aren't worth a job.
+	const uint32_t minimumChunkSize = 4096;
+
+	// Sets a draw can bind, higher ones are bound every time.
+	const uint32_t trackedSets = 4;
+
+	uint64_t getField(uint64_t value, uint32_t bits) {
+		return value & ((uint64_t(1) << bits) - 1);
+	}
+
+	// Positive floats compare like their bits, the top 16 of those keep the exponent and 7 bits of mantissa.
+	uint64_t getDepthField(float depth) {
+		uint32_t bits = 0;
+		depth = std::max(depth, 0.0f);
+		std::memcpy(&bits, &depth, sizeof(bits));
+		return bits >> 16;
+	}
+}
+
+uint64_t getDrawKey(uint32_t pass, DrawOrder order, resource_handle_t pipeline, uint32_t material, uint32_t geometry, float depth) {
+	const uint64_t p = getField(pass, 4);
+	const uint64_t s = getField(getHandleIndex(pipeline), 16) << 28 | getField(material, 16) << 12 | getField(geometry, 12);
+	const uint64_t d = getDepthField(depth);
+
+	if(order == DrawOrder::BACK_TO_FRONT)
+		return p << 60 | (0xffff - d) << 44 | s;
+	return p << 60 | s << 16 | d;
+}
+
+uint64_t getDrawKey(uint32_t pass, DrawOrder order, resource_handle_t pipeline, const Primitive& primitive, uint32_t geometry, float depth) {
+	return getDrawKey(pass, order, pipeline, static_cast<uint32_t>(primitive.material + 1), geometry, depth);
+}
+
+void DrawQueue::clear() {
+	draws.clear();
+	pushConstantData.clear();
+	order.clear();
+
+	std::lock_guard<std::mutex> lock(statisticsMutex);
+	statistics = DrawQueueStatistics();
+}
+
+void DrawQueue::reserve(uint32_t count) {
+	draws.reserve(count);
+	order.reserve(count);
+}
+
+void DrawQueue::add(uint64_t key, const DrawCommand& command, const void* pushConstants, uint32_t pushConstantSize) {
+	Draw draw;
+	draw.command = command;
+	draw.pushConstantOffset = static_cast<uint32_t>(pushConstantData.size());
+	draw.pushConstantSize = pushConstants ? pushConstantSize : 0;
+
+	if(draw.pushConstantSize) {
+		const auto* bytes = static_cast<const uint8_t*>(pushConstants);
+		pushConstantData.insert(pushConstantData.end(), bytes, bytes + pushConstantSize);
+	}
+
+	order.push_back({key, static_cast<uint32_t>(draws.size())});
+	draws.emplace_back(draw);
+}
+
+void DrawQueue::sort(JobSystem* jobSystem) {
+	PROFILE_FUNCTION();
+
+	const auto count = static_cast<uint32_t>(order.size());
+	uint32_t chunkCount = 1;
+	if(jobSystem)
+		chunkCount = std::max(1u, std::min(jobSystem->getWorkerCount() + 1, count / minimumChunkSize));
+	const auto chunkSize = (count + chunkCount - 1) / std::max(chunkCount, 1u);
+
+	scratch.resize(count);
+	histograms.resize(chunkCount * radixSize);
+
+	auto run = [&](const std::function<void(uint32_t chunk)>& body) {
+		if(chunkCount == 1)
+			body(0);
+		else
+			jobSystem->parallelFor(chunkCount, 1, [&](uint32_t begin, uint32_t end) {
+				for(auto chunk = begin; chunk < end; ++chunk)
+					body(chunk);
+			});
+	};
+
+	for(uint32_t pass = 0; pass < radixPasses; ++pass) {
+		const auto shift = pass * radixBits;
+
+		run([&](uint32_t chunk) {
+			auto* histogram = &histograms[chunk * radixSize];
+			std::fill(histogram, histogram + radixSize, 0);
+			const auto end = std::min(count, (chunk + 1) * chunkSize);
+			for(auto i = chunk * chunkSize; i < end; ++i)
+				++histogram[(order[i].key >> shift) & (radixSize - 1)];
+		});
+
+		// A digit all keys share leaves the order as it is, which is common for the pass and pipeline bits.
+		uint32_t offset = 0;
+		bool sorted = false;
+		for(uint32_t digit = 0; digit < radixSize; ++digit) {
+			uint32_t digitCount = 0;
+			for(uint32_t chunk = 0; chunk < chunkCount; ++chunk) {
+				auto& h = histograms[chunk * radixSize + digit];
+				const auto n = h;
+				h = offset + digitCount;
+				digitCount += n;
+			}
+			sorted |= digitCount == count;
+			offset += digitCount;
+		}
+
+		if(sorted)
+			continue;
+
+		run([&](uint32_t chunk) {
+			auto* next = &histograms[chunk * radixSize];
+			const auto end = std::min(count, (chunk + 1) * chunkSize);
+			for(auto i = chunk * chunkSize; i < end; ++i)
+				scratch[next[(order[i].key >> shift) & (radixSize - 1)]++] = order[i];
+		});
+
+		order.swap(scratch);
+	}
+}
+
+void DrawQueue::record(VulkanRenderer& renderer, vk::CommandBuffer commandBuffer, uint32_t begin, uint32_t end) {
+	PROFILE_FUNCTION();
+
+	end = std::min(end, static_cast<uint32_t>(order.size()));
+
+	DrawQueueStatistics s;
+	resource_handle_t boundPipeline = null_handle;
+	vk::PipelineLayout boundLayout;
+	vk::DescriptorSet boundSets[trackedSets];
+	resource_handle_t boundVertexBuffer = null_handle;
+	uint64_t boundVertexOffset = 0;
+	resource_handle_t boundIndexBuffer = null_handle;
+	uint64_t boundIndexOffset = 0;
+	vk::IndexType boundIndexType = vk::IndexType::eUint16;
+
+	for(auto i = begin; i < end; ++i) {
+		const auto& draw = draws[order[i].draw];
+		const auto& command = draw.command;
+		const auto& pipeline = renderer.getPipeline(command.pipeline);
+
+		if(command.pipeline != boundPipeline) {
+			commandBuffer.bindPipeline(pipeline.bindPoint, pipeline.pipeline);
+			boundPipeline = command.pipeline;
+			++s.pipelineBinds;
+
+			// Sets bound with another layout may be disturbed.
+			if(pipeline.layout != boundLayout) {
+				boundLayout = pipeline.layout;
+				std::fill(boundSets, boundSets + trackedSets, vk::DescriptorSet());
+			}
+		} else {
+			++s.pipelineBindsSkipped;
+		}
+
+		if(command.descriptorSet) {
+			if(command.set >= trackedSets || boundSets[command.set] != command.descriptorSet) {
+				commandBuffer.bindDescriptorSets(pipeline.bindPoint, pipeline.layout, command.set, command.descriptorSet, nullptr);
+				if(command.set < trackedSets)
+					boundSets[command.set] = command.descriptorSet;
+				++s.descriptorSetBinds;
+			} else {
+				++s.descriptorSetBindsSkipped;
+			}
+		}
+
+		if(draw.pushConstantSize)
+			renderer.pushConstants(commandBuffer, command.pipeline, &pushConstantData[draw.pushConstantOffset], draw.pushConstantSize);
+
+		if(command.vertexBuffer != null_handle) {
+			if(command.vertexBuffer != boundVertexBuffer || command.vertexBufferOffset != boundVertexOffset) {
+				const vk::DeviceSize offset = command.vertexBufferOffset;
+				commandBuffer.bindVertexBuffers(0, renderer.getBuffer(command.vertexBuffer).buffer, offset);
+				boundVertexBuffer = command.vertexBuffer;
+				boundVertexOffset = command.vertexBufferOffset;
+				++s.vertexBufferBinds;
+			} else {
+				++s.vertexBufferBindsSkipped;
+			}
+		}
+
+		if(command.indexBuffer != null_handle) {
+			if(command.indexBuffer != boundIndexBuffer || command.indexBufferOffset != boundIndexOffset || command.indexType != boundIndexType) {
+				commandBuffer.bindIndexBuffer(renderer.getBuffer(command.indexBuffer).buffer, command.indexBufferOffset, command.indexType);
+				boundIndexBuffer = command.indexBuffer;
+				boundIndexOffset = command.indexBufferOffset;
+				boundIndexType = command.indexType;
+				++s.indexBufferBinds;
+			} else {
+				++s.indexBufferBindsSkipped;
+			}
+
+			commandBuffer.drawIndexed(command.count, command.instanceCount, command.first, command.vertexOffset, command.firstInstance);
+		} else {
+			commandBuffer.draw(command.count, command.instanceCount, command.first, command.firstInstance);
+		}
+
+		++s.draws;
+	}
+
+	std::lock_guard<std::mutex> lock(statisticsMutex);
+	statistics.draws += s.draws;
+	statistics.pipelineBinds += s.pipelineBinds;
+	statistics.descriptorSetBinds += s.descriptorSetBinds;
+	statistics.vertexBufferBinds += s.vertexBufferBinds;
+	statistics.indexBufferBinds += s.indexBufferBinds;
+	statistics.pipelineBindsSkipped += s.pipelineBindsSkipped;
+	statistics.descriptorSetBindsSkipped += s.descriptorSetBindsSkipped;
+	statistics.vertexBufferBindsSkipped += s.vertexBufferBindsSkipped;
+	statistics.indexBufferBindsSkipped += s.indexBufferBindsSkipped;
+}
+
+DrawQueueStatistics DrawQueue::getStatistics() const {
+	std::lock_guard<std::mutex> lock(statisticsMutex);
+	return statistics;
+}
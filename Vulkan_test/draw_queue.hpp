@@ -0,0 +1,130 @@
+//
+//  draw_queue.hpp
+//  Vulkan_test
+//
+//  Created by Danny on 17/10/2026.
+//  Copyright © 2026 Danny. All rights reserved.
+//
+
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "resource_descriptors.hpp"
+
+class JobSystem;
+class VulkanRenderer;
+
+// How the draws within a pass are ordered.
+enum class DrawOrder
+{
+	// By pipeline, material and geometry, then front to back. For opaque draws.
+	STATE,
+	// Back to front before anything else. For blended draws.
+	BACK_TO_FRONT
+};
+
+// Builds the 64 bit key draws are sorted by, most significant first:
+//
+//	STATE			pass:4 pipeline:16 material:16 geometry:12 depth:16
+//	BACK_TO_FRONT	pass:4 depth:16 pipeline:16 material:16 geometry:12
+//
+// Handles (their slot, not the generation) and ids are truncated to their field, which only costs sorting quality. depth is the (positive)
+// view space distance.
+uint64_t getDrawKey(uint32_t pass, DrawOrder, resource_handle_t pipeline, uint32_t material, uint32_t geometry, float depth);
+// The key of a glTF primitive. Its mode is already part of the pipeline, primitives without a material sort first.
+uint64_t getDrawKey(uint32_t pass, DrawOrder, resource_handle_t pipeline, const Primitive&, uint32_t geometry, float depth);
+
+// A draw and the state it needs. Indexed if it has an index buffer.
+struct DrawCommand
+{
+	resource_handle_t pipeline = null_handle;
+
+	// Bound at set, usually the material's resources.
+	vk::DescriptorSet descriptorSet;
+	uint32_t set = 0;
+
+	resource_handle_t vertexBuffer = null_handle;
+	uint64_t vertexBufferOffset = 0;
+	resource_handle_t indexBuffer = null_handle;
+	uint64_t indexBufferOffset = 0;
+	vk::IndexType indexType = vk::IndexType::eUint16;
+
+	// Indices or vertices.
+	uint32_t count = 0;
+	uint32_t first = 0;
+	int32_t vertexOffset = 0;
+	uint32_t instanceCount = 1;
+	uint32_t firstInstance = 0;
+};
+
+struct DrawQueueStatistics
+{
+	uint32_t draws = 0;
+
+	uint32_t pipelineBinds = 0;
+	uint32_t descriptorSetBinds = 0;
+	uint32_t vertexBufferBinds = 0;
+	uint32_t indexBufferBinds = 0;
+
+	// Binds that were dropped because the state was bound already.
+	uint32_t pipelineBindsSkipped = 0;
+	uint32_t descriptorSetBindsSkipped = 0;
+	uint32_t vertexBufferBindsSkipped = 0;
+	uint32_t indexBufferBindsSkipped = 0;
+};
+
+// Draws collected from the scene, sorted by key and recorded without binding anything that is bound already.
+// Filled and recorded every frame: clear, add, sort, record.
+class DrawQueue {
+public:
+	// Also resets the statistics.
+	void clear();
+	void reserve(uint32_t draws);
+
+	// pushConstants, if any, are pushed at offset 0 of the draw's pipeline.
+	void add(uint64_t key, const DrawCommand&, const void* pushConstants = nullptr, uint32_t pushConstantSize = 0);
+	uint32_t size() const { return static_cast<uint32_t>(draws.size()); }
+
+	// Stable radix sort of the keys. With a job system every pass histograms and scatters in parallel.
+	void sort(JobSystem* jobSystem = nullptr);
+
+	// Records the sorted draws [begin, end). Nothing is assumed to be bound at the start, so ranges can go to
+	// the secondary command buffers of VulkanRenderer::recordParallel. Thread safe.
+	void record(VulkanRenderer&, vk::CommandBuffer, uint32_t begin = 0, uint32_t end = ~0u);
+
+	// What the recordings since the last clear did.
+	DrawQueueStatistics getStatistics() const;
+
+private:
+
+	struct SortItem
+	{
+		uint64_t key;
+		uint32_t draw;
+	};
+
+	struct Draw
+	{
+		DrawCommand command;
+		uint32_t pushConstantOffset;
+		uint32_t pushConstantSize;
+	};
+
+private:
+
+	std::vector<Draw> draws;
+	std::vector<uint8_t> pushConstantData;
+
+	std::vector<SortItem> order;
+	std::vector<SortItem> scratch;
+	// Digit counts of each chunk, then where its items go.
+	std::vector<uint32_t> histograms;
+
+	mutable std::mutex statisticsMutex;
+	DrawQueueStatistics statistics;
+};
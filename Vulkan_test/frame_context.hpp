@@ -0,0 +1,65 @@
+//
+//  frame_context.hpp
+//  Vulkan_test
+//
+//  Created by Danny on 17/10/2026.
+//  Copyright © 2026 Danny. All rights reserved.
+//
+
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+
+#include <memory>
+#include <vector>
+
+#include "descriptor_allocator.hpp"
+
+// Secondary command buffers recorded by one thread. The pool is only ever touched by its owning
+// thread, so no locking is needed while recording.
+struct ThreadCommandPool
+{
+	vk::CommandPool commandPool;
+	std::vector<vk::CommandBuffer> secondaryCommandBuffers;
+	uint32_t used = 0;
+};
+
+// Everything the cpu touches while recording a frame. There is one of these per frame in flight,
+// a frame context is only reused once the gpu signaled its fence.
+struct FrameContext
+{
+	// Reset as a whole at the start of the frame, never per command buffer.
+	vk::CommandPool commandPool;
+	vk::CommandBuffer commandBuffer;
+
+	// One pool per job system worker plus one for the render thread.
+	std::vector<ThreadCommandPool> threadCommandPools;
+
+	// Descriptor sets that only live for this frame.
+	std::unique_ptr<TransientDescriptorSets> descriptorSets;
+
+	// Signaled when the swapchain image can be rendered to.
+	vk::Semaphore imageAvailable;
+	// Signaled when rendering is done and the image can be presented.
+	vk::Semaphore renderFinished;
+	// Signaled when the gpu finished executing this frame.
+	vk::Fence inFlight;
+
+	// Value of the uploader's timeline semaphore this frame waits for before reading uploaded data.
+	uint64_t uploadWaitValue = 0;
+
+	// Async compute work recorded during the frame, on the compute family. Reset once the compute timeline
+	// reached the value of its last submission.
+	vk::CommandPool computeCommandPool;
+	std::vector<vk::CommandBuffer> computeCommandBuffers;
+	uint32_t usedComputeCommandBuffers = 0;
+	uint64_t lastComputeValue = 0;
+	// What the frame's own submission waits for on the compute timeline, 0 for nothing.
+	uint64_t computeWaitValue = 0;
+	vk::PipelineStageFlags computeWaitStages;
+
+	// Whether the frame renders to and presents swapChainImageIndex.
+	bool swapChainImageAcquired = false;
+	uint32_t swapChainImageIndex = 0;
+	uint64_t frameNumber = 0;
+};
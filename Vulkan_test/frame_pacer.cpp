@@ -0,0 +1,112 @@
+//
+//  frame_pacer.cpp
+//  Vulkan_test
+//
+//  Created by Danny on 17/10/2026.
+//  Copyright © 2026 Danny. All rights reserved.
+//
+
+#include "frame_pacer.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+#include "profiler.hpp"
+
+namespace {
+	// Sleeping overshoots by up to a scheduler tick, the last stretch is spent yielding instead.
+	const uint64_t spinTime = 1000000;
+
+	double getMilliseconds(uint64_t nanoseconds) {
+		return static_cast<double>(nanoseconds) / 1e6;
+	}
+
+	void push(std::vector<uint64_t>& ring, uint32_t& next, uint32_t size, uint64_t value) {
+		if(ring.size() < size)
+			ring.emplace_back(value);
+		else
+			ring[next] = value;
+		next = (next + 1) % size;
+	}
+
+	// Of a sorted range.
+	double getPercentile(const std::vector<uint64_t>& sorted, uint32_t percent) {
+		return getMilliseconds(sorted[(sorted.size() - 1) * percent / 100]);
+	}
+
+	double getMean(const std::vector<uint64_t>& values) {
+		uint64_t sum = 0;
+		for(auto value: values)
+			sum += value;
+		return getMilliseconds(sum) / static_cast<double>(values.size());
+	}
+}
+
+void FramePacer::setTargetInterval(double milliseconds) {
+	targetInterval = milliseconds > 0 ? static_cast<uint64_t>(milliseconds * 1e6) : 0;
+	nextFrameTime = 0;
+}
+
+void FramePacer::wait() {
+	if(!targetInterval)
+		return;
+
+	auto now = Profiler::now();
+	if(now + spinTime < nextFrameTime)
+		std::this_thread::sleep_for(std::chrono::nanoseconds(nextFrameTime - now - spinTime));
+	while((now = Profiler::now()) < nextFrameTime)
+		std::this_thread::yield();
+
+	nextFrameTime = now > nextFrameTime + targetInterval ? now + targetInterval : nextFrameTime + targetInterval;
+}
+
+void FramePacer::setInputTime(uint64_t frame, uint64_t time) {
+	auto& input = inputTimes[frame % inputSlots];
+	input.frame = frame;
+	input.time = time;
+}
+
+void FramePacer::setPresentTime(uint64_t frame, uint64_t time) {
+	const auto& input = inputTimes[frame % inputSlots];
+	if(input.frame == frame && time >= input.time)
+		push(latencies, nextLatency, historySize, time - input.time);
+
+	if(lastPresentTime && time >= lastPresentTime)
+		push(intervals, nextInterval, historySize, time - lastPresentTime);
+	lastPresentTime = time;
+}
+
+PresentStatistics FramePacer::getStatistics() const {
+	PresentStatistics statistics;
+	statistics.frames = static_cast<uint32_t>(latencies.size());
+
+	if(!latencies.empty()) {
+		auto sorted = latencies;
+		std::sort(sorted.begin(), sorted.end());
+		statistics.latencyMean = getMean(sorted);
+		statistics.latencyMin = getMilliseconds(sorted.front());
+		statistics.latencyMax = getMilliseconds(sorted.back());
+		statistics.latencyMedian = getPercentile(sorted, 50);
+		statistics.latency99 = getPercentile(sorted, 99);
+	}
+
+	if(!intervals.empty()) {
+		auto sorted = intervals;
+		std::sort(sorted.begin(), sorted.end());
+		statistics.intervalMean = getMean(sorted);
+		statistics.interval99 = getPercentile(sorted, 99);
+	}
+
+	return statistics;
+}
+
+void FramePacer::clear() {
+	for(auto& input: inputTimes)
+		input = InputTime();
+	lastPresentTime = 0;
+	latencies.clear();
+	intervals.clear();
+	nextLatency = 0;
+	nextInterval = 0;
+}
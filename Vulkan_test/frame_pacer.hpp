@@ -0,0 +1,79 @@
+//
+//  frame_pacer.hpp
+//  Vulkan_test
+//
+//  Created by Danny on 17/10/2026.
+//  Copyright © 2026 Danny. All rights reserved.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// How presentation went over the last frames the FramePacer remembers. Times are in milliseconds.
+struct PresentStatistics
+{
+	uint32_t frames = 0;
+
+	// From reading input (or the start of the frame) until the frame was presented.
+	double latencyMean = 0;
+	double latencyMin = 0;
+	double latencyMax = 0;
+	double latencyMedian = 0;
+	double latency99 = 0;
+
+	// Between consecutive presents, which shows how even the pacing is.
+	double intervalMean = 0;
+	double interval99 = 0;
+
+	// Presents were timed by VK_KHR_present_wait. Otherwise a frame counts as presented once its rendering was seen
+	// to be finished, which leaves out the wait for the display.
+	bool presentWait = false;
+	uint32_t swapChainRecreations = 0;
+};
+
+// Paces the frames of the render thread to a target interval and measures their input to present latency.
+// Frames are identified by their frame number, presents have to be reported in order.
+class FramePacer {
+public:
+	// 0 starts every frame right away.
+	void setTargetInterval(double milliseconds);
+	double getTargetInterval() const { return static_cast<double>(targetInterval) / 1e6; }
+
+	// Sleeps until the next frame is due. A frame that is late by more than an interval restarts the schedule
+	// rather than being followed by a burst of short frames.
+	void wait();
+
+	// Times are from Profiler::now().
+	void setInputTime(uint64_t frame, uint64_t time);
+	void setPresentTime(uint64_t frame, uint64_t time);
+
+	PresentStatistics getStatistics() const;
+	void clear();
+
+private:
+
+	struct InputTime
+	{
+		uint64_t frame = UINT64_MAX;
+		uint64_t time = 0;
+	};
+
+	// Frames whose input was read but that weren't presented yet, indexed by frame number.
+	static const uint32_t inputSlots = 16;
+	// Presents the statistics cover.
+	static const uint32_t historySize = 256;
+
+	uint64_t targetInterval = 0;
+	uint64_t nextFrameTime = 0;
+
+	InputTime inputTimes[inputSlots];
+	uint64_t lastPresentTime = 0;
+
+	// Rings of the last historySize latencies and intervals, in nanoseconds.
+	std::vector<uint64_t> latencies;
+	std::vector<uint64_t> intervals;
+	uint32_t nextLatency = 0;
+	uint32_t nextInterval = 0;
+};
@@ -0,0 +1,330 @@
+//
+//  frustum_culling.cpp
+//  Vulkan_test
+//
+//  Created by Danny on 17/10/2026.
+//  Copyright © 2026 Danny. All rights reserved.
+//
+
+#include "frustum_culling.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include "frustum_culling_avx2.hpp"
+#include "gltf_loader.hpp"
+#include "job_system.hpp"
+#include "profiler.hpp"
+#include "scene_transforms.hpp"
+
+#if defined(__SSE__) || defined(_M_X64)
+#include <immintrin.h>
+#define FRUSTUM_CULLING_SSE 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define FRUSTUM_CULLING_NEON 1
+#endif
+
+namespace {
+
+	// The world space arrays are padded to a multiple of this many objects.
+	const uint32_t blockSize = 8;
+	// Blocks culled by one job.
+	const uint32_t chunkBlocks = 128;
+	// Objects whose bounds are updated by one job.
+	const uint32_t boundsJobSize = 4096;
+
+	// Per plane: a, b, c, d, |a|, |b|, |c| and padding.
+	const uint32_t planeStride = 8;
+	const uint32_t viewStride = 6 * planeStride;
+
+	const float padding = std::numeric_limits<float>::quiet_NaN();
+
+	void normalise(float plane[4]) {
+		const float length = std::sqrt(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+		if(length == 0)
+			return;
+
+		for(int i = 0; i < 4; ++i)
+			plane[i] /= length;
+	}
+
+	// Appends the indices of the set bits of mask, offset by base.
+	inline uint32_t appendVisible(uint32_t mask, uint32_t base, uint32_t* output) {
+		uint32_t written = 0;
+		while(mask) {
+#if defined(__GNUC__) || defined(__clang__)
+			const uint32_t bit = static_cast<uint32_t>(__builtin_ctz(mask));
+#else
+			uint32_t bit = 0;
+			while(!(mask & (1u << bit)))
+				++bit;
+#endif
+			output[written++] = base + bit;
+			mask &= mask - 1;
+		}
+		return written;
+	}
+}
+
+Frustum getFrustum(const float m[16]) {
+	// Gribb and Hartmann: the planes are sums of the rows of the matrix. Row i is m[i], m[4 + i], m[8 + i], m[12 + i].
+	auto row = [&](int i, float sign, int j, float* plane) {
+		for(int c = 0; c < 4; ++c)
+			plane[c] = m[c * 4 + i] + sign * (j < 0 ? 0 : m[c * 4 + j]);
+	};
+
+	Frustum frustum;
+	row(3, 1, 0, frustum.planes[0]);	// left: w + x
+	row(3, -1, 0, frustum.planes[1]);	// right: w - x
+	row(3, 1, 1, frustum.planes[2]);	// bottom: w + y
+	row(3, -1, 1, frustum.planes[3]);	// top: w - y
+	row(2, 0, -1, frustum.planes[4]);	// near: z, clip depth starts at 0
+	row(3, -1, 2, frustum.planes[5]);	// far: w - z
+
+	for(auto& plane: frustum.planes)
+		normalise(plane);
+
+	return frustum;
+}
+
+uint32_t FrustumCuller::addObject(const float localMin[3], const float localMax[3], uint32_t transform) {
+	for(int i = 0; i < 3; ++i)
+		localBounds.emplace_back((localMin[i] + localMax[i]) * 0.5f);
+	for(int i = 0; i < 3; ++i)
+		localBounds.emplace_back((localMax[i] - localMin[i]) * 0.5f);
+
+	transforms.emplace_back(transform);
+
+	if(count % blockSize == 0) {
+		for(auto* array: {&centreX, &centreY, &centreZ, &extentX, &extentY, &extentZ})
+			array->resize(array->size() + blockSize, padding);
+	}
+
+	boundsStale = true;
+	return count++;
+}
+
+void FrustumCuller::clear() {
+	count = 0;
+	boundsStale = false;
+	localBounds.clear();
+	transforms.clear();
+	for(auto* array: {&centreX, &centreY, &centreZ, &extentX, &extentY, &extentZ})
+		array->clear();
+}
+
+void FrustumCuller::getWorldBounds(uint32_t object, float centre[3], float extents[3]) const {
+	centre[0] = centreX[object];
+	centre[1] = centreY[object];
+	centre[2] = centreZ[object];
+	extents[0] = extentX[object];
+	extents[1] = extentY[object];
+	extents[2] = extentZ[object];
+}
+
+void FrustumCuller::updateBounds(const SceneTransforms& scene, JobSystem* jobSystem) {
+	PROFILE_FUNCTION();
+
+	const bool all = boundsStale;
+	if(jobSystem) {
+		jobSystem->parallelFor(count, boundsJobSize, [&](uint32_t begin, uint32_t end) {
+			updateBounds(scene, begin, end, all);
+		});
+	} else {
+		updateBounds(scene, 0, count, all);
+	}
+
+	boundsStale = false;
+}
+
+void FrustumCuller::updateBounds(const SceneTransforms& scene, uint32_t begin, uint32_t end, bool all) {
+	for(auto object = begin; object < end; ++object) {
+		const auto transform = transforms[object];
+		if(!all && !scene.hasChanged(transform))
+			continue;
+
+		// Arvo: the centre moves with the matrix, the extents with its absolute value.
+		const float* m = scene.getWorldMatrix(transform);
+		const float* c = &localBounds[object * 6];
+		const float* e = c + 3;
+
+		centreX[object] = m[0] * c[0] + m[4] * c[1] + m[8] * c[2] + m[12];
+		centreY[object] = m[1] * c[0] + m[5] * c[1] + m[9] * c[2] + m[13];
+		centreZ[object] = m[2] * c[0] + m[6] * c[1] + m[10] * c[2] + m[14];
+		extentX[object] = std::abs(m[0]) * e[0] + std::abs(m[4]) * e[1] + std::abs(m[8]) * e[2];
+		extentY[object] = std::abs(m[1]) * e[0] + std::abs(m[5]) * e[1] + std::abs(m[9]) * e[2];
+		extentZ[object] = std::abs(m[2]) * e[0] + std::abs(m[6]) * e[1] + std::abs(m[10]) * e[2];
+	}
+}
+
+void FrustumCuller::cull(const Frustum* frustums, uint32_t viewCount, std::vector<std::vector<uint32_t>>& visible, JobSystem* jobSystem) {
+	PROFILE_FUNCTION();
+
+	planeData.assign(viewCount * viewStride, 0);
+	for(uint32_t view = 0; view < viewCount; ++view) {
+		for(uint32_t p = 0; p < 6; ++p) {
+			const float* plane = frustums[view].planes[p];
+			float* data = &planeData[view * viewStride + p * planeStride];
+			std::copy(plane, plane + 4, data);
+			for(int i = 0; i < 3; ++i)
+				data[4 + i] = std::abs(plane[i]);
+		}
+	}
+
+	// Every chunk writes its results where its objects start, then they're moved together.
+	const uint32_t blockCount = (count + blockSize - 1) / blockSize;
+	const uint32_t chunkCount = (blockCount + chunkBlocks - 1) / chunkBlocks;
+	chunkCounts.assign(chunkCount * viewCount, 0);
+
+	visible.resize(viewCount);
+	for(auto& list: visible)
+		list.resize(blockCount * blockSize);
+
+	auto cullChunks = [&](uint32_t begin, uint32_t end) {
+		for(auto chunk = begin; chunk < end; ++chunk)
+			cullBlocks(planeData.data(), viewCount, chunk * chunkBlocks, std::min((chunk + 1) * chunkBlocks, blockCount), visible, &chunkCounts[chunk * viewCount]);
+	};
+
+	if(jobSystem)
+		jobSystem->parallelFor(chunkCount, 1, cullChunks);
+	else
+		cullChunks(0, chunkCount);
+
+	for(uint32_t view = 0; view < viewCount; ++view) {
+		auto& list = visible[view];
+		uint32_t written = 0;
+		for(uint32_t chunk = 0; chunk < chunkCount; ++chunk) {
+			const auto n = chunkCounts[chunk * viewCount + view];
+			const auto source = chunk * chunkBlocks * blockSize;
+			if(source != written)
+				std::memmove(&list[written], &list[source], n * sizeof(uint32_t));
+			written += n;
+		}
+		list.resize(written);
+	}
+}
+
+std::vector<MeshInstance> addGltfMeshes(FrustumCuller& culler, const GltfScene& scene, const SceneTransforms& transforms) {
+	std::vector<MeshInstance> instances;
+	for(uint32_t index = 0; index < transforms.size(); ++index) {
+		const auto node = transforms.getSourceNode(index);
+		const auto mesh = scene.nodes[node].mesh;
+		if(mesh < 0 || mesh >= static_cast<int32_t>(scene.meshes.size()))
+			continue;
+
+		const auto& primitives = scene.meshes[mesh].primitives;
+		for(uint32_t primitive = 0; primitive < primitives.size(); ++primitive) {
+			const auto position = primitives[primitive].attributes.find("POSITION");
+			if(position == primitives[primitive].attributes.end() || position->second < 0 || position->second >= static_cast<int32_t>(scene.accessors.size()))
+				continue;
+
+			const auto& accessor = scene.accessors[position->second];
+			if(accessor.min.size() < 3 || accessor.max.size() < 3)
+				continue;
+
+			culler.addObject(accessor.min.data(), accessor.max.data(), index);
+
+			MeshInstance instance;
+			instance.node = node;
+			instance.mesh = mesh;
+			instance.primitive = primitive;
+			instances.emplace_back(instance);
+		}
+	}
+
+	return instances;
+}
+
+void FrustumCuller::cullBlocks(const float* planes, uint32_t viewCount, uint32_t beginBlock, uint32_t endBlock,
+							   std::vector<std::vector<uint32_t>>& visible, uint32_t* counts) const {
+	const uint32_t base = beginBlock * blockSize;
+
+	if(hasFrustumCullingAvx2()) {
+		const float* const bounds[6] {centreX.data(), centreY.data(), centreZ.data(), extentX.data(), extentY.data(), extentZ.data()};
+		std::vector<uint32_t*> outputs(viewCount);
+		for(uint32_t view = 0; view < viewCount; ++view)
+			outputs[view] = visible[view].data() + base;
+
+		cullBlocksAvx2(bounds, planes, viewCount, viewStride, planeStride, beginBlock, endBlock, outputs.data(), counts);
+		return;
+	}
+
+	for(auto block = beginBlock; block < endBlock; ++block) {
+		const uint32_t first = block * blockSize;
+
+#if defined(FRUSTUM_CULLING_SSE) || defined(FRUSTUM_CULLING_NEON)
+		for(uint32_t half = 0; half < blockSize; half += 4) {
+#if defined(FRUSTUM_CULLING_SSE)
+			const __m128 cx = _mm_loadu_ps(&centreX[first + half]);
+			const __m128 cy = _mm_loadu_ps(&centreY[first + half]);
+			const __m128 cz = _mm_loadu_ps(&centreZ[first + half]);
+			const __m128 ex = _mm_loadu_ps(&extentX[first + half]);
+			const __m128 ey = _mm_loadu_ps(&extentY[first + half]);
+			const __m128 ez = _mm_loadu_ps(&extentZ[first + half]);
+#else
+			const float32x4_t cx = vld1q_f32(&centreX[first + half]);
+			const float32x4_t cy = vld1q_f32(&centreY[first + half]);
+			const float32x4_t cz = vld1q_f32(&centreZ[first + half]);
+			const float32x4_t ex = vld1q_f32(&extentX[first + half]);
+			const float32x4_t ey = vld1q_f32(&extentY[first + half]);
+			const float32x4_t ez = vld1q_f32(&extentZ[first + half]);
+			const uint32_t bitValues[4] = {1, 2, 4, 8};
+			const uint32x4_t bits = vld1q_u32(bitValues);
+#endif
+
+			for(uint32_t view = 0; view < viewCount; ++view) {
+#if defined(FRUSTUM_CULLING_SSE)
+				__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+				for(uint32_t p = 0; p < 6; ++p) {
+					const float* plane = planes + view * viewStride + p * planeStride;
+					__m128 d = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane[0]), cx), _mm_set1_ps(plane[3]));
+					d = _mm_add_ps(d, _mm_mul_ps(_mm_set1_ps(plane[1]), cy));
+					d = _mm_add_ps(d, _mm_mul_ps(_mm_set1_ps(plane[2]), cz));
+					d = _mm_add_ps(d, _mm_mul_ps(_mm_set1_ps(plane[4]), ex));
+					d = _mm_add_ps(d, _mm_mul_ps(_mm_set1_ps(plane[5]), ey));
+					d = _mm_add_ps(d, _mm_mul_ps(_mm_set1_ps(plane[6]), ez));
+					inside = _mm_and_ps(inside, _mm_cmpge_ps(d, _mm_setzero_ps()));
+				}
+
+				const auto mask = static_cast<uint32_t>(_mm_movemask_ps(inside));
+#else
+				uint32x4_t inside = vdupq_n_u32(~0u);
+				for(uint32_t p = 0; p < 6; ++p) {
+					const float* plane = planes + view * viewStride + p * planeStride;
+					float32x4_t d = vmlaq_n_f32(vdupq_n_f32(plane[3]), cx, plane[0]);
+					d = vmlaq_n_f32(d, cy, plane[1]);
+					d = vmlaq_n_f32(d, cz, plane[2]);
+					d = vmlaq_n_f32(d, ex, plane[4]);
+					d = vmlaq_n_f32(d, ey, plane[5]);
+					d = vmlaq_n_f32(d, ez, plane[6]);
+					inside = vandq_u32(inside, vcgeq_f32(d, vdupq_n_f32(0)));
+				}
+
+				const auto mask = vaddvq_u32(vandq_u32(inside, bits));
+#endif
+				counts[view] += appendVisible(mask, first + half, &visible[view][base + counts[view]]);
+			}
+		}
+#else
+		for(uint32_t view = 0; view < viewCount; ++view) {
+			uint32_t mask = 0;
+			for(uint32_t i = 0; i < blockSize; ++i) {
+				const auto object = first + i;
+				bool inside = true;
+				for(uint32_t p = 0; p < 6 && inside; ++p) {
+					const float* plane = planes + view * viewStride + p * planeStride;
+					const float d = plane[0] * centreX[object] + plane[1] * centreY[object] + plane[2] * centreZ[object] + plane[3] +
+						plane[4] * extentX[object] + plane[5] * extentY[object] + plane[6] * extentZ[object];
+					inside = d >= 0;
+				}
+				mask |= inside ? 1u << i : 0;
+			}
+
+			counts[view] += appendVisible(mask, first, &visible[view][base + counts[view]]);
+		}
+#endif
+	}
+}
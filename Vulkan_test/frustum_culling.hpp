@@ -0,0 +1,89 @@
+//
+//  frustum_culling.hpp
+//  Vulkan_test
+//
+//  Created by Danny on 17/10/2026.
+//  Copyright © 2026 Danny. All rights reserved.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+class JobSystem;
+class SceneTransforms;
+struct GltfScene;
+
+// Six planes (left, right, bottom, top, near, far) as a, b, c, d. A point p is inside a plane when
+// a * p.x + b * p.y + c * p.z + d >= 0.
+struct Frustum
+{
+	float planes[6][4];
+};
+
+// The frustum of a column major view projection matrix with Vulkan's [0, 1] clip depth. Works with
+// reversed and infinite depth too, an infinite far plane never rejects anything.
+Frustum getFrustum(const float viewProjection[16]);
+
+// Visibility of objects with an axis aligned bounding box against any number of views, like the main camera
+// and the cascades of a shadow map. World space boxes are kept as centres and extents, one array per
+// component, and are tested 8 at a time with AVX2 when the cpu has it (4 with SSE or NEON otherwise). Every object
+// is loaded once and tested against all views before moving on.
+class FrustumCuller {
+public:
+	// A box in the object's local space, placed in the world by a node of SceneTransforms. Returns the
+	// object's index, which is what the visible lists hold.
+	uint32_t addObject(const float localMin[3], const float localMax[3], uint32_t transform);
+	void clear();
+
+	uint32_t size() const { return count; }
+
+	// Recomputes the world space boxes of objects whose transform changed in the last SceneTransforms::update,
+	// or of all of them after objects were added.
+	void updateBounds(const SceneTransforms&, JobSystem* jobSystem = nullptr);
+
+	// Fills visible[view] with the indices of the objects inside frustums[view], in ascending order.
+	// With a job system the objects are split into chunks that are culled in parallel.
+	void cull(const Frustum* frustums, uint32_t viewCount, std::vector<std::vector<uint32_t>>& visible, JobSystem* jobSystem = nullptr);
+
+	// The world space box of an object as of the last updateBounds.
+	void getWorldBounds(uint32_t object, float centre[3], float extents[3]) const;
+
+private:
+
+	void updateBounds(const SceneTransforms&, uint32_t begin, uint32_t end, bool all);
+	// Writes the visible objects of each view to visible[view], starting at the first object of beginBlock.
+	void cullBlocks(const float* planes, uint32_t viewCount, uint32_t beginBlock, uint32_t endBlock,
+					std::vector<std::vector<uint32_t>>& visible, uint32_t* counts) const;
+
+private:
+
+	uint32_t count = 0;
+	bool boundsStale = false;
+
+	// Local boxes as centre and extents, and the node placing them.
+	std::vector<float> localBounds;
+	std::vector<uint32_t> transforms;
+
+	// World space boxes padded to a multiple of 8. Padding has a NaN centre, which fails every plane test.
+	std::vector<float> centreX, centreY, centreZ;
+	std::vector<float> extentX, extentY, extentZ;
+
+	// The planes of the views being culled, with the absolute values of their normals.
+	std::vector<float> planeData;
+	// Visible counts of each chunk and view, for compacting the per chunk results.
+	std::vector<uint32_t> chunkCounts;
+};
+
+// What a culled object of a glTF scene draws.
+struct MeshInstance
+{
+	int32_t node = -1;
+	int32_t mesh = -1;
+	uint32_t primitive = 0;
+};
+
+// Adds an object for every primitive of every mesh node the transforms know about, bounded by the min and max
+// glTF requires on POSITION accessors. Element i of the result describes the i-th object added.
+std::vector<MeshInstance> addGltfMeshes(FrustumCuller&, const GltfScene&, const SceneTransforms&);
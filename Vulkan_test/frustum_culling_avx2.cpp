@@ -0,0 +1,76 @@
+//
+//  frustum_culling_avx2.cpp
+//  Vulkan_test
+//
+//  Created by Danny on 17/10/2026.
+//  Copyright © 2026 Danny. All rights reserved.
+//
+
+#include "frustum_culling_avx2.hpp"
+
+#include "cpu_features.hpp"
+
+#if defined(__AVX2__) && defined(__FMA__)
+#include <immintrin.h>
+
+namespace {
+
+	// Objects per block, as in frustum_culling.cpp.
+	const uint32_t blockSize = 8;
+
+	// Same as the one in frustum_culling.cpp, kept separate so it isn't compiled for AVX2 there as well.
+	uint32_t appendVisible(uint32_t mask, uint32_t base, uint32_t* output) {
+		uint32_t written = 0;
+		while(mask) {
+			output[written++] = base + static_cast<uint32_t>(__builtin_ctz(mask));
+			mask &= mask - 1;
+		}
+		return written;
+	}
+}
+
+bool hasFrustumCullingAvx2() {
+	return cpuHasAvx2Fma();
+}
+
+void cullBlocksAvx2(const float* const bounds[6], const float* planes, uint32_t viewCount, uint32_t viewStride, uint32_t planeStride,
+					uint32_t beginBlock, uint32_t endBlock, uint32_t* const* outputs, uint32_t* counts) {
+	for(auto block = beginBlock; block < endBlock; ++block) {
+		const uint32_t first = block * blockSize;
+		const __m256 cx = _mm256_loadu_ps(bounds[0] + first);
+		const __m256 cy = _mm256_loadu_ps(bounds[1] + first);
+		const __m256 cz = _mm256_loadu_ps(bounds[2] + first);
+		const __m256 ex = _mm256_loadu_ps(bounds[3] + first);
+		const __m256 ey = _mm256_loadu_ps(bounds[4] + first);
+		const __m256 ez = _mm256_loadu_ps(bounds[5] + first);
+
+		for(uint32_t view = 0; view < viewCount; ++view) {
+			// A box is outside once it's entirely behind any plane: distance of the centre plus the projected extents < 0.
+			__m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+			for(uint32_t p = 0; p < 6; ++p) {
+				const float* plane = planes + view * viewStride + p * planeStride;
+				__m256 d = _mm256_fmadd_ps(_mm256_set1_ps(plane[0]), cx, _mm256_set1_ps(plane[3]));
+				d = _mm256_fmadd_ps(_mm256_set1_ps(plane[1]), cy, d);
+				d = _mm256_fmadd_ps(_mm256_set1_ps(plane[2]), cz, d);
+				d = _mm256_fmadd_ps(_mm256_set1_ps(plane[4]), ex, d);
+				d = _mm256_fmadd_ps(_mm256_set1_ps(plane[5]), ey, d);
+				d = _mm256_fmadd_ps(_mm256_set1_ps(plane[6]), ez, d);
+				inside = _mm256_and_ps(inside, _mm256_cmp_ps(d, _mm256_setzero_ps(), _CMP_GE_OQ));
+			}
+
+			const auto mask = static_cast<uint32_t>(_mm256_movemask_ps(inside));
+			counts[view] += appendVisible(mask, first, outputs[view] + counts[view]);
+		}
+	}
+}
+
+#else
+
+// Built without -mavx2 -mfma, like the arm64 slice of a universal build.
+bool hasFrustumCullingAvx2() {
+	return false;
+}
+
+void cullBlocksAvx2(const float* const*, const float*, uint32_t, uint32_t, uint32_t, uint32_t, uint32_t, uint32_t* const*, uint32_t*) {}
+
+#endif
@@ -0,0 +1,23 @@
+//
+//  frustum_culling_avx2.hpp
+//  Vulkan_test
+//
+//  Created by Danny on 17/10/2026.
+//  Copyright © 2026 Danny. All rights reserved.
+//
+
+#pragma once
+
+#include <cstdint>
+
+// The AVX2 path of FrustumCuller. Its file is the only one built with -mavx2 -mfma, so it can't share any inline
+// code with the rest of the app: the linker could keep the AVX2 copy for everyone.
+
+// True when the kernel was built for AVX2 and the cpu has it, false on other architectures.
+bool hasFrustumCullingAvx2();
+
+// Culls the blocks of 8 objects in [beginBlock, endBlock). bounds are the centre x, y, z and extent x, y, z arrays,
+// planes are laid out per view and plane as viewStride and planeStride floats. The visible objects of each view
+// are appended at outputs[view] + counts[view], which is advanced.
+void cullBlocksAvx2(const float* const bounds[6], const float* planes, uint32_t viewCount, uint32_t viewStride, uint32_t planeStride,
+					uint32_t beginBlock, uint32_t endBlock, uint32_t* const* outputs, uint32_t* counts);
@@ -0,0 +1,552 @@
+//
+//  gltf_loader.cpp
+//  Vulkan_test
+//
+//  Created by Danny on 17/10/2026.
+//  Copyright © 2026 Danny. All rights reserved.
+//
+
+#include "gltf_loader.hpp"
+
+#include <cctype>
+#include <cstring>
+
+#include "json_tokenizer.hpp"
+
+namespace {
+
+	const uint32_t glbMagic 		= 0x46546C67; // "glTF"
+	const uint32_t glbChunkJson 	= 0x4E4F534A; // "JSON"
+	const uint32_t glbChunkBinary 	= 0x004E4942; // "BIN\0"
+
+	struct GlbHeader
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint32_t length;
+	};
+
+	struct GlbChunkHeader
+	{
+		uint32_t length;
+		uint32_t type;
+	};
+
+	std::string getDirectory(const std::string& path) {
+		const auto slash = path.find_last_of("/\\");
+		return slash == std::string::npos ? std::string() : path.substr(0, slash + 1);
+	}
+
+	int32_t getInt(const JsonView& json, uint32_t object, const char* key, int32_t fallback) {
+		const auto value = json.find(object, key);
+		return value < 0 ? fallback : static_cast<int32_t>(json.toInt(static_cast<uint32_t>(value)));
+	}
+
+	std::string getString(const JsonView& json, uint32_t object, const char* key) {
+		const auto value = json.find(object, key);
+		return value < 0 ? std::string() : json.toString(static_cast<uint32_t>(value));
+	}
+
+	template<size_t N>
+	void getFloats(const JsonView& json, uint32_t object, const char* key, float (&out)[N]) {
+		const auto value = json.find(object, key);
+		if(value < 0)
+			return;
+
+		size_t i = 0;
+		json.forEach(static_cast<uint32_t>(value), [&](uint32_t element) {
+			if(i < N)
+				out[i++] = static_cast<float>(json.toDouble(element));
+		});
+	}
+
+	template<typename T>
+	void getArray(const JsonView& json, uint32_t object, const char* key, std::vector<T>& out) {
+		const auto value = json.find(object, key);
+		if(value < 0)
+			return;
+
+		out.reserve(json[static_cast<uint32_t>(value)].size);
+		json.forEach(static_cast<uint32_t>(value), [&](uint32_t element) {
+			out.emplace_back(static_cast<T>(json.toDouble(element)));
+		});
+	}
+
+	int8_t decodeBase64Character(char c) {
+		if(c >= 'A' && c <= 'Z') return c - 'A';
+		if(c >= 'a' && c <= 'z') return c - 'a' + 26;
+		if(c >= '0' && c <= '9') return c - '0' + 52;
+		if(c == '+') return 62;
+		if(c == '/') return 63;
+		return -1;
+	}
+
+	bool decodeBase64(const std::string& text, size_t start, std::vector<uint8_t>& out) {
+		out.reserve((text.size() - start) * 3 / 4);
+		uint32_t accumulator = 0;
+		int32_t bits = 0;
+		for(size_t i = start; i < text.size(); ++i) {
+			if(text[i] == '=')
+				break;
+
+			const auto value = decodeBase64Character(text[i]);
+			if(value < 0)
+				return false;
+
+			accumulator = (accumulator << 6) | static_cast<uint32_t>(value);
+			bits += 6;
+			if(bits >= 8) {
+				bits -= 8;
+				out.push_back(static_cast<uint8_t>((accumulator >> bits) & 0xFF));
+			}
+		}
+
+		return true;
+	}
+
+	bool loadBuffers(const JsonView& json, uint32_t root, const std::string& baseDirectory, GltfScene& scene) {
+		const auto buffers = json.find(root, "buffers");
+		if(buffers < 0)
+			return true;
+
+		bool ok = true;
+		json.forEach(static_cast<uint32_t>(buffers), [&](uint32_t object) {
+			BufferResourceDescriptor buffer;
+			buffer.name = getString(json, object, "name");
+			buffer.uri = getString(json, object, "uri");
+			buffer.byteLength = getInt(json, object, "byteLength", -1);
+
+			if(buffer.uri.compare(0, 5, "data:") == 0) {
+				const auto comma = buffer.uri.find(',');
+				auto decoded = std::make_unique<std::vector<uint8_t>>();
+				if(comma == std::string::npos || !decodeBase64(buffer.uri, comma + 1, *decoded) || decoded->size() < static_cast<size_t>(buffer.byteLength)) {
+					ok = false;
+				} else {
+					buffer.data = decoded->data();
+					scene.ownedData.emplace_back(std::move(decoded));
+				}
+			} else if(!buffer.uri.empty()) {
+				auto file = std::make_unique<MappedFile>(baseDirectory + buffer.uri);
+				if(!*file || file->size() < static_cast<size_t>(buffer.byteLength)) {
+					ok = false;
+				} else {
+					buffer.data = const_cast<char*>(file->data());
+					scene.mappedFiles.emplace_back(std::move(file));
+				}
+			}
+
+			scene.buffers.emplace_back(std::move(buffer));
+		});
+
+		return ok;
+	}
+
+	void loadBufferViews(const JsonView& json, uint32_t root, GltfScene& scene) {
+		const auto views = json.find(root, "bufferViews");
+		if(views < 0)
+			return;
+
+		scene.bufferViews.reserve(json[static_cast<uint32_t>(views)].size);
+		json.forEach(static_cast<uint32_t>(views), [&](uint32_t object) {
+			BufferViewResourceDescriptor view;
+			view.bufferId = getInt(json, object, "buffer", -1);
+			view.byteOffset = getInt(json, object, "byteOffset", 0);
+			view.byteLength = getInt(json, object, "byteLength", -1);
+			view.byteStride = getInt(json, object, "byteStride", -1);
+			view.target = getInt(json, object, "target", -1);
+			view.name = getString(json, object, "name");
+			scene.bufferViews.emplace_back(std::move(view));
+		});
+	}
+
+	void loadAccessors(const JsonView& json, uint32_t root, GltfScene& scene) {
+		const auto accessors = json.find(root, "accessors");
+		if(accessors < 0)
+			return;
+
+		scene.accessors.reserve(json[static_cast<uint32_t>(accessors)].size);
+		json.forEach(static_cast<uint32_t>(accessors), [&](uint32_t object) {
+			Accessor accessor;
+			accessor.bufferView = getInt(json, object, "bufferView", -1);
+			accessor.byteOffset = getInt(json, object, "byteOffset", 0);
+			accessor.componentType = getInt(json, object, "componentType", -1);
+			accessor.count = getInt(json, object, "count", -1);
+			accessor.type = getString(json, object, "type");
+			accessor.name = getString(json, object, "name");
+
+			const auto normalized = json.find(object, "normalized");
+			accessor.normalized = normalized >= 0 && json.toBool(static_cast<uint32_t>(normalized));
+
+			getArray(json, object, "min", accessor.min);
+			getArray(json, object, "max", accessor.max);
+			scene.accessors.emplace_back(std::move(accessor));
+		});
+	}
+
+	void loadMeshes(const JsonView& json, uint32_t root, GltfScene& scene) {
+		const auto meshes = json.find(root, "meshes");
+		if(meshes < 0)
+			return;
+
+		scene.meshes.reserve(json[static_cast<uint32_t>(meshes)].size);
+		json.forEach(static_cast<uint32_t>(meshes), [&](uint32_t object) {
+			Mesh mesh;
+			mesh.name = getString(json, object, "name");
+			getArray(json, object, "weights", mesh.weights);
+
+			const auto primitives = json.find(object, "primitives");
+			if(primitives >= 0) {
+				json.forEach(static_cast<uint32_t>(primitives), [&](uint32_t p) {
+					Primitive primitive;
+					primitive.indices = getInt(json, p, "indices", -1);
+					primitive.material = getInt(json, p, "material", -1);
+					primitive.mode = getInt(json, p, "mode", 4);
+
+					const auto attributes = json.find(p, "attributes");
+					if(attributes >= 0) {
+						json.forEachMember(static_cast<uint32_t>(attributes), [&](uint32_t key, uint32_t value) {
+							primitive.attributes.emplace(json.toString(key), static_cast<int32_t>(json.toInt(value)));
+						});
+					}
+
+					const auto extras = json.find(p, "extras");
+					const auto lods = extras >= 0 && json[static_cast<uint32_t>(extras)].type == JsonType::OBJECT ? json.find(static_cast<uint32_t>(extras), "lods") : -1;
+					if(lods >= 0 && json[static_cast<uint32_t>(lods)].type == JsonType::ARRAY) {
+						json.forEach(static_cast<uint32_t>(lods), [&](uint32_t l) {
+							PrimitiveLod lod;
+							lod.indices = getInt(json, l, "indices", -1);
+							const auto error = json.find(l, "error");
+							lod.error = error < 0 ? 0.0f : static_cast<float>(json.toDouble(static_cast<uint32_t>(error)));
+							primitive.lods.emplace_back(lod);
+						});
+					}
+
+					mesh.primitives.emplace_back(std::move(primitive));
+				});
+			}
+
+			scene.meshes.emplace_back(std::move(mesh));
+		});
+	}
+
+	void loadNodes(const JsonView& json, uint32_t root, GltfScene& scene) {
+		const auto nodes = json.find(root, "nodes");
+		if(nodes < 0)
+			return;
+
+		scene.nodes.reserve(json[static_cast<uint32_t>(nodes)].size);
+		json.forEach(static_cast<uint32_t>(nodes), [&](uint32_t object) {
+			NodeResourceDescriptor node;
+			node.camera = getInt(json, object, "camera", -1);
+			node.skin = getInt(json, object, "skin", -1);
+			node.mesh = getInt(json, object, "mesh", -1);
+			node.name = getString(json, object, "name");
+			getArray(json, object, "children", node.children);
+			getArray(json, object, "weights", node.weights);
+			getFloats(json, object, "matrix", node.matrix);
+			getFloats(json, object, "rotation", node.rotation);
+			getFloats(json, object, "scale", node.scale);
+			getFloats(json, object, "translation", node.translation);
+			scene.nodes.emplace_back(std::move(node));
+		});
+	}
+
+	void loadImagesAndSamplers(const JsonView& json, uint32_t root, GltfScene& scene) {
+		const auto images = json.find(root, "images");
+		if(images >= 0) {
+			json.forEach(static_cast<uint32_t>(images), [&](uint32_t object) {
+				ImageResourceDescriptor image;
+				image.uri = getString(json, object, "uri");
+				image.mimeType = getString(json, object, "mimeType");
+				image.bufferView = getInt(json, object, "bufferView", -1);
+				image.name = getString(json, object, "name");
+				scene.images.emplace_back(std::move(image));
+			});
+		}
+
+		const auto samplers = json.find(root, "samplers");
+		if(samplers >= 0) {
+			json.forEach(static_cast<uint32_t>(samplers), [&](uint32_t object) {
+				SamplerResourceDescriptor sampler;
+				sampler.magFilter = getInt(json, object, "magFilter", -1);
+				sampler.minFilter = getInt(json, object, "minFilter", -1);
+				sampler.wrapS = getInt(json, object, "wrapS", 10497);
+				sampler.wrapT = getInt(json, object, "wrapT", 10497);
+				sampler.name = getString(json, object, "name");
+				scene.samplers.emplace_back(std::move(sampler));
+			});
+		}
+	}
+
+	void loadScenes(const JsonView& json, uint32_t root, GltfScene& scene) {
+		scene.scene = getInt(json, root, "scene", -1);
+
+		const auto scenes = json.find(root, "scenes");
+		if(scenes < 0)
+			return;
+
+		json.forEach(static_cast<uint32_t>(scenes), [&](uint32_t object) {
+			std::vector<int32_t> roots;
+			getArray(json, object, "nodes", roots);
+			scene.scenes.emplace_back(std::move(roots));
+		});
+	}
+
+	void loadOtherMembers(const JsonView& json, uint32_t root, GltfScene& scene) {
+		static const char* modelled[] = {"buffers", "bufferViews", "accessors", "meshes", "nodes", "images", "samplers", "scenes", "scene"};
+
+		json.forEachMember(root, [&](uint32_t key, uint32_t value) {
+			for(const auto* name: modelled)
+				if(json.equals(key, name))
+					return;
+			scene.otherMembers.emplace_back(json.toString(key), json.getSource(value));
+		});
+	}
+
+	// Every index and range has to be valid before anyone dereferences buffer data through it.
+	bool validate(const GltfScene& scene) {
+		for(const auto& view: scene.bufferViews) {
+			if(view.bufferId < 0 || view.bufferId >= static_cast<int32_t>(scene.buffers.size()) || view.byteOffset < 0 || view.byteLength < 0)
+				return false;
+
+			const auto& buffer = scene.buffers[view.bufferId];
+			if(static_cast<int64_t>(view.byteOffset) + view.byteLength > buffer.byteLength)
+				return false;
+		}
+
+		for(const auto& accessor: scene.accessors) {
+			if(accessor.count < 0 || getAccessorElementSize(accessor) == 0)
+				return false;
+
+			if(accessor.bufferView < 0)
+				continue;
+			if(accessor.bufferView >= static_cast<int32_t>(scene.bufferViews.size()) || accessor.byteOffset < 0)
+				return false;
+
+			const auto& view = scene.bufferViews[accessor.bufferView];
+			const int64_t elementSize = getAccessorElementSize(accessor);
+			const int64_t stride = view.byteStride > 0 ? view.byteStride : elementSize;
+			if(accessor.count > 0 && accessor.byteOffset + stride * (accessor.count - 1) + elementSize > view.byteLength)
+				return false;
+		}
+
+		for(const auto& image: scene.images)
+			if(image.bufferView >= static_cast<int32_t>(scene.bufferViews.size()))
+				return false;
+
+		const auto nodeCount = static_cast<int32_t>(scene.nodes.size());
+		for(const auto& node: scene.nodes) {
+			if(node.mesh >= static_cast<int32_t>(scene.meshes.size()))
+				return false;
+			for(auto child: node.children)
+				if(child < 0 || child >= nodeCount)
+					return false;
+		}
+
+		const auto accessorCount = static_cast<int32_t>(scene.accessors.size());
+		for(const auto& mesh: scene.meshes) {
+			for(const auto& primitive: mesh.primitives) {
+				if(primitive.indices >= accessorCount)
+					return false;
+				for(const auto& lod: primitive.lods)
+					if(lod.indices < 0 || lod.indices >= accessorCount)
+						return false;
+				for(const auto& attribute: primitive.attributes)
+					if(attribute.second < 0 || attribute.second >= accessorCount)
+						return false;
+			}
+		}
+
+		return true;
+	}
+
+	bool parseGltf(const char* text, size_t length, const std::string& baseDirectory, GltfScene& scene) {
+		// Count first so the token array is allocated exactly once.
+		const auto tokenCount = tokenizeJson(text, length, nullptr, 0);
+		if(tokenCount <= 0)
+			return false;
+
+		std::unique_ptr<JsonToken[]> tokens(new JsonToken[static_cast<size_t>(tokenCount)]);
+		if(tokenizeJson(text, length, tokens.get(), static_cast<size_t>(tokenCount)) != tokenCount)
+			return false;
+
+		JsonView json(text, tokens.get(), static_cast<size_t>(tokenCount));
+		if(json[0].type != JsonType::OBJECT)
+			return false;
+
+		const auto asset = json.find(0, "asset");
+		if(asset < 0 || getString(json, static_cast<uint32_t>(asset), "version").compare(0, 2, "2.") != 0)
+			return false;
+
+		if(!loadBuffers(json, 0, baseDirectory, scene))
+			return false;
+
+		loadBufferViews(json, 0, scene);
+		loadAccessors(json, 0, scene);
+		loadMeshes(json, 0, scene);
+		loadNodes(json, 0, scene);
+		loadImagesAndSamplers(json, 0, scene);
+		loadScenes(json, 0, scene);
+		loadOtherMembers(json, 0, scene);
+
+		return true;
+	}
+}
+
+bool loadGltfJson(const char* text, size_t length, const std::string& baseDirectory, GltfScene& scene)
+{
+	scene.baseDirectory = baseDirectory;
+	return parseGltf(text, length, baseDirectory, scene) && validate(scene);
+}
+
+bool loadGltf(const std::string& path, GltfScene& scene)
+{
+	auto file = std::make_unique<MappedFile>(path);
+	if(!*file)
+		return false;
+
+	const auto baseDirectory = getDirectory(path);
+
+	GlbHeader header;
+	if(file->size() < sizeof(GlbHeader))
+		return loadGltfJson(file->data(), file->size(), baseDirectory, scene);
+
+	std::memcpy(&header, file->data(), sizeof(header));
+	if(header.magic != glbMagic)
+		return loadGltfJson(file->data(), file->size(), baseDirectory, scene);
+
+	if(header.version != 2 || header.length > file->size())
+		return false;
+
+	// The first chunk is always json, an optional binary chunk follows.
+	size_t offset = sizeof(GlbHeader);
+	GlbChunkHeader jsonChunk;
+	if(offset + sizeof(GlbChunkHeader) > header.length)
+		return false;
+
+	std::memcpy(&jsonChunk, file->data() + offset, sizeof(jsonChunk));
+	offset += sizeof(GlbChunkHeader);
+	if(jsonChunk.type != glbChunkJson || offset + jsonChunk.length > header.length)
+		return false;
+
+	const char* jsonData = file->data() + offset;
+	offset += jsonChunk.length;
+
+	const char* binaryData = nullptr;
+	uint32_t binaryLength = 0;
+	if(offset + sizeof(GlbChunkHeader) <= header.length) {
+		GlbChunkHeader binaryChunk;
+		std::memcpy(&binaryChunk, file->data() + offset, sizeof(binaryChunk));
+		offset += sizeof(GlbChunkHeader);
+		if(binaryChunk.type == glbChunkBinary && offset + binaryChunk.length <= header.length) {
+			binaryData = file->data() + offset;
+			binaryLength = binaryChunk.length;
+		}
+	}
+
+	// Mapped files are kept in the scene, the binary chunk is referenced in place.
+	scene.mappedFiles.emplace_back(std::move(file));
+
+	if(!parseGltf(jsonData, jsonChunk.length, baseDirectory, scene))
+		return false;
+
+	// Buffer 0 without a uri refers to the binary chunk.
+	if(!scene.buffers.empty() && scene.buffers[0].uri.empty()) {
+		if(!binaryData || scene.buffers[0].byteLength < 0 || static_cast<uint32_t>(scene.buffers[0].byteLength) > binaryLength)
+			return false;
+
+		scene.buffers[0].data = const_cast<char*>(binaryData);
+	}
+
+	return validate(scene);
+}
+
+uint32_t getAccessorElementSize(const Accessor& accessor)
+{
+	uint32_t componentSize = 0;
+	switch(accessor.componentType)
+	{
+		case 5120: // BYTE
+		case 5121: componentSize = 1; break; // UNSIGNED_BYTE
+		case 5122: // SHORT
+		case 5123: componentSize = 2; break; // UNSIGNED_SHORT
+		case 5125: // UNSIGNED_INT
+		case 5126: componentSize = 4; break; // FLOAT
+		default: return 0;
+	}
+
+	uint32_t components = 0;
+	if(accessor.type == "SCALAR") components = 1;
+	else if(accessor.type == "VEC2") components = 2;
+	else if(accessor.type == "VEC3") components = 3;
+	else if(accessor.type == "VEC4" || accessor.type == "MAT2") components = 4;
+	else if(accessor.type == "MAT3") components = 9;
+	else if(accessor.type == "MAT4") components = 16;
+
+	return componentSize * components;
+}
+
+const uint8_t* getAccessorData(const GltfScene& scene, const Accessor& accessor, uint32_t& stride)
+{
+	if(accessor.bufferView < 0)
+		return nullptr;
+
+	const auto& view = scene.bufferViews[accessor.bufferView];
+	const auto& buffer = scene.buffers[view.bufferId];
+	if(!buffer.data)
+		return nullptr;
+
+	stride = view.byteStride > 0 ? static_cast<uint32_t>(view.byteStride) : getAccessorElementSize(accessor);
+	return static_cast<const uint8_t*>(buffer.data) + view.byteOffset + accessor.byteOffset;
+}
+
+bool getImageData(const GltfScene& scene, const ImageResourceDescriptor& image, ImageData& out)
+{
+	out.mimeType = image.mimeType;
+
+	if(image.bufferView >= 0) {
+		const auto& view = scene.bufferViews[image.bufferView];
+		const auto& buffer = scene.buffers[view.bufferId];
+		if(!buffer.data)
+			return false;
+
+		out.data = static_cast<const uint8_t*>(buffer.data) + view.byteOffset;
+		out.size = static_cast<size_t>(view.byteLength);
+		return true;
+	}
+
+	// data:image/png;base64,...
+	if(image.uri.compare(0, 5, "data:") == 0) {
+		const auto comma = image.uri.find(',');
+		if(comma == std::string::npos || !decodeBase64(image.uri, comma + 1, out.decoded))
+			return false;
+
+		if(out.mimeType.empty())
+			out.mimeType = image.uri.substr(5, image.uri.find_first_of(";,") - 5);
+		out.data = out.decoded.data();
+		out.size = out.decoded.size();
+		return true;
+	}
+
+	if(image.uri.empty())
+		return false;
+
+	if(out.mimeType.empty()) {
+		static const std::pair<const char*, const char*> extensions[] = {
+			{".png", "image/png"}, {".jpg", "image/jpeg"}, {".jpeg", "image/jpeg"}, {".ktx2", "image/ktx2"}, {".webp", "image/webp"}
+		};
+
+		const auto dot = image.uri.find_last_of('.');
+		auto extension = dot == std::string::npos ? std::string() : image.uri.substr(dot);
+		for(auto& c: extension)
+			c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+		for(const auto& e: extensions)
+			if(extension == e.first)
+				out.mimeType = e.second;
+	}
+
+	out.file = MappedFile(scene.baseDirectory + image.uri);
+	out.data = reinterpret_cast<const uint8_t*>(out.file.data());
+	out.size = out.file.size();
+	return static_cast<bool>(out.file);
+}
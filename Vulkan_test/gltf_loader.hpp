@@ -0,0 +1,76 @@
+//
+//  gltf_loader.hpp
+//  Vulkan_test
+//
+//  Created by Danny on 17/10/2026.
+//  Copyright © 2026 Danny. All rights reserved.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "mapped_file.hpp"
+#include "resource_descriptors.hpp"
+
+// Everything a .gltf or .glb file describes. BufferResourceDescriptor::data points into memory owned
+// by the scene: the mapped .glb/.bin files themselves, or a decoded copy for data: uris. The scene has
+// to outlive every pointer taken from it.
+struct GltfScene
+{
+	std::vector<NodeResourceDescriptor> nodes;
+	std::vector<Mesh> meshes;
+	std::vector<Accessor> accessors;
+	std::vector<BufferResourceDescriptor> buffers;
+	std::vector<BufferViewResourceDescriptor> bufferViews;
+	std::vector<ImageResourceDescriptor> images;
+	std::vector<SamplerResourceDescriptor> samplers;
+
+	// Root nodes of every scene, and the scene to show by default.
+	std::vector<std::vector<int32_t>> scenes;
+	int32_t scene = -1;
+
+	// Json of the top level members the scene doesn't model (asset, materials, animations, ...), by name.
+	std::vector<std::pair<std::string, std::string>> otherMembers;
+
+	// Relative uris of buffers and images resolve against this.
+	std::string baseDirectory;
+
+	std::vector<std::unique_ptr<MappedFile>> mappedFiles;
+	std::vector<std::unique_ptr<std::vector<uint8_t>>> ownedData;
+};
+
+// Loads a .gltf or .glb file. Binary data is memory mapped rather than read, so loading cost is
+// dominated by the json, and pages of vertex data are only touched when they're uploaded.
+// Returns false if the file can't be read or isn't valid glTF 2.0.
+bool loadGltf(const std::string& path, GltfScene& scene);
+
+// Loads from json text that is already in memory. Relative uris resolve against baseDirectory.
+bool loadGltfJson(const char* json, size_t length, const std::string& baseDirectory, GltfScene& scene);
+
+// Pointer to element i of an accessor and the distance between elements, or nullptr if the
+// accessor doesn't reference buffer data.
+const uint8_t* getAccessorData(const GltfScene&, const Accessor&, uint32_t& stride);
+
+// Size in bytes of one element of an accessor (component size * component count).
+uint32_t getAccessorElementSize(const Accessor&);
+
+// The encoded bytes of an image, e.g. a png.
+struct ImageData
+{
+	const uint8_t* data = nullptr;
+	size_t size = 0;
+	// From the image, or guessed from the extension of its uri.
+	std::string mimeType;
+
+	// Images that aren't in a buffer of the scene keep their bytes here.
+	MappedFile file;
+	std::vector<uint8_t> decoded;
+};
+
+// Finds the bytes of an image, mapping its file or decoding its data uri if it has one. Only reads the scene,
+// so images can be fetched from several threads at once. Returns false if the bytes can't be found.
+bool getImageData(const GltfScene&, const ImageResourceDescriptor&, ImageData&);
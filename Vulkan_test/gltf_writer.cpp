@@ -0,0 +1,386 @@
+//
+//  gltf_writer.cpp
+//  Vulkan_test
+//
+//  Created by Danny on 17/10/2026.
+//  Copyright © 2026 Danny. All rights reserved.
+//
+
+#include "gltf_writer.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#include "gltf_loader.hpp"
+
+namespace {
+
+	const uint32_t glbMagic 		= 0x46546C67; // "glTF"
+	const uint32_t glbChunkJson 	= 0x4E4F534A; // "JSON"
+	const uint32_t glbChunkBinary 	= 0x004E4942; // "BIN\0"
+
+	// Appends comma separated members and elements, so callers don't have to track whether one came before.
+	class JsonWriter {
+	public:
+		explicit JsonWriter(std::string& out) : out(out) {}
+
+		void beginObject() { separate(); out += '{'; first = true; }
+		void endObject() { out += '}'; first = false; }
+		void beginArray() { separate(); out += '['; first = true; }
+		void endArray() { out += ']'; first = false; }
+
+		void key(const std::string& name) {
+			string(name);
+			out += ':';
+			first = true;
+		}
+
+		void string(const std::string& value) {
+			separate();
+			out += '"';
+			for(const char c: value) {
+				switch(c) {
+					case '"': out += "\\\""; break;
+					case '\\': out += "\\\\"; break;
+					case '\n': out += "\\n"; break;
+					case '\r': out += "\\r"; break;
+					case '\t': out += "\\t"; break;
+					default:
+						if(static_cast<unsigned char>(c) < 0x20) {
+							char escaped[8];
+							std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+							out += escaped;
+						} else {
+							out += c;
+						}
+				}
+			}
+			out += '"';
+			first = false;
+		}
+
+		void number(int64_t value) {
+			separate();
+			out += std::to_string(value);
+			first = false;
+		}
+
+		void number(double value) {
+			separate();
+			char text[32];
+			std::snprintf(text, sizeof(text), "%.9g", value);
+			out += text;
+			first = false;
+		}
+
+		void boolean(bool value) {
+			separate();
+			out += value ? "true" : "false";
+			first = false;
+		}
+
+		// Json that is already written out.
+		void raw(const std::string& json) {
+			separate();
+			out += json;
+			first = false;
+		}
+
+		template<typename T>
+		void member(const std::string& name, const T& value) {
+			key(name);
+			write(value);
+		}
+
+	private:
+
+		void separate() {
+			if(!first)
+				out += ',';
+		}
+
+		void write(int32_t value) { number(static_cast<int64_t>(value)); }
+		void write(uint32_t value) { number(static_cast<int64_t>(value)); }
+		void write(float value) { number(static_cast<double>(value)); }
+		void write(bool value) { boolean(value); }
+		void write(const std::string& value) { string(value); }
+
+		template<typename T>
+		void write(const std::vector<T>& values) {
+			beginArray();
+			for(const auto& value: values)
+				write(value);
+			endArray();
+		}
+
+	private:
+
+		std::string& out;
+		bool first = true;
+	};
+
+	bool isIdentity(const float (&matrix)[16]) {
+		for(uint32_t i = 0; i < 16; ++i)
+			if(matrix[i] != (i % 5 == 0 ? 1.0f : 0.0f))
+				return false;
+		return true;
+	}
+
+	template<size_t N>
+	std::vector<float> toVector(const float (&values)[N]) {
+		return std::vector<float>(values, values + N);
+	}
+
+	void writeNodes(JsonWriter& json, const GltfScene& scene) {
+		json.key("nodes");
+		json.beginArray();
+		for(const auto& node: scene.nodes) {
+			json.beginObject();
+			if(!node.name.empty())
+				json.member("name", node.name);
+			if(node.mesh >= 0)
+				json.member("mesh", node.mesh);
+			if(node.camera >= 0)
+				json.member("camera", node.camera);
+			if(node.skin >= 0)
+				json.member("skin", node.skin);
+			if(!node.children.empty())
+				json.member("children", node.children);
+			if(!node.weights.empty())
+				json.member("weights", node.weights);
+
+			// Nodes have either a matrix or translation, rotation and scale.
+			if(!isIdentity(node.matrix)) {
+				json.member("matrix", toVector(node.matrix));
+			} else {
+				if(node.translation[0] != 0 || node.translation[1] != 0 || node.translation[2] != 0)
+					json.member("translation", toVector(node.translation));
+				if(node.rotation[0] != 0 || node.rotation[1] != 0 || node.rotation[2] != 0 || node.rotation[3] != 1)
+					json.member("rotation", toVector(node.rotation));
+				if(node.scale[0] != 1 || node.scale[1] != 1 || node.scale[2] != 1)
+					json.member("scale", toVector(node.scale));
+			}
+			json.endObject();
+		}
+		json.endArray();
+	}
+
+	void writeMeshes(JsonWriter& json, const GltfScene& scene) {
+		json.key("meshes");
+		json.beginArray();
+		for(const auto& mesh: scene.meshes) {
+			json.beginObject();
+			if(!mesh.name.empty())
+				json.member("name", mesh.name);
+			if(!mesh.weights.empty())
+				json.member("weights", mesh.weights);
+
+			json.key("primitives");
+			json.beginArray();
+			for(const auto& primitive: mesh.primitives) {
+				json.beginObject();
+				json.key("attributes");
+				json.beginObject();
+				for(const auto& attribute: primitive.attributes)
+					json.member(attribute.first, attribute.second);
+				json.endObject();
+
+				if(primitive.indices >= 0)
+					json.member("indices", primitive.indices);
+				if(primitive.material >= 0)
+					json.member("material", primitive.material);
+				if(primitive.mode != 4)
+					json.member("mode", primitive.mode);
+
+				if(!primitive.lods.empty()) {
+					json.key("extras");
+					json.beginObject();
+					json.key("lods");
+					json.beginArray();
+					for(const auto& lod: primitive.lods) {
+						json.beginObject();
+						json.member("indices", lod.indices);
+						json.member("error", lod.error);
+						json.endObject();
+					}
+					json.endArray();
+					json.endObject();
+				}
+				json.endObject();
+			}
+			json.endArray();
+			json.endObject();
+		}
+		json.endArray();
+	}
+
+	void writeAccessors(JsonWriter& json, const GltfScene& scene) {
+		json.key("accessors");
+		json.beginArray();
+		for(const auto& accessor: scene.accessors) {
+			json.beginObject();
+			if(!accessor.name.empty())
+				json.member("name", accessor.name);
+			if(accessor.bufferView >= 0)
+				json.member("bufferView", accessor.bufferView);
+			if(accessor.byteOffset)
+				json.member("byteOffset", accessor.byteOffset);
+			json.member("componentType", accessor.componentType);
+			if(accessor.normalized)
+				json.member("normalized", true);
+			json.member("count", accessor.count);
+			json.member("type", accessor.type);
+			if(!accessor.min.empty())
+				json.member("min", accessor.min);
+			if(!accessor.max.empty())
+				json.member("max", accessor.max);
+			json.endObject();
+		}
+		json.endArray();
+	}
+
+	void writeImagesAndSamplers(JsonWriter& json, const GltfScene& scene) {
+		if(!scene.images.empty()) {
+			json.key("images");
+			json.beginArray();
+			for(const auto& image: scene.images) {
+				json.beginObject();
+				if(!image.name.empty())
+					json.member("name", image.name);
+				if(!image.uri.empty())
+					json.member("uri", image.uri);
+				if(!image.mimeType.empty())
+					json.member("mimeType", image.mimeType);
+				if(image.bufferView >= 0)
+					json.member("bufferView", image.bufferView);
+				json.endObject();
+			}
+			json.endArray();
+		}
+
+		if(!scene.samplers.empty()) {
+			json.key("samplers");
+			json.beginArray();
+			for(const auto& sampler: scene.samplers) {
+				json.beginObject();
+				if(!sampler.name.empty())
+					json.member("name", sampler.name);
+				if(sampler.magFilter >= 0)
+					json.member("magFilter", sampler.magFilter);
+				if(sampler.minFilter >= 0)
+					json.member("minFilter", sampler.minFilter);
+				json.member("wrapS", sampler.wrapS);
+				json.member("wrapT", sampler.wrapT);
+				json.endObject();
+			}
+			json.endArray();
+		}
+	}
+
+	void appendChunk(std::string& glb, uint32_t type, const std::string& data) {
+		const uint32_t header[] = {static_cast<uint32_t>(data.size()), type};
+		glb.append(reinterpret_cast<const char*>(header), sizeof(header));
+		glb += data;
+	}
+}
+
+bool saveGlb(const std::string& path, const GltfScene& scene)
+{
+	// Views are packed back to back, 4 byte aligned so every component type stays aligned.
+	std::string binary;
+	std::vector<uint32_t> viewOffsets;
+	for(const auto& view: scene.bufferViews) {
+		const auto& buffer = scene.buffers[view.bufferId];
+		if(!buffer.data)
+			return false;
+
+		viewOffsets.emplace_back(static_cast<uint32_t>(binary.size()));
+		binary.append(static_cast<const char*>(buffer.data) + view.byteOffset, view.byteLength);
+		binary.resize((binary.size() + 3) & ~size_t(3), '\0');
+	}
+
+	std::string text;
+	JsonWriter json(text);
+	json.beginObject();
+
+	bool hasAsset = false;
+	for(const auto& member: scene.otherMembers) {
+		json.key(member.first);
+		json.raw(member.second);
+		hasAsset |= member.first == "asset";
+	}
+
+	if(!hasAsset) {
+		json.key("asset");
+		json.beginObject();
+		json.member("version", std::string("2.0"));
+		json.endObject();
+	}
+
+	if(scene.scene >= 0)
+		json.member("scene", scene.scene);
+
+	if(!scene.scenes.empty()) {
+		json.key("scenes");
+		json.beginArray();
+		for(const auto& roots: scene.scenes) {
+			json.beginObject();
+			json.member("nodes", roots);
+			json.endObject();
+		}
+		json.endArray();
+	}
+
+	if(!scene.nodes.empty())
+		writeNodes(json, scene);
+	if(!scene.meshes.empty())
+		writeMeshes(json, scene);
+	if(!scene.accessors.empty())
+		writeAccessors(json, scene);
+
+	if(!scene.bufferViews.empty()) {
+		json.key("bufferViews");
+		json.beginArray();
+		for(size_t i = 0; i < scene.bufferViews.size(); ++i) {
+			const auto& view = scene.bufferViews[i];
+			json.beginObject();
+			if(!view.name.empty())
+				json.member("name", view.name);
+			json.member("buffer", 0);
+			json.member("byteOffset", viewOffsets[i]);
+			json.member("byteLength", view.byteLength);
+			if(view.byteStride > 0)
+				json.member("byteStride", view.byteStride);
+			if(view.target >= 0)
+				json.member("target", view.target);
+			json.endObject();
+		}
+		json.endArray();
+
+		json.key("buffers");
+		json.beginArray();
+		json.beginObject();
+		json.member("byteLength", static_cast<uint32_t>(binary.size()));
+		json.endObject();
+		json.endArray();
+	}
+
+	writeImagesAndSamplers(json, scene);
+	json.endObject();
+
+	// The json chunk is padded with spaces, the binary chunk with zeros.
+	text.resize((text.size() + 3) & ~size_t(3), ' ');
+
+	std::string glb(12, '\0');
+	appendChunk(glb, glbChunkJson, text);
+	if(!binary.empty())
+		appendChunk(glb, glbChunkBinary, binary);
+
+	const uint32_t header[] = {glbMagic, 2, static_cast<uint32_t>(glb.size())};
+	std::memcpy(&glb[0], header, sizeof(header));
+
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	file.write(glb.data(), glb.size());
+	return static_cast<bool>(file);
+}
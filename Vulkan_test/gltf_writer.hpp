@@ -0,0 +1,18 @@
+//
+//  gltf_writer.hpp
+//  Vulkan_test
+//
+//  Created by Danny on 17/10/2026.
+//  Copyright © 2026 Danny. All rights reserved.
+//
+
+#pragma once
+
+#include <string>
+
+struct GltfScene;
+
+// Writes the scene as a .glb. The data of every buffer view is packed into the binary chunk as a single buffer,
+// so bytes no view refers to are dropped. Members the scene doesn't model are written back as they were loaded.
+// Returns false if a buffer view has no data or the file can't be written.
+bool saveGlb(const std::string& path, const GltfScene&);
@@ -0,0 +1,336 @@
+//
+//  gpu_driven_scene.cpp
+//  Vulkan_test
+//
+//  Created by Danny on 17/10/2026.
+//  Copyright © 2026 Danny. All rights reserved.
+//
+
+#include "gpu_driven_scene.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include "profiler.hpp"
+#include "vulkan_renderer.hpp"
+
+namespace {
+
+	const char* cullShader = R"(
+		#version 450
+		layout(local_size_x = 64) in;
+
+		struct Instance { mat4 world; uint mesh; uint bucket; uint slot; uint padding; };
+		struct Mesh { vec4 sphere; uint indexCount; uint firstIndex; int vertexOffset; uint padding; };
+		struct Command { uint indexCount; uint instanceCount; uint firstIndex; int vertexOffset; uint firstInstance; };
+
+		layout(set = 0, binding = 0) readonly buffer Instances { Instance instances[]; };
+		layout(set = 0, binding = 1) readonly buffer Meshes { Mesh meshes[]; };
+		layout(set = 0, binding = 2) readonly buffer Buckets { uint bucketOffsets[]; };
+		layout(set = 0, binding = 3) writeonly buffer Commands { Command commands[]; };
+		layout(set = 0, binding = 4) buffer Counts { uint counts[]; };
+
+		layout(push_constant) uniform Constants {
+			vec4 planes[6];
+			uint instanceCount;
+			// Without a count to draw with every instance keeps its slot and culled ones draw nothing.
+			uint compact;
+		};
+
+		void main() {
+			const uint index = gl_GlobalInvocationID.x;
+			if(index >= instanceCount)
+				return;
+
+			const Instance instance = instances[index];
+			const Mesh mesh = meshes[instance.mesh];
+
+			const vec3 centre = (instance.world * vec4(mesh.sphere.xyz, 1.0)).xyz;
+			const float scale = max(max(length(instance.world[0].xyz), length(instance.world[1].xyz)), length(instance.world[2].xyz));
+			const float radius = mesh.sphere.w * scale;
+
+			bool visible = true;
+			for(int i = 0; i < 6; ++i)
+				visible = visible && dot(planes[i].xyz, centre) + planes[i].w >= -radius;
+
+			if(compact != 0) {
+				if(!visible)
+					return;
+				const uint slot = bucketOffsets[instance.bucket] + atomicAdd(counts[instance.bucket], 1u);
+				commands[slot] = Command(mesh.indexCount, 1u, mesh.firstIndex, mesh.vertexOffset, index);
+			} else {
+				commands[instance.slot] = Command(mesh.indexCount, visible ? 1u : 0u, mesh.firstIndex, mesh.vertexOffset, index);
+			}
+		}
+	)";
+
+	struct CullConstants
+	{
+		float planes[6][4];
+		uint32_t instanceCount;
+		uint32_t compact;
+	};
+
+	const vk::DeviceSize commandSize = sizeof(VkDrawIndexedIndirectCommand);
+}
+
+GpuDrivenScene::GpuDrivenScene(VulkanRenderer& renderer, uint32_t maxInstances, uint32_t maxMeshes, uint32_t maxBuckets)
+: renderer(renderer), maxInstances(std::max(maxInstances, 1u)), maxMeshes(std::max(maxMeshes, 1u)), maxBuckets(std::max(maxBuckets, 1u)) {
+
+	static_assert(sizeof(Instance) == 80, "Instance has to match the shader");
+	static_assert(sizeof(Mesh) == 32, "Mesh has to match the shader");
+
+	if(!renderer.getDeviceFeatures().multiDrawIndirect)
+		return;
+	drawIndirectCount = renderer.getDeviceFeatures12().drawIndirectCount;
+
+	ShaderSourceDescriptor source;
+	source.source = cullShader;
+	source.path = "gpu_driven_cull.comp";
+	source.stage = ShaderStageDescriptor::Type::COMPUTE;
+	const auto module = renderer.createShaderModule(source);
+	if(module == null_handle)
+		return;
+
+	auto createBuffer = [&](uint64_t size, BufferUsage usage, StorageMode storageMode) {
+		BufferDescriptor descriptor;
+		descriptor.size = size;
+		descriptor.usage = usage;
+		descriptor.storageMode = storageMode;
+		return renderer.createBuffer(descriptor);
+	};
+
+	const auto instanceBytes = uint64_t(this->maxInstances) * sizeof(Instance);
+	const auto meshBytes = uint64_t(this->maxMeshes) * sizeof(Mesh);
+	const auto bucketBytes = uint64_t(this->maxBuckets) * sizeof(uint32_t);
+
+	instanceBuffer = createBuffer(instanceBytes, BufferUsage::STORAGE, StorageMode::PRIVATE);
+	meshBuffer = createBuffer(meshBytes, BufferUsage::STORAGE, StorageMode::PRIVATE);
+	bucketBuffer = createBuffer(bucketBytes, BufferUsage::STORAGE, StorageMode::PRIVATE);
+	drawBuffer = createBuffer(uint64_t(this->maxInstances) * commandSize, BufferUsage::STORAGE | BufferUsage::INDIRECT, StorageMode::PRIVATE);
+	countBuffer = createBuffer(bucketBytes, BufferUsage::STORAGE | BufferUsage::INDIRECT, StorageMode::PRIVATE);
+	if(instanceBuffer == null_handle || meshBuffer == null_handle || bucketBuffer == null_handle || drawBuffer == null_handle || countBuffer == null_handle)
+		return;
+
+	// Only ever copied from, the usage doesn't matter.
+	for(uint32_t i = 0; i < renderer.getFramesInFlight(); ++i) {
+		stagingBuffers.emplace_back(createBuffer(instanceBytes + meshBytes + bucketBytes, BufferUsage::UNIFORM, StorageMode::SHARED));
+		if(stagingBuffers.back() == null_handle)
+			return;
+	}
+
+	ComputePipelineDescriptor pipelineDescriptor;
+	pipelineDescriptor.module = module;
+	const auto pipeline = renderer.createComputePipeline(pipelineDescriptor);
+	renderer.destroyShaderModule(module);
+	if(pipeline == null_handle)
+		return;
+
+	std::vector<ResourceBinding> bindings(5);
+	const resource_handle_t bound[] = {instanceBuffer, meshBuffer, bucketBuffer, drawBuffer, countBuffer};
+	for(uint32_t i = 0; i < 5; ++i) {
+		bindings[i].binding = i;
+		bindings[i].type = BindingType::STORAGE_BUFFER;
+		bindings[i].buffer = bound[i];
+	}
+
+	cullSet = renderer.getDescriptorSet(pipeline, bindings);
+	cullPipeline = pipeline;
+}
+
+GpuDrivenScene::~GpuDrivenScene() {
+	renderer.destroyPipeline(cullPipeline);
+	for(auto buffer: {instanceBuffer, meshBuffer, bucketBuffer, drawBuffer, countBuffer})
+		renderer.destroyBuffer(buffer);
+	for(auto buffer: stagingBuffers)
+		renderer.destroyBuffer(buffer);
+}
+
+uint32_t GpuDrivenScene::addMesh(const GpuMesh& mesh) {
+	if(meshes.size() == maxMeshes)
+		return ~0u;
+
+	Mesh m;
+	std::copy(mesh.centre, mesh.centre + 3, m.sphere);
+	m.sphere[3] = mesh.radius;
+	m.indexCount = mesh.indexCount;
+	m.firstIndex = mesh.firstIndex;
+	m.vertexOffset = mesh.vertexOffset;
+	m.padding = 0;
+	meshes.emplace_back(m);
+
+	layoutChanged = true;
+	return static_cast<uint32_t>(meshes.size() - 1);
+}
+
+uint32_t GpuDrivenScene::addBucket(resource_handle_t pipeline) {
+	if(buckets.size() == maxBuckets)
+		return ~0u;
+
+	buckets.push_back({pipeline, 0, 0});
+	layoutChanged = true;
+	return static_cast<uint32_t>(buckets.size() - 1);
+}
+
+uint32_t GpuDrivenScene::addInstance(uint32_t mesh, uint32_t bucket, const float world[16]) {
+	if(instances.size() == maxInstances || mesh >= meshes.size() || bucket >= buckets.size())
+		return ~0u;
+
+	Instance instance;
+	std::copy(world, world + 16, instance.world);
+	instance.mesh = mesh;
+	instance.bucket = bucket;
+	instance.slot = 0;
+	instance.padding = 0;
+	instances.emplace_back(instance);
+	changed.emplace_back(false);
+	markChanged(static_cast<uint32_t>(instances.size() - 1));
+
+	layoutChanged = true;
+	return static_cast<uint32_t>(instances.size() - 1);
+}
+
+void GpuDrivenScene::setTransform(uint32_t instance, const float world[16]) {
+	std::copy(world, world + 16, instances.at(instance).world);
+	markChanged(instance);
+}
+
+void GpuDrivenScene::markChanged(uint32_t instance) {
+	if(changed[instance])
+		return;
+
+	changed[instance] = true;
+	changedInstances.emplace_back(instance);
+}
+
+void GpuDrivenScene::layOutBuckets() {
+	for(auto& bucket: buckets)
+		bucket.count = 0;
+	for(const auto& instance: instances)
+		++buckets[instance.bucket].count;
+
+	bucketOffsets.clear();
+	uint32_t first = 0;
+	for(auto& bucket: buckets) {
+		bucket.first = first;
+		bucketOffsets.emplace_back(first);
+		first += bucket.count;
+	}
+
+	// Counts are back to the start of each bucket, instances take the next slot of theirs.
+	for(auto& bucket: buckets)
+		bucket.count = 0;
+	for(uint32_t i = 0; i < instances.size(); ++i) {
+		auto& bucket = buckets[instances[i].bucket];
+		const auto slot = bucket.first + bucket.count++;
+		if(instances[i].slot != slot) {
+			instances[i].slot = slot;
+			markChanged(i);
+		}
+	}
+}
+
+void GpuDrivenScene::copyChanges(vk::CommandBuffer commandBuffer, resource_handle_t staging) {
+	auto* contents = static_cast<uint8_t*>(renderer.getBufferContents(staging));
+	const auto& stagingBuffer = renderer.getBuffer(staging).buffer;
+
+	// The staging buffer mirrors the instance buffer, neighbouring instances go in a single copy.
+	std::sort(changedInstances.begin(), changedInstances.end());
+	copies.clear();
+	for(const auto instance: changedInstances) {
+		const vk::DeviceSize offset = uint64_t(instance) * sizeof(Instance);
+		std::memcpy(contents + offset, &instances[instance], sizeof(Instance));
+		changed[instance] = false;
+
+		if(!copies.empty() && copies.back().srcOffset + copies.back().size == offset)
+			copies.back().size += sizeof(Instance);
+		else
+			copies.emplace_back(offset, offset, sizeof(Instance));
+	}
+	changedInstances.clear();
+
+	if(!copies.empty())
+		commandBuffer.copyBuffer(stagingBuffer, renderer.getBuffer(instanceBuffer).buffer, copies);
+
+	if(!layoutChanged)
+		return;
+
+	const vk::DeviceSize meshOffset = uint64_t(maxInstances) * sizeof(Instance);
+	const vk::DeviceSize bucketOffset = meshOffset + uint64_t(maxMeshes) * sizeof(Mesh);
+	if(!meshes.empty()) {
+		std::memcpy(contents + meshOffset, meshes.data(), meshes.size() * sizeof(Mesh));
+		commandBuffer.copyBuffer(stagingBuffer, renderer.getBuffer(meshBuffer).buffer, vk::BufferCopy(meshOffset, 0, meshes.size() * sizeof(Mesh)));
+	}
+	if(!bucketOffsets.empty()) {
+		std::memcpy(contents + bucketOffset, bucketOffsets.data(), bucketOffsets.size() * sizeof(uint32_t));
+		commandBuffer.copyBuffer(stagingBuffer, renderer.getBuffer(bucketBuffer).buffer, vk::BufferCopy(bucketOffset, 0, bucketOffsets.size() * sizeof(uint32_t)));
+	}
+	layoutChanged = false;
+}
+
+void GpuDrivenScene::cull(vk::CommandBuffer commandBuffer, const Frustum& frustum) {
+	if(!isSupported())
+		return;
+
+	PROFILE_FUNCTION();
+
+	if(layoutChanged)
+		layOutBuckets();
+
+	// Earlier frames may still be culling with or drawing from the buffers written here.
+	commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eDrawIndirect | vk::PipelineStageFlagBits::eVertexShader | vk::PipelineStageFlagBits::eComputeShader,
+								  vk::PipelineStageFlagBits::eTransfer, vk::DependencyFlags(), nullptr, nullptr, nullptr);
+
+	copyChanges(commandBuffer, stagingBuffers[renderer.getCurrentFrameIndex()]);
+	const auto& counts = renderer.getBuffer(countBuffer).buffer;
+	commandBuffer.fillBuffer(counts, 0, VK_WHOLE_SIZE, 0);
+
+	const vk::MemoryBarrier copied(vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite);
+	commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eComputeShader | vk::PipelineStageFlagBits::eVertexShader,
+								  vk::DependencyFlags(), copied, nullptr, nullptr);
+
+	if(!instances.empty()) {
+		CullConstants constants;
+		std::memcpy(constants.planes, frustum.planes, sizeof(constants.planes));
+		constants.instanceCount = static_cast<uint32_t>(instances.size());
+		constants.compact = drawIndirectCount ? 1 : 0;
+
+		commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eCompute, renderer.getPipeline(cullPipeline).layout, 0, cullSet, nullptr);
+		renderer.pushConstants(commandBuffer, cullPipeline, &constants, sizeof(constants));
+		renderer.dispatchThreads(commandBuffer, cullPipeline, constants.instanceCount);
+	}
+
+	const vk::MemoryBarrier culled(vk::AccessFlagBits::eShaderWrite, vk::AccessFlagBits::eIndirectCommandRead);
+	commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eDrawIndirect,
+								  vk::DependencyFlags(), culled, nullptr, nullptr);
+
+	// The cull pipeline's set may have disturbed the bindless table for compute.
+	renderer.bindBindlessTable(commandBuffer);
+}
+
+void GpuDrivenScene::draw(vk::CommandBuffer commandBuffer) {
+	if(!isSupported())
+		return;
+
+	PROFILE_FUNCTION();
+
+	const auto& commands = renderer.getBuffer(drawBuffer).buffer;
+	const auto& counts = renderer.getBuffer(countBuffer).buffer;
+
+	resource_handle_t bound = null_handle;
+	for(uint32_t i = 0; i < buckets.size(); ++i) {
+		const auto& bucket = buckets[i];
+		if(!bucket.count)
+			continue;
+
+		if(bucket.pipeline != bound) {
+			commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, renderer.getPipeline(bucket.pipeline).pipeline);
+			bound = bucket.pipeline;
+		}
+
+		if(drawIndirectCount)
+			commandBuffer.drawIndexedIndirectCount(commands, bucket.first * commandSize, counts, i * sizeof(uint32_t), bucket.count, commandSize);
+		else
+			commandBuffer.drawIndexedIndirect(commands, bucket.first * commandSize, bucket.count, commandSize);
+	}
+}
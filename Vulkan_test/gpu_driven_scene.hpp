@@ -0,0 +1,138 @@
+//
+//  gpu_driven_scene.hpp
+//  Vulkan_test
+//
+//  Created by Danny on 17/10/2026.
+//  Copyright © 2026 Danny. All rights reserved.
+//
+
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+
+#include <cstdint>
+#include <vector>
+
+#include "frustum_culling.hpp"
+#include "resource_descriptors.hpp"
+
+class VulkanRenderer;
+
+// A range of the shared index and vertex buffers, bounded by a sphere in its local space.
+struct GpuMesh
+{
+	uint32_t indexCount = 0;
+	uint32_t firstIndex = 0;
+	int32_t vertexOffset = 0;
+	float centre[3] = {0, 0, 0};
+	float radius = 0;
+};
+
+// Instances that build their own draw lists on the gpu. Instance transforms and mesh bounds live in storage
+// buffers, a compute shader culls every instance against the frustum and appends a VkDrawIndexedIndirectCommand
+// to the range of its bucket, and each bucket (a pipeline) is drawn with a single vkCmdDrawIndexedIndirectCount.
+// The cpu cost of a frame is the instances that changed plus a draw per bucket, however many instances there are.
+//
+// Commands have instanceCount 1 and firstInstance set to the instance, vertex shaders find their transform as
+//
+//	struct Instance { mat4 world; uint mesh; uint bucket; uint slot; uint padding; };
+//	layout(set = ..., binding = ...) readonly buffer Instances { Instance instances[]; };
+//	... instances[gl_InstanceIndex].world ...
+//
+// through getInstanceBuffer (or its bindless index).
+class GpuDrivenScene {
+public:
+	// Capacities are fixed, adding beyond them fails.
+	GpuDrivenScene(VulkanRenderer&, uint32_t maxInstances, uint32_t maxMeshes, uint32_t maxBuckets);
+	~GpuDrivenScene();
+
+	GpuDrivenScene(const GpuDrivenScene&) = delete;
+	GpuDrivenScene& operator=(const GpuDrivenScene&) = delete;
+
+	// Needs multiDrawIndirect. Without drawIndirectCount culled commands are drawn with no instances instead
+	// of being compacted away.
+	bool isSupported() const { return cullPipeline != null_handle; }
+
+	// All return ~0u once full.
+	uint32_t addMesh(const GpuMesh&);
+	// Draws of a bucket share the pipeline.
+	uint32_t addBucket(resource_handle_t pipeline);
+	// world is a column major matrix.
+	uint32_t addInstance(uint32_t mesh, uint32_t bucket, const float world[16]);
+	void setTransform(uint32_t instance, const float world[16]);
+
+	uint32_t getInstanceCount() const { return static_cast<uint32_t>(instances.size()); }
+	resource_handle_t getInstanceBuffer() const { return instanceBuffer; }
+
+	// Outside of a render pass. Copies what changed since the last cull to the gpu, resets the counts and culls.
+	// Transforms of a frame have to be set before its cull.
+	void cull(vk::CommandBuffer, const Frustum&);
+	// Inside a render pass. Binds the pipeline of each bucket and draws it, the vertex and index buffers
+	// and the sets the pipelines use have to be bound already.
+	void draw(vk::CommandBuffer);
+
+private:
+
+	// The gpu side layouts, std430.
+	struct Instance
+	{
+		float world[16];
+		uint32_t mesh;
+		uint32_t bucket;
+		// Where its command goes when commands aren't compacted.
+		uint32_t slot;
+		uint32_t padding;
+	};
+
+	struct Mesh
+	{
+		float sphere[4];
+		uint32_t indexCount;
+		uint32_t firstIndex;
+		int32_t vertexOffset;
+		uint32_t padding;
+	};
+
+	struct Bucket
+	{
+		resource_handle_t pipeline;
+		uint32_t first;
+		uint32_t count;
+	};
+
+	// Gives every bucket a range of commands as long as its number of instances.
+	void layOutBuckets();
+	void markChanged(uint32_t instance);
+	void copyChanges(vk::CommandBuffer, resource_handle_t staging);
+
+private:
+
+	VulkanRenderer& renderer;
+	const uint32_t maxInstances;
+	const uint32_t maxMeshes;
+	const uint32_t maxBuckets;
+	bool drawIndirectCount = false;
+
+	resource_handle_t cullPipeline = null_handle;
+	vk::DescriptorSet cullSet;
+
+	std::vector<Instance> instances;
+	std::vector<Mesh> meshes;
+	std::vector<Bucket> buckets;
+	// First command of each bucket, what the shader reads.
+	std::vector<uint32_t> bucketOffsets;
+
+	// Instances whose copy on the gpu is out of date, each listed once.
+	std::vector<uint32_t> changedInstances;
+	std::vector<bool> changed;
+	bool layoutChanged = false;
+	std::vector<vk::BufferCopy> copies;
+
+	resource_handle_t instanceBuffer = null_handle;
+	resource_handle_t meshBuffer = null_handle;
+	resource_handle_t bucketBuffer = null_handle;
+	resource_handle_t drawBuffer = null_handle;
+	resource_handle_t countBuffer = null_handle;
+	// Per frame in flight, laid out like the instance, mesh and bucket buffers back to back.
+	std::vector<resource_handle_t> stagingBuffers;
+};
@@ -0,0 +1,109 @@
+//
+//  gpu_profiler.cpp
+//  Vulkan_test
+//
+//  Created by Danny on 17/10/2026.
+//  Copyright © 2026 Danny. All rights reserved.
+//
+
+#include "gpu_profiler.hpp"
+
+GpuProfiler::GpuProfiler(const vk::PhysicalDevice& physicalDevice, const vk::Device& logicalDevice, uint32_t queueFamilyIndex, uint32_t frameCount, uint32_t maximumScopesPerFrame)
+: logicalDevice(logicalDevice), maximumScopes(maximumScopesPerFrame) {
+
+	const auto validBits = physicalDevice.getQueueFamilyProperties()[queueFamilyIndex].timestampValidBits;
+	timestampPeriod = physicalDevice.getProperties().limits.timestampPeriod;
+	timestampMask = validBits >= 64 ? ~0ull : (1ull << validBits) - 1;
+
+	// Without valid bits the queue can't write timestamps, every scope is skipped.
+	if(validBits == 0)
+		return;
+
+	frames.resize(frameCount);
+	for(auto& frame: frames) {
+		vk::QueryPoolCreateInfo info;
+		info.setQueryType(vk::QueryType::eTimestamp);
+		info.setQueryCount(maximumScopes * 2);
+		frame.pool = logicalDevice.createQueryPool(info);
+	}
+
+	results.resize(maximumScopes * 2);
+}
+
+GpuProfiler::~GpuProfiler() {
+	for(auto& frame: frames)
+		logicalDevice.destroyQueryPool(frame.pool);
+}
+
+void GpuProfiler::beginFrame(vk::CommandBuffer commandBuffer, uint32_t frameIndex) {
+	if(frames.empty())
+		return;
+
+	currentFrame = frameIndex;
+	auto& frame = frames[frameIndex];
+	if(frame.pending)
+		resolve(frame);
+
+	commandBuffer.resetQueryPool(frame.pool, 0, maximumScopes * 2);
+	frame.names.clear();
+	frame.used = 0;
+}
+
+void GpuProfiler::endFrame() {
+	if(frames.empty())
+		return;
+
+	auto& frame = frames[currentFrame];
+	frame.submitTime = Profiler::now();
+	frame.pending = frame.used > 0;
+}
+
+int32_t GpuProfiler::beginScope(vk::CommandBuffer commandBuffer, const std::string& name) {
+	if(frames.empty())
+		return -1;
+
+	auto& frame = frames[currentFrame];
+	if(frame.used == maximumScopes)
+		return -1;
+
+	const auto scope = frame.used++;
+	frame.names.emplace_back(name);
+	commandBuffer.writeTimestamp(vk::PipelineStageFlagBits::eTopOfPipe, frame.pool, scope * 2);
+	return static_cast<int32_t>(scope);
+}
+
+void GpuProfiler::endScope(vk::CommandBuffer commandBuffer, int32_t scope) {
+	if(scope < 0)
+		return;
+
+	commandBuffer.writeTimestamp(vk::PipelineStageFlagBits::eBottomOfPipe, frames[currentFrame].pool, static_cast<uint32_t>(scope) * 2 + 1);
+}
+
+void GpuProfiler::resolve(FrameQueries& frame) {
+	frame.pending = false;
+
+	// The frame's fence signaled before we got here, so this doesn't wait.
+	const auto result = logicalDevice.getQueryPoolResults(frame.pool, 0, frame.used * 2, frame.used * 2 * sizeof(uint64_t), results.data(),
+														  sizeof(uint64_t), vk::QueryResultFlagBits::e64);
+	if(result != vk::Result::eSuccess)
+		return;
+
+	// Gpu and cpu clocks aren't related, the first timestamp of the frame is placed at its submission.
+	const uint64_t origin = results[0] & timestampMask;
+	auto toCpuTime = [&](uint64_t ticks) {
+		const uint64_t delta = ((ticks & timestampMask) - origin) & timestampMask;
+		return frame.submitTime + static_cast<uint64_t>(delta * timestampPeriod);
+	};
+
+	lastFrameTimings.clear();
+	for(uint32_t scope = 0; scope < frame.used; ++scope) {
+		const auto start = toCpuTime(results[scope * 2]);
+		const auto end = toCpuTime(results[scope * 2 + 1]);
+		Profiler::get().recordGpu(frame.names[scope], start, end);
+
+		GpuScopeTiming timing;
+		timing.name = frame.names[scope];
+		timing.milliseconds = (end - start) / 1e6;
+		lastFrameTimings.emplace_back(timing);
+	}
+}
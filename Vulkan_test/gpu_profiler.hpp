@@ -0,0 +1,96 @@
+//
+//  gpu_profiler.hpp
+//  Vulkan_test
+//
+//  Created by Danny on 17/10/2026.
+//  Copyright © 2026 Danny. All rights reserved.
+//
+
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+
+#include <string>
+#include <vector>
+
+#include "profiler.hpp"
+
+struct GpuScopeTiming
+{
+	std::string name;
+	double milliseconds = 0;
+};
+
+// Timestamp queries around scopes of a frame's command buffers. Every frame context has its own query pool,
+// which is read back when the context comes around again: its fence signaled, so the results are there and
+// reading them never stalls. Resolved scopes go to the Profiler, aligned so the frame starts at its submission.
+class GpuProfiler {
+public:
+	GpuProfiler(const vk::PhysicalDevice&, const vk::Device&, uint32_t queueFamilyIndex, uint32_t frameCount, uint32_t maximumScopesPerFrame = 256);
+	~GpuProfiler();
+
+	GpuProfiler(const GpuProfiler&) = delete;
+	GpuProfiler& operator=(const GpuProfiler&) = delete;
+
+	// Collects what the frame context recorded last time and resets its queries. Has to be recorded before
+	// any scope of the frame, outside of a render pass.
+	void beginFrame(vk::CommandBuffer, uint32_t frameIndex);
+	// Call right before the frame is submitted.
+	void endFrame();
+
+	// Returns the scope to end, or -1 if the frame ran out of queries or timestamps aren't supported.
+	int32_t beginScope(vk::CommandBuffer, const std::string& name);
+	void endScope(vk::CommandBuffer, int32_t scope);
+
+	// The scopes of the most recently resolved frame.
+	const std::vector<GpuScopeTiming>& getLastFrameTimings() const { return lastFrameTimings; }
+
+private:
+
+	struct FrameQueries
+	{
+		vk::QueryPool pool;
+		std::vector<std::string> names;
+		uint32_t used = 0;
+		uint64_t submitTime = 0;
+		bool pending = false;
+	};
+
+	void resolve(FrameQueries&);
+
+private:
+
+	vk::Device logicalDevice;
+	std::vector<FrameQueries> frames;
+	uint32_t currentFrame = 0;
+	uint32_t maximumScopes;
+
+	// Nanoseconds per tick, and the bits of a timestamp that are valid.
+	double timestampPeriod = 0;
+	uint64_t timestampMask = 0;
+
+	std::vector<uint64_t> results;
+	std::vector<GpuScopeTiming> lastFrameTimings;
+};
+
+// Ends the scope when it goes out of scope. Does nothing without a profiler.
+class GpuProfileScope {
+public:
+	GpuProfileScope(GpuProfiler* profiler, vk::CommandBuffer commandBuffer, const std::string& name)
+	: profiler(profiler), commandBuffer(commandBuffer), scope(profiler ? profiler->beginScope(commandBuffer, name) : -1) {}
+	~GpuProfileScope() { if(profiler) profiler->endScope(commandBuffer, scope); }
+
+	GpuProfileScope(const GpuProfileScope&) = delete;
+	GpuProfileScope& operator=(const GpuProfileScope&) = delete;
+
+private:
+	GpuProfiler* profiler;
+	vk::CommandBuffer commandBuffer;
+	int32_t scope;
+};
+
+#ifdef RENDERER_PROFILING
+#define PROFILE_GPU_SCOPE(profiler, commandBuffer, name) GpuProfileScope PROFILE_CONCAT(gpuProfileScope, __LINE__)(profiler, commandBuffer, name)
+#else
+#define PROFILE_GPU_SCOPE(profiler, commandBuffer, name)
+#endif
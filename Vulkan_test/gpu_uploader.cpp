@@ -0,0 +1,518 @@
+//
+//  gpu_uploader.cpp
+//  Vulkan_test
+//
+//  Created by Danny on 17/10/2026.
+//  Copyright © 2026 Danny. All rights reserved.
+//
+
+#include "gpu_uploader.hpp"
+#include "profiler.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+namespace {
+
+	vk::DeviceSize alignUp(vk::DeviceSize value, vk::DeviceSize alignment) {
+		return (value + alignment - 1) / alignment * alignment;
+	}
+
+	// Image copies need an offset that is a multiple of the texel size and of 4. 16 keeps the copies fast.
+	vk::DeviceSize getImageCopyAlignment(uint32_t texelSize) {
+		vk::DeviceSize alignment = 16;
+		while(alignment % std::max(texelSize, 1u) != 0)
+			alignment += 16;
+		return alignment;
+	}
+
+	const vk::DeviceSize bufferCopyAlignment = 16;
+
+	// Everything the graphics queue may read uploaded data with.
+	const vk::AccessFlags consumerAccess = vk::AccessFlagBits::eVertexAttributeRead | vk::AccessFlagBits::eIndexRead | vk::AccessFlagBits::eUniformRead |
+		vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eIndirectCommandRead | vk::AccessFlagBits::eTransferRead;
+}
+
+GpuUploader::GpuUploader(const vk::Device& logicalDevice, MemoryAllocator& allocator, vk::Queue transferQueue, uint32_t transferQueueIndex,
+						 vk::Queue graphicsQueue, uint32_t graphicsQueueIndex, std::mutex* queueMutex, std::mutex& graphicsQueueMutex,
+						 vk::DeviceSize stagingSize)
+: logicalDevice(logicalDevice), allocator(allocator), transferQueue(transferQueue), transferQueueIndex(transferQueueIndex),
+graphicsQueue(graphicsQueue), graphicsQueueIndex(graphicsQueueIndex), queueMutex(queueMutex), graphicsQueueMutex(graphicsQueueMutex),
+capacity(stagingSize) {
+
+	// Both queues copy out of the ring.
+	const uint32_t families[] = {transferQueueIndex, graphicsQueueIndex};
+	vk::BufferCreateInfo bufferInfo;
+	bufferInfo.setSize(capacity);
+	bufferInfo.setUsage(vk::BufferUsageFlagBits::eTransferSrc);
+	if(transferQueueIndex != graphicsQueueIndex) {
+		bufferInfo.setSharingMode(vk::SharingMode::eConcurrent);
+		bufferInfo.setQueueFamilyIndexCount(2);
+		bufferInfo.setPQueueFamilyIndices(families);
+	} else {
+		bufferInfo.setSharingMode(vk::SharingMode::eExclusive);
+	}
+	stagingBuffer = logicalDevice.createBuffer(bufferInfo);
+
+	stagingMemory = allocator.allocateForBuffer(stagingBuffer, MemoryUsage::CPU_TO_GPU, AllocationStrategy::DEDICATED);
+	staging = static_cast<uint8_t*>(stagingMemory.mapped);
+
+	vk::CommandPoolCreateInfo poolInfo;
+	poolInfo.setQueueFamilyIndex(transferQueueIndex);
+	poolInfo.setFlags(vk::CommandPoolCreateFlagBits::eTransient | vk::CommandPoolCreateFlagBits::eResetCommandBuffer);
+	commandPool = logicalDevice.createCommandPool(poolInfo);
+	poolInfo.setQueueFamilyIndex(graphicsQueueIndex);
+	graphicsCommandPool = logicalDevice.createCommandPool(poolInfo);
+
+	vk::SemaphoreTypeCreateInfo typeInfo(vk::SemaphoreType::eTimeline, 0);
+	vk::SemaphoreCreateInfo semaphoreInfo;
+	semaphoreInfo.setPNext(&typeInfo);
+	timeline = logicalDevice.createSemaphore(semaphoreInfo);
+}
+
+GpuUploader::~GpuUploader() {
+	if(lastSubmittedValue)
+		wait(UploadToken{lastSubmittedValue});
+
+	logicalDevice.destroySemaphore(timeline);
+	logicalDevice.destroyCommandPool(commandPool);
+	logicalDevice.destroyCommandPool(graphicsCommandPool);
+	logicalDevice.destroyBuffer(stagingBuffer);
+	allocator.free(stagingMemory);
+}
+
+UploadToken GpuUploader::uploadBuffer(vk::Buffer buffer, vk::DeviceSize offset, const void* data, vk::DeviceSize size) {
+	std::unique_lock<std::mutex> lock(mutex);
+
+	// Half the ring at most, so a chunk always fits once the batch before it retired.
+	const vk::DeviceSize chunkSize = capacity / 2;
+	const auto* source = static_cast<const uint8_t*>(data);
+
+	for(vk::DeviceSize done = 0; done < size;) {
+		const auto length = std::min(size - done, chunkSize);
+		const auto stagingOffset = allocate(lock, length, bufferCopyAlignment);
+		std::memcpy(staging + stagingOffset, source + done, length);
+
+		PendingBufferCopy copy;
+		copy.buffer = buffer;
+		copy.region = vk::BufferCopy(stagingOffset, offset + done, length);
+		done += length;
+
+		if(done == size) {
+			copy.release = true;
+			copy.releaseOffset = offset;
+			copy.releaseSize = size;
+		}
+
+		pendingBufferCopies.emplace_back(copy);
+	}
+
+	return UploadToken{nextValue};
+}
+
+UploadToken GpuUploader::uploadImage(vk::Image image, vk::ImageAspectFlags aspect, vk::Extent3D mipExtent, uint32_t mipLevel, uint32_t layer,
+									 uint32_t texelSize, const void* data, vk::DeviceSize size, uint32_t blockDimension) {
+	std::unique_lock<std::mutex> lock(mutex);
+
+	// In blocks, which are single texels for uncompressed formats.
+	const uint32_t columns = (mipExtent.width + blockDimension - 1) / blockDimension;
+	const uint32_t height = (mipExtent.height + blockDimension - 1) / blockDimension;
+
+	const vk::DeviceSize rowSize = static_cast<vk::DeviceSize>(columns) * texelSize;
+	const vk::DeviceSize sliceSize = rowSize * height;
+	const auto alignment = getImageCopyAlignment(texelSize);
+	if(rowSize == 0 || rowSize > capacity / 2 || size < sliceSize * mipExtent.depth)
+		return UploadToken{};
+
+	const uint32_t rowsPerChunk = static_cast<uint32_t>(std::max<vk::DeviceSize>(capacity / 2 / rowSize, 1));
+	const auto* source = static_cast<const uint8_t*>(data);
+
+	// Large mips are split in bands of rows, one slice at a time.
+	bool first = true;
+	for(uint32_t z = 0; z < mipExtent.depth; ++z) {
+		for(uint32_t y = 0; y < height; y += rowsPerChunk) {
+			const uint32_t rows = std::min(rowsPerChunk, height - y);
+			const auto length = rows * rowSize;
+			const auto stagingOffset = allocate(lock, length, alignment);
+			std::memcpy(staging + stagingOffset, source + z * sliceSize + y * rowSize, length);
+
+			// Copies of block compressed images may only end off the block grid at the edge of the image.
+			const uint32_t top = y * blockDimension;
+			const uint32_t bottom = std::min((y + rows) * blockDimension, mipExtent.height);
+
+			PendingImageCopy copy;
+			copy.image = image;
+			copy.range = vk::ImageSubresourceRange(aspect, mipLevel, 1, layer, 1);
+			copy.region.setBufferOffset(stagingOffset);
+			copy.region.setImageSubresource(vk::ImageSubresourceLayers(aspect, mipLevel, layer, 1));
+			copy.region.setImageOffset(vk::Offset3D(0, static_cast<int32_t>(top), static_cast<int32_t>(z)));
+			copy.region.setImageExtent(vk::Extent3D(mipExtent.width, bottom - top, 1));
+			copy.first = first;
+			copy.last = z + 1 == mipExtent.depth && y + rows == height;
+			first = false;
+
+			pendingImageCopies.emplace_back(copy);
+		}
+	}
+
+	return UploadToken{nextValue};
+}
+
+UploadToken GpuUploader::flush() {
+	PROFILE_FUNCTION();
+	std::lock_guard<std::mutex> lock(mutex);
+	submitLocked();
+	return UploadToken{lastSubmittedValue};
+}
+
+bool GpuUploader::isComplete(UploadToken token) const {
+	return getCompletedValue() >= token.value;
+}
+
+void GpuUploader::wait(UploadToken token) {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if(token.value > lastSubmittedValue)
+			submitLocked();
+	}
+
+	vk::SemaphoreWaitInfo waitInfo;
+	waitInfo.setSemaphoreCount(1);
+	waitInfo.setPSemaphores(&timeline);
+	waitInfo.setPValues(&token.value);
+	logicalDevice.waitSemaphores(waitInfo, std::numeric_limits<uint64_t>::max());
+}
+
+uint64_t GpuUploader::recordAcquireBarriers(vk::CommandBuffer commandBuffer) {
+	std::lock_guard<std::mutex> lock(mutex);
+
+	if(!pendingBufferAcquires.empty() || !pendingImageAcquires.empty()) {
+		commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTopOfPipe, vk::PipelineStageFlagBits::eAllCommands, vk::DependencyFlags(),
+									  nullptr, pendingBufferAcquires, pendingImageAcquires);
+		pendingBufferAcquires.clear();
+		pendingImageAcquires.clear();
+	}
+
+	return lastSubmittedValue;
+}
+
+void GpuUploader::forget(vk::Buffer buffer) {
+	std::lock_guard<std::mutex> lock(mutex);
+	graphicsBuffers.erase(buffer);
+}
+
+void GpuUploader::forget(vk::Image image) {
+	std::lock_guard<std::mutex> lock(mutex);
+	auto it = graphicsImages.lower_bound(std::make_tuple(image, 0u, 0u));
+	while(it != graphicsImages.end() && std::get<0>(*it) == image)
+		it = graphicsImages.erase(it);
+}
+
+vk::PipelineStageFlags GpuUploader::getConsumerStages() {
+	return vk::PipelineStageFlagBits::eDrawIndirect | vk::PipelineStageFlagBits::eVertexInput | vk::PipelineStageFlagBits::eVertexShader |
+		vk::PipelineStageFlagBits::eFragmentShader | vk::PipelineStageFlagBits::eComputeShader | vk::PipelineStageFlagBits::eTransfer;
+}
+
+bool GpuUploader::tryAllocate(vk::DeviceSize size, vk::DeviceSize alignment, vk::DeviceSize& offset) {
+	// Live data is [tail, head), possibly wrapped around the end of the ring.
+	const bool empty = inFlight.empty() && pendingBufferCopies.empty() && pendingImageCopies.empty();
+	if(empty)
+		head = tail = 0;
+
+	if(empty || tail < head) {
+		const auto start = alignUp(head, alignment);
+		if(start + size <= capacity) {
+			offset = start;
+			head = start + size;
+			return true;
+		}
+
+		// Wrap around, the end of the ring stays unused until the tail passed it.
+		if(!empty && size <= tail) {
+			offset = 0;
+			head = size;
+			return true;
+		}
+
+		return false;
+	}
+
+	// head == tail with live data means the ring is full.
+	const auto start = alignUp(head, alignment);
+	if(tail > head && start + size <= tail) {
+		offset = start;
+		head = start + size;
+		return true;
+	}
+
+	return false;
+}
+
+vk::DeviceSize GpuUploader::allocate(std::unique_lock<std::mutex>& lock, vk::DeviceSize size, vk::DeviceSize alignment) {
+	vk::DeviceSize offset = 0;
+	for(;;) {
+		reclaim();
+		if(tryAllocate(size, alignment, offset))
+			return offset;
+
+		// Get the copies that fill the ring on their way, then wait for the oldest batch to retire.
+		if(!pendingBufferCopies.empty() || !pendingImageCopies.empty()) {
+			submitLocked();
+			continue;
+		}
+
+		const auto value = inFlight.front().value;
+		lock.unlock();
+		wait(UploadToken{value});
+		lock.lock();
+	}
+}
+
+void GpuUploader::reclaim() {
+	const auto completed = getCompletedValue();
+	while(!inFlight.empty() && inFlight.front().value <= completed) {
+		const auto& batch = inFlight.front();
+		tail = batch.ringEnd;
+		if(batch.commandBuffer)
+			freeCommandBuffers.emplace_back(batch.commandBuffer);
+		if(batch.graphicsCommandBuffer)
+			freeGraphicsCommandBuffers.emplace_back(batch.graphicsCommandBuffer);
+		inFlight.pop_front();
+	}
+}
+
+void GpuUploader::submitLocked() {
+	if(pendingBufferCopies.empty() && pendingImageCopies.empty())
+		return;
+
+	// Whatever the graphics queue already owns is copied there, all copies of an upload go the same way.
+	std::vector<PendingBufferCopy> graphicsBufferCopies;
+	std::vector<PendingImageCopy> graphicsImageCopies;
+	std::vector<PendingBufferCopy> bufferCopies;
+	std::vector<PendingImageCopy> imageCopies;
+	for(const auto& copy: pendingBufferCopies)
+		(graphicsBuffers.count(copy.buffer) ? graphicsBufferCopies : bufferCopies).emplace_back(copy);
+	for(const auto& copy: pendingImageCopies) {
+		const auto key = std::make_tuple(copy.image, copy.range.baseMipLevel, copy.range.baseArrayLayer);
+		(graphicsImages.count(key) ? graphicsImageCopies : imageCopies).emplace_back(copy);
+	}
+
+	const bool transferOwnership = transferQueueIndex != graphicsQueueIndex;
+	const auto srcFamily = transferOwnership ? transferQueueIndex : VK_QUEUE_FAMILY_IGNORED;
+	const auto dstFamily = transferOwnership ? graphicsQueueIndex : VK_QUEUE_FAMILY_IGNORED;
+
+	std::vector<vk::ImageMemoryBarrier> toTransfer;
+	std::vector<vk::ImageMemoryBarrier> imageReleases;
+	std::vector<vk::BufferMemoryBarrier> bufferReleases;
+
+	for(const auto& copy: imageCopies) {
+		vk::ImageMemoryBarrier barrier;
+		barrier.setImage(copy.image);
+		barrier.setSubresourceRange(copy.range);
+		barrier.setSrcQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED);
+		barrier.setDstQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED);
+
+		if(copy.first) {
+			barrier.setOldLayout(vk::ImageLayout::eUndefined);
+			barrier.setNewLayout(vk::ImageLayout::eTransferDstOptimal);
+			barrier.setDstAccessMask(vk::AccessFlagBits::eTransferWrite);
+			toTransfer.emplace_back(barrier);
+		}
+
+		if(copy.last) {
+			// The release half. Its destination access is ignored, visibility comes from the acquire and the semaphore.
+			barrier.setOldLayout(vk::ImageLayout::eTransferDstOptimal);
+			barrier.setNewLayout(vk::ImageLayout::eShaderReadOnlyOptimal);
+			barrier.setSrcQueueFamilyIndex(srcFamily);
+			barrier.setDstQueueFamilyIndex(dstFamily);
+			barrier.setSrcAccessMask(vk::AccessFlagBits::eTransferWrite);
+			barrier.setDstAccessMask(vk::AccessFlags());
+			imageReleases.emplace_back(barrier);
+			graphicsImages.emplace(copy.image, copy.range.baseMipLevel, copy.range.baseArrayLayer);
+
+			if(transferOwnership) {
+				barrier.setSrcAccessMask(vk::AccessFlags());
+				barrier.setDstAccessMask(vk::AccessFlagBits::eShaderRead);
+				pendingImageAcquires.emplace_back(barrier);
+			}
+		}
+	}
+
+	for(const auto& copy: bufferCopies) {
+		if(!copy.release)
+			continue;
+
+		vk::BufferMemoryBarrier barrier;
+		barrier.setBuffer(copy.buffer);
+		barrier.setOffset(copy.releaseOffset);
+		barrier.setSize(copy.releaseSize);
+		barrier.setSrcQueueFamilyIndex(srcFamily);
+		barrier.setDstQueueFamilyIndex(dstFamily);
+		barrier.setSrcAccessMask(vk::AccessFlagBits::eTransferWrite);
+		bufferReleases.emplace_back(barrier);
+		graphicsBuffers.emplace(copy.buffer);
+
+		if(transferOwnership) {
+			barrier.setSrcAccessMask(vk::AccessFlags());
+			barrier.setDstAccessMask(consumerAccess);
+			pendingBufferAcquires.emplace_back(barrier);
+		}
+	}
+
+	Batch batch;
+	batch.value = nextValue;
+	const bool graphicsCopies = !graphicsBufferCopies.empty() || !graphicsImageCopies.empty();
+
+	if(!bufferCopies.empty() || !imageCopies.empty()) {
+		auto commandBuffer = acquireCommandBuffer(commandPool, freeCommandBuffers);
+		commandBuffer.begin(vk::CommandBufferBeginInfo(vk::CommandBufferUsageFlagBits::eOneTimeSubmit));
+
+		if(!toTransfer.empty())
+			commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTopOfPipe, vk::PipelineStageFlagBits::eTransfer, vk::DependencyFlags(), nullptr, nullptr, toTransfer);
+
+		for(const auto& copy: bufferCopies)
+			commandBuffer.copyBuffer(stagingBuffer, copy.buffer, copy.region);
+
+		for(const auto& copy: imageCopies)
+			commandBuffer.copyBufferToImage(stagingBuffer, copy.image, vk::ImageLayout::eTransferDstOptimal, copy.region);
+
+		if(!bufferReleases.empty() || !imageReleases.empty())
+			commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eBottomOfPipe, vk::DependencyFlags(), nullptr, bufferReleases, imageReleases);
+
+		commandBuffer.end();
+		submit(transferQueue, queueMutex, commandBuffer, 0, graphicsCopies ? batch.value - 1 : batch.value);
+		batch.commandBuffer = commandBuffer;
+	}
+
+	// Waits for every earlier transfer submission, its releases are acquired here if no frame did that yet.
+	// Signals after the transfer queue did, the semaphore's value may only go up.
+	if(graphicsCopies) {
+		auto commandBuffer = acquireCommandBuffer(graphicsCommandPool, freeGraphicsCommandBuffers);
+		recordGraphicsCopies(commandBuffer, graphicsBufferCopies, graphicsImageCopies);
+		submit(graphicsQueue, &graphicsQueueMutex, commandBuffer, batch.commandBuffer ? batch.value - 1 : lastSubmittedValue, batch.value);
+		batch.graphicsCommandBuffer = commandBuffer;
+	}
+
+	batch.ringEnd = head;
+	inFlight.emplace_back(batch);
+	lastSubmittedValue = batch.value;
+	nextValue += 2;
+
+	pendingBufferCopies.clear();
+	pendingImageCopies.clear();
+}
+
+void GpuUploader::recordGraphicsCopies(vk::CommandBuffer commandBuffer, const std::vector<PendingBufferCopy>& bufferCopies,
+									   const std::vector<PendingImageCopy>& imageCopies) {
+	// Copies wait for everything submitted to the graphics queue before, which may still read or write the resource,
+	// and leave it the way an upload on the transfer queue would have.
+	std::vector<vk::BufferMemoryBarrier> bufferBefore;
+	std::vector<vk::BufferMemoryBarrier> bufferAfter;
+	for(const auto& copy: bufferCopies) {
+		vk::BufferMemoryBarrier barrier;
+		barrier.setBuffer(copy.buffer);
+		barrier.setOffset(copy.region.dstOffset);
+		barrier.setSize(copy.region.size);
+		barrier.setSrcQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED);
+		barrier.setDstQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED);
+		barrier.setSrcAccessMask(vk::AccessFlagBits::eTransferWrite | vk::AccessFlagBits::eShaderWrite);
+		barrier.setDstAccessMask(vk::AccessFlagBits::eTransferWrite);
+		bufferBefore.emplace_back(barrier);
+
+		barrier.setSrcAccessMask(vk::AccessFlagBits::eTransferWrite);
+		barrier.setDstAccessMask(consumerAccess);
+		bufferAfter.emplace_back(barrier);
+	}
+
+	std::vector<vk::ImageMemoryBarrier> imageBefore;
+	std::vector<vk::ImageMemoryBarrier> imageAfter;
+	for(const auto& copy: imageCopies) {
+		vk::ImageMemoryBarrier barrier;
+		barrier.setImage(copy.image);
+		barrier.setSubresourceRange(copy.range);
+		barrier.setSrcQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED);
+		barrier.setDstQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED);
+
+		if(copy.first) {
+			barrier.setOldLayout(vk::ImageLayout::eShaderReadOnlyOptimal);
+			barrier.setNewLayout(vk::ImageLayout::eTransferDstOptimal);
+			barrier.setDstAccessMask(vk::AccessFlagBits::eTransferWrite);
+			imageBefore.emplace_back(barrier);
+		}
+
+		if(copy.last) {
+			barrier.setOldLayout(vk::ImageLayout::eTransferDstOptimal);
+			barrier.setNewLayout(vk::ImageLayout::eShaderReadOnlyOptimal);
+			barrier.setSrcAccessMask(vk::AccessFlagBits::eTransferWrite);
+			barrier.setDstAccessMask(vk::AccessFlagBits::eShaderRead);
+			imageAfter.emplace_back(barrier);
+		}
+	}
+
+	commandBuffer.begin(vk::CommandBufferBeginInfo(vk::CommandBufferUsageFlagBits::eOneTimeSubmit));
+	if(!pendingBufferAcquires.empty() || !pendingImageAcquires.empty()) {
+		commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTopOfPipe, vk::PipelineStageFlagBits::eAllCommands, vk::DependencyFlags(),
+									  nullptr, pendingBufferAcquires, pendingImageAcquires);
+		pendingBufferAcquires.clear();
+		pendingImageAcquires.clear();
+	}
+	commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eAllCommands, vk::PipelineStageFlagBits::eTransfer, vk::DependencyFlags(), nullptr, bufferBefore, imageBefore);
+
+	for(const auto& copy: bufferCopies)
+		commandBuffer.copyBuffer(stagingBuffer, copy.buffer, copy.region);
+
+	for(const auto& copy: imageCopies)
+		commandBuffer.copyBufferToImage(stagingBuffer, copy.image, vk::ImageLayout::eTransferDstOptimal, copy.region);
+
+	commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eAllCommands, vk::DependencyFlags(), nullptr, bufferAfter, imageAfter);
+	commandBuffer.end();
+}
+
+void GpuUploader::submit(vk::Queue queue, std::mutex* mutex, vk::CommandBuffer commandBuffer, uint64_t waitValue, uint64_t signalValue) {
+	const vk::PipelineStageFlags waitStage = vk::PipelineStageFlagBits::eTransfer;
+
+	vk::TimelineSemaphoreSubmitInfo timelineInfo;
+	timelineInfo.setSignalSemaphoreValueCount(1);
+	timelineInfo.setPSignalSemaphoreValues(&signalValue);
+
+	vk::SubmitInfo submitInfo;
+	submitInfo.setPNext(&timelineInfo);
+	submitInfo.setCommandBufferCount(1);
+	submitInfo.setPCommandBuffers(&commandBuffer);
+	submitInfo.setSignalSemaphoreCount(1);
+	submitInfo.setPSignalSemaphores(&timeline);
+	if(waitValue) {
+		timelineInfo.setWaitSemaphoreValueCount(1);
+		timelineInfo.setPWaitSemaphoreValues(&waitValue);
+		submitInfo.setWaitSemaphoreCount(1);
+		submitInfo.setPWaitSemaphores(&timeline);
+		submitInfo.setPWaitDstStageMask(&waitStage);
+	}
+
+	if(mutex) {
+		std::lock_guard<std::mutex> queueLock(*mutex);
+		queue.submit(submitInfo, nullptr);
+	} else {
+		queue.submit(submitInfo, nullptr);
+	}
+}
+
+vk::CommandBuffer GpuUploader::acquireCommandBuffer(vk::CommandPool pool, std::vector<vk::CommandBuffer>& freeCommandBuffers) {
+	if(!freeCommandBuffers.empty()) {
+		auto commandBuffer = freeCommandBuffers.back();
+		freeCommandBuffers.pop_back();
+		commandBuffer.reset(vk::CommandBufferResetFlags());
+		return commandBuffer;
+	}
+
+	vk::CommandBufferAllocateInfo info;
+	info.setCommandPool(pool);
+	info.setLevel(vk::CommandBufferLevel::ePrimary);
+	info.setCommandBufferCount(1);
+	return logicalDevice.allocateCommandBuffers(info).front();
+}
+
+uint64_t GpuUploader::getCompletedValue() const {
+	return logicalDevice.getSemaphoreCounterValue(timeline);
+}
@@ -0,0 +1,155 @@
+//
+//  gpu_uploader.hpp
+//  Vulkan_test
+//
+//  Created by Danny on 17/10/2026.
+//  Copyright © 2026 Danny. All rights reserved.
+//
+
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+
+#include <deque>
+#include <mutex>
+#include <set>
+#include <tuple>
+#include <vector>
+
+#include "memory_allocator.hpp"
+
+// Identifies the batch an upload went into. The upload is done once the uploader's timeline semaphore reached value.
+struct UploadToken
+{
+	uint64_t value = 0;
+};
+
+// Streams buffer and image data to device local memory on a transfer queue. Data is copied into a persistently
+// mapped staging ring straight away, the copies themselves are batched and submitted together by flush().
+// When the transfer queue belongs to another family than the graphics queue, ownership of every uploaded
+// range is released on the transfer queue and acquired again by recordAcquireBarriers() on the graphics side.
+// From then on the graphics queue owns it and may still be reading it, so later uploads to the same buffer or image
+// subresource are copied on the graphics queue, after everything submitted to it before.
+class GpuUploader {
+public:
+	// queueMutex guards the transfer queue if it is shared with other submissions, it may be nullptr otherwise.
+	GpuUploader(const vk::Device& logicalDevice, MemoryAllocator& allocator, vk::Queue transferQueue, uint32_t transferQueueIndex,
+				vk::Queue graphicsQueue, uint32_t graphicsQueueIndex, std::mutex* queueMutex, std::mutex& graphicsQueueMutex,
+				vk::DeviceSize stagingSize = 32 * 1024 * 1024);
+	~GpuUploader();
+
+	GpuUploader(const GpuUploader&) = delete;
+	GpuUploader& operator=(const GpuUploader&) = delete;
+
+	// Uploads larger than the staging ring are split into several copies. These block only when the ring is full
+	// of data the gpu hasn't consumed yet.
+	UploadToken uploadBuffer(vk::Buffer, vk::DeviceSize offset, const void* data, vk::DeviceSize size);
+	// Uploads a whole mip level of one layer, tightly packed. The image ends up in eShaderReadOnlyOptimal.
+	// Block compressed formats pass the size of a block and its width in texels, rows are rows of blocks then.
+	// Returns an already complete token if a row doesn't fit in the staging ring or size is too small.
+	UploadToken uploadImage(vk::Image, vk::ImageAspectFlags, vk::Extent3D mipExtent, uint32_t mipLevel, uint32_t layer,
+							uint32_t texelSize, const void* data, vk::DeviceSize size, uint32_t blockDimension = 1);
+
+	// Submits every pending copy as one batch. Does nothing if nothing is pending.
+	UploadToken flush();
+
+	// Never blocks.
+	bool isComplete(UploadToken) const;
+	void wait(UploadToken);
+
+	// Records the queue family acquire barriers for all flushed batches that haven't been acquired yet and
+	// returns the timeline value a graphics submission has to wait on before it reads the uploaded data.
+	uint64_t recordAcquireBarriers(vk::CommandBuffer graphicsCommandBuffer);
+
+	// Has to be called before a resource that was uploaded to is destroyed, its handle may be reused.
+	void forget(vk::Buffer);
+	void forget(vk::Image);
+
+	vk::Semaphore getTimelineSemaphore() const { return timeline; }
+	// Stages a graphics submission has to wait on the timeline semaphore at.
+	static vk::PipelineStageFlags getConsumerStages();
+
+private:
+
+	struct Batch
+	{
+		vk::CommandBuffer commandBuffer;
+		// Copies to resources the graphics queue owns, may be null.
+		vk::CommandBuffer graphicsCommandBuffer;
+		uint64_t value = 0;
+		// Ring head after this batch, the tail moves here once the batch retired.
+		vk::DeviceSize ringEnd = 0;
+	};
+
+	struct PendingBufferCopy
+	{
+		vk::Buffer buffer;
+		vk::BufferCopy region;
+		// The last copy of an upload releases the whole range.
+		bool release = false;
+		vk::DeviceSize releaseOffset = 0;
+		vk::DeviceSize releaseSize = 0;
+	};
+
+	struct PendingImageCopy
+	{
+		vk::Image image;
+		vk::BufferImageCopy region;
+		vk::ImageSubresourceRange range;
+		bool first = false;
+		bool last = false;
+	};
+
+	bool tryAllocate(vk::DeviceSize size, vk::DeviceSize alignment, vk::DeviceSize& offset);
+	// Makes room in the ring, submitting and waiting for earlier batches if needed.
+	vk::DeviceSize allocate(std::unique_lock<std::mutex>&, vk::DeviceSize size, vk::DeviceSize alignment);
+	void reclaim();
+	void submitLocked();
+	void recordGraphicsCopies(vk::CommandBuffer, const std::vector<PendingBufferCopy>&, const std::vector<PendingImageCopy>&);
+	void submit(vk::Queue, std::mutex*, vk::CommandBuffer, uint64_t waitValue, uint64_t signalValue);
+	vk::CommandBuffer acquireCommandBuffer(vk::CommandPool, std::vector<vk::CommandBuffer>& freeCommandBuffers);
+	uint64_t getCompletedValue() const;
+
+private:
+
+	vk::Device logicalDevice;
+	MemoryAllocator& allocator;
+	vk::Queue transferQueue;
+	uint32_t transferQueueIndex;
+	vk::Queue graphicsQueue;
+	uint32_t graphicsQueueIndex;
+	std::mutex* queueMutex;
+	std::mutex& graphicsQueueMutex;
+
+	vk::Buffer stagingBuffer;
+	MemoryAllocation stagingMemory;
+	uint8_t* staging = nullptr;
+	vk::DeviceSize capacity = 0;
+	vk::DeviceSize head = 0;
+	vk::DeviceSize tail = 0;
+
+	vk::CommandPool commandPool;
+	std::vector<vk::CommandBuffer> freeCommandBuffers;
+	vk::CommandPool graphicsCommandPool;
+	std::vector<vk::CommandBuffer> freeGraphicsCommandBuffers;
+
+	vk::Semaphore timeline;
+	// The value the batch that is being filled will signal once all its copies are done. A batch with copies on both
+	// queues signals the value below it from the transfer queue first, values go up by two for that.
+	uint64_t nextValue = 2;
+
+	std::vector<PendingBufferCopy> pendingBufferCopies;
+	std::vector<PendingImageCopy> pendingImageCopies;
+	std::deque<Batch> inFlight;
+
+	// Acquire halves of the ownership transfers, recorded by the graphics queue.
+	std::vector<vk::BufferMemoryBarrier> pendingBufferAcquires;
+	std::vector<vk::ImageMemoryBarrier> pendingImageAcquires;
+	uint64_t lastSubmittedValue = 0;
+
+	// What was handed to the graphics queue, images by mip level and layer.
+	std::set<vk::Buffer> graphicsBuffers;
+	std::set<std::tuple<vk::Image, uint32_t, uint32_t>> graphicsImages;
+
+	mutable std::mutex mutex;
+};
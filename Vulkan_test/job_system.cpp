@@ -0,0 +1,119 @@
+//
+//  job_system.cpp
+//  Vulkan_test
+//
+//  Created by Danny on 17/10/2026.
+//  Copyright © 2026 Danny. All rights reserved.
+//
+
+#include "job_system.hpp"
+
+#include <algorithm>
+
+#include "profiler.hpp"
+
+namespace {
+	thread_local const void* currentJobSystem = nullptr;
+	thread_local uint32_t currentWorkerIndex = 0;
+}
+
+void JobCounter::wait() {
+	std::unique_lock<std::mutex> lock(mutex);
+	done.wait(lock, [this]{ return pending.load() == 0; });
+}
+
+JobSystem::JobSystem(uint32_t threadCount) {
+	if(threadCount == 0)
+		threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+
+	for(uint32_t i = 0; i < threadCount; ++i)
+		workers.emplace_back([this, i]{ run(i); });
+}
+
+JobSystem::~JobSystem() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+
+	available.notify_all();
+	for(auto& worker: workers)
+		worker.join();
+}
+
+void JobSystem::schedule(std::function<void()> job, JobCounter& counter) {
+	counter.pending++;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		queue.push_back({std::move(job), &counter});
+	}
+
+	available.notify_one();
+}
+
+void JobSystem::parallelFor(uint32_t count, uint32_t chunkSize, const std::function<void(uint32_t, uint32_t)>& body) {
+	if(count == 0)
+		return;
+
+	chunkSize = std::max(chunkSize, 1u);
+
+	JobCounter counter;
+	for(uint32_t begin = 0; begin < count; begin += chunkSize) {
+		const auto end = std::min(begin + chunkSize, count);
+		schedule([&body, begin, end]{ body(begin, end); }, counter);
+	}
+
+	while(counter.pending.load() != 0 && tryRunOne()) {}
+
+	// Always finish through wait(), it synchronises with the last finish() touching the counter.
+	counter.wait();
+}
+
+uint32_t JobSystem::getWorkerIndex() const {
+	return currentJobSystem == this ? currentWorkerIndex : getWorkerCount();
+}
+
+void JobSystem::run(uint32_t workerIndex) {
+	currentJobSystem = this;
+	currentWorkerIndex = workerIndex;
+	PROFILE_THREAD_NAME("Worker " + std::to_string(workerIndex));
+
+	for(;;) {
+		Job job;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			available.wait(lock, [this]{ return stopping || !queue.empty(); });
+			if(queue.empty())
+				return;
+
+			job = std::move(queue.front());
+			queue.pop_front();
+		}
+
+		job.function();
+		finish(*job.counter);
+	}
+}
+
+bool JobSystem::tryRunOne() {
+	Job job;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if(queue.empty())
+			return false;
+
+		job = std::move(queue.front());
+		queue.pop_front();
+	}
+
+	job.function();
+	finish(*job.counter);
+	return true;
+}
+
+void JobSystem::finish(JobCounter& counter) {
+	// Take the lock so a waiter can't miss the notification between checking pending and sleeping.
+	std::lock_guard<std::mutex> lock(counter.mutex);
+	if(--counter.pending == 0)
+		counter.done.notify_all();
+}
@@ -0,0 +1,75 @@
+//
+//  job_system.hpp
+//  Vulkan_test
+//
+//  Created by Danny on 17/10/2026.
+//  Copyright © 2026 Danny. All rights reserved.
+//
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Counts outstanding jobs, wait() returns once all jobs that were scheduled with it have run.
+class JobCounter {
+public:
+	void wait();
+
+private:
+	friend class JobSystem;
+
+	std::atomic<uint32_t> pending {0};
+	std::mutex mutex;
+	std::condition_variable done;
+};
+
+// A fixed pool of worker threads. Worker indices are stable for the lifetime of the job system,
+// so per thread resources (command pools, scratch memory) can be indexed by getWorkerIndex().
+class JobSystem {
+public:
+	// 0 threads picks one worker per hardware thread.
+	explicit JobSystem(uint32_t threadCount = 0);
+	~JobSystem();
+
+	JobSystem(const JobSystem&) = delete;
+	JobSystem& operator=(const JobSystem&) = delete;
+
+	void schedule(std::function<void()> job, JobCounter& counter);
+
+	// Runs body(begin, end) over [0, count) in chunks of at most chunkSize and waits for all of them.
+	// The calling thread helps out instead of sleeping.
+	void parallelFor(uint32_t count, uint32_t chunkSize, const std::function<void(uint32_t begin, uint32_t end)>& body);
+
+	uint32_t getWorkerCount() const { return static_cast<uint32_t>(workers.size()); }
+
+	// Index of the calling worker in [0, getWorkerCount()), or getWorkerCount() for threads that
+	// aren't part of any job system (e.g. the render thread helping out in parallelFor).
+	uint32_t getWorkerIndex() const;
+
+private:
+
+	struct Job
+	{
+		std::function<void()> function;
+		JobCounter* counter = nullptr;
+	};
+
+	void run(uint32_t workerIndex);
+	bool tryRunOne();
+	void finish(JobCounter&);
+
+private:
+
+	std::vector<std::thread> workers;
+	std::deque<Job> queue;
+	std::mutex mutex;
+	std::condition_variable available;
+	bool stopping = false;
+};
@@ -0,0 +1,813 @@
+//
+//  jpeg_decoder.cpp
+//  Vulkan_test
+//
+//  Created by Danny on 17/10/2026.
+//  Copyright © 2026 Danny. All rights reserved.
+//
+
+#include "jpeg_decoder.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <new>
+#include <vector>
+
+#include "texture_streamer.hpp"
+
+namespace {
+
+	// Larger than any device's maxImageDimension2D.
+	const uint32_t maxDimension = 1 << 15;
+
+	// Position in the block of each coefficient in the order they are coded.
+	const uint8_t zigzag[64] = {
+		0, 1, 8, 16, 9, 2, 3, 10, 17, 24, 32, 25, 18, 11, 4, 5, 12, 19, 26, 33, 40, 48, 41, 34, 27, 20, 13, 6, 7, 14, 21, 28,
+		35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23, 30, 37, 44, 51, 58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63
+	};
+
+	uint32_t readU16BigEndian(const uint8_t* data) {
+		return uint32_t(data[0]) << 8 | data[1];
+	}
+
+	uint8_t clampToByte(int value) {
+		return static_cast<uint8_t>(std::min(std::max(value, 0), 255));
+	}
+
+	// A canonical Huffman code of up to 16 bits. Codes up to fastBits long are decoded with one table lookup.
+	struct HuffmanTable
+	{
+		static const uint32_t fastBits = 9;
+		static const uint16_t notFast = 0xFFFF;
+
+		bool present = false;
+		// Index into sizes and values, notFast for codes that are longer.
+		uint16_t fast[1 << fastBits];
+		uint8_t sizes[256];
+		uint8_t values[256];
+		uint32_t count = 0;
+		// Per length, the first code past the last one as 16 bits, and what turns a code into an index.
+		uint32_t maxCode[18];
+		int32_t indexOffset[17];
+
+		bool build(const uint8_t counts[16], const uint8_t* symbols) {
+			uint16_t codes[256];
+			uint32_t code = 0;
+			count = 0;
+			for(uint32_t length = 1; length <= 16; ++length) {
+				indexOffset[length] = int32_t(count) - int32_t(code);
+				for(uint32_t i = 0; i < counts[length - 1]; ++i) {
+					sizes[count] = static_cast<uint8_t>(length);
+					values[count] = symbols[count];
+					codes[count++] = static_cast<uint16_t>(code++);
+				}
+				if(code > (1u << length))
+					return false;
+				maxCode[length] = code << (16 - length);
+				code <<= 1;
+			}
+			maxCode[17] = 0xFFFFFFFF;
+
+			std::fill(std::begin(fast), std::end(fast), static_cast<uint16_t>(notFast));
+			for(uint32_t i = 0; i < count; ++i) {
+				if(sizes[i] > fastBits)
+					continue;
+				const uint32_t first = uint32_t(codes[i]) << (fastBits - sizes[i]);
+				for(uint32_t j = 0; j < (1u << (fastBits - sizes[i])); ++j)
+					fast[first + j] = static_cast<uint16_t>(i);
+			}
+
+			present = true;
+			return true;
+		}
+	};
+
+	struct Component
+	{
+		uint32_t id = 0;
+		uint32_t h = 1, v = 1;
+		uint32_t quantTable = 0;
+		uint32_t dcTable = 0, acTable = 0;
+
+		// Blocks stored, a whole number of MCUs, and blocks that hold part of the image, which is what a scan of
+		// only this component codes.
+		uint32_t blocksWide = 0, blocksHigh = 0;
+		uint32_t usedBlocksWide = 0, usedBlocksHigh = 0;
+		// Pixels of the image in this component.
+		uint32_t width = 0, height = 0;
+
+		// Quantised coefficients of every block in natural order, decoded once all scans are in.
+		std::vector<int16_t> coefficients;
+		int dcPrediction = 0;
+		std::vector<uint8_t> samples;
+	};
+
+	class JpegDecoder {
+	public:
+		JpegDecoder(const uint8_t* data, size_t size) : data(data), size(size) {}
+
+		bool decode(DecodedImage&);
+
+	private:
+		bool readFrame(const uint8_t* segment, uint32_t length, bool progressive);
+		bool readQuantisationTables(const uint8_t* segment, uint32_t length);
+		bool readHuffmanTables(const uint8_t* segment, uint32_t length);
+		bool readScan(const uint8_t* segment, uint32_t length);
+
+		bool decodeScan();
+		bool decodeBlock(Component&, int16_t* block);
+		bool decodeDcFirst(Component&, int16_t* block);
+		void decodeDcRefinement(int16_t* block);
+		bool decodeAcFirst(Component&, int16_t* block);
+		bool decodeAcRefinement(Component&, int16_t* block);
+		bool decodeBlockOfScan(Component&, int16_t* block);
+
+		void inverseTransform(Component&) const;
+		void writeRgba(uint8_t* output) const;
+
+		// The entropy coded data, most significant bit first. Stops at a marker and reads zeros from there.
+		void fill();
+		void consume(uint32_t n) { buffer <<= n; count -= n; }
+		uint32_t getBits(uint32_t n);
+		int receiveExtend(uint32_t n);
+		int decodeHuffman(const HuffmanTable&);
+		void resetBits() { buffer = 0; count = 0; atMarker = false; }
+		void skipToRestart();
+		void skipToMarker();
+
+	private:
+		const uint8_t* data;
+		size_t size;
+		size_t position = 0;
+		uint32_t buffer = 0;
+		uint32_t count = 0;
+		bool atMarker = false;
+
+		uint32_t width = 0, height = 0;
+		bool hasFrame = false;
+		bool progressive = false;
+		uint32_t maxH = 1, maxV = 1;
+		uint32_t mcusWide = 0, mcusHigh = 0;
+		std::vector<Component> components;
+		uint16_t quantisation[4][64] = {};
+		HuffmanTable dcTables[4], acTables[4];
+		uint32_t restartInterval = 0;
+		// The Adobe segment's colour transform, -1 without one.
+		int adobeTransform = -1;
+		uint32_t scanCount = 0;
+
+		// The current scan.
+		Component* scanComponents[4] = {};
+		uint32_t scanComponentCount = 0;
+		uint32_t spectralStart = 0, spectralEnd = 63;
+		uint32_t approximationHigh = 0, approximationLow = 0;
+		uint32_t endOfBandRun = 0;
+	};
+
+	void JpegDecoder::fill() {
+		while(count <= 24) {
+			uint32_t byte = 0;
+			if(!atMarker && position < size) {
+				byte = data[position];
+				if(byte == 0xFF) {
+					// A stuffed zero byte, anything else is a marker.
+					if(position + 1 < size && data[position + 1] == 0) {
+						position += 2;
+					} else {
+						atMarker = true;
+						byte = 0;
+					}
+				} else {
+					++position;
+				}
+			}
+			buffer |= byte << (24 - count);
+			count += 8;
+		}
+	}
+
+	uint32_t JpegDecoder::getBits(uint32_t n) {
+		if(!n)
+			return 0;
+		fill();
+		const uint32_t value = buffer >> (32 - n);
+		consume(n);
+		return value;
+	}
+
+	int JpegDecoder::receiveExtend(uint32_t n) {
+		if(!n)
+			return 0;
+		const uint32_t value = getBits(n);
+		return value < (1u << (n - 1)) ? int(value) - int(1u << n) + 1 : int(value);
+	}
+
+	int JpegDecoder::decodeHuffman(const HuffmanTable& table) {
+		fill();
+		uint32_t index = table.fast[buffer >> (32 - HuffmanTable::fastBits)];
+		if(index != HuffmanTable::notFast) {
+			consume(table.sizes[index]);
+			return table.values[index];
+		}
+
+		const uint32_t top = buffer >> 16;
+		uint32_t length = HuffmanTable::fastBits + 1;
+		while(top >= table.maxCode[length])
+			if(++length > 16)
+				return -1;
+
+		index = static_cast<uint32_t>(int32_t(buffer >> (32 - length)) + table.indexOffset[length]);
+		if(index >= table.count)
+			return -1;
+		consume(length);
+		return table.values[index];
+	}
+
+	void JpegDecoder::skipToRestart() {
+		resetBits();
+		while(position + 1 < size) {
+			if(data[position] == 0xFF && data[position + 1] >= 0xD0 && data[position + 1] <= 0xD7) {
+				position += 2;
+				return;
+			}
+			// Some other marker, the scan was cut short. What is left of it decodes as zeros.
+			if(data[position] == 0xFF && data[position + 1] != 0 && data[position + 1] != 0xFF) {
+				atMarker = true;
+				return;
+			}
+			++position;
+		}
+	}
+
+	void JpegDecoder::skipToMarker() {
+		while(position + 1 < size) {
+			if(data[position] == 0xFF && data[position + 1] != 0 && (data[position + 1] < 0xD0 || data[position + 1] > 0xD7))
+				return;
+			++position;
+		}
+		position = size;
+	}
+
+	bool JpegDecoder::readFrame(const uint8_t* segment, uint32_t length, bool isProgressive) {
+		if(hasFrame || length < 6 || segment[0] != 8)
+			return false;
+		height = readU16BigEndian(segment + 1);
+		width = readU16BigEndian(segment + 3);
+		const uint32_t componentCount = segment[5];
+		// No DNL marker support, CMYK and other component counts aren't colours this can show.
+		if(!width || !height || width > maxDimension || height > maxDimension || (componentCount != 1 && componentCount != 3) ||
+		   length < 6 + componentCount * 3)
+			return false;
+
+		components.resize(componentCount);
+		for(uint32_t i = 0; i < componentCount; ++i) {
+			auto& component = components[i];
+			component.id = segment[6 + i * 3];
+			component.h = segment[7 + i * 3] >> 4;
+			component.v = segment[7 + i * 3] & 15;
+			component.quantTable = segment[8 + i * 3];
+			if(component.h < 1 || component.h > 4 || component.v < 1 || component.v > 4 || component.quantTable > 3)
+				return false;
+			maxH = std::max(maxH, component.h);
+			maxV = std::max(maxV, component.v);
+		}
+
+		mcusWide = (width + maxH * 8 - 1) / (maxH * 8);
+		mcusHigh = (height + maxV * 8 - 1) / (maxV * 8);
+		for(auto& component: components) {
+			component.blocksWide = mcusWide * component.h;
+			component.blocksHigh = mcusHigh * component.v;
+			component.width = (width * component.h + maxH - 1) / maxH;
+			component.height = (height * component.v + maxV - 1) / maxV;
+			component.usedBlocksWide = (component.width + 7) / 8;
+			component.usedBlocksHigh = (component.height + 7) / 8;
+			component.coefficients.assign(size_t(component.blocksWide) * component.blocksHigh * 64, 0);
+		}
+
+		progressive = isProgressive;
+		hasFrame = true;
+		return true;
+	}
+
+	bool JpegDecoder::readQuantisationTables(const uint8_t* segment, uint32_t length) {
+		for(uint32_t offset = 0; offset < length;) {
+			const uint32_t precision = segment[offset] >> 4;
+			const uint32_t table = segment[offset] & 15;
+			const uint32_t tableSize = precision ? 128 : 64;
+			if(precision > 1 || table > 3 || length - offset - 1 < tableSize)
+				return false;
+
+			const uint8_t* values = segment + offset + 1;
+			for(uint32_t i = 0; i < 64; ++i)
+				quantisation[table][zigzag[i]] = static_cast<uint16_t>(precision ? readU16BigEndian(values + i * 2) : values[i]);
+			offset += 1 + tableSize;
+		}
+		return true;
+	}
+
+	bool JpegDecoder::readHuffmanTables(const uint8_t* segment, uint32_t length) {
+		for(uint32_t offset = 0; offset < length;) {
+			if(length - offset < 17)
+				return false;
+			const uint32_t tableClass = segment[offset] >> 4;
+			const uint32_t table = segment[offset] & 15;
+			const uint8_t* counts = segment + offset + 1;
+
+			uint32_t total = 0;
+			for(uint32_t i = 0; i < 16; ++i)
+				total += counts[i];
+			if(tableClass > 1 || table > 3 || total > 256 || length - offset - 17 < total)
+				return false;
+
+			if(!(tableClass ? acTables : dcTables)[table].build(counts, segment + offset + 17))
+				return false;
+			offset += 17 + total;
+		}
+		return true;
+	}
+
+	bool JpegDecoder::readScan(const uint8_t* segment, uint32_t length) {
+		if(!hasFrame || length < 1)
+			return false;
+		scanComponentCount = segment[0];
+		if(!scanComponentCount || scanComponentCount > components.size() || length != 4 + scanComponentCount * 2)
+			return false;
+
+		for(uint32_t i = 0; i < scanComponentCount; ++i) {
+			const uint32_t id = segment[1 + i * 2];
+			const auto component = std::find_if(components.begin(), components.end(), [id](const Component& c) { return c.id == id; });
+			if(component == components.end())
+				return false;
+			component->dcTable = segment[2 + i * 2] >> 4;
+			component->acTable = segment[2 + i * 2] & 15;
+			if(component->dcTable > 3 || component->acTable > 3)
+				return false;
+			scanComponents[i] = &*component;
+		}
+
+		const uint8_t* parameters = segment + 1 + scanComponentCount * 2;
+		spectralStart = parameters[0];
+		spectralEnd = parameters[1];
+		approximationHigh = parameters[2] >> 4;
+		approximationLow = parameters[2] & 15;
+
+		if(progressive) {
+			// DC and AC are in separate scans, AC ones have a single component.
+			if(spectralStart > spectralEnd || spectralEnd > 63 || (spectralStart == 0 && spectralEnd != 0) ||
+			   (spectralStart > 0 && scanComponentCount != 1) || approximationLow > 13)
+				return false;
+		} else {
+			spectralStart = 0;
+			spectralEnd = 63;
+			approximationHigh = approximationLow = 0;
+		}
+
+		for(uint32_t i = 0; i < scanComponentCount; ++i) {
+			const bool needsDc = spectralStart == 0 && approximationHigh == 0;
+			const bool needsAc = spectralEnd > 0;
+			if((needsDc && !dcTables[scanComponents[i]->dcTable].present) || (needsAc && !acTables[scanComponents[i]->acTable].present))
+				return false;
+		}
+
+		return decodeScan();
+	}
+
+	bool JpegDecoder::decodeBlock(Component& component, int16_t* block) {
+		if(!decodeDcFirst(component, block))
+			return false;
+
+		const auto& table = acTables[component.acTable];
+		for(uint32_t k = 1; k < 64;) {
+			const int symbol = decodeHuffman(table);
+			if(symbol < 0)
+				return false;
+
+			const uint32_t run = uint32_t(symbol) >> 4;
+			const uint32_t bits = uint32_t(symbol) & 15;
+			if(!bits) {
+				if(run != 15)
+					break;
+				k += 16;
+				continue;
+			}
+
+			k += run;
+			if(k > 63)
+				return false;
+			block[zigzag[k++]] = static_cast<int16_t>(receiveExtend(bits));
+		}
+		return true;
+	}
+
+	bool JpegDecoder::decodeDcFirst(Component& component, int16_t* block) {
+		const int bits = decodeHuffman(dcTables[component.dcTable]);
+		if(bits < 0 || bits > 15)
+			return false;
+		component.dcPrediction += receiveExtend(static_cast<uint32_t>(bits));
+		block[0] = static_cast<int16_t>(component.dcPrediction * (1 << approximationLow));
+		return true;
+	}
+
+	void JpegDecoder::decodeDcRefinement(int16_t* block) {
+		if(getBits(1))
+			block[0] = static_cast<int16_t>(block[0] | (1 << approximationLow));
+	}
+
+	bool JpegDecoder::decodeAcFirst(Component& component, int16_t* block) {
+		if(endOfBandRun) {
+			--endOfBandRun;
+			return true;
+		}
+
+		const auto& table = acTables[component.acTable];
+		for(uint32_t k = spectralStart; k <= spectralEnd;) {
+			const int symbol = decodeHuffman(table);
+			if(symbol < 0)
+				return false;
+
+			const uint32_t run = uint32_t(symbol) >> 4;
+			const uint32_t bits = uint32_t(symbol) & 15;
+			if(!bits) {
+				if(run < 15) {
+					endOfBandRun = (1u << run) - 1 + getBits(run);
+					break;
+				}
+				k += 16;
+				continue;
+			}
+
+			k += run;
+			if(k > spectralEnd)
+				return false;
+			block[zigzag[k++]] = static_cast<int16_t>(receiveExtend(bits) * (1 << approximationLow));
+		}
+		return true;
+	}
+
+	bool JpegDecoder::decodeAcRefinement(Component& component, int16_t* block) {
+		const int bit = 1 << approximationLow;
+		// Coefficients that are already non-zero get a correction bit each, new ones come with a run of zeros.
+		auto refine = [&](int16_t& coefficient) {
+			if(getBits(1) && !(coefficient & bit))
+				coefficient = static_cast<int16_t>(coefficient + (coefficient > 0 ? bit : -bit));
+		};
+
+		uint32_t k = spectralStart;
+		if(!endOfBandRun) {
+			const auto& table = acTables[component.acTable];
+			for(; k <= spectralEnd;) {
+				const int symbol = decodeHuffman(table);
+				if(symbol < 0)
+					return false;
+
+				uint32_t run = uint32_t(symbol) >> 4;
+				const uint32_t bits = uint32_t(symbol) & 15;
+				int value = 0;
+				if(!bits) {
+					if(run < 15) {
+						endOfBandRun = (1u << run) + getBits(run);
+						break;
+					}
+				} else {
+					if(bits != 1)
+						return false;
+					value = getBits(1) ? bit : -bit;
+				}
+
+				for(; k <= spectralEnd; ++k) {
+					auto& coefficient = block[zigzag[k]];
+					if(coefficient) {
+						refine(coefficient);
+					} else if(run) {
+						--run;
+					} else {
+						coefficient = static_cast<int16_t>(value);
+						++k;
+						break;
+					}
+				}
+			}
+
+			if(!endOfBandRun)
+				return true;
+		}
+
+		// The rest of the band is in an end of band run.
+		for(; k <= spectralEnd; ++k)
+			if(block[zigzag[k]])
+				refine(block[zigzag[k]]);
+		--endOfBandRun;
+		return true;
+	}
+
+	bool JpegDecoder::decodeBlockOfScan(Component& component, int16_t* block) {
+		if(!progressive)
+			return decodeBlock(component, block);
+		if(spectralStart == 0) {
+			if(approximationHigh)
+				decodeDcRefinement(block);
+			else if(!decodeDcFirst(component, block))
+				return false;
+			return true;
+		}
+		return approximationHigh ? decodeAcRefinement(component, block) : decodeAcFirst(component, block);
+	}
+
+	bool JpegDecoder::decodeScan() {
+		resetBits();
+		endOfBandRun = 0;
+		for(uint32_t i = 0; i < scanComponentCount; ++i)
+			scanComponents[i]->dcPrediction = 0;
+
+		// A scan of a single component codes its blocks in order, one per MCU, without the padding of the others.
+		const bool interleaved = scanComponentCount > 1;
+		const uint32_t unitsWide = interleaved ? mcusWide : scanComponents[0]->usedBlocksWide;
+		const uint32_t unitsHigh = interleaved ? mcusHigh : scanComponents[0]->usedBlocksHigh;
+
+		uint32_t restartsLeft = restartInterval;
+		for(uint32_t y = 0; y < unitsHigh; ++y) {
+			for(uint32_t x = 0; x < unitsWide; ++x) {
+				if(interleaved) {
+					for(uint32_t i = 0; i < scanComponentCount; ++i) {
+						auto& component = *scanComponents[i];
+						for(uint32_t v = 0; v < component.v; ++v)
+							for(uint32_t h = 0; h < component.h; ++h) {
+								const size_t block = size_t(y * component.v + v) * component.blocksWide + x * component.h + h;
+								if(!decodeBlockOfScan(component, &component.coefficients[block * 64]))
+									return false;
+							}
+					}
+				} else {
+					auto& component = *scanComponents[0];
+					if(!decodeBlockOfScan(component, &component.coefficients[(size_t(y) * component.blocksWide + x) * 64]))
+						return false;
+				}
+
+				if(restartInterval && --restartsLeft == 0) {
+					skipToRestart();
+					restartsLeft = restartInterval;
+					endOfBandRun = 0;
+					for(uint32_t i = 0; i < scanComponentCount; ++i)
+						scanComponents[i]->dcPrediction = 0;
+				}
+			}
+		}
+
+		// Back to byte boundaries: whatever the bit reader prefetched was part of the scan.
+		resetBits();
+		skipToMarker();
+		++scanCount;
+		return true;
+	}
+
+	// Dequantises and transforms every block into 8 bit samples, with the float AAN inverse DCT.
+	void JpegDecoder::inverseTransform(Component& component) const {
+		static const float aanScale[8] = {1.0f, 1.387039845f, 1.306562965f, 1.175875602f, 1.0f, 0.785694958f, 0.541196100f, 0.275899379f};
+		float scale[64];
+		for(uint32_t i = 0; i < 64; ++i)
+			scale[i] = quantisation[component.quantTable][i] * aanScale[i / 8] * aanScale[i % 8] / 8;
+
+		const size_t stride = size_t(component.blocksWide) * 8;
+		component.samples.resize(stride * component.blocksHigh * 8);
+
+		for(uint32_t by = 0; by < component.blocksHigh; ++by) {
+			for(uint32_t bx = 0; bx < component.blocksWide; ++bx) {
+				const int16_t* block = &component.coefficients[(size_t(by) * component.blocksWide + bx) * 64];
+				uint8_t* output = &component.samples[size_t(by) * 8 * stride + bx * 8];
+				float workspace[64];
+
+				for(uint32_t c = 0; c < 8; ++c) {
+					const int16_t* in = block + c;
+					const float* q = scale + c;
+					float* w = workspace + c;
+					if(!in[8] && !in[16] && !in[24] && !in[32] && !in[40] && !in[48] && !in[56]) {
+						const float dc = in[0] * q[0];
+						for(uint32_t r = 0; r < 8; ++r)
+							w[r * 8] = dc;
+						continue;
+					}
+
+					float tmp0 = in[0] * q[0], tmp1 = in[16] * q[16], tmp2 = in[32] * q[32], tmp3 = in[48] * q[48];
+					float tmp10 = tmp0 + tmp2, tmp11 = tmp0 - tmp2;
+					float tmp13 = tmp1 + tmp3, tmp12 = (tmp1 - tmp3) * 1.414213562f - tmp13;
+					tmp0 = tmp10 + tmp13; tmp3 = tmp10 - tmp13; tmp1 = tmp11 + tmp12; tmp2 = tmp11 - tmp12;
+
+					float tmp4 = in[8] * q[8], tmp5 = in[24] * q[24], tmp6 = in[40] * q[40], tmp7 = in[56] * q[56];
+					const float z13 = tmp6 + tmp5, z10 = tmp6 - tmp5, z11 = tmp4 + tmp7, z12 = tmp4 - tmp7;
+					tmp7 = z11 + z13;
+					tmp11 = (z11 - z13) * 1.414213562f;
+					const float z5 = (z10 + z12) * 1.847759065f;
+					tmp10 = 1.082392200f * z12 - z5;
+					tmp12 = -2.613125930f * z10 + z5;
+					tmp6 = tmp12 - tmp7; tmp5 = tmp11 - tmp6; tmp4 = tmp10 + tmp5;
+
+					w[0] = tmp0 + tmp7; w[56] = tmp0 - tmp7; w[8] = tmp1 + tmp6; w[48] = tmp1 - tmp6;
+					w[16] = tmp2 + tmp5; w[40] = tmp2 - tmp5; w[32] = tmp3 + tmp4; w[24] = tmp3 - tmp4;
+				}
+
+				for(uint32_t r = 0; r < 8; ++r) {
+					const float* w = workspace + r * 8;
+					uint8_t* row = output + r * stride;
+
+					float tmp10 = w[0] + w[4], tmp11 = w[0] - w[4];
+					float tmp13 = w[2] + w[6], tmp12 = (w[2] - w[6]) * 1.414213562f - tmp13;
+					const float tmp0 = tmp10 + tmp13, tmp3 = tmp10 - tmp13, tmp1 = tmp11 + tmp12, tmp2 = tmp11 - tmp12;
+
+					const float z13 = w[5] + w[3], z10 = w[5] - w[3], z11 = w[1] + w[7], z12 = w[1] - w[7];
+					const float tmp7 = z11 + z13;
+					tmp11 = (z11 - z13) * 1.414213562f;
+					const float z5 = (z10 + z12) * 1.847759065f;
+					tmp10 = 1.082392200f * z12 - z5;
+					tmp12 = -2.613125930f * z10 + z5;
+					const float tmp6 = tmp12 - tmp7, tmp5 = tmp11 - tmp6, tmp4 = tmp10 + tmp5;
+
+					const float values[8] = {tmp0 + tmp7, tmp1 + tmp6, tmp2 + tmp5, tmp3 - tmp4, tmp3 + tmp4, tmp2 - tmp5, tmp1 - tmp6, tmp0 - tmp7};
+					for(uint32_t i = 0; i < 8; ++i)
+						row[i] = clampToByte(static_cast<int>(values[i] + 128.5f));
+				}
+			}
+		}
+	}
+
+	// Upsamples subsampled components with a triangle filter, like libjpeg's fancy upsampling, and converts to RGB.
+	void JpegDecoder::writeRgba(uint8_t* output) const {
+		// Per output column and row of each component: the two samples to blend and the weight of the second, of 256.
+		struct Tap
+		{
+			uint32_t first, second, weight;
+		};
+		auto getTaps = [](uint32_t outputSize, uint32_t factor, uint32_t maxFactor, uint32_t componentSize) {
+			std::vector<Tap> taps(outputSize);
+			for(uint32_t i = 0; i < outputSize; ++i) {
+				const float position = std::max((i + 0.5f) * factor / maxFactor - 0.5f, 0.0f);
+				const auto first = static_cast<uint32_t>(position);
+				if(first + 1 >= componentSize)
+					taps[i] = {componentSize - 1, componentSize - 1, 0};
+				else
+					taps[i] = {first, first + 1, static_cast<uint32_t>((position - first) * 256 + 0.5f)};
+			}
+			return taps;
+		};
+
+		std::vector<uint8_t> planes[3];
+		const uint8_t* rows[3];
+		size_t strides[3];
+		for(size_t c = 0; c < components.size(); ++c) {
+			const auto& component = components[c];
+			strides[c] = size_t(component.blocksWide) * 8;
+			rows[c] = component.samples.data();
+			if(component.h == maxH && component.v == maxV)
+				continue;
+
+			const auto columns = getTaps(width, component.h, maxH, component.width);
+			const auto lines = getTaps(height, component.v, maxV, component.height);
+			planes[c].resize(size_t(width) * height);
+			for(uint32_t y = 0; y < height; ++y) {
+				const uint8_t* above = &component.samples[lines[y].first * strides[c]];
+				const uint8_t* below = &component.samples[lines[y].second * strides[c]];
+				const uint32_t wy = lines[y].weight;
+				uint8_t* target = &planes[c][size_t(y) * width];
+				for(uint32_t x = 0; x < width; ++x) {
+					const auto& tap = columns[x];
+					const uint32_t top = above[tap.first] * (256 - tap.weight) + above[tap.second] * tap.weight;
+					const uint32_t bottom = below[tap.first] * (256 - tap.weight) + below[tap.second] * tap.weight;
+					target[x] = static_cast<uint8_t>((top * (256 - wy) + bottom * wy + 32768) >> 16);
+				}
+			}
+			rows[c] = planes[c].data();
+			strides[c] = width;
+		}
+
+		// Three components are YCbCr unless an Adobe segment or the component ids say they're RGB.
+		const bool rgb = components.size() == 3 &&
+			(adobeTransform == 0 || (adobeTransform < 0 && components[0].id == 'R' && components[1].id == 'G' && components[2].id == 'B'));
+
+		for(uint32_t y = 0; y < height; ++y) {
+			uint8_t* pixel = output + size_t(y) * width * 4;
+			for(uint32_t x = 0; x < width; ++x, pixel += 4) {
+				const int luma = rows[0][y * strides[0] + x];
+				if(components.size() == 1) {
+					pixel[0] = pixel[1] = pixel[2] = static_cast<uint8_t>(luma);
+				} else if(rgb) {
+					pixel[0] = static_cast<uint8_t>(luma);
+					pixel[1] = rows[1][y * strides[1] + x];
+					pixel[2] = rows[2][y * strides[2] + x];
+				} else {
+					const int cb = rows[1][y * strides[1] + x] - 128;
+					const int cr = rows[2][y * strides[2] + x] - 128;
+					// 1.402, 0.344136, 0.714136 and 1.772 in 16.16 fixed point.
+					const int base = luma * 65536 + 32768;
+					pixel[0] = clampToByte((base + 91881 * cr) >> 16);
+					pixel[1] = clampToByte((base - 22554 * cb - 46802 * cr) >> 16);
+					pixel[2] = clampToByte((base + 116130 * cb) >> 16);
+				}
+				pixel[3] = 255;
+			}
+		}
+	}
+
+	bool JpegDecoder::decode(DecodedImage& image) {
+		if(size < 4 || data[0] != 0xFF || data[1] != 0xD8)
+			return false;
+
+		position = 2;
+		for(;;) {
+			// Tolerates garbage and fill bytes between segments.
+			while(position < size && data[position] != 0xFF)
+				++position;
+			while(position < size && data[position] == 0xFF)
+				++position;
+			if(position >= size)
+				break;
+
+			const uint8_t marker = data[position++];
+			if(marker == 0xD9)
+				break;
+			if((marker >= 0xD0 && marker <= 0xD7) || marker == 0x01)
+				continue;
+
+			if(size - position < 2)
+				return false;
+			const uint32_t length = readU16BigEndian(data + position);
+			if(length < 2 || size - position < length)
+				return false;
+			const uint8_t* segment = data + position + 2;
+			const uint32_t segmentLength = length - 2;
+			position += length;
+
+			switch(marker)
+			{
+				case 0xC0:
+				case 0xC1:
+					if(!readFrame(segment, segmentLength, false))
+						return false;
+					break;
+				case 0xC2:
+					if(!readFrame(segment, segmentLength, true))
+						return false;
+					break;
+				case 0xC3: case 0xC5: case 0xC6: case 0xC7:
+				case 0xC9: case 0xCA: case 0xCB:
+				case 0xCD: case 0xCE: case 0xCF:
+					// Lossless, hierarchical or arithmetic coded.
+					return false;
+				case 0xC4:
+					if(!readHuffmanTables(segment, segmentLength))
+						return false;
+					break;
+				case 0xDB:
+					if(!readQuantisationTables(segment, segmentLength))
+						return false;
+					break;
+				case 0xDD:
+					if(segmentLength < 2)
+						return false;
+					restartInterval = readU16BigEndian(segment);
+					break;
+				case 0xDA:
+					if(!readScan(segment, segmentLength))
+						return false;
+					break;
+				case 0xEE:
+					if(segmentLength >= 12 && !std::memcmp(segment, "Adobe", 5))
+						adobeTransform = segment[11];
+					break;
+				default:
+					break;
+			}
+		}
+
+		// Files cut short still show what they have.
+		if(!hasFrame || !scanCount)
+			return false;
+
+		for(auto& component: components)
+			inverseTransform(component);
+
+		auto& descriptor = image.descriptor;
+		descriptor = TextureDescriptor();
+		descriptor.width = width;
+		descriptor.height = height;
+		descriptor.depth = 1;
+		descriptor.layout = ChannelLayout::RGBA;
+		descriptor.dataType = DataType::UNSIGNED_BYTE;
+
+		image.firstMip = 0;
+		image.mips.clear();
+		image.mips.emplace_back(size_t(width) * height * 4);
+		writeRgba(image.mips[0].data());
+		return true;
+	}
+}
+
+bool decodeJpeg(const uint8_t* data, size_t size, uint32_t, DecodedImage& image)
+{
+	// Headers of a few bytes can ask for gigabytes of coefficients.
+	try {
+		JpegDecoder decoder(data, size);
+		return decoder.decode(image);
+	} catch(const std::bad_alloc&) {
+		return false;
+	}
+}
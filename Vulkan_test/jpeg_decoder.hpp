@@ -0,0 +1,19 @@
+//
+//  jpeg_decoder.hpp
+//  Vulkan_test
+//
+//  Created by Danny on 17/10/2026.
+//  Copyright © 2026 Danny. All rights reserved.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+struct DecodedImage;
+
+// An ImageDecoder for baseline and progressive JPEG files with Huffman coding, greyscale or YCbCr with any
+// chroma subsampling. The top level comes out as 8 bit RGBA. Arithmetic coding, 12 bit samples, lossless and
+// CMYK files are rejected.
+bool decodeJpeg(const uint8_t* data, size_t size, uint32_t maxSize, DecodedImage&);
@@ -0,0 +1,247 @@
+//
+//  json_tokenizer.cpp
+//  Vulkan_test
+//
+//  Created by Danny on 17/10/2026.
+//  Copyright © 2026 Danny. All rights reserved.
+//
+
+#include "json_tokenizer.hpp"
+
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+	struct Scope
+	{
+		uint32_t token;
+		JsonType type;
+		bool expectingKey;
+	};
+
+	const uint32_t maximumDepth = 128;
+
+	bool isDelimiter(char c) {
+		return c == ',' || c == ']' || c == '}' || c == ' ' || c == '\t' || c == '\n' || c == '\r';
+	}
+
+	void appendUtf8(std::string& out, uint32_t codePoint) {
+		if(codePoint < 0x80) {
+			out += static_cast<char>(codePoint);
+		} else if(codePoint < 0x800) {
+			out += static_cast<char>(0xC0 | (codePoint >> 6));
+			out += static_cast<char>(0x80 | (codePoint & 0x3F));
+		} else {
+			out += static_cast<char>(0xE0 | (codePoint >> 12));
+			out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+			out += static_cast<char>(0x80 | (codePoint & 0x3F));
+		}
+	}
+}
+
+int64_t tokenizeJson(const char* json, size_t length, JsonToken* tokens, size_t capacity)
+{
+	Scope stack[maximumDepth];
+	uint32_t depth = 0;
+	size_t count = 0;
+
+	// Registers a new token with its parent and returns its index.
+	auto add = [&](JsonType type, size_t start, size_t end) -> int64_t {
+		if(depth > 0) {
+			auto& parent = stack[depth - 1];
+			const bool isKey = parent.type == JsonType::OBJECT && parent.expectingKey;
+			if(parent.type == JsonType::OBJECT && isKey && type != JsonType::STRING)
+				return -1;
+
+			if(parent.type == JsonType::ARRAY || isKey) {
+				if(tokens)
+					tokens[parent.token].size++;
+			}
+
+			if(isKey)
+				parent.expectingKey = false;
+		}
+
+		if(tokens) {
+			if(count >= capacity)
+				return -1;
+
+			auto& token = tokens[count];
+			token.type = type;
+			token.start = static_cast<uint32_t>(start);
+			token.end = static_cast<uint32_t>(end);
+			token.size = 0;
+			token.next = static_cast<uint32_t>(count + 1);
+		}
+
+		return static_cast<int64_t>(count++);
+	};
+
+	for(size_t pos = 0; pos < length; ++pos) {
+		const char c = json[pos];
+		switch(c)
+		{
+			case '{':
+			case '[':
+			{
+				if(depth == maximumDepth)
+					return -1;
+
+				const auto type = c == '{' ? JsonType::OBJECT : JsonType::ARRAY;
+				const auto index = add(type, pos, pos);
+				if(index < 0)
+					return -1;
+
+				stack[depth++] = {static_cast<uint32_t>(index), type, type == JsonType::OBJECT};
+				break;
+			}
+
+			case '}':
+			case ']':
+			{
+				const auto type = c == '}' ? JsonType::OBJECT : JsonType::ARRAY;
+				if(depth == 0 || stack[depth - 1].type != type)
+					return -1;
+
+				const auto& scope = stack[--depth];
+				if(tokens) {
+					tokens[scope.token].end = static_cast<uint32_t>(pos + 1);
+					tokens[scope.token].next = static_cast<uint32_t>(count);
+				}
+				break;
+			}
+
+			case '"':
+			{
+				const size_t start = pos + 1;
+				size_t end = start;
+				while(end < length && json[end] != '"') {
+					if(json[end] == '\\')
+						end++;
+					end++;
+				}
+
+				if(end >= length)
+					return -1;
+
+				if(add(JsonType::STRING, start, end) < 0)
+					return -1;
+
+				pos = end;
+				break;
+			}
+
+			case ',':
+				if(depth > 0 && stack[depth - 1].type == JsonType::OBJECT)
+					stack[depth - 1].expectingKey = true;
+				break;
+
+			case ':':
+			case ' ':
+			case '\t':
+			case '\n':
+			case '\r':
+				break;
+
+			default:
+			{
+				if(!(c == '-' || (c >= '0' && c <= '9') || c == 't' || c == 'f' || c == 'n'))
+					return -1;
+
+				size_t end = pos;
+				while(end < length && !isDelimiter(json[end]))
+					end++;
+
+				if(add(JsonType::PRIMITIVE, pos, end) < 0)
+					return -1;
+
+				pos = end - 1;
+				break;
+			}
+		}
+	}
+
+	if(depth != 0)
+		return -1;
+
+	return static_cast<int64_t>(count);
+}
+
+bool JsonView::equals(uint32_t token, const char* text) const {
+	const auto& t = tokens[token];
+	const size_t length = t.end - t.start;
+	return std::strlen(text) == length && std::memcmp(json + t.start, text, length) == 0;
+}
+
+int64_t JsonView::find(uint32_t object, const char* key) const {
+	if(tokens[object].type != JsonType::OBJECT)
+		return -1;
+
+	uint32_t k = object + 1;
+	for(uint32_t i = 0; i < tokens[object].size; ++i) {
+		if(equals(k, key))
+			return k + 1;
+
+		k = tokens[k + 1].next;
+	}
+
+	return -1;
+}
+
+int64_t JsonView::toInt(uint32_t token) const {
+	// Numbers are always followed by a delimiter, so strtoll stops inside the document.
+	return std::strtoll(json + tokens[token].start, nullptr, 10);
+}
+
+double JsonView::toDouble(uint32_t token) const {
+	return std::strtod(json + tokens[token].start, nullptr);
+}
+
+bool JsonView::toBool(uint32_t token) const {
+	return json[tokens[token].start] == 't';
+}
+
+std::string JsonView::toString(uint32_t token) const {
+	const auto& t = tokens[token];
+	std::string result;
+	result.reserve(t.end - t.start);
+
+	for(uint32_t i = t.start; i < t.end; ++i) {
+		const char c = json[i];
+		if(c != '\\' || i + 1 >= t.end) {
+			result += c;
+			continue;
+		}
+
+		const char e = json[++i];
+		switch(e)
+		{
+			case 'n': result += '\n'; break;
+			case 't': result += '\t'; break;
+			case 'r': result += '\r'; break;
+			case 'b': result += '\b'; break;
+			case 'f': result += '\f'; break;
+			case 'u':
+			{
+				if(i + 4 >= t.end)
+					return result;
+
+				const std::string hex(json + i + 1, 4);
+				appendUtf8(result, static_cast<uint32_t>(std::strtoul(hex.c_str(), nullptr, 16)));
+				i += 4;
+				break;
+			}
+			default: result += e; break;
+		}
+	}
+
+	return result;
+}
+
+std::string JsonView::getSource(uint32_t token) const {
+	const auto& t = tokens[token];
+	if(t.type == JsonType::STRING)
+		return std::string(json + t.start - 1, t.end - t.start + 2);
+	return std::string(json + t.start, t.end - t.start);
+}
@@ -0,0 +1,87 @@
+//
+//  json_tokenizer.hpp
+//  Vulkan_test
+//
+//  Created by Danny on 17/10/2026.
+//  Copyright © 2026 Danny. All rights reserved.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+enum class JsonType : uint8_t
+{
+	OBJECT,
+	ARRAY,
+	STRING,
+	// Numbers, true, false and null.
+	PRIMITIVE
+};
+
+// A token refers to a range of the source text, nothing is copied. Strings exclude their quotes.
+struct JsonToken
+{
+	JsonType type;
+	uint32_t start 	= 0;
+	uint32_t end 	= 0;
+	// Number of elements of an array, or key/value pairs of an object.
+	uint32_t size 	= 0;
+	// Index of the first token after this one and all of its children.
+	uint32_t next 	= 0;
+};
+
+// Tokenizes json into a caller provided array and never allocates. Returns the number of tokens,
+// or -1 if the text is malformed or there are more tokens than capacity. With tokens == nullptr the
+// tokens are only counted, so callers can size the array exactly with a first pass.
+int64_t tokenizeJson(const char* json, size_t length, JsonToken* tokens, size_t capacity);
+
+// Read only access to tokenized json.
+class JsonView {
+public:
+	JsonView(const char* json, const JsonToken* tokens, size_t count) : json(json), tokens(tokens), count(count) {}
+
+	const JsonToken& operator[](uint32_t index) const { return tokens[index]; }
+	size_t size() const { return count; }
+
+	bool equals(uint32_t token, const char* text) const;
+
+	// Index of the value for key in an object, or -1 if it is absent.
+	int64_t find(uint32_t object, const char* key) const;
+
+	int64_t toInt(uint32_t token) const;
+	double toDouble(uint32_t token) const;
+	bool toBool(uint32_t token) const;
+	// Unescapes the string token.
+	std::string toString(uint32_t token) const;
+	// The token's json as written, strings with their quotes.
+	std::string getSource(uint32_t token) const;
+
+	// Calls f(valueIndex) for every element of an array.
+	template<typename F>
+	void forEach(uint32_t array, F f) const {
+		uint32_t element = array + 1;
+		for(uint32_t i = 0; i < tokens[array].size; ++i) {
+			f(element);
+			element = tokens[element].next;
+		}
+	}
+
+	// Calls f(keyIndex, valueIndex) for every key/value pair of an object.
+	template<typename F>
+	void forEachMember(uint32_t object, F f) const {
+		uint32_t key = object + 1;
+		for(uint32_t i = 0; i < tokens[object].size; ++i) {
+			f(key, key + 1);
+			key = tokens[key + 1].next;
+		}
+	}
+
+private:
+
+	const char* json;
+	const JsonToken* tokens;
+	size_t count;
+};
@@ -0,0 +1,184 @@
+//
+//  ktx2_loader.cpp
+//  Vulkan_test
+//
+//  Created by Danny on 17/10/2026.
+//  Copyright © 2026 Danny. All rights reserved.
+//
+
+#include "ktx2_loader.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include <zstd.h>
+
+#include "png_decoder.hpp"
+#include "texture_streamer.hpp"
+#include "vulkan_resources.hpp"
+
+namespace {
+
+	const uint8_t ktx2Identifier[12] = {0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n'};
+
+	// The level index follows the fixed size part of the header.
+	const size_t levelIndexOffset = 80;
+	const size_t levelIndexEntrySize = 24;
+
+	uint32_t readU32(const uint8_t* data) {
+		return uint32_t(data[0]) | uint32_t(data[1]) << 8 | uint32_t(data[2]) << 16 | uint32_t(data[3]) << 24;
+	}
+
+	uint64_t readU64(const uint8_t* data) {
+		return uint64_t(readU32(data)) | uint64_t(readU32(data + 4)) << 32;
+	}
+
+	void setFormat(TextureDescriptor& descriptor, ChannelLayout layout, DataType dataType, BlockCompression compression, bool srgb = false) {
+		descriptor.layout = layout;
+		descriptor.dataType = dataType;
+		descriptor.compression = compression;
+		descriptor.srgb = srgb;
+	}
+
+	uint32_t getMaxDimension(const TextureDescriptor& descriptor, uint32_t mipLevel) {
+		const auto extent = getMipExtent(descriptor, mipLevel);
+		return std::max(extent.width, extent.height);
+	}
+
+	// Each level is supercompressed on its own, so a level can be unpacked without the ones before it.
+	bool readLevel(const uint8_t* data, const Ktx2Level& entry, Ktx2Supercompression supercompression, size_t byteSize, std::vector<uint8_t>& mip) {
+		const auto source = data + entry.offset;
+		switch(supercompression)
+		{
+			case Ktx2Supercompression::NONE:
+				if(entry.size != byteSize)
+					return false;
+				mip.assign(source, source + entry.size);
+				return true;
+
+			case Ktx2Supercompression::ZSTANDARD: {
+				if(entry.uncompressedSize != byteSize)
+					return false;
+				mip.resize(byteSize);
+				const auto written = ZSTD_decompress(mip.data(), mip.size(), source, entry.size);
+				return !ZSTD_isError(written) && written == byteSize;
+			}
+
+			case Ktx2Supercompression::ZLIB:
+				if(entry.uncompressedSize != byteSize)
+					return false;
+				return inflateZlib(source, entry.size, byteSize, mip) && mip.size() == byteSize;
+
+			default:
+				return false;
+		}
+	}
+}
+
+bool readKtx2Header(const uint8_t* data, size_t size, Ktx2Header& header)
+{
+	if(size < levelIndexOffset || std::memcmp(data, ktx2Identifier, sizeof(ktx2Identifier)))
+		return false;
+
+	header.vkFormat = readU32(data + 12);
+	header.width = readU32(data + 20);
+	header.height = readU32(data + 24);
+	header.depth = readU32(data + 28);
+	header.layers = readU32(data + 32);
+	header.faces = readU32(data + 36);
+	header.levelCount = readU32(data + 40);
+
+	const auto supercompression = readU32(data + 44);
+	if(supercompression > static_cast<uint32_t>(Ktx2Supercompression::ZLIB))
+		return false;
+	header.supercompression = static_cast<Ktx2Supercompression>(supercompression);
+
+	const auto levels = std::max(header.levelCount, 1u);
+	if(levels > 32 || size < levelIndexOffset + levels * levelIndexEntrySize)
+		return false;
+
+	for(uint32_t i = 0; i < levels; ++i) {
+		const auto entry = data + levelIndexOffset + i * levelIndexEntrySize;
+		auto& level = header.levels[i];
+		level.offset = readU64(entry);
+		level.size = readU64(entry + 8);
+		level.uncompressedSize = readU64(entry + 16);
+		if(level.offset > size || level.size > size - level.offset)
+			return false;
+	}
+
+	return true;
+}
+
+bool getKtx2Format(uint32_t vkFormat, TextureDescriptor& descriptor)
+{
+	const auto format = static_cast<vk::Format>(vkFormat);
+	switch(format)
+	{
+		case vk::Format::eR8Unorm: setFormat(descriptor, ChannelLayout::R, DataType::UNSIGNED_BYTE, BlockCompression::NONE); break;
+		case vk::Format::eR8G8Unorm: setFormat(descriptor, ChannelLayout::RG, DataType::UNSIGNED_BYTE, BlockCompression::NONE); break;
+		case vk::Format::eR8G8B8Unorm: setFormat(descriptor, ChannelLayout::RGB, DataType::UNSIGNED_BYTE, BlockCompression::NONE); break;
+		case vk::Format::eR8G8B8A8Unorm:
+		case vk::Format::eR8G8B8A8Srgb: setFormat(descriptor, ChannelLayout::RGBA, DataType::UNSIGNED_BYTE, BlockCompression::NONE, format == vk::Format::eR8G8B8A8Srgb); break;
+		case vk::Format::eB8G8R8A8Unorm:
+		case vk::Format::eB8G8R8A8Srgb: setFormat(descriptor, ChannelLayout::BGRA, DataType::UNSIGNED_BYTE, BlockCompression::NONE, format == vk::Format::eB8G8R8A8Srgb); break;
+		case vk::Format::eR16G16B16A16Sfloat: setFormat(descriptor, ChannelLayout::RGBA, DataType::FLOAT_16, BlockCompression::NONE); break;
+		case vk::Format::eR32G32B32A32Sfloat: setFormat(descriptor, ChannelLayout::RGBA, DataType::FLOAT_32, BlockCompression::NONE); break;
+
+		case vk::Format::eBc1RgbUnormBlock:
+		case vk::Format::eBc1RgbSrgbBlock: setFormat(descriptor, ChannelLayout::RGB, DataType::UNSIGNED_BYTE, BlockCompression::BC1, format == vk::Format::eBc1RgbSrgbBlock); break;
+		case vk::Format::eBc1RgbaUnormBlock:
+		case vk::Format::eBc1RgbaSrgbBlock: setFormat(descriptor, ChannelLayout::RGBA, DataType::UNSIGNED_BYTE, BlockCompression::BC1, format == vk::Format::eBc1RgbaSrgbBlock); break;
+		case vk::Format::eBc3UnormBlock:
+		case vk::Format::eBc3SrgbBlock: setFormat(descriptor, ChannelLayout::RGBA, DataType::UNSIGNED_BYTE, BlockCompression::BC3, format == vk::Format::eBc3SrgbBlock); break;
+		case vk::Format::eBc4UnormBlock: setFormat(descriptor, ChannelLayout::R, DataType::UNSIGNED_BYTE, BlockCompression::BC4); break;
+		case vk::Format::eBc5UnormBlock: setFormat(descriptor, ChannelLayout::RG, DataType::UNSIGNED_BYTE, BlockCompression::BC5); break;
+		case vk::Format::eBc7UnormBlock:
+		case vk::Format::eBc7SrgbBlock: setFormat(descriptor, ChannelLayout::RGBA, DataType::UNSIGNED_BYTE, BlockCompression::BC7, format == vk::Format::eBc7SrgbBlock); break;
+		case vk::Format::eEtc2R8G8B8UnormBlock:
+		case vk::Format::eEtc2R8G8B8SrgbBlock: setFormat(descriptor, ChannelLayout::RGB, DataType::UNSIGNED_BYTE, BlockCompression::ETC2_RGB, format == vk::Format::eEtc2R8G8B8SrgbBlock); break;
+		case vk::Format::eEtc2R8G8B8A8UnormBlock:
+		case vk::Format::eEtc2R8G8B8A8SrgbBlock: setFormat(descriptor, ChannelLayout::RGBA, DataType::UNSIGNED_BYTE, BlockCompression::ETC2_RGBA, format == vk::Format::eEtc2R8G8B8A8SrgbBlock); break;
+		case vk::Format::eEacR11UnormBlock: setFormat(descriptor, ChannelLayout::R, DataType::UNSIGNED_BYTE, BlockCompression::EAC_R); break;
+		case vk::Format::eEacR11G11UnormBlock: setFormat(descriptor, ChannelLayout::RG, DataType::UNSIGNED_BYTE, BlockCompression::EAC_RG); break;
+		case vk::Format::eAstc4x4UnormBlock:
+		case vk::Format::eAstc4x4SrgbBlock: setFormat(descriptor, ChannelLayout::RGBA, DataType::UNSIGNED_BYTE, BlockCompression::ASTC_4x4, format == vk::Format::eAstc4x4SrgbBlock); break;
+
+		default: return false;
+	}
+
+	return true;
+}
+
+bool decodeKtx2(const uint8_t* data, size_t size, uint32_t maxSize, DecodedImage& image)
+{
+	Ktx2Header header;
+	if(!readKtx2Header(data, size, header) || header.supercompression == Ktx2Supercompression::BASIS_LZ)
+		return false;
+	if(header.depth > 1 || header.layers > 1 || header.faces != 1)
+		return false;
+
+	auto& descriptor = image.descriptor;
+	if(!getKtx2Format(header.vkFormat, descriptor))
+		return false;
+	descriptor.width = header.width;
+	descriptor.height = std::max(header.height, 1u);
+	descriptor.depth = 1;
+	descriptor.mipLevels = std::max(header.levelCount, 1u);
+	descriptor.type = TextureType::TWO_DIMENSIONAL;
+
+	uint32_t first = 0;
+	while(first + 1 < descriptor.mipLevels && getMaxDimension(descriptor, first) > maxSize)
+		++first;
+
+	image.firstMip = first;
+	image.mips.clear();
+	for(uint32_t level = first; level < descriptor.mipLevels; ++level) {
+		image.mips.emplace_back();
+		if(!readLevel(data, header.levels[level], header.supercompression, getTextureByteSize(descriptor, level), image.mips.back()))
+			return false;
+	}
+
+	return true;
+}
@@ -0,0 +1,59 @@
+//
+//  ktx2_loader.hpp
+//  Vulkan_test
+//
+//  Created by Danny on 17/10/2026.
+//  Copyright © 2026 Danny. All rights reserved.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+#include "resource_descriptors.hpp"
+
+struct DecodedImage;
+
+enum class Ktx2Supercompression
+{
+	NONE,
+	BASIS_LZ,
+	ZSTANDARD,
+	ZLIB
+};
+
+struct Ktx2Level
+{
+	uint64_t offset = 0;
+	uint64_t size = 0;
+	uint64_t uncompressedSize = 0;
+};
+
+struct Ktx2Header
+{
+	uint32_t vkFormat = 0;
+	uint32_t width = 0;
+	uint32_t height = 0;
+	uint32_t depth = 0;
+	uint32_t layers = 0;
+	uint32_t faces = 0;
+	// 0 if the loader should build the mip chain.
+	uint32_t levelCount = 0;
+	Ktx2Supercompression supercompression = Ktx2Supercompression::NONE;
+
+	// Finest level first.
+	Ktx2Level levels[32];
+};
+
+// Reads the header and level index of a KTX2 file. False if it isn't one or the index points outside of it.
+bool readKtx2Header(const uint8_t* data, size_t size, Ktx2Header&);
+
+// Fills the layout, data type and compression of a descriptor for a vkFormat of a KTX2 file. Handles 8 bit and
+// float colour formats and the 4x4 block formats, false for anything else.
+bool getKtx2Format(uint32_t vkFormat, TextureDescriptor&);
+
+// An ImageDecoder for KTX2 files of 2D textures with a single layer and face. Levels supercompressed with zstd or
+// zlib are unpacked, the rest is taken as stored, without transcoding. Basis Universal files (BasisLZ, or UASTC
+// with an undefined vkFormat) are rejected.
+bool decodeKtx2(const uint8_t* data, size_t size, uint32_t maxSize, DecodedImage&);
@@ -17,6 +17,8 @@ int main(int argc, const char * argv[]) {
 	requirements.swapchainSupport = true;
 	requirements.createDepthBuffer = true;
 	requirements.nativeWindowHandle = w.getNativeHandle();
+	// Loaded at startup and written back when the renderer goes away.
+	requirements.pipelineCachePath = "pipeline_cache.bin";
 	
 	VulkanRenderer renderer(requirements);
 	
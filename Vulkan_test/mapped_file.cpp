@@ -0,0 +1,62 @@
+//
+//  mapped_file.cpp
+//  Vulkan_test
+//
+//  Created by Danny on 17/10/2026.
+//  Copyright © 2026 Danny. All rights reserved.
+//
+
+#include "mapped_file.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <utility>
+
+MappedFile::MappedFile(const std::string& path) {
+	const int fd = ::open(path.c_str(), O_RDONLY);
+	if(fd < 0)
+		return;
+
+	struct stat info;
+	if(::fstat(fd, &info) == 0 && info.st_size > 0) {
+		void* result = ::mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+		if(result != MAP_FAILED) {
+			mapping = result;
+			length = static_cast<size_t>(info.st_size);
+		}
+	}
+
+	// The mapping keeps its own reference to the file.
+	::close(fd);
+}
+
+MappedFile::~MappedFile() {
+	close();
+}
+
+MappedFile::MappedFile(MappedFile&& other)
+: mapping(other.mapping), length(other.length) {
+	other.mapping = nullptr;
+	other.length = 0;
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) {
+	if(this != &other) {
+		close();
+		std::swap(mapping, other.mapping);
+		std::swap(length, other.length);
+	}
+
+	return *this;
+}
+
+void MappedFile::close() {
+	if(mapping)
+		::munmap(mapping, length);
+
+	mapping = nullptr;
+	length = 0;
+}
@@ -0,0 +1,41 @@
+//
+//  mapped_file.hpp
+//  Vulkan_test
+//
+//  Created by Danny on 17/10/2026.
+//  Copyright © 2026 Danny. All rights reserved.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+// A read only memory mapping of a whole file. Pages are only read from disk when touched,
+// so pointing into the mapping is cheaper than reading the file into memory.
+class MappedFile {
+public:
+	MappedFile() = default;
+	explicit MappedFile(const std::string& path);
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	MappedFile(MappedFile&&);
+	MappedFile& operator=(MappedFile&&);
+
+	const char* data() const { return static_cast<const char*>(mapping); }
+	size_t size() const { return length; }
+
+	explicit operator bool() const { return mapping != nullptr; }
+
+private:
+
+	void close();
+
+private:
+
+	void* mapping = nullptr;
+	size_t length = 0;
+};
@@ -0,0 +1,501 @@
+//
+//  memory_allocator.cpp
+//  Vulkan_test
+//
+//  Created by Danny on 17/10/2026.
+//  Copyright © 2026 Danny. All rights reserved.
+//
+
+#include "memory_allocator.hpp"
+
+#include <algorithm>
+
+namespace {
+
+	vk::DeviceSize nextPowerOfTwo(vk::DeviceSize v) {
+		vk::DeviceSize result = 1;
+		while(result < v)
+			result <<= 1;
+
+		return result;
+	}
+
+	vk::DeviceSize previousPowerOfTwo(vk::DeviceSize v) {
+		vk::DeviceSize result = 1;
+		while(result <= v / 2)
+			result <<= 1;
+
+		return result;
+	}
+
+	vk::DeviceSize alignUp(vk::DeviceSize v, vk::DeviceSize alignment) {
+		return (v + alignment - 1) & ~(alignment - 1);
+	}
+
+	uint32_t countBits(uint32_t v) {
+		uint32_t count = 0;
+		for(; v; v &= v - 1)
+			count++;
+
+		return count;
+	}
+
+	void getMemoryFlagsForUsage(MemoryUsage usage, vk::MemoryPropertyFlags& required, vk::MemoryPropertyFlags& preferred) {
+		switch(usage)
+		{
+			case MemoryUsage::GPU_ONLY:
+				preferred = vk::MemoryPropertyFlagBits::eDeviceLocal;
+				break;
+			case MemoryUsage::CPU_TO_GPU:
+				required = vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent;
+				preferred = vk::MemoryPropertyFlagBits::eDeviceLocal;
+				break;
+			case MemoryUsage::GPU_TO_CPU:
+				required = vk::MemoryPropertyFlagBits::eHostVisible;
+				preferred = vk::MemoryPropertyFlagBits::eHostCoherent | vk::MemoryPropertyFlagBits::eHostCached;
+				break;
+			case MemoryUsage::CPU_ONLY:
+				required = vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent;
+				break;
+		}
+	}
+}
+
+MemoryAllocator::MemoryAllocator(const vk::PhysicalDevice& physicalDevice, const vk::Device& logicalDevice, vk::DeviceSize preferredBlockSize)
+: logicalDevice(logicalDevice), memoryProperties(physicalDevice.getMemoryProperties()), preferredBlockSize(previousPowerOfTwo(preferredBlockSize)) {
+
+}
+
+MemoryAllocator::~MemoryAllocator() {
+	for(auto& pool: pools) {
+		for(auto& block: pool.buddyBlocks)
+			if(block)
+				destroyBlock(*block);
+		for(auto& block: pool.linearBlocks)
+			destroyBlock(*block);
+		for(auto& block: pool.dedicated)
+			if(block)
+				destroyBlock(*block);
+	}
+}
+
+uint32_t MemoryAllocator::findMemoryType(uint32_t typeBits, vk::MemoryPropertyFlags required, vk::MemoryPropertyFlags preferred) const {
+
+	uint32_t bestType = -1;
+	uint32_t bestScore = 0;
+	for(uint32_t i = 0; i < memoryProperties.memoryTypeCount; ++i) {
+		if(!(typeBits & (1 << i)))
+			continue;
+
+		const auto flags = memoryProperties.memoryTypes[i].propertyFlags;
+		if((flags & required) != required)
+			continue;
+
+		// Types are ordered by the driver from most to least performant, so the first match with the
+		// highest score wins.
+		const uint32_t score = 1 + countBits(static_cast<uint32_t>(flags & preferred));
+		if(score > bestScore) {
+			bestScore = score;
+			bestType = i;
+		}
+	}
+
+	return bestType;
+}
+
+MemoryAllocation MemoryAllocator::allocate(const vk::MemoryRequirements& requirements, MemoryUsage usage, ResourceTiling tiling, AllocationStrategy strategy) {
+	return allocate(requirements, usage, tiling, strategy, nullptr);
+}
+
+MemoryAllocation MemoryAllocator::allocate(const vk::MemoryRequirements& requirements, MemoryUsage usage, ResourceTiling tiling, AllocationStrategy strategy,
+										   const vk::MemoryDedicatedAllocateInfo* dedicatedInfo) {
+
+	vk::MemoryPropertyFlags required;
+	vk::MemoryPropertyFlags preferred;
+	getMemoryFlagsForUsage(usage, required, preferred);
+
+	MemoryAllocation allocation;
+	const auto memoryType = findMemoryType(requirements.memoryTypeBits, required, preferred);
+	if(memoryType == uint32_t(-1))
+		return allocation;
+
+	std::lock_guard<std::mutex> lock(mutex);
+
+	const auto poolIndex = getPoolIndex(memoryType, tiling);
+	auto& pool = pools[poolIndex];
+
+	allocation.memoryType = memoryType;
+	allocation.pool = poolIndex;
+	allocation.strategy = strategy;
+
+	// Anything bigger than half a block would waste most of it, give it its own allocation.
+	if(strategy == AllocationStrategy::DEFAULT && requirements.size > pool.blockSize / 2)
+		allocation.strategy = strategy = AllocationStrategy::DEDICATED;
+
+	switch(strategy)
+	{
+		case AllocationStrategy::DEDICATED:
+			if(!allocateDedicated(pool, requirements.size, dedicatedInfo, allocation))
+				return MemoryAllocation();
+
+			return allocation;
+
+		case AllocationStrategy::LINEAR:
+		{
+			for(uint32_t i = 0; i < pool.linearBlocks.size(); ++i) {
+				if(allocateLinear(*pool.linearBlocks[i], requirements.size, requirements.alignment, allocation)) {
+					allocation.block = i;
+					return allocation;
+				}
+			}
+
+			auto block = createBlock(memoryType, std::max(pool.blockSize, requirements.size), false, nullptr);
+			if(!block)
+				return MemoryAllocation();
+
+			pool.linearBlocks.emplace_back(std::move(block));
+			allocation.block = static_cast<uint32_t>(pool.linearBlocks.size() - 1);
+			allocateLinear(*pool.linearBlocks.back(), requirements.size, requirements.alignment, allocation);
+			return allocation;
+		}
+
+		case AllocationStrategy::DEFAULT:
+		{
+			uint32_t freeSlot = -1;
+			for(uint32_t i = 0; i < pool.buddyBlocks.size(); ++i) {
+				if(!pool.buddyBlocks[i]) {
+					freeSlot = i;
+					continue;
+				}
+
+				if(allocateBuddy(*pool.buddyBlocks[i], requirements.size, requirements.alignment, allocation)) {
+					allocation.block = i;
+					return allocation;
+				}
+			}
+
+			// A whole new block may not fit into the heap anymore where the resource on its own still does.
+			auto block = createBlock(memoryType, pool.blockSize, true, nullptr);
+			if(!block) {
+				allocation.strategy = AllocationStrategy::DEDICATED;
+				if(!allocateDedicated(pool, requirements.size, dedicatedInfo, allocation))
+					return MemoryAllocation();
+
+				return allocation;
+			}
+
+			if(freeSlot == uint32_t(-1)) {
+				freeSlot = static_cast<uint32_t>(pool.buddyBlocks.size());
+				pool.buddyBlocks.emplace_back(std::move(block));
+			} else {
+				pool.buddyBlocks[freeSlot] = std::move(block);
+			}
+
+			allocation.block = freeSlot;
+			allocateBuddy(*pool.buddyBlocks[freeSlot], requirements.size, requirements.alignment, allocation);
+			return allocation;
+		}
+	}
+
+	return allocation;
+}
+
+MemoryAllocation MemoryAllocator::allocateForImage(const vk::Image& image, MemoryUsage usage, AllocationStrategy strategy) {
+	vk::ImageMemoryRequirementsInfo2 info;
+	info.setImage(image);
+	const auto requirements = logicalDevice.getImageMemoryRequirements2<vk::MemoryRequirements2, vk::MemoryDedicatedRequirements>(info);
+
+	vk::MemoryDedicatedAllocateInfo dedicatedInfo;
+	dedicatedInfo.setImage(image);
+
+	auto allocation = allocate(requirements.get<vk::MemoryRequirements2>().memoryRequirements, usage, ResourceTiling::OPTIMAL,
+							   getStrategy(requirements.get<vk::MemoryDedicatedRequirements>(), strategy), &dedicatedInfo);
+	if(allocation)
+		logicalDevice.bindImageMemory(image, allocation.memory, allocation.offset);
+
+	return allocation;
+}
+
+MemoryAllocation MemoryAllocator::allocateForBuffer(const vk::Buffer& buffer, MemoryUsage usage, AllocationStrategy strategy) {
+	vk::BufferMemoryRequirementsInfo2 info;
+	info.setBuffer(buffer);
+	const auto requirements = logicalDevice.getBufferMemoryRequirements2<vk::MemoryRequirements2, vk::MemoryDedicatedRequirements>(info);
+
+	vk::MemoryDedicatedAllocateInfo dedicatedInfo;
+	dedicatedInfo.setBuffer(buffer);
+
+	auto allocation = allocate(requirements.get<vk::MemoryRequirements2>().memoryRequirements, usage, ResourceTiling::LINEAR,
+							   getStrategy(requirements.get<vk::MemoryDedicatedRequirements>(), strategy), &dedicatedInfo);
+	if(allocation)
+		logicalDevice.bindBufferMemory(buffer, allocation.memory, allocation.offset);
+
+	return allocation;
+}
+
+void MemoryAllocator::free(const MemoryAllocation& allocation) {
+	if(!allocation)
+		return;
+
+	std::lock_guard<std::mutex> lock(mutex);
+	auto& pool = pools[allocation.pool];
+
+	switch(allocation.strategy)
+	{
+		case AllocationStrategy::DEDICATED:
+		{
+			auto& block = pool.dedicated[allocation.block];
+			destroyBlock(*block);
+			block.reset();
+			break;
+		}
+
+		case AllocationStrategy::LINEAR:
+			// Reclaimed as a whole by resetLinear().
+			break;
+
+		case AllocationStrategy::DEFAULT:
+		{
+			auto& block = pool.buddyBlocks[allocation.block];
+			freeBuddy(*block, allocation);
+
+			// Keep one empty block around per pool so alternating allocate/free doesn't hit the driver.
+			if(block->allocationCount == 0) {
+				const auto emptyBlocks = std::count_if(pool.buddyBlocks.begin(), pool.buddyBlocks.end(), [](const std::unique_ptr<MemoryBlock>& b) {
+					return b && b->allocationCount == 0;
+				});
+
+				if(emptyBlocks > 1) {
+					destroyBlock(*block);
+					block.reset();
+				}
+			}
+			break;
+		}
+	}
+}
+
+void MemoryAllocator::resetLinear() {
+	std::lock_guard<std::mutex> lock(mutex);
+	for(auto& pool: pools) {
+		for(auto& block: pool.linearBlocks) {
+			block->head = 0;
+			block->bytesUsed = 0;
+			block->allocationCount = 0;
+		}
+	}
+}
+
+MemoryStatistics MemoryAllocator::getStatistics() const {
+	std::lock_guard<std::mutex> lock(mutex);
+
+	MemoryStatistics statistics;
+	statistics.memoryTypes.resize(memoryProperties.memoryTypeCount);
+
+	auto accumulate = [&statistics](MemoryTypeStatistics& type, const MemoryBlock& block) {
+		type.bytesReserved += block.size;
+		type.bytesUsed += block.bytesUsed;
+		type.allocationCount += block.allocationCount;
+		statistics.bytesReserved += block.size;
+		statistics.bytesUsed += block.bytesUsed;
+		statistics.deviceAllocationCount++;
+	};
+
+	for(const auto& pool: pools) {
+		auto& type = statistics.memoryTypes[pool.memoryType];
+		for(const auto& block: pool.buddyBlocks) {
+			if(block) {
+				type.blockCount++;
+				accumulate(type, *block);
+			}
+		}
+
+		for(const auto& block: pool.linearBlocks) {
+			type.blockCount++;
+			accumulate(type, *block);
+		}
+
+		for(const auto& block: pool.dedicated) {
+			if(block) {
+				type.dedicatedCount++;
+				accumulate(type, *block);
+			}
+		}
+	}
+
+	return statistics;
+}
+
+uint32_t MemoryAllocator::getPoolIndex(uint32_t memoryType, ResourceTiling tiling) {
+	for(uint32_t i = 0; i < pools.size(); ++i)
+		if(pools[i].memoryType == memoryType && pools[i].tiling == tiling)
+			return i;
+
+	// Don't let a single block take up more than an eighth of a small heap.
+	const auto heapSize = memoryProperties.memoryHeaps[memoryProperties.memoryTypes[memoryType].heapIndex].size;
+
+	MemoryPool pool;
+	pool.memoryType = memoryType;
+	pool.tiling = tiling;
+	pool.blockSize = std::max(minimumAllocationSize, std::min(preferredBlockSize, previousPowerOfTwo(heapSize / 8)));
+	pools.emplace_back(std::move(pool));
+
+	return static_cast<uint32_t>(pools.size() - 1);
+}
+
+AllocationStrategy MemoryAllocator::getStrategy(const vk::MemoryDedicatedRequirements& dedicated, AllocationStrategy strategy) {
+	// Some drivers only support the resource in memory of its own, others are merely faster with it. A preference
+	// doesn't override an explicit linear allocation.
+	if(dedicated.requiresDedicatedAllocation || (dedicated.prefersDedicatedAllocation && strategy == AllocationStrategy::DEFAULT))
+		return AllocationStrategy::DEDICATED;
+
+	return strategy;
+}
+
+bool MemoryAllocator::allocateDedicated(MemoryPool& pool, vk::DeviceSize size, const vk::MemoryDedicatedAllocateInfo* dedicatedInfo, MemoryAllocation& allocation) {
+	auto block = createBlock(pool.memoryType, size, false, dedicatedInfo);
+	if(!block)
+		return false;
+
+	block->bytesUsed = size;
+	block->allocationCount = 1;
+
+	allocation.memory = block->memory;
+	allocation.offset = 0;
+	allocation.size = size;
+	allocation.mapped = block->mapped;
+
+	auto slot = std::find(pool.dedicated.begin(), pool.dedicated.end(), nullptr);
+	allocation.block = static_cast<uint32_t>(slot - pool.dedicated.begin());
+	if(slot == pool.dedicated.end())
+		pool.dedicated.emplace_back(std::move(block));
+	else
+		*slot = std::move(block);
+
+	return true;
+}
+
+std::unique_ptr<MemoryAllocator::MemoryBlock> MemoryAllocator::createBlock(uint32_t memoryType, vk::DeviceSize size, bool buddy,
+																		  const vk::MemoryDedicatedAllocateInfo* dedicatedInfo) {
+	vk::MemoryAllocateInfo info;
+	info.setPNext(dedicatedInfo);
+	info.setAllocationSize(size);
+	info.setMemoryTypeIndex(memoryType);
+
+	// Running out of memory is reported like every other failure, with an empty allocation.
+	auto block = std::make_unique<MemoryBlock>();
+	try {
+		block->memory = logicalDevice.allocateMemory(info);
+	} catch(const vk::OutOfDeviceMemoryError&) {
+		return nullptr;
+	} catch(const vk::OutOfHostMemoryError&) {
+		return nullptr;
+	}
+	block->size = size;
+
+	// Host visible blocks stay mapped for their whole lifetime.
+	if(memoryProperties.memoryTypes[memoryType].propertyFlags & vk::MemoryPropertyFlagBits::eHostVisible)
+		block->mapped = logicalDevice.mapMemory(block->memory, 0, VK_WHOLE_SIZE);
+
+	if(buddy) {
+		block->freeLists.resize(getLevelCount(size));
+		block->freeLists[0].insert(0);
+	}
+
+	return block;
+}
+
+void MemoryAllocator::destroyBlock(MemoryBlock& block) {
+	if(block.mapped)
+		logicalDevice.unmapMemory(block.memory);
+
+	logicalDevice.freeMemory(block.memory);
+	block.memory = nullptr;
+	block.mapped = nullptr;
+}
+
+uint32_t MemoryAllocator::getLevelCount(vk::DeviceSize blockSize) const {
+	uint32_t levels = 1;
+	while(blockSize > minimumAllocationSize) {
+		blockSize >>= 1;
+		levels++;
+	}
+
+	return levels;
+}
+
+bool MemoryAllocator::allocateBuddy(MemoryBlock& block, vk::DeviceSize size, vk::DeviceSize alignment, MemoryAllocation& allocation) {
+
+	// Nodes are aligned to their own size, so rounding up to the alignment is enough to satisfy it.
+	const auto nodeSize = nextPowerOfTwo(std::max({size, alignment, minimumAllocationSize}));
+	if(nodeSize > block.size)
+		return false;
+
+	uint32_t level = 0;
+	for(auto s = block.size; s > nodeSize; s >>= 1)
+		level++;
+
+	// Find the smallest free node that fits and split it down to the requested level.
+	int32_t freeLevel = level;
+	while(freeLevel >= 0 && block.freeLists[freeLevel].empty())
+		freeLevel--;
+
+	if(freeLevel < 0)
+		return false;
+
+	auto offset = *block.freeLists[freeLevel].begin();
+	block.freeLists[freeLevel].erase(block.freeLists[freeLevel].begin());
+
+	for(uint32_t l = freeLevel; l < level; ++l) {
+		const auto half = block.size >> (l + 1);
+		block.freeLists[l + 1].insert(offset + half);
+	}
+
+	block.bytesUsed += nodeSize;
+	block.allocationCount++;
+
+	allocation.memory = block.memory;
+	allocation.offset = offset;
+	allocation.size = size;
+	allocation.level = level;
+	allocation.mapped = block.mapped ? static_cast<uint8_t*>(block.mapped) + offset : nullptr;
+
+	return true;
+}
+
+void MemoryAllocator::freeBuddy(MemoryBlock& block, const MemoryAllocation& allocation) {
+	auto offset = allocation.offset;
+	auto level = allocation.level;
+
+	block.bytesUsed -= block.size >> level;
+	block.allocationCount--;
+
+	// Merge with the buddy for as long as it is free as well.
+	while(level > 0) {
+		const auto nodeSize = block.size >> level;
+		const auto buddy = offset ^ nodeSize;
+		if(!block.freeLists[level].erase(buddy))
+			break;
+
+		offset = std::min(offset, buddy);
+		level--;
+	}
+
+	block.freeLists[level].insert(offset);
+}
+
+bool MemoryAllocator::allocateLinear(MemoryBlock& block, vk::DeviceSize size, vk::DeviceSize alignment, MemoryAllocation& allocation) {
+	const auto offset = alignUp(block.head, alignment);
+	if(offset + size > block.size)
+		return false;
+
+	block.head = offset + size;
+	block.bytesUsed += size;
+	block.allocationCount++;
+
+	allocation.memory = block.memory;
+	allocation.offset = offset;
+	allocation.size = size;
+	allocation.mapped = block.mapped ? static_cast<uint8_t*>(block.mapped) + offset : nullptr;
+
+	return true;
+}
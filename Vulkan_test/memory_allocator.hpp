@@ -0,0 +1,169 @@
+//
+//  memory_allocator.hpp
+//  Vulkan_test
+//
+//  Created by Danny on 17/10/2026.
+//  Copyright © 2026 Danny. All rights reserved.
+//
+
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+
+#include <memory>
+#include <mutex>
+#include <set>
+#include <vector>
+
+// What the memory is used for. Determines which memory type gets picked.
+enum class MemoryUsage
+{
+	// Only ever touched by the gpu (render targets, static vertex data).
+	GPU_ONLY,
+	// Written by the cpu, read by the gpu (staging, per frame uniforms).
+	CPU_TO_GPU,
+	// Written by the gpu, read back by the cpu (readbacks, queries).
+	GPU_TO_CPU,
+	// Only ever touched by the cpu.
+	CPU_ONLY
+};
+
+enum class AllocationStrategy
+{
+	// Buddy sub-allocation from a shared block, or a dedicated allocation for very large resources.
+	DEFAULT,
+	// Bump allocation from a shared block. Individual frees are ignored, memory is reclaimed by resetLinear().
+	LINEAR,
+	// Always give the resource its own vkAllocateMemory. Chains VkMemoryDedicatedAllocateInfo when allocated for an
+	// image or buffer, which is also what images and buffers get when their driver requires or prefers it.
+	DEDICATED
+};
+
+// Buffers and linear images may not share a page with optimal images (bufferImageGranularity),
+// so they are sub-allocated from separate blocks.
+enum class ResourceTiling
+{
+	LINEAR,
+	OPTIMAL
+};
+
+struct MemoryAllocation
+{
+	vk::DeviceMemory memory;
+	vk::DeviceSize offset 	= 0;
+	vk::DeviceSize size 	= 0;
+
+	// Persistently mapped pointer to the start of this allocation, nullptr if not host visible.
+	void* mapped = nullptr;
+
+	uint32_t memoryType = 0;
+	uint32_t pool		= 0;
+	uint32_t block		= 0;
+	uint32_t level		= 0;
+	AllocationStrategy strategy = AllocationStrategy::DEFAULT;
+
+	explicit operator bool() const { return static_cast<bool>(memory); }
+};
+
+struct MemoryTypeStatistics
+{
+	uint32_t blockCount 		= 0;
+	uint32_t dedicatedCount 	= 0;
+	uint32_t allocationCount 	= 0;
+
+	// Bytes obtained from the driver and bytes handed out to resources.
+	vk::DeviceSize bytesReserved 	= 0;
+	vk::DeviceSize bytesUsed 		= 0;
+};
+
+struct MemoryStatistics
+{
+	std::vector<MemoryTypeStatistics> memoryTypes;
+
+	// Number of live vkAllocateMemory allocations.
+	uint32_t deviceAllocationCount = 0;
+	vk::DeviceSize bytesReserved 	= 0;
+	vk::DeviceSize bytesUsed 		= 0;
+};
+
+// Sub-allocates device memory from large per memory type blocks, so the number of
+// vkAllocateMemory calls stays far below maxMemoryAllocationCount.
+class MemoryAllocator {
+public:
+	MemoryAllocator(const vk::PhysicalDevice& physicalDevice, const vk::Device& logicalDevice, vk::DeviceSize preferredBlockSize = 64 * 1024 * 1024);
+	~MemoryAllocator();
+
+	MemoryAllocator(const MemoryAllocator&) = delete;
+	MemoryAllocator& operator=(const MemoryAllocator&) = delete;
+
+	// Returns the index of a memory type allowed by typeBits that has all required flags, favouring types that
+	// also have the preferred flags. Returns -1 if there is none.
+	uint32_t findMemoryType(uint32_t typeBits, vk::MemoryPropertyFlags required, vk::MemoryPropertyFlags preferred = {}) const;
+
+	MemoryAllocation allocate(const vk::MemoryRequirements&, MemoryUsage, ResourceTiling, AllocationStrategy = AllocationStrategy::DEFAULT);
+
+	// Allocate and bind memory for a resource.
+	MemoryAllocation allocateForImage(const vk::Image&, MemoryUsage, AllocationStrategy = AllocationStrategy::DEFAULT);
+	MemoryAllocation allocateForBuffer(const vk::Buffer&, MemoryUsage, AllocationStrategy = AllocationStrategy::DEFAULT);
+
+	void free(const MemoryAllocation&);
+
+	// Reclaims every allocation made with AllocationStrategy::LINEAR.
+	void resetLinear();
+
+	MemoryStatistics getStatistics() const;
+
+private:
+
+	struct MemoryBlock
+	{
+		vk::DeviceMemory memory;
+		vk::DeviceSize size = 0;
+		void* mapped = nullptr;
+
+		// Buddy blocks: free offsets per level, level 0 being the whole block.
+		std::vector<std::set<vk::DeviceSize>> freeLists;
+		// Linear blocks: the bump pointer.
+		vk::DeviceSize head = 0;
+
+		vk::DeviceSize bytesUsed = 0;
+		uint32_t allocationCount = 0;
+	};
+
+	struct MemoryPool
+	{
+		uint32_t memoryType = 0;
+		ResourceTiling tiling;
+		vk::DeviceSize blockSize = 0;
+		std::vector<std::unique_ptr<MemoryBlock>> buddyBlocks;
+		std::vector<std::unique_ptr<MemoryBlock>> linearBlocks;
+		std::vector<std::unique_ptr<MemoryBlock>> dedicated;
+	};
+
+	// The resource is only known to allocateForImage/allocateForBuffer, dedicated allocations are made for it when given.
+	MemoryAllocation allocate(const vk::MemoryRequirements&, MemoryUsage, ResourceTiling, AllocationStrategy, const vk::MemoryDedicatedAllocateInfo*);
+	static AllocationStrategy getStrategy(const vk::MemoryDedicatedRequirements&, AllocationStrategy);
+
+	uint32_t getPoolIndex(uint32_t memoryType, ResourceTiling);
+	std::unique_ptr<MemoryBlock> createBlock(uint32_t memoryType, vk::DeviceSize size, bool buddy, const vk::MemoryDedicatedAllocateInfo*);
+	void destroyBlock(MemoryBlock&);
+
+	bool allocateBuddy(MemoryBlock&, vk::DeviceSize size, vk::DeviceSize alignment, MemoryAllocation&);
+	void freeBuddy(MemoryBlock&, const MemoryAllocation&);
+	bool allocateLinear(MemoryBlock&, vk::DeviceSize size, vk::DeviceSize alignment, MemoryAllocation&);
+	bool allocateDedicated(MemoryPool&, vk::DeviceSize size, const vk::MemoryDedicatedAllocateInfo*, MemoryAllocation&);
+
+	uint32_t getLevelCount(vk::DeviceSize blockSize) const;
+
+private:
+
+	vk::Device logicalDevice;
+	vk::PhysicalDeviceMemoryProperties memoryProperties;
+	vk::DeviceSize preferredBlockSize;
+
+	// The smallest node a buddy block hands out.
+	static constexpr vk::DeviceSize minimumAllocationSize = 256;
+
+	std::vector<MemoryPool> pools;
+	mutable std::mutex mutex;
+};
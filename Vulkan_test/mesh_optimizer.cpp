@@ -0,0 +1,890 @@
+//
+//  mesh_optimizer.cpp
+//  Vulkan_test
+//
+//  Created by Danny on 17/10/2026.
+//  Copyright © 2026 Danny. All rights reserved.
+//
+
+#include "mesh_optimizer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <unordered_map>
+
+#include "gltf_loader.hpp"
+#include "job_system.hpp"
+#include "profiler.hpp"
+
+namespace {
+
+	const uint32_t unused = ~0u;
+
+	// A FIFO cache of vertex indices. A vertex is cached when it was inserted less than size misses ago.
+	class VertexCache {
+	public:
+		VertexCache(uint32_t vertexCount, uint32_t size) : timestamps(vertexCount, 0), size(size), time(size + 1) {}
+
+		// Returns true on a miss.
+		bool access(uint32_t vertex) {
+			if(time - timestamps[vertex] <= size)
+				return false;
+			timestamps[vertex] = time++;
+			return true;
+		}
+
+		void clear() { time += size + 1; }
+
+	private:
+
+		std::vector<uint32_t> timestamps;
+		uint32_t size;
+		uint32_t time;
+	};
+
+	// Triangles of every vertex, in compressed rows.
+	struct Adjacency
+	{
+		std::vector<uint32_t> offsets;
+		std::vector<uint32_t> triangles;
+
+		Adjacency(const std::vector<uint32_t>& indices, uint32_t vertexCount) : offsets(vertexCount + 1, 0), triangles(indices.size()) {
+			for(auto index: indices)
+				++offsets[index + 1];
+			std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+			std::vector<uint32_t> next(offsets.begin(), offsets.end() - 1);
+			for(size_t i = 0; i < indices.size(); ++i)
+				triangles[next[indices[i]]++] = static_cast<uint32_t>(i / 3);
+		}
+
+		const uint32_t* begin(uint32_t vertex) const { return triangles.data() + offsets[vertex]; }
+		const uint32_t* end(uint32_t vertex) const { return triangles.data() + offsets[vertex + 1]; }
+	};
+
+	// Tipsify. Writes the triangle order and where the algorithm had to jump to a far away vertex, which are
+	// the natural boundaries of clusters.
+	void tipsify(const std::vector<uint32_t>& indices, uint32_t vertexCount, uint32_t cacheSize,
+				 std::vector<uint32_t>& order, std::vector<uint32_t>& clusters) {
+		const auto triangleCount = static_cast<uint32_t>(indices.size() / 3);
+		const Adjacency adjacency(indices, vertexCount);
+
+		std::vector<uint32_t> live(vertexCount);
+		for(uint32_t v = 0; v < vertexCount; ++v)
+			live[v] = adjacency.offsets[v + 1] - adjacency.offsets[v];
+
+		std::vector<uint32_t> timestamps(vertexCount, 0);
+		std::vector<bool> emitted(triangleCount, false);
+		std::vector<uint32_t> deadEnds;
+		std::vector<uint32_t> candidates;
+
+		order.clear();
+		order.reserve(triangleCount);
+		clusters.clear();
+
+		uint32_t time = cacheSize + 1;
+		uint32_t cursor = 0;
+		uint32_t fan = 0;
+		bool jumped = true;
+
+		while(fan != unused) {
+			candidates.clear();
+			for(auto* t = adjacency.begin(fan); t != adjacency.end(fan); ++t) {
+				if(emitted[*t])
+					continue;
+
+				if(jumped) {
+					clusters.emplace_back(static_cast<uint32_t>(order.size()));
+					jumped = false;
+				}
+
+				for(uint32_t k = 0; k < 3; ++k) {
+					const auto v = indices[*t * 3 + k];
+					deadEnds.emplace_back(v);
+					candidates.emplace_back(v);
+					--live[v];
+					if(time - timestamps[v] > cacheSize)
+						timestamps[v] = time++;
+				}
+
+				emitted[*t] = true;
+				order.emplace_back(*t);
+			}
+
+			// The candidate that is still in the cache after its remaining triangles were emitted and entered it
+			// the longest time ago.
+			fan = unused;
+			int32_t best = -1;
+			for(auto v: candidates) {
+				if(!live[v])
+					continue;
+
+				int32_t priority = 0;
+				if(time - timestamps[v] + 2 * live[v] <= cacheSize)
+					priority = static_cast<int32_t>(time - timestamps[v]);
+				if(priority > best) {
+					best = priority;
+					fan = v;
+				}
+			}
+
+			if(fan != unused)
+				continue;
+
+			// A dead end. Go back to recently used vertices, then to any vertex with triangles left.
+			jumped = true;
+			while(!deadEnds.empty() && fan == unused) {
+				if(live[deadEnds.back()])
+					fan = deadEnds.back();
+				deadEnds.pop_back();
+			}
+
+			while(fan == unused && cursor < vertexCount) {
+				if(live[cursor])
+					fan = cursor;
+				++cursor;
+			}
+		}
+	}
+
+	void getTriangleNormal(const float* a, const float* b, const float* c, double normal[3]) {
+		const double e0[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+		const double e1[3] = {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+		normal[0] = e0[1] * e1[2] - e0[2] * e1[1];
+		normal[1] = e0[2] * e1[0] - e0[0] * e1[2];
+		normal[2] = e0[0] * e1[1] - e0[1] * e1[0];
+	}
+
+	// Sum of squared distances to planes, ax + by + cz + d = 0.
+	struct Quadric
+	{
+		double a2 = 0, b2 = 0, c2 = 0, ab = 0, ac = 0, bc = 0, ad = 0, bd = 0, cd = 0, d2 = 0;
+		double weight = 0;
+
+		void addPlane(const double n[3], double d, double w) {
+			a2 += w * n[0] * n[0]; b2 += w * n[1] * n[1]; c2 += w * n[2] * n[2];
+			ab += w * n[0] * n[1]; ac += w * n[0] * n[2]; bc += w * n[1] * n[2];
+			ad += w * n[0] * d; bd += w * n[1] * d; cd += w * n[2] * d;
+			d2 += w * d * d;
+			weight += w;
+		}
+
+		void add(const Quadric& q) {
+			a2 += q.a2; b2 += q.b2; c2 += q.c2; ab += q.ab; ac += q.ac; bc += q.bc;
+			ad += q.ad; bd += q.bd; cd += q.cd; d2 += q.d2;
+			weight += q.weight;
+		}
+
+		double evaluate(const float* p) const {
+			const double x = p[0], y = p[1], z = p[2];
+			const double error = a2 * x * x + b2 * y * y + c2 * z * z + 2 * (ab * x * y + ac * x * z + bc * y * z) +
+				2 * (ad * x + bd * y + cd * z) + d2;
+			return weight > 0 ? std::max(error, 0.0) / weight : 0;
+		}
+	};
+
+	uint64_t getEdgeKey(uint32_t a, uint32_t b) {
+		return a < b ? uint64_t(a) << 32 | b : uint64_t(b) << 32 | a;
+	}
+
+	uint32_t resolve(const std::vector<uint32_t>& collapsed, uint32_t v) {
+		while(collapsed[v] != v)
+			v = collapsed[v];
+		return v;
+	}
+}
+
+VertexCacheStatistics analyzeVertexCache(const std::vector<uint32_t>& indices, uint32_t vertexCount, uint32_t cacheSize) {
+	VertexCacheStatistics statistics;
+	VertexCache cache(vertexCount, cacheSize);
+	std::vector<bool> referenced(vertexCount, false);
+
+	for(auto index: indices) {
+		if(cache.access(index))
+			++statistics.transformed;
+		if(!referenced[index]) {
+			referenced[index] = true;
+			++statistics.vertices;
+		}
+	}
+
+	statistics.triangles = static_cast<uint32_t>(indices.size() / 3);
+	statistics.acmr = statistics.triangles ? float(statistics.transformed) / statistics.triangles : 0;
+	statistics.atvr = statistics.vertices ? float(statistics.transformed) / statistics.vertices : 0;
+	return statistics;
+}
+
+uint32_t generateVertexRemap(std::vector<uint32_t>& remap, const std::vector<uint32_t>& indices, uint32_t vertexCount,
+							 const VertexStream* streams, uint32_t streamCount) {
+	auto getVertex = [&](uint32_t stream, uint32_t v) {
+		return static_cast<const uint8_t*>(streams[stream].data) + size_t(v) * streams[stream].stride;
+	};
+
+	auto hash = [&](uint32_t v) {
+		uint64_t value = 0xcbf29ce484222325ull;
+		for(uint32_t s = 0; s < streamCount; ++s) {
+			const auto* bytes = getVertex(s, v);
+			for(uint32_t i = 0; i < streams[s].size; ++i) {
+				value ^= bytes[i];
+				value *= 0x100000001b3ull;
+			}
+		}
+		return static_cast<size_t>(value);
+	};
+
+	auto equal = [&](uint32_t a, uint32_t b) {
+		for(uint32_t s = 0; s < streamCount; ++s)
+			if(std::memcmp(getVertex(s, a), getVertex(s, b), streams[s].size) != 0)
+				return false;
+		return true;
+	};
+
+	// Keyed by the first vertex with the contents, mapping to its new index.
+	std::unordered_map<uint32_t, uint32_t, decltype(hash), decltype(equal)> unique(vertexCount, hash, equal);
+
+	remap.assign(vertexCount, unused);
+	uint32_t next = 0;
+	for(auto index: indices) {
+		if(remap[index] != unused)
+			continue;
+
+		const auto inserted = unique.emplace(index, next);
+		remap[index] = inserted.first->second;
+		if(inserted.second)
+			++next;
+	}
+
+	return next;
+}
+
+uint32_t generateVertexFetchRemap(std::vector<uint32_t>& remap, const std::vector<uint32_t>& indices, uint32_t vertexCount) {
+	remap.assign(vertexCount, unused);
+	uint32_t next = 0;
+	for(auto index: indices)
+		if(remap[index] == unused)
+			remap[index] = next++;
+	return next;
+}
+
+void remapIndices(std::vector<uint32_t>& indices, const std::vector<uint32_t>& remap) {
+	for(auto& index: indices)
+		index = remap[index];
+}
+
+void remapVertices(std::vector<uint8_t>& destination, const VertexStream& source, uint32_t vertexCount, const std::vector<uint32_t>& remap, uint32_t uniqueVertexCount) {
+	destination.resize(size_t(uniqueVertexCount) * source.size);
+	const auto* bytes = static_cast<const uint8_t*>(source.data);
+	for(uint32_t v = 0; v < vertexCount; ++v)
+		if(remap[v] != unused)
+			std::memcpy(&destination[size_t(remap[v]) * source.size], bytes + size_t(v) * source.stride, source.size);
+}
+
+void optimizeVertexCache(std::vector<uint32_t>& indices, uint32_t vertexCount, uint32_t cacheSize) {
+	std::vector<uint32_t> order;
+	std::vector<uint32_t> clusters;
+	tipsify(indices, vertexCount, cacheSize, order, clusters);
+
+	std::vector<uint32_t> result(indices.size());
+	for(size_t i = 0; i < order.size(); ++i)
+		std::copy(&indices[order[i] * 3], &indices[order[i] * 3] + 3, &result[i * 3]);
+	indices.swap(result);
+}
+
+void optimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<float>& positions, uint32_t vertexCount, float threshold, uint32_t cacheSize) {
+	PROFILE_FUNCTION();
+
+	std::vector<uint32_t> order;
+	std::vector<uint32_t> hardClusters;
+	tipsify(indices, vertexCount, cacheSize, order, hardClusters);
+	hardClusters.emplace_back(static_cast<uint32_t>(order.size()));
+
+	// Split each cluster wherever the part so far is within threshold of the cache efficiency of the whole
+	// cluster, starting the next part with a cold cache.
+	std::vector<uint32_t> clusters;
+	VertexCache cache(vertexCount, cacheSize);
+	for(size_t c = 0; c + 1 < hardClusters.size(); ++c) {
+		const auto begin = hardClusters[c];
+		const auto end = hardClusters[c + 1];
+
+		cache.clear();
+		uint32_t misses = 0;
+		for(auto i = begin; i < end; ++i)
+			for(uint32_t k = 0; k < 3; ++k)
+				misses += cache.access(indices[order[i] * 3 + k]);
+		const float limit = threshold * float(misses) / float(end - begin);
+
+		clusters.emplace_back(begin);
+		cache.clear();
+		uint32_t partMisses = 0;
+		uint32_t partTriangles = 0;
+		for(auto i = begin; i < end; ++i) {
+			for(uint32_t k = 0; k < 3; ++k)
+				partMisses += cache.access(indices[order[i] * 3 + k]);
+			++partTriangles;
+
+			if(i + 1 < end && float(partMisses) <= limit * partTriangles) {
+				clusters.emplace_back(i + 1);
+				cache.clear();
+				partMisses = 0;
+				partTriangles = 0;
+			}
+		}
+	}
+	clusters.emplace_back(static_cast<uint32_t>(order.size()));
+
+	// Clusters facing away from the centre of the mesh are likely to occlude the others, from whatever side.
+	double centre[3] = {0, 0, 0};
+	double totalArea = 0;
+	std::vector<double> sortKeys(clusters.size() - 1);
+	std::vector<double> clusterData((clusters.size() - 1) * 7, 0.0);
+	for(size_t c = 0; c + 1 < clusters.size(); ++c) {
+		auto* data = &clusterData[c * 7];
+		for(auto i = clusters[c]; i < clusters[c + 1]; ++i) {
+			const auto* t = &indices[order[i] * 3];
+			const float* p[3] = {&positions[t[0] * 3], &positions[t[1] * 3], &positions[t[2] * 3]};
+
+			double normal[3];
+			getTriangleNormal(p[0], p[1], p[2], normal);
+			const double area = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+
+			for(uint32_t k = 0; k < 3; ++k) {
+				const double centroid = (double(p[0][k]) + p[1][k] + p[2][k]) / 3;
+				data[k] += centroid * area;
+				data[3 + k] += normal[k];
+			}
+			data[6] += area;
+		}
+
+		for(uint32_t k = 0; k < 3; ++k)
+			centre[k] += data[k];
+		totalArea += data[6];
+	}
+
+	for(uint32_t k = 0; k < 3; ++k)
+		centre[k] = totalArea > 0 ? centre[k] / totalArea : 0;
+
+	for(size_t c = 0; c < sortKeys.size(); ++c) {
+		const auto* data = &clusterData[c * 7];
+		const double length = std::sqrt(data[3] * data[3] + data[4] * data[4] + data[5] * data[5]);
+		if(data[6] <= 0 || length <= 0)
+			continue;
+
+		double key = 0;
+		for(uint32_t k = 0; k < 3; ++k)
+			key += (data[k] / data[6] - centre[k]) * data[3 + k] / length;
+		sortKeys[c] = key;
+	}
+
+	std::vector<uint32_t> clusterOrder(sortKeys.size());
+	std::iota(clusterOrder.begin(), clusterOrder.end(), 0);
+	std::stable_sort(clusterOrder.begin(), clusterOrder.end(), [&](uint32_t a, uint32_t b) { return sortKeys[a] > sortKeys[b]; });
+
+	std::vector<uint32_t> result;
+	result.reserve(indices.size());
+	for(auto c: clusterOrder)
+		for(auto i = clusters[c]; i < clusters[c + 1]; ++i)
+			result.insert(result.end(), &indices[order[i] * 3], &indices[order[i] * 3] + 3);
+	indices.swap(result);
+}
+
+std::vector<uint32_t> simplify(const std::vector<uint32_t>& source, const std::vector<float>& sourcePositions, size_t targetIndexCount,
+							   float targetError, float* resultError) {
+	PROFILE_FUNCTION();
+
+	const auto vertexCount = static_cast<uint32_t>(sourcePositions.size() / 3);
+	std::vector<uint32_t> indices(source);
+	if(resultError)
+		*resultError = 0;
+	if(indices.size() <= targetIndexCount)
+		return indices;
+
+	// Errors are relative to the extent of the mesh.
+	float minimum[3] = {std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max()};
+	float maximum[3] = {-std::numeric_limits<float>::max(), -std::numeric_limits<float>::max(), -std::numeric_limits<float>::max()};
+	for(auto index: indices) {
+		for(uint32_t k = 0; k < 3; ++k) {
+			minimum[k] = std::min(minimum[k], sourcePositions[index * 3 + k]);
+			maximum[k] = std::max(maximum[k], sourcePositions[index * 3 + k]);
+		}
+	}
+
+	const float extent = std::max({maximum[0] - minimum[0], maximum[1] - minimum[1], maximum[2] - minimum[2]});
+	const float scale = extent > 0 ? 1 / extent : 1;
+	std::vector<float> positions(sourcePositions.size());
+	for(size_t i = 0; i < positions.size(); ++i)
+		positions[i] = (sourcePositions[i] - minimum[i % 3]) * scale;
+
+	std::vector<Quadric> quadrics(vertexCount);
+	for(size_t i = 0; i < indices.size(); i += 3) {
+		const float* p[3] = {&positions[indices[i] * 3], &positions[indices[i + 1] * 3], &positions[indices[i + 2] * 3]};
+		double normal[3];
+		getTriangleNormal(p[0], p[1], p[2], normal);
+		const double length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+		if(length <= 0)
+			continue;
+
+		for(auto& n: normal)
+			n /= length;
+		const double d = -(normal[0] * p[0][0] + normal[1] * p[0][1] + normal[2] * p[0][2]);
+		for(uint32_t k = 0; k < 3; ++k)
+			quadrics[indices[i + k]].addPlane(normal, d, length * 0.5);
+	}
+
+	// Edges with a single triangle are borders or seams between vertices with different attributes, edges with
+	// more are non manifold. Their vertices stay where they are.
+	std::vector<bool> locked(vertexCount, false);
+	{
+		std::unordered_map<uint64_t, uint32_t> edges(indices.size());
+		for(size_t i = 0; i < indices.size(); i += 3)
+			for(uint32_t k = 0; k < 3; ++k)
+				++edges[getEdgeKey(indices[i + k], indices[i + (k + 1) % 3])];
+
+		for(const auto& edge: edges) {
+			if(edge.second != 2) {
+				locked[edge.first >> 32] = true;
+				locked[edge.first & 0xffffffff] = true;
+			}
+		}
+	}
+
+	struct Collapse
+	{
+		uint32_t from;
+		uint32_t to;
+		double error;
+	};
+
+	const double errorLimit = double(targetError) * targetError;
+	double maximumError = 0;
+	std::vector<uint32_t> collapsed(vertexCount);
+	std::iota(collapsed.begin(), collapsed.end(), 0);
+	std::vector<Collapse> collapses;
+	std::vector<bool> touched(vertexCount);
+
+	// Every pass collapses the cheapest edges that don't share a vertex, then rebuilds the triangles.
+	while(indices.size() > targetIndexCount) {
+		const Adjacency adjacency(indices, vertexCount);
+
+		collapses.clear();
+		for(size_t i = 0; i < indices.size(); i += 3) {
+			for(uint32_t k = 0; k < 3; ++k) {
+				const auto a = indices[i + k];
+				const auto b = indices[i + (k + 1) % 3];
+				if(!locked[a]) {
+					Quadric q = quadrics[a];
+					q.add(quadrics[b]);
+					collapses.push_back({a, b, q.evaluate(&positions[b * 3])});
+				}
+				if(!locked[b]) {
+					Quadric q = quadrics[a];
+					q.add(quadrics[b]);
+					collapses.push_back({b, a, q.evaluate(&positions[a * 3])});
+				}
+			}
+		}
+
+		std::sort(collapses.begin(), collapses.end(), [](const Collapse& x, const Collapse& y) { return x.error < y.error; });
+
+		std::fill(touched.begin(), touched.end(), false);
+		const auto trianglesToRemove = (indices.size() - targetIndexCount) / 3;
+		size_t removed = 0;
+		size_t performed = 0;
+		for(const auto& collapse: collapses) {
+			if(removed >= trianglesToRemove || collapse.error > errorLimit)
+				break;
+			if(touched[collapse.from] || touched[collapse.to])
+				continue;
+
+			// Triangles around the vertex that survive the collapse mustn't flip.
+			bool flips = false;
+			uint32_t degenerate = 0;
+			for(auto* t = adjacency.begin(collapse.from); t != adjacency.end(collapse.from) && !flips; ++t) {
+				uint32_t v[3];
+				for(uint32_t k = 0; k < 3; ++k)
+					v[k] = resolve(collapsed, indices[*t * 3 + k]);
+
+				if(v[0] == collapse.to || v[1] == collapse.to || v[2] == collapse.to) {
+					++degenerate;
+					continue;
+				}
+
+				double before[3];
+				getTriangleNormal(&positions[v[0] * 3], &positions[v[1] * 3], &positions[v[2] * 3], before);
+				for(auto& vertex: v)
+					if(vertex == collapse.from)
+						vertex = collapse.to;
+
+				double after[3];
+				getTriangleNormal(&positions[v[0] * 3], &positions[v[1] * 3], &positions[v[2] * 3], after);
+				flips = before[0] * after[0] + before[1] * after[1] + before[2] * after[2] <= 0;
+			}
+
+			if(flips)
+				continue;
+
+			collapsed[collapse.from] = collapse.to;
+			quadrics[collapse.to].add(quadrics[collapse.from]);
+			touched[collapse.from] = true;
+			touched[collapse.to] = true;
+			maximumError = std::max(maximumError, collapse.error);
+			removed += degenerate;
+			++performed;
+		}
+
+		if(!performed)
+			break;
+
+		size_t count = 0;
+		for(size_t i = 0; i < indices.size(); i += 3) {
+			const auto a = resolve(collapsed, indices[i]);
+			const auto b = resolve(collapsed, indices[i + 1]);
+			const auto c = resolve(collapsed, indices[i + 2]);
+			if(a == b || b == c || c == a)
+				continue;
+
+			indices[count++] = a;
+			indices[count++] = b;
+			indices[count++] = c;
+		}
+		indices.resize(count);
+	}
+
+	if(resultError)
+		*resultError = static_cast<float>(std::sqrt(maximumError));
+	return indices;
+}
+
+namespace {
+
+	const int32_t componentUnsignedShort = 5123;
+	const int32_t componentUnsignedInt = 5125;
+	const int32_t componentFloat = 5126;
+	const int32_t targetArrayBuffer = 34962;
+	const int32_t targetElementArrayBuffer = 34963;
+
+	struct Attribute
+	{
+		std::string name;
+		uint32_t elementSize = 0;
+		std::vector<uint8_t> data;
+	};
+
+	// A primitive's new data, built in parallel and committed to the scene afterwards.
+	struct OptimizedPrimitive
+	{
+		uint32_t mesh = 0;
+		uint32_t primitive = 0;
+		bool optimized = false;
+
+		std::vector<uint32_t> indices;
+		std::vector<std::vector<uint32_t>> lodIndices;
+		std::vector<float> lodErrors;
+		std::vector<Attribute> attributes;
+		uint32_t vertexCount = 0;
+
+		VertexCacheStatistics before;
+		VertexCacheStatistics after;
+	};
+
+	bool readIndices(const GltfScene& scene, const Primitive& primitive, uint32_t vertexCount, std::vector<uint32_t>& indices) {
+		if(primitive.indices < 0) {
+			indices.resize(vertexCount - vertexCount % 3);
+			std::iota(indices.begin(), indices.end(), 0);
+			return true;
+		}
+
+		const auto& accessor = scene.accessors[primitive.indices];
+		uint32_t stride = 0;
+		const auto* data = getAccessorData(scene, accessor, stride);
+		if(!data || accessor.type != "SCALAR")
+			return false;
+
+		indices.resize(accessor.count - accessor.count % 3);
+		for(size_t i = 0; i < indices.size(); ++i) {
+			const auto* element = data + i * stride;
+			switch(accessor.componentType) {
+				case 5121: indices[i] = *element; break;
+				case 5123: { uint16_t value; std::memcpy(&value, element, sizeof(value)); indices[i] = value; break; }
+				case 5125: std::memcpy(&indices[i], element, sizeof(uint32_t)); break;
+				default: return false;
+			}
+
+			if(indices[i] >= vertexCount)
+				return false;
+		}
+
+		return true;
+	}
+
+	void optimizePrimitive(const GltfScene& scene, const MeshOptimizerSettings& settings, OptimizedPrimitive& result) {
+		const auto& primitive = scene.meshes[result.mesh].primitives[result.primitive];
+		const auto position = primitive.attributes.find("POSITION");
+		if(primitive.mode != 4 || position == primitive.attributes.end())
+			return;
+
+		const auto& positionAccessor = scene.accessors[position->second];
+		if(positionAccessor.componentType != componentFloat || positionAccessor.type != "VEC3")
+			return;
+
+		const auto vertexCount = static_cast<uint32_t>(positionAccessor.count);
+		std::vector<VertexStream> streams;
+		for(const auto& attribute: primitive.attributes) {
+			const auto& accessor = scene.accessors[attribute.second];
+			VertexStream stream;
+			stream.data = getAccessorData(scene, accessor, stream.stride);
+			stream.size = getAccessorElementSize(accessor);
+			if(!stream.data || accessor.count != positionAccessor.count)
+				return;
+
+			streams.emplace_back(stream);
+			result.attributes.emplace_back();
+			result.attributes.back().name = attribute.first;
+			result.attributes.back().elementSize = stream.size;
+		}
+
+		std::vector<uint32_t> indices;
+		if(!readIndices(scene, primitive, vertexCount, indices) || indices.empty())
+			return;
+
+		result.before = analyzeVertexCache(indices, vertexCount, settings.cacheSize);
+
+		// Unique vertices, packed.
+		std::vector<uint32_t> remap;
+		auto uniqueCount = generateVertexRemap(remap, indices, vertexCount, streams.data(), static_cast<uint32_t>(streams.size()));
+		remapIndices(indices, remap);
+		for(size_t s = 0; s < streams.size(); ++s)
+			remapVertices(result.attributes[s].data, streams[s], vertexCount, remap, uniqueCount);
+
+		const auto positionStream = static_cast<size_t>(std::distance(primitive.attributes.begin(), position));
+		std::vector<float> positions(size_t(uniqueCount) * 3);
+		std::memcpy(positions.data(), result.attributes[positionStream].data.data(), positions.size() * sizeof(float));
+
+		optimizeOverdraw(indices, positions, uniqueCount, settings.overdrawThreshold, settings.cacheSize);
+
+		const auto* previous = &indices;
+		for(uint32_t level = 0; level < settings.maxLods; ++level) {
+			const auto target = static_cast<size_t>(previous->size() / 3 * settings.lodRatio) * 3;
+			if(target / 3 < settings.minLodTriangles)
+				break;
+
+			float error = 0;
+			auto lod = simplify(*previous, positions, target, settings.maxLodError, &error);
+			// Stop once simplification stalls, a level that barely differs isn't worth its memory.
+			if(lod.size() / 3 < settings.minLodTriangles || lod.size() * 10 > previous->size() * 9)
+				break;
+
+			optimizeVertexCache(lod, uniqueCount, settings.cacheSize);
+			result.lodIndices.emplace_back(std::move(lod));
+			result.lodErrors.emplace_back(std::max(error, result.lodErrors.empty() ? 0.0f : result.lodErrors.back()));
+			previous = &result.lodIndices.back();
+		}
+
+		// Vertices in the order the full detail triangles first use them. Levels of detail only use a subset.
+		uniqueCount = generateVertexFetchRemap(remap, indices, uniqueCount);
+		remapIndices(indices, remap);
+		for(auto& lod: result.lodIndices)
+			remapIndices(lod, remap);
+		for(auto& attribute: result.attributes) {
+			const auto packed = std::move(attribute.data);
+			VertexStream stream;
+			stream.data = packed.data();
+			stream.size = attribute.elementSize;
+			stream.stride = attribute.elementSize;
+			remapVertices(attribute.data, stream, static_cast<uint32_t>(remap.size()), remap, uniqueCount);
+		}
+
+		result.indices = std::move(indices);
+		result.vertexCount = uniqueCount;
+		result.after = analyzeVertexCache(result.indices, uniqueCount, settings.cacheSize);
+		result.optimized = true;
+	}
+
+	void accumulate(VertexCacheStatistics& total, const VertexCacheStatistics& statistics) {
+		total.triangles += statistics.triangles;
+		total.vertices += statistics.vertices;
+		total.transformed += statistics.transformed;
+		total.acmr = total.triangles ? float(total.transformed) / total.triangles : 0;
+		total.atvr = total.vertices ? float(total.transformed) / total.vertices : 0;
+	}
+
+	// Writes the primitive's data to a buffer of its own. Accessors that only this primitive uses are replaced
+	// in place, and with them their buffer views if nothing else reads those, so the old data is no longer
+	// referenced. Anything shared gets a new accessor.
+	void commit(GltfScene& scene, OptimizedPrimitive& result, const std::vector<uint32_t>& accessorUsers, const std::vector<uint32_t>& viewUsers) {
+		auto data = std::make_unique<std::vector<uint8_t>>();
+		const bool wideIndices = result.vertexCount > 0xffff;
+		const auto bufferId = static_cast<int32_t>(scene.buffers.size());
+
+		auto append = [&](const void* bytes, size_t size, int32_t target) {
+			BufferViewResourceDescriptor view;
+			view.bufferId = bufferId;
+			view.byteOffset = static_cast<int32_t>(data->size());
+			view.byteLength = static_cast<int32_t>(size);
+			view.target = target;
+
+			const auto* b = static_cast<const uint8_t*>(bytes);
+			data->insert(data->end(), b, b + size);
+			data->resize((data->size() + 3) & ~size_t(3), 0);
+			return view;
+		};
+
+		auto place = [&](int32_t existing, BufferViewResourceDescriptor view, Accessor accessor) {
+			if(existing >= 0 && accessorUsers[existing] == 1) {
+				const auto oldView = scene.accessors[existing].bufferView;
+				accessor.name = scene.accessors[existing].name;
+				if(oldView >= 0 && viewUsers[oldView] == 1) {
+					view.name = scene.bufferViews[oldView].name;
+					scene.bufferViews[oldView] = view;
+					accessor.bufferView = oldView;
+				} else {
+					accessor.bufferView = static_cast<int32_t>(scene.bufferViews.size());
+					scene.bufferViews.emplace_back(std::move(view));
+				}
+
+				scene.accessors[existing] = std::move(accessor);
+				return existing;
+			}
+
+			accessor.bufferView = static_cast<int32_t>(scene.bufferViews.size());
+			scene.bufferViews.emplace_back(std::move(view));
+			scene.accessors.emplace_back(std::move(accessor));
+			return static_cast<int32_t>(scene.accessors.size() - 1);
+		};
+
+		auto placeIndices = [&](int32_t existing, const std::vector<uint32_t>& indices) {
+			Accessor accessor;
+			accessor.type = "SCALAR";
+			accessor.count = static_cast<int32_t>(indices.size());
+			accessor.componentType = wideIndices ? componentUnsignedInt : componentUnsignedShort;
+
+			if(wideIndices)
+				return place(existing, append(indices.data(), indices.size() * sizeof(uint32_t), targetElementArrayBuffer), std::move(accessor));
+
+			std::vector<uint16_t> narrow(indices.begin(), indices.end());
+			return place(existing, append(narrow.data(), narrow.size() * sizeof(uint16_t), targetElementArrayBuffer), std::move(accessor));
+		};
+
+		auto& primitive = scene.meshes[result.mesh].primitives[result.primitive];
+		primitive.indices = placeIndices(primitive.indices, result.indices);
+
+		const auto oldLods = std::move(primitive.lods);
+		primitive.lods.clear();
+		for(size_t i = 0; i < result.lodIndices.size(); ++i) {
+			PrimitiveLod lod;
+			lod.indices = placeIndices(i < oldLods.size() ? oldLods[i].indices : -1, result.lodIndices[i]);
+			lod.error = result.lodErrors[i];
+			primitive.lods.emplace_back(lod);
+		}
+
+		for(const auto& attribute: result.attributes) {
+			const auto existing = primitive.attributes.at(attribute.name);
+			const auto& old = scene.accessors[existing];
+
+			Accessor accessor;
+			accessor.type = old.type;
+			accessor.componentType = old.componentType;
+			accessor.normalized = old.normalized;
+			accessor.count = static_cast<int32_t>(result.vertexCount);
+
+			// glTF requires the bounds of positions, other bounds would be stale and are dropped.
+			if(attribute.name == "POSITION") {
+				accessor.min.assign(3, std::numeric_limits<float>::max());
+				accessor.max.assign(3, -std::numeric_limits<float>::max());
+				const auto* p = reinterpret_cast<const float*>(attribute.data.data());
+				for(uint32_t v = 0; v < result.vertexCount; ++v) {
+					for(uint32_t k = 0; k < 3; ++k) {
+						accessor.min[k] = std::min(accessor.min[k], p[v * 3 + k]);
+						accessor.max[k] = std::max(accessor.max[k], p[v * 3 + k]);
+					}
+				}
+			}
+
+			primitive.attributes[attribute.name] = place(existing, append(attribute.data.data(), attribute.data.size(), targetArrayBuffer), std::move(accessor));
+		}
+
+		BufferResourceDescriptor buffer;
+		buffer.byteLength = static_cast<int32_t>(data->size());
+		buffer.data = data->data();
+		scene.buffers.emplace_back(std::move(buffer));
+		scene.ownedData.emplace_back(std::move(data));
+	}
+}
+
+std::vector<MeshOptimizationReport> optimizeGltfMeshes(GltfScene& scene, const MeshOptimizerSettings& settings, JobSystem* jobSystem) {
+	PROFILE_FUNCTION();
+
+	std::vector<OptimizedPrimitive> results;
+	for(uint32_t m = 0; m < scene.meshes.size(); ++m) {
+		for(uint32_t p = 0; p < scene.meshes[m].primitives.size(); ++p) {
+			results.emplace_back();
+			results.back().mesh = m;
+			results.back().primitive = p;
+		}
+	}
+
+	auto optimize = [&](uint32_t begin, uint32_t end) {
+		for(auto i = begin; i < end; ++i)
+			optimizePrimitive(scene, settings, results[i]);
+	};
+
+	if(jobSystem)
+		jobSystem->parallelFor(static_cast<uint32_t>(results.size()), 1, optimize);
+	else
+		optimize(0, static_cast<uint32_t>(results.size()));
+
+	// Who reads each accessor and buffer view, to know what can be replaced.
+	std::vector<uint32_t> accessorUsers(scene.accessors.size(), 0);
+	std::vector<uint32_t> viewUsers(scene.bufferViews.size(), 0);
+	for(const auto& mesh: scene.meshes) {
+		for(const auto& primitive: mesh.primitives) {
+			if(primitive.indices >= 0)
+				++accessorUsers[primitive.indices];
+			for(const auto& lod: primitive.lods)
+				++accessorUsers[lod.indices];
+			for(const auto& attribute: primitive.attributes)
+				++accessorUsers[attribute.second];
+		}
+	}
+	for(const auto& accessor: scene.accessors)
+		if(accessor.bufferView >= 0)
+			++viewUsers[accessor.bufferView];
+	for(const auto& image: scene.images)
+		if(image.bufferView >= 0)
+			viewUsers[image.bufferView] += 2;
+
+	std::vector<MeshOptimizationReport> reports(scene.meshes.size());
+	for(uint32_t m = 0; m < scene.meshes.size(); ++m) {
+		reports[m].mesh = static_cast<int32_t>(m);
+		reports[m].name = scene.meshes[m].name;
+	}
+
+	for(auto& result: results) {
+		auto& report = reports[result.mesh];
+		if(!result.optimized) {
+			++report.skippedPrimitives;
+			continue;
+		}
+
+		++report.optimizedPrimitives;
+		report.verticesBefore += result.before.vertices;
+		report.verticesAfter += result.vertexCount;
+		accumulate(report.before, result.before);
+		accumulate(report.after, result.after);
+
+		for(size_t i = 0; i < result.lodIndices.size(); ++i) {
+			if(report.lodTriangles.size() <= i) {
+				report.lodTriangles.emplace_back(0);
+				report.lodErrors.emplace_back(0.0f);
+			}
+			report.lodTriangles[i] += static_cast<uint32_t>(result.lodIndices[i].size() / 3);
+			report.lodErrors[i] = std::max(report.lodErrors[i], result.lodErrors[i]);
+		}
+
+		commit(scene, result, accessorUsers, viewUsers);
+	}
+
+	return reports;
+}
@@ -0,0 +1,108 @@
+//
+//  mesh_optimizer.hpp
+//  Vulkan_test
+//
+//  Created by Danny on 17/10/2026.
+//  Copyright © 2026 Danny. All rights reserved.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class JobSystem;
+struct GltfScene;
+
+// Post transform cache size of the gpus we care about, as far as a FIFO model goes.
+constexpr uint32_t vertex_cache_size = 16;
+
+struct VertexCacheStatistics
+{
+	uint32_t triangles = 0;
+	// Vertices referenced by the indices.
+	uint32_t vertices = 0;
+	// Vertices transformed, cache misses of a FIFO cache.
+	uint32_t transformed = 0;
+
+	// Average cache miss ratio, transforms per triangle. Ranges from about 0.5 on large regular grids to 3.
+	float acmr = 0;
+	// Average transform to vertex ratio, 1 when every vertex is transformed only once.
+	float atvr = 0;
+};
+
+VertexCacheStatistics analyzeVertexCache(const std::vector<uint32_t>& indices, uint32_t vertexCount, uint32_t cacheSize = vertex_cache_size);
+
+// One attribute of every vertex, size bytes each and stride bytes apart.
+struct VertexStream
+{
+	const void* data = nullptr;
+	uint32_t size = 0;
+	uint32_t stride = 0;
+};
+
+// Maps every vertex to its index among the unique vertices, in order of first use. Vertices equal in all streams
+// get the same index, vertices the indices don't reference get ~0u. Returns the number of unique vertices.
+uint32_t generateVertexRemap(std::vector<uint32_t>& remap, const std::vector<uint32_t>& indices, uint32_t vertexCount,
+							 const VertexStream* streams, uint32_t streamCount);
+// Maps vertices to the order the indices first use them, which is what the vertex fetch wants to see.
+uint32_t generateVertexFetchRemap(std::vector<uint32_t>& remap, const std::vector<uint32_t>& indices, uint32_t vertexCount);
+
+void remapIndices(std::vector<uint32_t>& indices, const std::vector<uint32_t>& remap);
+// Packs vertex v of the source (size bytes, stride apart) to remap[v] * size of the destination.
+void remapVertices(std::vector<uint8_t>& destination, const VertexStream& source, uint32_t vertexCount, const std::vector<uint32_t>& remap, uint32_t uniqueVertexCount);
+
+// Reorders triangles for the post transform cache with Tipsify (Sander et al., Fast Triangle Reordering for
+// Vertex Locality and Reduced Overdraw), which runs in linear time.
+void optimizeVertexCache(std::vector<uint32_t>& indices, uint32_t vertexCount, uint32_t cacheSize = vertex_cache_size);
+
+// Orders the triangles for the vertex cache, then splits them into clusters and sorts the clusters so the ones
+// facing outwards come first, which reduces overdraw from any direction. threshold is how much worse than the
+// cache order a cluster may get, 1.05 gives up at most 5% of transforms. positions are packed x, y, z.
+void optimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<float>& positions, uint32_t vertexCount,
+					  float threshold = 1.05f, uint32_t cacheSize = vertex_cache_size);
+
+// Quadric error edge collapse towards targetIndexCount, stopping early once the next collapse would move the
+// surface by more than targetError, relative to the size of the mesh. Vertices only ever collapse onto other
+// vertices, so the result indexes the same vertex buffer. Borders and attribute seams are kept as they are.
+std::vector<uint32_t> simplify(const std::vector<uint32_t>& indices, const std::vector<float>& positions, size_t targetIndexCount,
+							   float targetError, float* resultError = nullptr);
+
+struct MeshOptimizerSettings
+{
+	uint32_t cacheSize = vertex_cache_size;
+	float overdrawThreshold = 1.05f;
+
+	// Each level of detail aims for lodRatio of the triangles of the one before, until the error would pass
+	// maxLodError or a level would have fewer than minLodTriangles.
+	uint32_t maxLods = 4;
+	float lodRatio = 0.5f;
+	float maxLodError = 0.02f;
+	uint32_t minLodTriangles = 64;
+};
+
+struct MeshOptimizationReport
+{
+	int32_t mesh = -1;
+	std::string name;
+
+	// Triangle list primitives that were optimized, and the rest.
+	uint32_t optimizedPrimitives = 0;
+	uint32_t skippedPrimitives = 0;
+	uint32_t verticesBefore = 0;
+	uint32_t verticesAfter = 0;
+
+	VertexCacheStatistics before;
+	VertexCacheStatistics after;
+
+	// Triangles and error of each level of detail, summed and maxed over the primitives.
+	std::vector<uint32_t> lodTriangles;
+	std::vector<float> lodErrors;
+};
+
+// Deduplicates, reorders and simplifies every triangle list primitive of the scene. Rewritten data lives in
+// buffers the scene owns, accessors and buffer views only the primitive used are replaced in place. Levels of
+// detail end up in Primitive::lods. Meshes are processed in parallel with a job system.
+std::vector<MeshOptimizationReport> optimizeGltfMeshes(GltfScene&, const MeshOptimizerSettings& = MeshOptimizerSettings(), JobSystem* = nullptr);
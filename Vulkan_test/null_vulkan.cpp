@@ -0,0 +1,1669 @@
+//
+//  null_vulkan.cpp
+//  Vulkan_test
+//
+//  Created by Danny on 17/10/2026.
+//  Copyright © 2026 Danny. All rights reserved.
+//
+
+#ifdef __APPLE__
+#define VK_USE_PLATFORM_MACOS_MVK
+#endif
+
+#include "null_vulkan.hpp"
+#include "profiler.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <new>
+
+static_assert(sizeof(void*) == sizeof(uint64_t), "non-dispatchable handles have to be pointers to the null driver's objects");
+
+namespace {
+
+	// Every object the driver hands out, dispatchable or not, starts with its id.
+	std::atomic<uint64_t> nextObjectId {1};
+}
+
+struct NullObject
+{
+	uint64_t id = nextObjectId.fetch_add(1, std::memory_order_relaxed);
+};
+
+namespace {
+
+	struct CallSite
+	{
+		explicit CallSite(const char* name);
+
+		const char* name;
+		std::atomic<uint64_t> count {0};
+		std::atomic<uint64_t> nanoseconds {0};
+	};
+
+	struct CallSites
+	{
+		std::mutex mutex;
+		std::vector<CallSite*> sites;
+	};
+
+	// Call sites are function statics that register themselves on their first call, which may happen before main.
+	CallSites& getCallSites() {
+		static CallSites callSites;
+		return callSites;
+	}
+
+	CallSite::CallSite(const char* name) : name(name) {
+		auto& callSites = getCallSites();
+		std::lock_guard<std::mutex> lock(callSites.mutex);
+		callSites.sites.emplace_back(this);
+	}
+
+	// The counters of the frame in progress. Threads add to them without taking a lock, ending the frame takes
+	// each of them out on its own, so a call racing with the end of a frame may be split between both frames.
+	struct FrameCounters
+	{
+		std::atomic<uint64_t> calls {0};
+		std::atomic<uint64_t> nanoseconds {0};
+		std::atomic<uint64_t> objectsCreated {0};
+		std::atomic<uint64_t> objectsDestroyed {0};
+		std::atomic<uint64_t> memoryAllocations {0};
+		std::atomic<uint64_t> memoryFrees {0};
+		std::atomic<uint64_t> bytesAllocated {0};
+		std::atomic<uint64_t> bytesFreed {0};
+		std::atomic<uint64_t> descriptorSetsAllocated {0};
+		std::atomic<uint64_t> descriptorWrites {0};
+		std::atomic<uint64_t> descriptors {0};
+		std::atomic<uint64_t> commands {0};
+		std::atomic<uint64_t> submits {0};
+		std::atomic<uint64_t> commandBuffersSubmitted {0};
+
+		NullVulkanFrame get(bool reset) {
+			auto take = [reset](std::atomic<uint64_t>& counter) {
+				return reset ? counter.exchange(0, std::memory_order_relaxed) : counter.load(std::memory_order_relaxed);
+			};
+
+			NullVulkanFrame frame;
+			frame.calls = take(calls);
+			frame.nanoseconds = take(nanoseconds);
+			frame.objectsCreated = take(objectsCreated);
+			frame.objectsDestroyed = take(objectsDestroyed);
+			frame.memoryAllocations = take(memoryAllocations);
+			frame.memoryFrees = take(memoryFrees);
+			frame.bytesAllocated = take(bytesAllocated);
+			frame.bytesFreed = take(bytesFreed);
+			frame.descriptorSetsAllocated = take(descriptorSetsAllocated);
+			frame.descriptorWrites = take(descriptorWrites);
+			frame.descriptors = take(descriptors);
+			frame.commands = take(commands);
+			frame.submits = take(submits);
+			frame.commandBuffersSubmitted = take(commandBuffersSubmitted);
+			return frame;
+		}
+	};
+
+	FrameCounters currentFrame;
+
+	std::mutex framesMutex;
+	std::vector<NullVulkanFrame> frames;
+
+	std::mutex submissionsMutex;
+	std::atomic<bool> captureSubmissions {false};
+	std::vector<NullSubmission> submissions;
+
+	// Without a swapchain frames end with fenced submissions instead of presents.
+	std::atomic<uint32_t> liveSwapchains {0};
+
+	void add(std::atomic<uint64_t>& counter, uint64_t value = 1) {
+		counter.fetch_add(value, std::memory_order_relaxed);
+	}
+
+	void endFrame() {
+		const auto frame = currentFrame.get(true);
+		std::lock_guard<std::mutex> lock(framesMutex);
+		frames.emplace_back(frame);
+	}
+
+	class CallTimer {
+	public:
+		explicit CallTimer(CallSite& site) : site(site), start(Profiler::now()) {}
+		~CallTimer() {
+			const auto elapsed = Profiler::now() - start;
+			add(site.count);
+			add(site.nanoseconds, elapsed);
+			add(currentFrame.calls);
+			add(currentFrame.nanoseconds, elapsed);
+		}
+
+		CallTimer(const CallTimer&) = delete;
+		CallTimer& operator=(const CallTimer&) = delete;
+
+	private:
+		CallSite& site;
+		uint64_t start;
+	};
+}
+
+// Opens every entry point, counts and times it under its own name.
+#define NULL_VULKAN_CALL() static CallSite nullCallSite(__func__); CallTimer nullCallTimer(nullCallSite)
+
+// The objects behind the handles. The loader would expect its dispatch table at the start of dispatchable ones,
+// there is no loader here.
+
+struct VkPhysicalDevice_T: NullObject
+{
+};
+
+struct VkInstance_T: NullObject
+{
+	VkPhysicalDevice_T physicalDevice;
+};
+
+struct VkSurfaceKHR_T: NullObject
+{
+	VkExtent2D extent {1280, 720};
+};
+
+struct VkQueue_T: NullObject
+{
+	uint32_t family = 0;
+};
+
+struct VkDevice_T: NullObject
+{
+	std::vector<std::vector<std::unique_ptr<VkQueue_T>>> queues;
+};
+
+struct VkCommandPool_T;
+
+struct VkCommandBuffer_T: NullObject
+{
+	VkCommandPool_T* pool = nullptr;
+	VkCommandBufferLevel level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	std::vector<NullCommand> commands;
+	// The secondary command buffers of each EXECUTE_COMMANDS in order, to inline them into captured submissions.
+	std::vector<VkCommandBuffer_T*> executed;
+
+	void reset() {
+		commands.clear();
+		executed.clear();
+	}
+
+	void record(NullCommandType type, uint64_t a = 0, uint64_t b = 0, uint64_t c = 0, uint64_t d = 0, uint64_t e = 0) {
+		commands.emplace_back();
+		auto& command = commands.back();
+		command.type = type;
+		command.arguments[0] = a;
+		command.arguments[1] = b;
+		command.arguments[2] = c;
+		command.arguments[3] = d;
+		command.arguments[4] = e;
+	}
+};
+
+struct VkCommandPool_T: NullObject
+{
+	uint32_t family = 0;
+	std::vector<VkCommandBuffer_T*> commandBuffers;
+};
+
+struct VkSemaphore_T: NullObject
+{
+	bool timeline = false;
+	std::atomic<uint64_t> value {0};
+};
+
+struct VkFence_T: NullObject
+{
+	std::atomic<bool> signaled {false};
+};
+
+struct VkDeviceMemory_T: NullObject
+{
+	VkDeviceSize size = 0;
+	uint32_t heap = 0;
+	// Only host visible memory has contents.
+	std::unique_ptr<uint8_t[]> contents;
+};
+
+struct VkImage_T: NullObject
+{
+	VkDeviceSize size = 0;
+	bool swapchain = false;
+};
+
+struct VkBuffer_T: NullObject
+{
+	VkDeviceSize size = 0;
+};
+
+struct VkSwapchainKHR_T: NullObject
+{
+	std::vector<std::unique_ptr<VkImage_T>> images;
+	uint32_t nextImage = 0;
+};
+
+struct VkImageView_T: NullObject {};
+struct VkSampler_T: NullObject {};
+struct VkShaderModule_T: NullObject {};
+struct VkRenderPass_T: NullObject {};
+struct VkFramebuffer_T: NullObject {};
+struct VkPipelineLayout_T: NullObject {};
+struct VkPipeline_T: NullObject {};
+struct VkPipelineCache_T: NullObject {};
+struct VkDescriptorSetLayout_T: NullObject {};
+struct VkDescriptorSet_T: NullObject {};
+
+struct VkDescriptorPool_T: NullObject
+{
+	uint32_t maxSets = 0;
+	std::vector<VkDescriptorSet_T*> sets;
+};
+
+struct VkQueryPool_T: NullObject
+{
+	uint32_t count = 0;
+};
+
+namespace {
+
+	const uint8_t deviceUUID[VK_UUID_SIZE] = {'n', 'u', 'l', 'l', '-', 'v', 'u', 'l', 'k', 'a', 'n', '-', 'g', 'p', 'u', 0};
+	const uint8_t driverUUID[VK_UUID_SIZE] = {'n', 'u', 'l', 'l', '-', 'v', 'u', 'l', 'k', 'a', 'n', '-', 'd', 'r', 'v', 0};
+	const uint32_t vendorID = 0x10000;
+	const uint32_t deviceID = 1;
+
+	// A desktop gpu: 8GB of video memory, host memory, and a 256MB window into video memory the cpu can write.
+	const VkDeviceSize heapSizes[] = {8ull << 30, 16ull << 30, 256ull << 20};
+	std::atomic<uint64_t> heapUsage[3];
+
+	struct MemoryType
+	{
+		VkMemoryPropertyFlags flags;
+		uint32_t heap;
+	};
+
+	const MemoryType memoryTypes[] = {
+		{VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0},
+		{VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, 1},
+		{VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT, 1},
+		{VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, 2}
+	};
+	const uint32_t memoryTypeCount = sizeof(memoryTypes) / sizeof(memoryTypes[0]);
+
+	// Like most desktop drivers optimally tiled images can't live in host memory.
+	const uint32_t bufferMemoryTypeBits = 0xf;
+	const uint32_t imageMemoryTypeBits = 0x9;
+
+	// A graphics family, an async compute family and a copy engine.
+	const VkQueueFamilyProperties queueFamilies[] = {
+		{VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT | VK_QUEUE_TRANSFER_BIT, 1, 64, {1, 1, 1}},
+		{VK_QUEUE_COMPUTE_BIT | VK_QUEUE_TRANSFER_BIT, 2, 64, {1, 1, 1}},
+		{VK_QUEUE_TRANSFER_BIT, 2, 64, {1, 1, 1}}
+	};
+	const uint32_t queueFamilyCount = sizeof(queueFamilies) / sizeof(queueFamilies[0]);
+
+	// The two call idiom of every vkEnumerate and vkGet...s function.
+	template<typename T>
+	VkResult enumerate(const T* values, uint32_t count, uint32_t* pCount, T* pValues) {
+		if(!pValues) {
+			*pCount = count;
+			return VK_SUCCESS;
+		}
+
+		const auto copied = std::min(*pCount, count);
+		std::copy(values, values + copied, pValues);
+		*pCount = copied;
+		return copied < count ? VK_INCOMPLETE : VK_SUCCESS;
+	}
+
+	template<typename T>
+	T* create() {
+		add(currentFrame.objectsCreated);
+		return new T();
+	}
+
+	template<typename T>
+	void destroy(T* object) {
+		if(!object)
+			return;
+
+		add(currentFrame.objectsDestroyed);
+		delete object;
+	}
+
+	uint64_t getId(const NullObject* object) {
+		return object ? object->id : 0;
+	}
+
+	VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment) {
+		return (value + alignment - 1) / alignment * alignment;
+	}
+
+	// Bits per texel, close enough for memory statistics without a table of every format.
+	uint32_t getBitsPerTexel(VkFormat format) {
+		if(format == VK_FORMAT_BC1_RGB_UNORM_BLOCK || format == VK_FORMAT_BC1_RGB_SRGB_BLOCK || format == VK_FORMAT_BC1_RGBA_UNORM_BLOCK ||
+		   format == VK_FORMAT_BC1_RGBA_SRGB_BLOCK || format == VK_FORMAT_BC4_UNORM_BLOCK || format == VK_FORMAT_BC4_SNORM_BLOCK)
+			return 4;
+		if(format >= VK_FORMAT_BC2_UNORM_BLOCK && format <= VK_FORMAT_BC7_SRGB_BLOCK)
+			return 8;
+		if(format >= VK_FORMAT_R8_UNORM && format <= VK_FORMAT_R8_SRGB)
+			return 8;
+		if(format >= VK_FORMAT_R16G16B16A16_UNORM && format <= VK_FORMAT_R16G16B16A16_SFLOAT)
+			return 64;
+		if(format >= VK_FORMAT_R32G32B32A32_UINT && format <= VK_FORMAT_R32G32B32A32_SFLOAT)
+			return 128;
+		if(format == VK_FORMAT_D32_SFLOAT_S8_UINT)
+			return 64;
+		return 32;
+	}
+
+	VkDeviceSize getImageSize(const VkImageCreateInfo& info) {
+		VkDeviceSize size = 0;
+		for(uint32_t level = 0; level < info.mipLevels; ++level) {
+			const VkDeviceSize width = std::max(info.extent.width >> level, 1u);
+			const VkDeviceSize height = std::max(info.extent.height >> level, 1u);
+			const VkDeviceSize depth = std::max(info.extent.depth >> level, 1u);
+			size += (width * height * depth * getBitsPerTexel(info.format) + 7) / 8;
+		}
+		return alignUp(size * info.arrayLayers * info.samples, 4096);
+	}
+
+	void setAll(VkBool32* first, VkBool32* last) {
+		std::fill(first, last + 1, VK_TRUE);
+	}
+
+	VkPhysicalDeviceLimits getLimits() {
+		VkPhysicalDeviceLimits limits = {};
+		limits.maxImageDimension1D = 16384;
+		limits.maxImageDimension2D = 16384;
+		limits.maxImageDimension3D = 2048;
+		limits.maxImageDimensionCube = 16384;
+		limits.maxImageArrayLayers = 2048;
+		limits.maxTexelBufferElements = 1u << 27;
+		limits.maxUniformBufferRange = 65536;
+		limits.maxStorageBufferRange = 1u << 31;
+		limits.maxPushConstantsSize = 256;
+		limits.maxMemoryAllocationCount = 4096;
+		limits.maxSamplerAllocationCount = 4000;
+		limits.bufferImageGranularity = 1024;
+		limits.maxBoundDescriptorSets = 32;
+		limits.maxPerStageDescriptorSamplers = 1u << 20;
+		limits.maxPerStageDescriptorUniformBuffers = 1u << 20;
+		limits.maxPerStageDescriptorStorageBuffers = 1u << 20;
+		limits.maxPerStageDescriptorSampledImages = 1u << 20;
+		limits.maxPerStageDescriptorStorageImages = 1u << 20;
+		limits.maxPerStageDescriptorInputAttachments = 1u << 20;
+		limits.maxPerStageResources = 1u << 20;
+		limits.maxDescriptorSetSamplers = 1u << 20;
+		limits.maxDescriptorSetUniformBuffers = 1u << 20;
+		limits.maxDescriptorSetUniformBuffersDynamic = 15;
+		limits.maxDescriptorSetStorageBuffers = 1u << 20;
+		limits.maxDescriptorSetStorageBuffersDynamic = 16;
+		limits.maxDescriptorSetSampledImages = 1u << 20;
+		limits.maxDescriptorSetStorageImages = 1u << 20;
+		limits.maxDescriptorSetInputAttachments = 1u << 20;
+		limits.maxVertexInputAttributes = 32;
+		limits.maxVertexInputBindings = 32;
+		limits.maxVertexInputAttributeOffset = 2047;
+		limits.maxVertexInputBindingStride = 2048;
+		limits.maxVertexOutputComponents = 128;
+		limits.maxFragmentInputComponents = 128;
+		limits.maxFragmentOutputAttachments = 8;
+		limits.maxFragmentCombinedOutputResources = 1u << 20;
+		limits.maxComputeSharedMemorySize = 49152;
+		limits.maxComputeWorkGroupCount[0] = 1u << 31;
+		limits.maxComputeWorkGroupCount[1] = 65535;
+		limits.maxComputeWorkGroupCount[2] = 65535;
+		limits.maxComputeWorkGroupInvocations = 1024;
+		limits.maxComputeWorkGroupSize[0] = 1024;
+		limits.maxComputeWorkGroupSize[1] = 1024;
+		limits.maxComputeWorkGroupSize[2] = 64;
+		limits.maxDrawIndexedIndexValue = ~0u;
+		limits.maxDrawIndirectCount = ~0u;
+		limits.maxSamplerLodBias = 16;
+		limits.maxSamplerAnisotropy = 16;
+		limits.maxViewports = 16;
+		limits.maxViewportDimensions[0] = 16384;
+		limits.maxViewportDimensions[1] = 16384;
+		limits.viewportBoundsRange[0] = -32768;
+		limits.viewportBoundsRange[1] = 32767;
+		limits.minMemoryMapAlignment = 64;
+		limits.minTexelBufferOffsetAlignment = 16;
+		limits.minUniformBufferOffsetAlignment = 64;
+		limits.minStorageBufferOffsetAlignment = 16;
+		limits.maxFramebufferWidth = 16384;
+		limits.maxFramebufferHeight = 16384;
+		limits.maxFramebufferLayers = 2048;
+		limits.framebufferColorSampleCounts = VK_SAMPLE_COUNT_1_BIT | VK_SAMPLE_COUNT_2_BIT | VK_SAMPLE_COUNT_4_BIT | VK_SAMPLE_COUNT_8_BIT;
+		limits.framebufferDepthSampleCounts = limits.framebufferColorSampleCounts;
+		limits.framebufferStencilSampleCounts = limits.framebufferColorSampleCounts;
+		limits.framebufferNoAttachmentsSampleCounts = limits.framebufferColorSampleCounts;
+		limits.maxColorAttachments = 8;
+		limits.sampledImageColorSampleCounts = limits.framebufferColorSampleCounts;
+		limits.sampledImageIntegerSampleCounts = limits.framebufferColorSampleCounts;
+		limits.sampledImageDepthSampleCounts = limits.framebufferColorSampleCounts;
+		limits.sampledImageStencilSampleCounts = limits.framebufferColorSampleCounts;
+		limits.storageImageSampleCounts = limits.framebufferColorSampleCounts;
+		limits.maxSampleMaskWords = 1;
+		limits.timestampComputeAndGraphics = VK_TRUE;
+		limits.timestampPeriod = 1;
+		limits.maxClipDistances = 8;
+		limits.maxCullDistances = 8;
+		limits.maxCombinedClipAndCullDistances = 8;
+		limits.discreteQueuePriorities = 2;
+		limits.pointSizeRange[0] = 1;
+		limits.pointSizeRange[1] = 2048;
+		limits.lineWidthRange[0] = 1;
+		limits.lineWidthRange[1] = 64;
+		limits.pointSizeGranularity = 0.125f;
+		limits.lineWidthGranularity = 0.125f;
+		limits.optimalBufferCopyOffsetAlignment = 1;
+		limits.optimalBufferCopyRowPitchAlignment = 1;
+		limits.nonCoherentAtomSize = 64;
+		return limits;
+	}
+
+	VkPhysicalDeviceProperties getProperties() {
+		VkPhysicalDeviceProperties properties = {};
+		properties.apiVersion = VK_API_VERSION_1_2;
+		properties.driverVersion = 1;
+		properties.vendorID = vendorID;
+		properties.deviceID = deviceID;
+		properties.deviceType = VK_PHYSICAL_DEVICE_TYPE_OTHER;
+		std::strncpy(properties.deviceName, "Null Device", VK_MAX_PHYSICAL_DEVICE_NAME_SIZE - 1);
+		std::memcpy(properties.pipelineCacheUUID, deviceUUID, VK_UUID_SIZE);
+		properties.limits = getLimits();
+		return properties;
+	}
+
+	void fillVulkan12Properties(VkPhysicalDeviceVulkan12Properties& properties) {
+		std::strncpy(properties.driverName, "null", VK_MAX_DRIVER_NAME_SIZE - 1);
+		std::strncpy(properties.driverInfo, "records instead of rendering", VK_MAX_DRIVER_INFO_SIZE - 1);
+		properties.maxUpdateAfterBindDescriptorsInAllPools = 1u << 20;
+		properties.shaderSampledImageArrayNonUniformIndexingNative = VK_TRUE;
+		properties.shaderStorageBufferArrayNonUniformIndexingNative = VK_TRUE;
+		properties.maxPerStageDescriptorUpdateAfterBindSamplers = 1u << 20;
+		properties.maxPerStageDescriptorUpdateAfterBindUniformBuffers = 1u << 20;
+		properties.maxPerStageDescriptorUpdateAfterBindStorageBuffers = 1u << 20;
+		properties.maxPerStageDescriptorUpdateAfterBindSampledImages = 1u << 20;
+		properties.maxPerStageDescriptorUpdateAfterBindStorageImages = 1u << 20;
+		properties.maxPerStageDescriptorUpdateAfterBindInputAttachments = 1u << 20;
+		properties.maxPerStageUpdateAfterBindResources = 1u << 20;
+		properties.maxDescriptorSetUpdateAfterBindSamplers = 1u << 20;
+		properties.maxDescriptorSetUpdateAfterBindUniformBuffers = 1u << 20;
+		properties.maxDescriptorSetUpdateAfterBindUniformBuffersDynamic = 15;
+		properties.maxDescriptorSetUpdateAfterBindStorageBuffers = 1u << 20;
+		properties.maxDescriptorSetUpdateAfterBindStorageBuffersDynamic = 16;
+		properties.maxDescriptorSetUpdateAfterBindSampledImages = 1u << 20;
+		properties.maxDescriptorSetUpdateAfterBindStorageImages = 1u << 20;
+		properties.maxDescriptorSetUpdateAfterBindInputAttachments = 1u << 20;
+		properties.maxTimelineSemaphoreValueDifference = ~0ull;
+	}
+
+	void signal(VkSemaphore semaphore, uint64_t value) {
+		if(!semaphore)
+			return;
+
+		// Binary semaphores are signaled and waited on in pairs, which completes right away as well.
+		if(semaphore->timeline)
+			semaphore->value.store(std::max(semaphore->value.load(), value));
+		else
+			semaphore->value.store(1);
+	}
+
+	// Everything that was submitted has completed, anything else would only ever complete on the host.
+	VkResult wait(bool complete, uint64_t timeout) {
+		return complete || timeout ? VK_SUCCESS : VK_TIMEOUT;
+	}
+
+	void capture(const VkCommandBuffer_T& commandBuffer, std::vector<NullCommand>& commands) {
+		size_t executed = 0;
+		for(const auto& command: commandBuffer.commands) {
+			commands.emplace_back(command);
+			if(command.type != NullCommandType::EXECUTE_COMMANDS)
+				continue;
+
+			for(uint64_t i = 0; i < command.arguments[0] && executed < commandBuffer.executed.size(); ++i)
+				capture(*commandBuffer.executed[executed++], commands);
+		}
+	}
+
+	uint64_t countCommands(const VkCommandBuffer_T& commandBuffer) {
+		uint64_t count = commandBuffer.commands.size();
+		for(const auto secondary: commandBuffer.executed)
+			count += countCommands(*secondary);
+		return count;
+	}
+
+	// Any resource can share its memory.
+	void setDedicatedRequirements(void* pNext) {
+		for(auto next = static_cast<VkBaseOutStructure*>(pNext); next; next = next->pNext) {
+			if(next->sType != VK_STRUCTURE_TYPE_MEMORY_DEDICATED_REQUIREMENTS)
+				continue;
+
+			auto& requirements = *reinterpret_cast<VkMemoryDedicatedRequirements*>(next);
+			requirements.prefersDedicatedAllocation = VK_FALSE;
+			requirements.requiresDedicatedAllocation = VK_FALSE;
+		}
+	}
+}
+
+extern "C" {
+
+// Instance and physical device
+
+VKAPI_ATTR VkResult VKAPI_CALL vkCreateInstance(const VkInstanceCreateInfo*, const VkAllocationCallbacks*, VkInstance* pInstance) {
+	NULL_VULKAN_CALL();
+	*pInstance = create<VkInstance_T>();
+	return VK_SUCCESS;
+}
+
+VKAPI_ATTR void VKAPI_CALL vkDestroyInstance(VkInstance instance, const VkAllocationCallbacks*) {
+	NULL_VULKAN_CALL();
+	destroy(instance);
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkEnumerateInstanceVersion(uint32_t* pApiVersion) {
+	NULL_VULKAN_CALL();
+	*pApiVersion = VK_API_VERSION_1_2;
+	return VK_SUCCESS;
+}
+
+// No layers, the validation layer needs a loader to sit behind.
+VKAPI_ATTR VkResult VKAPI_CALL vkEnumerateInstanceLayerProperties(uint32_t* pPropertyCount, VkLayerProperties* pProperties) {
+	NULL_VULKAN_CALL();
+	return enumerate<VkLayerProperties>(nullptr, 0, pPropertyCount, pProperties);
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkEnumerateInstanceExtensionProperties(const char*, uint32_t* pPropertyCount, VkExtensionProperties* pProperties) {
+	NULL_VULKAN_CALL();
+	std::vector<VkExtensionProperties> extensions(1);
+	std::strncpy(extensions[0].extensionName, "VK_KHR_surface", VK_MAX_EXTENSION_NAME_SIZE - 1);
+	extensions[0].specVersion = 25;
+#ifdef __APPLE__
+	extensions.emplace_back();
+	std::strncpy(extensions[1].extensionName, "VK_MVK_macos_surface", VK_MAX_EXTENSION_NAME_SIZE - 1);
+	extensions[1].specVersion = 3;
+#endif
+	return enumerate(extensions.data(), static_cast<uint32_t>(extensions.size()), pPropertyCount, pProperties);
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkEnumeratePhysicalDevices(VkInstance instance, uint32_t* pPhysicalDeviceCount, VkPhysicalDevice* pPhysicalDevices) {
+	NULL_VULKAN_CALL();
+	const VkPhysicalDevice physicalDevice = &instance->physicalDevice;
+	return enumerate(&physicalDevice, 1, pPhysicalDeviceCount, pPhysicalDevices);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkGetPhysicalDeviceProperties(VkPhysicalDevice, VkPhysicalDeviceProperties* pProperties) {
+	NULL_VULKAN_CALL();
+	*pProperties = getProperties();
+}
+
+VKAPI_ATTR void VKAPI_CALL vkGetPhysicalDeviceProperties2(VkPhysicalDevice, VkPhysicalDeviceProperties2* pProperties) {
+	NULL_VULKAN_CALL();
+	pProperties->properties = getProperties();
+
+	for(auto next = static_cast<VkBaseOutStructure*>(pProperties->pNext); next; next = next->pNext) {
+		switch(next->sType) {
+			case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ID_PROPERTIES: {
+				auto& ids = *reinterpret_cast<VkPhysicalDeviceIDProperties*>(next);
+				std::memcpy(ids.deviceUUID, deviceUUID, VK_UUID_SIZE);
+				std::memcpy(ids.driverUUID, driverUUID, VK_UUID_SIZE);
+				ids.deviceLUIDValid = VK_FALSE;
+				break;
+			}
+			case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_1_PROPERTIES: {
+				auto& properties = *reinterpret_cast<VkPhysicalDeviceVulkan11Properties*>(next);
+				std::memcpy(properties.deviceUUID, deviceUUID, VK_UUID_SIZE);
+				std::memcpy(properties.driverUUID, driverUUID, VK_UUID_SIZE);
+				properties.subgroupSize = 32;
+				properties.subgroupSupportedStages = VK_SHADER_STAGE_ALL;
+				properties.subgroupSupportedOperations = VK_SUBGROUP_FEATURE_BASIC_BIT | VK_SUBGROUP_FEATURE_VOTE_BIT | VK_SUBGROUP_FEATURE_ARITHMETIC_BIT |
+				VK_SUBGROUP_FEATURE_BALLOT_BIT | VK_SUBGROUP_FEATURE_SHUFFLE_BIT;
+				properties.maxMultiviewViewCount = 32;
+				properties.maxMultiviewInstanceIndex = ~0u >> 5;
+				properties.maxPerSetDescriptors = 1u << 20;
+				properties.maxMemoryAllocationSize = heapSizes[0];
+				break;
+			}
+			case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_PROPERTIES:
+				fillVulkan12Properties(*reinterpret_cast<VkPhysicalDeviceVulkan12Properties*>(next));
+				break;
+			default:
+				break;
+		}
+	}
+}
+
+VKAPI_ATTR void VKAPI_CALL vkGetPhysicalDeviceFeatures(VkPhysicalDevice, VkPhysicalDeviceFeatures* pFeatures) {
+	NULL_VULKAN_CALL();
+	setAll(&pFeatures->robustBufferAccess, &pFeatures->inheritedQueries);
+}
+
+// Everything is supported, nothing is ever executed.
+VKAPI_ATTR void VKAPI_CALL vkGetPhysicalDeviceFeatures2(VkPhysicalDevice, VkPhysicalDeviceFeatures2* pFeatures) {
+	NULL_VULKAN_CALL();
+	setAll(&pFeatures->features.robustBufferAccess, &pFeatures->features.inheritedQueries);
+
+	for(auto next = static_cast<VkBaseOutStructure*>(pFeatures->pNext); next; next = next->pNext) {
+		switch(next->sType) {
+			case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_1_FEATURES: {
+				auto& features = *reinterpret_cast<VkPhysicalDeviceVulkan11Features*>(next);
+				setAll(&features.storageBuffer16BitAccess, &features.shaderDrawParameters);
+				break;
+			}
+			case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES: {
+				auto& features = *reinterpret_cast<VkPhysicalDeviceVulkan12Features*>(next);
+				setAll(&features.samplerMirrorClampToEdge, &features.subgroupBroadcastDynamicId);
+				break;
+			}
+			default:
+				break;
+		}
+	}
+}
+
+VKAPI_ATTR void VKAPI_CALL vkGetPhysicalDeviceQueueFamilyProperties(VkPhysicalDevice, uint32_t* pQueueFamilyPropertyCount, VkQueueFamilyProperties* pQueueFamilyProperties) {
+	NULL_VULKAN_CALL();
+	enumerate(queueFamilies, queueFamilyCount, pQueueFamilyPropertyCount, pQueueFamilyProperties);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkGetPhysicalDeviceMemoryProperties(VkPhysicalDevice, VkPhysicalDeviceMemoryProperties* pMemoryProperties) {
+	NULL_VULKAN_CALL();
+	*pMemoryProperties = {};
+	pMemoryProperties->memoryTypeCount = memoryTypeCount;
+	for(uint32_t i = 0; i < memoryTypeCount; ++i) {
+		pMemoryProperties->memoryTypes[i].propertyFlags = memoryTypes[i].flags;
+		pMemoryProperties->memoryTypes[i].heapIndex = memoryTypes[i].heap;
+	}
+
+	pMemoryProperties->memoryHeapCount = 3;
+	for(uint32_t i = 0; i < 3; ++i) {
+		pMemoryProperties->memoryHeaps[i].size = heapSizes[i];
+		pMemoryProperties->memoryHeaps[i].flags = i == 1 ? 0 : VK_MEMORY_HEAP_DEVICE_LOCAL_BIT;
+	}
+}
+
+VKAPI_ATTR void VKAPI_CALL vkGetPhysicalDeviceFormatProperties(VkPhysicalDevice, VkFormat, VkFormatProperties* pFormatProperties) {
+	NULL_VULKAN_CALL();
+	pFormatProperties->linearTilingFeatures = ~VkFormatFeatureFlags(0);
+	pFormatProperties->optimalTilingFeatures = ~VkFormatFeatureFlags(0);
+	pFormatProperties->bufferFeatures = ~VkFormatFeatureFlags(0);
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkEnumerateDeviceExtensionProperties(VkPhysicalDevice, const char*, uint32_t* pPropertyCount, VkExtensionProperties* pProperties) {
+	NULL_VULKAN_CALL();
+	VkExtensionProperties swapchain = {};
+	std::strncpy(swapchain.extensionName, VK_KHR_SWAPCHAIN_EXTENSION_NAME, VK_MAX_EXTENSION_NAME_SIZE - 1);
+	swapchain.specVersion = 70;
+	return enumerate(&swapchain, 1, pPropertyCount, pProperties);
+}
+
+// Surfaces
+
+#ifdef __APPLE__
+VKAPI_ATTR VkResult VKAPI_CALL vkCreateMacOSSurfaceMVK(VkInstance, const VkMacOSSurfaceCreateInfoMVK*, const VkAllocationCallbacks*, VkSurfaceKHR* pSurface) {
+	NULL_VULKAN_CALL();
+	*pSurface = create<VkSurfaceKHR_T>();
+	return VK_SUCCESS;
+}
+#endif
+
+VKAPI_ATTR void VKAPI_CALL vkDestroySurfaceKHR(VkInstance, VkSurfaceKHR surface, const VkAllocationCallbacks*) {
+	NULL_VULKAN_CALL();
+	destroy(surface);
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkGetPhysicalDeviceSurfaceSupportKHR(VkPhysicalDevice, uint32_t queueFamilyIndex, VkSurfaceKHR, VkBool32* pSupported) {
+	NULL_VULKAN_CALL();
+	*pSupported = queueFamilyIndex == 0 ? VK_TRUE : VK_FALSE;
+	return VK_SUCCESS;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkGetPhysicalDeviceSurfaceCapabilitiesKHR(VkPhysicalDevice, VkSurfaceKHR surface, VkSurfaceCapabilitiesKHR* pSurfaceCapabilities) {
+	NULL_VULKAN_CALL();
+	*pSurfaceCapabilities = {};
+	pSurfaceCapabilities->minImageCount = 2;
+	pSurfaceCapabilities->maxImageCount = 8;
+	pSurfaceCapabilities->currentExtent = surface->extent;
+	pSurfaceCapabilities->minImageExtent = {1, 1};
+	pSurfaceCapabilities->maxImageExtent = {16384, 16384};
+	pSurfaceCapabilities->maxImageArrayLayers = 1;
+	pSurfaceCapabilities->supportedTransforms = VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR;
+	pSurfaceCapabilities->currentTransform = VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR;
+	pSurfaceCapabilities->supportedCompositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
+	pSurfaceCapabilities->supportedUsageFlags = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+	return VK_SUCCESS;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkGetPhysicalDeviceSurfaceFormatsKHR(VkPhysicalDevice, VkSurfaceKHR, uint32_t* pSurfaceFormatCount, VkSurfaceFormatKHR* pSurfaceFormats) {
+	NULL_VULKAN_CALL();
+	const VkSurfaceFormatKHR formats[] = {
+		{VK_FORMAT_B8G8R8A8_UNORM, VK_COLOR_SPACE_SRGB_NONLINEAR_KHR},
+		{VK_FORMAT_B8G8R8A8_SRGB, VK_COLOR_SPACE_SRGB_NONLINEAR_KHR}
+	};
+	return enumerate(formats, 2, pSurfaceFormatCount, pSurfaceFormats);
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkGetPhysicalDeviceSurfacePresentModesKHR(VkPhysicalDevice, VkSurfaceKHR, uint32_t* pPresentModeCount, VkPresentModeKHR* pPresentModes) {
+	NULL_VULKAN_CALL();
+	const VkPresentModeKHR modes[] = {VK_PRESENT_MODE_FIFO_KHR, VK_PRESENT_MODE_MAILBOX_KHR, VK_PRESENT_MODE_IMMEDIATE_KHR};
+	return enumerate(modes, 3, pPresentModeCount, pPresentModes);
+}
+
+// Device and queues
+
+VKAPI_ATTR VkResult VKAPI_CALL vkCreateDevice(VkPhysicalDevice, const VkDeviceCreateInfo* pCreateInfo, const VkAllocationCallbacks*, VkDevice* pDevice) {
+	NULL_VULKAN_CALL();
+	auto device = create<VkDevice_T>();
+	device->queues.resize(queueFamilyCount);
+	for(uint32_t i = 0; i < pCreateInfo->queueCreateInfoCount; ++i) {
+		const auto& info = pCreateInfo->pQueueCreateInfos[i];
+		auto& queues = device->queues[info.queueFamilyIndex];
+		for(uint32_t j = 0; j < info.queueCount; ++j) {
+			queues.emplace_back(new VkQueue_T());
+			queues.back()->family = info.queueFamilyIndex;
+		}
+	}
+
+	*pDevice = device;
+	return VK_SUCCESS;
+}
+
+VKAPI_ATTR void VKAPI_CALL vkDestroyDevice(VkDevice device, const VkAllocationCallbacks*) {
+	NULL_VULKAN_CALL();
+	destroy(device);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkGetDeviceQueue(VkDevice device, uint32_t queueFamilyIndex, uint32_t queueIndex, VkQueue* pQueue) {
+	NULL_VULKAN_CALL();
+	*pQueue = device->queues[queueFamilyIndex][queueIndex].get();
+}
+
+// Only extensions the driver doesn't advertise are looked up, e.g. present wait.
+VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL vkGetDeviceProcAddr(VkDevice, const char*) {
+	NULL_VULKAN_CALL();
+	return nullptr;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkDeviceWaitIdle(VkDevice) {
+	NULL_VULKAN_CALL();
+	return VK_SUCCESS;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkQueueWaitIdle(VkQueue) {
+	NULL_VULKAN_CALL();
+	return VK_SUCCESS;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkQueueSubmit(VkQueue queue, uint32_t submitCount, const VkSubmitInfo* pSubmits, VkFence fence) {
+	NULL_VULKAN_CALL();
+	for(uint32_t i = 0; i < submitCount; ++i) {
+		const auto& submit = pSubmits[i];
+
+		const VkTimelineSemaphoreSubmitInfo* timelineInfo = nullptr;
+		for(auto next = static_cast<const VkBaseInStructure*>(submit.pNext); next; next = next->pNext)
+			if(next->sType == VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO)
+				timelineInfo = reinterpret_cast<const VkTimelineSemaphoreSubmitInfo*>(next);
+
+		for(uint32_t j = 0; j < submit.commandBufferCount; ++j) {
+			const auto& commandBuffer = *submit.pCommandBuffers[j];
+			add(currentFrame.commands, countCommands(commandBuffer));
+
+			if(captureSubmissions.load(std::memory_order_relaxed)) {
+				NullSubmission submission;
+				submission.queueFamily = queue->family;
+				submission.commandBuffer = commandBuffer.id;
+				capture(commandBuffer, submission.commands);
+
+				std::lock_guard<std::mutex> lock(submissionsMutex);
+				submissions.emplace_back(std::move(submission));
+			}
+		}
+
+		for(uint32_t j = 0; j < submit.signalSemaphoreCount; ++j) {
+			const bool hasValue = timelineInfo && timelineInfo->pSignalSemaphoreValues && j < timelineInfo->signalSemaphoreValueCount;
+			signal(submit.pSignalSemaphores[j], hasValue ? timelineInfo->pSignalSemaphoreValues[j] : 0);
+		}
+
+		add(currentFrame.submits);
+		add(currentFrame.commandBuffersSubmitted, submit.commandBufferCount);
+	}
+
+	if(fence) {
+		fence->signaled.store(true);
+		if(liveSwapchains.load() == 0)
+			endFrame();
+	}
+	return VK_SUCCESS;
+}
+
+// Command pools and buffers
+
+VKAPI_ATTR VkResult VKAPI_CALL vkCreateCommandPool(VkDevice, const VkCommandPoolCreateInfo* pCreateInfo, const VkAllocationCallbacks*, VkCommandPool* pCommandPool) {
+	NULL_VULKAN_CALL();
+	auto pool = create<VkCommandPool_T>();
+	pool->family = pCreateInfo->queueFamilyIndex;
+	*pCommandPool = pool;
+	return VK_SUCCESS;
+}
+
+VKAPI_ATTR void VKAPI_CALL vkDestroyCommandPool(VkDevice, VkCommandPool commandPool, const VkAllocationCallbacks*) {
+	NULL_VULKAN_CALL();
+	if(!commandPool)
+		return;
+
+	for(auto commandBuffer: commandPool->commandBuffers)
+		destroy(commandBuffer);
+	destroy(commandPool);
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkResetCommandPool(VkDevice, VkCommandPool commandPool, VkCommandPoolResetFlags) {
+	NULL_VULKAN_CALL();
+	for(auto commandBuffer: commandPool->commandBuffers)
+		commandBuffer->reset();
+	return VK_SUCCESS;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkAllocateCommandBuffers(VkDevice, const VkCommandBufferAllocateInfo* pAllocateInfo, VkCommandBuffer* pCommandBuffers) {
+	NULL_VULKAN_CALL();
+	auto pool = pAllocateInfo->commandPool;
+	for(uint32_t i = 0; i < pAllocateInfo->commandBufferCount; ++i) {
+		auto commandBuffer = create<VkCommandBuffer_T>();
+		commandBuffer->pool = pool;
+		commandBuffer->level = pAllocateInfo->level;
+		pool->commandBuffers.emplace_back(commandBuffer);
+		pCommandBuffers[i] = commandBuffer;
+	}
+	return VK_SUCCESS;
+}
+
+VKAPI_ATTR void VKAPI_CALL vkFreeCommandBuffers(VkDevice, VkCommandPool commandPool, uint32_t commandBufferCount, const VkCommandBuffer* pCommandBuffers) {
+	NULL_VULKAN_CALL();
+	auto& commandBuffers = commandPool->commandBuffers;
+	for(uint32_t i = 0; i < commandBufferCount; ++i) {
+		if(!pCommandBuffers[i])
+			continue;
+
+		commandBuffers.erase(std::remove(commandBuffers.begin(), commandBuffers.end(), pCommandBuffers[i]), commandBuffers.end());
+		destroy(pCommandBuffers[i]);
+	}
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkBeginCommandBuffer(VkCommandBuffer commandBuffer, const VkCommandBufferBeginInfo*) {
+	NULL_VULKAN_CALL();
+	commandBuffer->reset();
+	return VK_SUCCESS;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkEndCommandBuffer(VkCommandBuffer) {
+	NULL_VULKAN_CALL();
+	return VK_SUCCESS;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkResetCommandBuffer(VkCommandBuffer commandBuffer, VkCommandBufferResetFlags) {
+	NULL_VULKAN_CALL();
+	commandBuffer->reset();
+	return VK_SUCCESS;
+}
+
+// Synchronisation
+
+VKAPI_ATTR VkResult VKAPI_CALL vkCreateSemaphore(VkDevice, const VkSemaphoreCreateInfo* pCreateInfo, const VkAllocationCallbacks*, VkSemaphore* pSemaphore) {
+	NULL_VULKAN_CALL();
+	auto semaphore = create<VkSemaphore_T>();
+	for(auto next = static_cast<const VkBaseInStructure*>(pCreateInfo->pNext); next; next = next->pNext) {
+		if(next->sType != VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO)
+			continue;
+
+		const auto& typeInfo = *reinterpret_cast<const VkSemaphoreTypeCreateInfo*>(next);
+		semaphore->timeline = typeInfo.semaphoreType == VK_SEMAPHORE_TYPE_TIMELINE;
+		semaphore->value.store(typeInfo.initialValue);
+	}
+
+	*pSemaphore = semaphore;
+	return VK_SUCCESS;
+}
+
+VKAPI_ATTR void VKAPI_CALL vkDestroySemaphore(VkDevice, VkSemaphore semaphore, const VkAllocationCallbacks*) {
+	NULL_VULKAN_CALL();
+	destroy(semaphore);
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkGetSemaphoreCounterValue(VkDevice, VkSemaphore semaphore, uint64_t* pValue) {
+	NULL_VULKAN_CALL();
+	*pValue = semaphore->value.load();
+	return VK_SUCCESS;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkWaitSemaphores(VkDevice, const VkSemaphoreWaitInfo* pWaitInfo, uint64_t timeout) {
+	NULL_VULKAN_CALL();
+	const bool any = pWaitInfo->flags & VK_SEMAPHORE_WAIT_ANY_BIT;
+	bool complete = !any;
+	for(uint32_t i = 0; i < pWaitInfo->semaphoreCount; ++i) {
+		const bool reached = pWaitInfo->pSemaphores[i]->value.load() >= pWaitInfo->pValues[i];
+		complete = any ? complete || reached : complete && reached;
+	}
+	return wait(complete, timeout);
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkSignalSemaphore(VkDevice, const VkSemaphoreSignalInfo* pSignalInfo) {
+	NULL_VULKAN_CALL();
+	signal(pSignalInfo->semaphore, pSignalInfo->value);
+	return VK_SUCCESS;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkCreateFence(VkDevice, const VkFenceCreateInfo* pCreateInfo, const VkAllocationCallbacks*, VkFence* pFence) {
+	NULL_VULKAN_CALL();
+	auto fence = create<VkFence_T>();
+	fence->signaled.store((pCreateInfo->flags & VK_FENCE_CREATE_SIGNALED_BIT) != 0);
+	*pFence = fence;
+	return VK_SUCCESS;
+}
+
+VKAPI_ATTR void VKAPI_CALL vkDestroyFence(VkDevice, VkFence fence, const VkAllocationCallbacks*) {
+	NULL_VULKAN_CALL();
+	destroy(fence);
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkGetFenceStatus(VkDevice, VkFence fence) {
+	NULL_VULKAN_CALL();
+	return fence->signaled.load() ? VK_SUCCESS : VK_NOT_READY;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkWaitForFences(VkDevice, uint32_t fenceCount, const VkFence* pFences, VkBool32 waitAll, uint64_t timeout) {
+	NULL_VULKAN_CALL();
+	bool complete = waitAll;
+	for(uint32_t i = 0; i < fenceCount; ++i) {
+		const bool signaled = pFences[i]->signaled.load();
+		complete = waitAll ? complete && signaled : complete || signaled;
+	}
+	return wait(complete, timeout);
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkResetFences(VkDevice, uint32_t fenceCount, const VkFence* pFences) {
+	NULL_VULKAN_CALL();
+	for(uint32_t i = 0; i < fenceCount; ++i)
+		pFences[i]->signaled.store(false);
+	return VK_SUCCESS;
+}
+
+// Swapchains
+
+VKAPI_ATTR VkResult VKAPI_CALL vkCreateSwapchainKHR(VkDevice, const VkSwapchainCreateInfoKHR* pCreateInfo, const VkAllocationCallbacks*, VkSwapchainKHR* pSwapchain) {
+	NULL_VULKAN_CALL();
+	auto swapchain = create<VkSwapchainKHR_T>();
+	for(uint32_t i = 0; i < std::max(pCreateInfo->minImageCount, 1u); ++i) {
+		swapchain->images.emplace_back(new VkImage_T());
+		swapchain->images.back()->swapchain = true;
+	}
+
+	liveSwapchains.fetch_add(1);
+	*pSwapchain = swapchain;
+	return VK_SUCCESS;
+}
+
+VKAPI_ATTR void VKAPI_CALL vkDestroySwapchainKHR(VkDevice, VkSwapchainKHR swapchain, const VkAllocationCallbacks*) {
+	NULL_VULKAN_CALL();
+	if(!swapchain)
+		return;
+
+	liveSwapchains.fetch_sub(1);
+	destroy(swapchain);
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkGetSwapchainImagesKHR(VkDevice, VkSwapchainKHR swapchain, uint32_t* pSwapchainImageCount, VkImage* pSwapchainImages) {
+	NULL_VULKAN_CALL();
+	std::vector<VkImage> images;
+	for(const auto& image: swapchain->images)
+		images.emplace_back(image.get());
+	return enumerate(images.data(), static_cast<uint32_t>(images.size()), pSwapchainImageCount, pSwapchainImages);
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkAcquireNextImageKHR(VkDevice, VkSwapchainKHR swapchain, uint64_t, VkSemaphore semaphore, VkFence fence, uint32_t* pImageIndex) {
+	NULL_VULKAN_CALL();
+	*pImageIndex = swapchain->nextImage;
+	swapchain->nextImage = (swapchain->nextImage + 1) % swapchain->images.size();
+
+	signal(semaphore, 0);
+	if(fence)
+		fence->signaled.store(true);
+	return VK_SUCCESS;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkQueuePresentKHR(VkQueue, const VkPresentInfoKHR* pPresentInfo) {
+	NULL_VULKAN_CALL();
+	if(pPresentInfo->pResults)
+		std::fill_n(pPresentInfo->pResults, pPresentInfo->swapchainCount, VK_SUCCESS);
+
+	endFrame();
+	return VK_SUCCESS;
+}
+
+// Memory
+
+VKAPI_ATTR VkResult VKAPI_CALL vkAllocateMemory(VkDevice, const VkMemoryAllocateInfo* pAllocateInfo, const VkAllocationCallbacks*, VkDeviceMemory* pMemory) {
+	NULL_VULKAN_CALL();
+	const auto size = pAllocateInfo->allocationSize;
+	const auto& type = memoryTypes[pAllocateInfo->memoryTypeIndex];
+
+	auto& usage = heapUsage[type.heap];
+	if(usage.fetch_add(size) + size > heapSizes[type.heap]) {
+		usage.fetch_sub(size);
+		return type.heap == 1 ? VK_ERROR_OUT_OF_HOST_MEMORY : VK_ERROR_OUT_OF_DEVICE_MEMORY;
+	}
+
+	std::unique_ptr<uint8_t[]> contents;
+	if(type.flags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
+		// Left uninitialised, so untouched pages never get committed.
+		contents.reset(new(std::nothrow) uint8_t[size]);
+		if(!contents) {
+			usage.fetch_sub(size);
+			return VK_ERROR_OUT_OF_HOST_MEMORY;
+		}
+	}
+
+	auto memory = create<VkDeviceMemory_T>();
+	memory->size = size;
+	memory->heap = type.heap;
+	memory->contents = std::move(contents);
+
+	add(currentFrame.memoryAllocations);
+	add(currentFrame.bytesAllocated, size);
+	*pMemory = memory;
+	return VK_SUCCESS;
+}
+
+VKAPI_ATTR void VKAPI_CALL vkFreeMemory(VkDevice, VkDeviceMemory memory, const VkAllocationCallbacks*) {
+	NULL_VULKAN_CALL();
+	if(!memory)
+		return;
+
+	heapUsage[memory->heap].fetch_sub(memory->size);
+	add(currentFrame.memoryFrees);
+	add(currentFrame.bytesFreed, memory->size);
+	destroy(memory);
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkMapMemory(VkDevice, VkDeviceMemory memory, VkDeviceSize offset, VkDeviceSize, VkMemoryMapFlags, void** ppData) {
+	NULL_VULKAN_CALL();
+	if(!memory->contents)
+		return VK_ERROR_MEMORY_MAP_FAILED;
+
+	*ppData = memory->contents.get() + offset;
+	return VK_SUCCESS;
+}
+
+VKAPI_ATTR void VKAPI_CALL vkUnmapMemory(VkDevice, VkDeviceMemory) {
+	NULL_VULKAN_CALL();
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkFlushMappedMemoryRanges(VkDevice, uint32_t, const VkMappedMemoryRange*) {
+	NULL_VULKAN_CALL();
+	return VK_SUCCESS;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkInvalidateMappedMemoryRanges(VkDevice, uint32_t, const VkMappedMemoryRange*) {
+	NULL_VULKAN_CALL();
+	return VK_SUCCESS;
+}
+
+// Buffers and images
+
+VKAPI_ATTR VkResult VKAPI_CALL vkCreateBuffer(VkDevice, const VkBufferCreateInfo* pCreateInfo, const VkAllocationCallbacks*, VkBuffer* pBuffer) {
+	NULL_VULKAN_CALL();
+	auto buffer = create<VkBuffer_T>();
+	buffer->size = pCreateInfo->size;
+	*pBuffer = buffer;
+	return VK_SUCCESS;
+}
+
+VKAPI_ATTR void VKAPI_CALL vkDestroyBuffer(VkDevice, VkBuffer buffer, const VkAllocationCallbacks*) {
+	NULL_VULKAN_CALL();
+	destroy(buffer);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkGetBufferMemoryRequirements(VkDevice, VkBuffer buffer, VkMemoryRequirements* pMemoryRequirements) {
+	NULL_VULKAN_CALL();
+	pMemoryRequirements->size = alignUp(buffer->size, 256);
+	pMemoryRequirements->alignment = 256;
+	pMemoryRequirements->memoryTypeBits = bufferMemoryTypeBits;
+}
+
+VKAPI_ATTR void VKAPI_CALL vkGetBufferMemoryRequirements2(VkDevice device, const VkBufferMemoryRequirementsInfo2* pInfo, VkMemoryRequirements2* pMemoryRequirements) {
+	NULL_VULKAN_CALL();
+	vkGetBufferMemoryRequirements(device, pInfo->buffer, &pMemoryRequirements->memoryRequirements);
+	setDedicatedRequirements(pMemoryRequirements->pNext);
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkBindBufferMemory(VkDevice, VkBuffer, VkDeviceMemory, VkDeviceSize) {
+	NULL_VULKAN_CALL();
+	return VK_SUCCESS;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkCreateImage(VkDevice, const VkImageCreateInfo* pCreateInfo, const VkAllocationCallbacks*, VkImage* pImage) {
+	NULL_VULKAN_CALL();
+	auto image = create<VkImage_T>();
+	image->size = getImageSize(*pCreateInfo);
+	*pImage = image;
+	return VK_SUCCESS;
+}
+
+VKAPI_ATTR void VKAPI_CALL vkDestroyImage(VkDevice, VkImage image, const VkAllocationCallbacks*) {
+	NULL_VULKAN_CALL();
+	destroy(image);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkGetImageMemoryRequirements(VkDevice, VkImage image, VkMemoryRequirements* pMemoryRequirements) {
+	NULL_VULKAN_CALL();
+	pMemoryRequirements->size = image->size;
+	pMemoryRequirements->alignment = 4096;
+	pMemoryRequirements->memoryTypeBits = imageMemoryTypeBits;
+}
+
+VKAPI_ATTR void VKAPI_CALL vkGetImageMemoryRequirements2(VkDevice device, const VkImageMemoryRequirementsInfo2* pInfo, VkMemoryRequirements2* pMemoryRequirements) {
+	NULL_VULKAN_CALL();
+	vkGetImageMemoryRequirements(device, pInfo->image, &pMemoryRequirements->memoryRequirements);
+	setDedicatedRequirements(pMemoryRequirements->pNext);
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkBindImageMemory(VkDevice, VkImage, VkDeviceMemory, VkDeviceSize) {
+	NULL_VULKAN_CALL();
+	return VK_SUCCESS;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkCreateImageView(VkDevice, const VkImageViewCreateInfo*, const VkAllocationCallbacks*, VkImageView* pView) {
+	NULL_VULKAN_CALL();
+	*pView = create<VkImageView_T>();
+	return VK_SUCCESS;
+}
+
+VKAPI_ATTR void VKAPI_CALL vkDestroyImageView(VkDevice, VkImageView imageView, const VkAllocationCallbacks*) {
+	NULL_VULKAN_CALL();
+	destroy(imageView);
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkCreateSampler(VkDevice, const VkSamplerCreateInfo*, const VkAllocationCallbacks*, VkSampler* pSampler) {
+	NULL_VULKAN_CALL();
+	*pSampler = create<VkSampler_T>();
+	return VK_SUCCESS;
+}
+
+VKAPI_ATTR void VKAPI_CALL vkDestroySampler(VkDevice, VkSampler sampler, const VkAllocationCallbacks*) {
+	NULL_VULKAN_CALL();
+	destroy(sampler);
+}
+
+// Shaders, render passes and pipelines
+
+VKAPI_ATTR VkResult VKAPI_CALL vkCreateShaderModule(VkDevice, const VkShaderModuleCreateInfo*, const VkAllocationCallbacks*, VkShaderModule* pShaderModule) {
+	NULL_VULKAN_CALL();
+	*pShaderModule = create<VkShaderModule_T>();
+	return VK_SUCCESS;
+}
+
+VKAPI_ATTR void VKAPI_CALL vkDestroyShaderModule(VkDevice, VkShaderModule shaderModule, const VkAllocationCallbacks*) {
+	NULL_VULKAN_CALL();
+	destroy(shaderModule);
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkCreateRenderPass(VkDevice, const VkRenderPassCreateInfo*, const VkAllocationCallbacks*, VkRenderPass* pRenderPass) {
+	NULL_VULKAN_CALL();
+	*pRenderPass = create<VkRenderPass_T>();
+	return VK_SUCCESS;
+}
+
+VKAPI_ATTR void VKAPI_CALL vkDestroyRenderPass(VkDevice, VkRenderPass renderPass, const VkAllocationCallbacks*) {
+	NULL_VULKAN_CALL();
+	destroy(renderPass);
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkCreateFramebuffer(VkDevice, const VkFramebufferCreateInfo*, const VkAllocationCallbacks*, VkFramebuffer* pFramebuffer) {
+	NULL_VULKAN_CALL();
+	*pFramebuffer = create<VkFramebuffer_T>();
+	return VK_SUCCESS;
+}
+
+VKAPI_ATTR void VKAPI_CALL vkDestroyFramebuffer(VkDevice, VkFramebuffer framebuffer, const VkAllocationCallbacks*) {
+	NULL_VULKAN_CALL();
+	destroy(framebuffer);
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkCreatePipelineLayout(VkDevice, const VkPipelineLayoutCreateInfo*, const VkAllocationCallbacks*, VkPipelineLayout* pPipelineLayout) {
+	NULL_VULKAN_CALL();
+	*pPipelineLayout = create<VkPipelineLayout_T>();
+	return VK_SUCCESS;
+}
+
+VKAPI_ATTR void VKAPI_CALL vkDestroyPipelineLayout(VkDevice, VkPipelineLayout pipelineLayout, const VkAllocationCallbacks*) {
+	NULL_VULKAN_CALL();
+	destroy(pipelineLayout);
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkCreateGraphicsPipelines(VkDevice, VkPipelineCache, uint32_t createInfoCount, const VkGraphicsPipelineCreateInfo*,
+														 const VkAllocationCallbacks*, VkPipeline* pPipelines) {
+	NULL_VULKAN_CALL();
+	for(uint32_t i = 0; i < createInfoCount; ++i)
+		pPipelines[i] = create<VkPipeline_T>();
+	return VK_SUCCESS;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkCreateComputePipelines(VkDevice, VkPipelineCache, uint32_t createInfoCount, const VkComputePipelineCreateInfo*,
+														const VkAllocationCallbacks*, VkPipeline* pPipelines) {
+	NULL_VULKAN_CALL();
+	for(uint32_t i = 0; i < createInfoCount; ++i)
+		pPipelines[i] = create<VkPipeline_T>();
+	return VK_SUCCESS;
+}
+
+VKAPI_ATTR void VKAPI_CALL vkDestroyPipeline(VkDevice, VkPipeline pipeline, const VkAllocationCallbacks*) {
+	NULL_VULKAN_CALL();
+	destroy(pipeline);
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkCreatePipelineCache(VkDevice, const VkPipelineCacheCreateInfo*, const VkAllocationCallbacks*, VkPipelineCache* pPipelineCache) {
+	NULL_VULKAN_CALL();
+	*pPipelineCache = create<VkPipelineCache_T>();
+	return VK_SUCCESS;
+}
+
+VKAPI_ATTR void VKAPI_CALL vkDestroyPipelineCache(VkDevice, VkPipelineCache pipelineCache, const VkAllocationCallbacks*) {
+	NULL_VULKAN_CALL();
+	destroy(pipelineCache);
+}
+
+// Nothing is ever compiled, the data is only the header a driver has to start it with.
+VKAPI_ATTR VkResult VKAPI_CALL vkGetPipelineCacheData(VkDevice, VkPipelineCache, size_t* pDataSize, void* pData) {
+	NULL_VULKAN_CALL();
+	const size_t headerSize = 16 + VK_UUID_SIZE;
+	if(!pData) {
+		*pDataSize = headerSize;
+		return VK_SUCCESS;
+	}
+
+	if(*pDataSize < headerSize) {
+		*pDataSize = 0;
+		return VK_INCOMPLETE;
+	}
+
+	const uint32_t header[4] = {static_cast<uint32_t>(headerSize), VK_PIPELINE_CACHE_HEADER_VERSION_ONE, vendorID, deviceID};
+	std::memcpy(pData, header, sizeof(header));
+	std::memcpy(static_cast<uint8_t*>(pData) + sizeof(header), deviceUUID, VK_UUID_SIZE);
+	*pDataSize = headerSize;
+	return VK_SUCCESS;
+}
+
+// Descriptors
+
+VKAPI_ATTR VkResult VKAPI_CALL vkCreateDescriptorSetLayout(VkDevice, const VkDescriptorSetLayoutCreateInfo*, const VkAllocationCallbacks*, VkDescriptorSetLayout* pSetLayout) {
+	NULL_VULKAN_CALL();
+	*pSetLayout = create<VkDescriptorSetLayout_T>();
+	return VK_SUCCESS;
+}
+
+VKAPI_ATTR void VKAPI_CALL vkDestroyDescriptorSetLayout(VkDevice, VkDescriptorSetLayout setLayout, const VkAllocationCallbacks*) {
+	NULL_VULKAN_CALL();
+	destroy(setLayout);
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkCreateDescriptorPool(VkDevice, const VkDescriptorPoolCreateInfo* pCreateInfo, const VkAllocationCallbacks*, VkDescriptorPool* pDescriptorPool) {
+	NULL_VULKAN_CALL();
+	auto pool = create<VkDescriptorPool_T>();
+	pool->maxSets = pCreateInfo->maxSets;
+	*pDescriptorPool = pool;
+	return VK_SUCCESS;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkResetDescriptorPool(VkDevice, VkDescriptorPool descriptorPool, VkDescriptorPoolResetFlags) {
+	NULL_VULKAN_CALL();
+	for(auto set: descriptorPool->sets)
+		destroy(set);
+	descriptorPool->sets.clear();
+	return VK_SUCCESS;
+}
+
+VKAPI_ATTR void VKAPI_CALL vkDestroyDescriptorPool(VkDevice, VkDescriptorPool descriptorPool, const VkAllocationCallbacks*) {
+	NULL_VULKAN_CALL();
+	if(!descriptorPool)
+		return;
+
+	for(auto set: descriptorPool->sets)
+		destroy(set);
+	destroy(descriptorPool);
+}
+
+// Pools only run out of sets, what they were told about descriptor counts isn't tracked.
+VKAPI_ATTR VkResult VKAPI_CALL vkAllocateDescriptorSets(VkDevice, const VkDescriptorSetAllocateInfo* pAllocateInfo, VkDescriptorSet* pDescriptorSets) {
+	NULL_VULKAN_CALL();
+	auto pool = pAllocateInfo->descriptorPool;
+	if(pool->sets.size() + pAllocateInfo->descriptorSetCount > pool->maxSets)
+		return VK_ERROR_OUT_OF_POOL_MEMORY;
+
+	for(uint32_t i = 0; i < pAllocateInfo->descriptorSetCount; ++i) {
+		auto set = create<VkDescriptorSet_T>();
+		pool->sets.emplace_back(set);
+		pDescriptorSets[i] = set;
+	}
+
+	add(currentFrame.descriptorSetsAllocated, pAllocateInfo->descriptorSetCount);
+	return VK_SUCCESS;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkFreeDescriptorSets(VkDevice, VkDescriptorPool descriptorPool, uint32_t descriptorSetCount, const VkDescriptorSet* pDescriptorSets) {
+	NULL_VULKAN_CALL();
+	auto& sets = descriptorPool->sets;
+	for(uint32_t i = 0; i < descriptorSetCount; ++i) {
+		if(!pDescriptorSets[i])
+			continue;
+
+		sets.erase(std::remove(sets.begin(), sets.end(), pDescriptorSets[i]), sets.end());
+		destroy(pDescriptorSets[i]);
+	}
+	return VK_SUCCESS;
+}
+
+VKAPI_ATTR void VKAPI_CALL vkUpdateDescriptorSets(VkDevice, uint32_t descriptorWriteCount, const VkWriteDescriptorSet* pDescriptorWrites,
+												  uint32_t descriptorCopyCount, const VkCopyDescriptorSet* pDescriptorCopies) {
+	NULL_VULKAN_CALL();
+	uint64_t descriptors = 0;
+	for(uint32_t i = 0; i < descriptorWriteCount; ++i)
+		descriptors += pDescriptorWrites[i].descriptorCount;
+	for(uint32_t i = 0; i < descriptorCopyCount; ++i)
+		descriptors += pDescriptorCopies[i].descriptorCount;
+
+	add(currentFrame.descriptorWrites, descriptorWriteCount + descriptorCopyCount);
+	add(currentFrame.descriptors, descriptors);
+}
+
+// Queries
+
+VKAPI_ATTR VkResult VKAPI_CALL vkCreateQueryPool(VkDevice, const VkQueryPoolCreateInfo* pCreateInfo, const VkAllocationCallbacks*, VkQueryPool* pQueryPool) {
+	NULL_VULKAN_CALL();
+	auto pool = create<VkQueryPool_T>();
+	pool->count = pCreateInfo->queryCount;
+	*pQueryPool = pool;
+	return VK_SUCCESS;
+}
+
+VKAPI_ATTR void VKAPI_CALL vkDestroyQueryPool(VkDevice, VkQueryPool queryPool, const VkAllocationCallbacks*) {
+	NULL_VULKAN_CALL();
+	destroy(queryPool);
+}
+
+// Every query is available and took no time.
+VKAPI_ATTR VkResult VKAPI_CALL vkGetQueryPoolResults(VkDevice, VkQueryPool, uint32_t, uint32_t queryCount, size_t, void* pData,
+													 VkDeviceSize stride, VkQueryResultFlags flags) {
+	NULL_VULKAN_CALL();
+	const bool wide = flags & VK_QUERY_RESULT_64_BIT;
+	const bool availability = flags & VK_QUERY_RESULT_WITH_AVAILABILITY_BIT;
+	for(uint32_t i = 0; i < queryCount; ++i) {
+		auto result = static_cast<uint8_t*>(pData) + i * stride;
+		if(wide) {
+			const uint64_t values[2] = {0, 1};
+			std::memcpy(result, values, availability ? 16 : 8);
+		} else {
+			const uint32_t values[2] = {0, 1};
+			std::memcpy(result, values, availability ? 8 : 4);
+		}
+	}
+	return VK_SUCCESS;
+}
+
+VKAPI_ATTR void VKAPI_CALL vkResetQueryPool(VkDevice, VkQueryPool, uint32_t, uint32_t) {
+	NULL_VULKAN_CALL();
+}
+
+// Commands
+
+VKAPI_ATTR void VKAPI_CALL vkCmdPipelineBarrier(VkCommandBuffer commandBuffer, VkPipelineStageFlags srcStageMask, VkPipelineStageFlags dstStageMask, VkDependencyFlags,
+												uint32_t memoryBarrierCount, const VkMemoryBarrier*, uint32_t bufferMemoryBarrierCount, const VkBufferMemoryBarrier*,
+												uint32_t imageMemoryBarrierCount, const VkImageMemoryBarrier*) {
+	NULL_VULKAN_CALL();
+	commandBuffer->record(NullCommandType::PIPELINE_BARRIER, srcStageMask, dstStageMask, memoryBarrierCount + bufferMemoryBarrierCount, imageMemoryBarrierCount);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdCopyBuffer(VkCommandBuffer commandBuffer, VkBuffer srcBuffer, VkBuffer dstBuffer, uint32_t regionCount, const VkBufferCopy* pRegions) {
+	NULL_VULKAN_CALL();
+	VkDeviceSize bytes = 0;
+	for(uint32_t i = 0; i < regionCount; ++i)
+		bytes += pRegions[i].size;
+	commandBuffer->record(NullCommandType::COPY_BUFFER, getId(srcBuffer), getId(dstBuffer), regionCount, bytes);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdCopyBufferToImage(VkCommandBuffer commandBuffer, VkBuffer srcBuffer, VkImage dstImage, VkImageLayout dstImageLayout,
+												  uint32_t regionCount, const VkBufferImageCopy*) {
+	NULL_VULKAN_CALL();
+	commandBuffer->record(NullCommandType::COPY_BUFFER_TO_IMAGE, getId(srcBuffer), getId(dstImage), regionCount, dstImageLayout);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdCopyImage(VkCommandBuffer commandBuffer, VkImage srcImage, VkImageLayout, VkImage dstImage, VkImageLayout,
+										  uint32_t regionCount, const VkImageCopy*) {
+	NULL_VULKAN_CALL();
+	commandBuffer->record(NullCommandType::COPY_IMAGE, getId(srcImage), getId(dstImage), regionCount);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdCopyImageToBuffer(VkCommandBuffer commandBuffer, VkImage srcImage, VkImageLayout srcImageLayout, VkBuffer dstBuffer,
+												  uint32_t regionCount, const VkBufferImageCopy*) {
+	NULL_VULKAN_CALL();
+	commandBuffer->record(NullCommandType::COPY_IMAGE_TO_BUFFER, getId(srcImage), getId(dstBuffer), regionCount, srcImageLayout);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdFillBuffer(VkCommandBuffer commandBuffer, VkBuffer dstBuffer, VkDeviceSize dstOffset, VkDeviceSize size, uint32_t data) {
+	NULL_VULKAN_CALL();
+	commandBuffer->record(NullCommandType::FILL_BUFFER, getId(dstBuffer), dstOffset, size, data);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdBindPipeline(VkCommandBuffer commandBuffer, VkPipelineBindPoint pipelineBindPoint, VkPipeline pipeline) {
+	NULL_VULKAN_CALL();
+	commandBuffer->record(NullCommandType::BIND_PIPELINE, pipelineBindPoint, getId(pipeline));
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdBindDescriptorSets(VkCommandBuffer commandBuffer, VkPipelineBindPoint pipelineBindPoint, VkPipelineLayout layout, uint32_t firstSet,
+												   uint32_t descriptorSetCount, const VkDescriptorSet* pDescriptorSets, uint32_t, const uint32_t*) {
+	NULL_VULKAN_CALL();
+	commandBuffer->record(NullCommandType::BIND_DESCRIPTOR_SETS, pipelineBindPoint, getId(layout), firstSet, descriptorSetCount,
+						  descriptorSetCount ? getId(pDescriptorSets[0]) : 0);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdPushConstants(VkCommandBuffer commandBuffer, VkPipelineLayout layout, VkShaderStageFlags stageFlags, uint32_t offset,
+											  uint32_t size, const void*) {
+	NULL_VULKAN_CALL();
+	commandBuffer->record(NullCommandType::PUSH_CONSTANTS, getId(layout), stageFlags, offset, size);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdBindVertexBuffers(VkCommandBuffer commandBuffer, uint32_t firstBinding, uint32_t bindingCount, const VkBuffer* pBuffers,
+												  const VkDeviceSize* pOffsets) {
+	NULL_VULKAN_CALL();
+	commandBuffer->record(NullCommandType::BIND_VERTEX_BUFFERS, firstBinding, bindingCount, bindingCount ? getId(pBuffers[0]) : 0,
+						  bindingCount ? pOffsets[0] : 0);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdBindIndexBuffer(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset, VkIndexType indexType) {
+	NULL_VULKAN_CALL();
+	commandBuffer->record(NullCommandType::BIND_INDEX_BUFFER, getId(buffer), offset, indexType);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdDraw(VkCommandBuffer commandBuffer, uint32_t vertexCount, uint32_t instanceCount, uint32_t firstVertex, uint32_t firstInstance) {
+	NULL_VULKAN_CALL();
+	commandBuffer->record(NullCommandType::DRAW, vertexCount, instanceCount, firstVertex, firstInstance);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdDrawIndexed(VkCommandBuffer commandBuffer, uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex, int32_t vertexOffset,
+											uint32_t firstInstance) {
+	NULL_VULKAN_CALL();
+	commandBuffer->record(NullCommandType::DRAW_INDEXED, indexCount, instanceCount, firstIndex, static_cast<uint64_t>(static_cast<int64_t>(vertexOffset)),
+						  firstInstance);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdDrawIndirect(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset, uint32_t drawCount, uint32_t stride) {
+	NULL_VULKAN_CALL();
+	commandBuffer->record(NullCommandType::DRAW_INDIRECT, getId(buffer), offset, drawCount, stride);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdDrawIndexedIndirect(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset, uint32_t drawCount, uint32_t stride) {
+	NULL_VULKAN_CALL();
+	commandBuffer->record(NullCommandType::DRAW_INDEXED_INDIRECT, getId(buffer), offset, drawCount, stride);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdDrawIndirectCount(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset, VkBuffer countBuffer,
+												  VkDeviceSize countBufferOffset, uint32_t maxDrawCount, uint32_t) {
+	NULL_VULKAN_CALL();
+	commandBuffer->record(NullCommandType::DRAW_INDIRECT_COUNT, getId(buffer), offset, getId(countBuffer), countBufferOffset, maxDrawCount);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdDrawIndexedIndirectCount(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset, VkBuffer countBuffer,
+														 VkDeviceSize countBufferOffset, uint32_t maxDrawCount, uint32_t) {
+	NULL_VULKAN_CALL();
+	commandBuffer->record(NullCommandType::DRAW_INDEXED_INDIRECT_COUNT, getId(buffer), offset, getId(countBuffer), countBufferOffset, maxDrawCount);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdDispatch(VkCommandBuffer commandBuffer, uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ) {
+	NULL_VULKAN_CALL();
+	commandBuffer->record(NullCommandType::DISPATCH, groupCountX, groupCountY, groupCountZ);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdDispatchIndirect(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset) {
+	NULL_VULKAN_CALL();
+	commandBuffer->record(NullCommandType::DISPATCH_INDIRECT, getId(buffer), offset);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdBeginRenderPass(VkCommandBuffer commandBuffer, const VkRenderPassBeginInfo* pRenderPassBegin, VkSubpassContents contents) {
+	NULL_VULKAN_CALL();
+	commandBuffer->record(NullCommandType::BEGIN_RENDER_PASS, getId(pRenderPassBegin->renderPass), getId(pRenderPassBegin->framebuffer), contents,
+						  pRenderPassBegin->clearValueCount);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdEndRenderPass(VkCommandBuffer commandBuffer) {
+	NULL_VULKAN_CALL();
+	commandBuffer->record(NullCommandType::END_RENDER_PASS);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdExecuteCommands(VkCommandBuffer commandBuffer, uint32_t commandBufferCount, const VkCommandBuffer* pCommandBuffers) {
+	NULL_VULKAN_CALL();
+	commandBuffer->record(NullCommandType::EXECUTE_COMMANDS, commandBufferCount, commandBufferCount ? getId(pCommandBuffers[0]) : 0);
+	commandBuffer->executed.insert(commandBuffer->executed.end(), pCommandBuffers, pCommandBuffers + commandBufferCount);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdWriteTimestamp(VkCommandBuffer commandBuffer, VkPipelineStageFlagBits pipelineStage, VkQueryPool queryPool, uint32_t query) {
+	NULL_VULKAN_CALL();
+	commandBuffer->record(NullCommandType::WRITE_TIMESTAMP, pipelineStage, getId(queryPool), query);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdResetQueryPool(VkCommandBuffer commandBuffer, VkQueryPool queryPool, uint32_t firstQuery, uint32_t queryCount) {
+	NULL_VULKAN_CALL();
+	commandBuffer->record(NullCommandType::RESET_QUERY_POOL, getId(queryPool), firstQuery, queryCount);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdSetViewport(VkCommandBuffer commandBuffer, uint32_t firstViewport, uint32_t viewportCount, const VkViewport*) {
+	NULL_VULKAN_CALL();
+	commandBuffer->record(NullCommandType::SET_VIEWPORT, firstViewport, viewportCount);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdSetScissor(VkCommandBuffer commandBuffer, uint32_t firstScissor, uint32_t scissorCount, const VkRect2D*) {
+	NULL_VULKAN_CALL();
+	commandBuffer->record(NullCommandType::SET_SCISSOR, firstScissor, scissorCount);
+}
+
+}
+
+const char* getNullCommandName(NullCommandType type) {
+	switch(type) {
+		case NullCommandType::PIPELINE_BARRIER: return "pipelineBarrier";
+		case NullCommandType::COPY_BUFFER: return "copyBuffer";
+		case NullCommandType::COPY_BUFFER_TO_IMAGE: return "copyBufferToImage";
+		case NullCommandType::COPY_IMAGE: return "copyImage";
+		case NullCommandType::COPY_IMAGE_TO_BUFFER: return "copyImageToBuffer";
+		case NullCommandType::FILL_BUFFER: return "fillBuffer";
+		case NullCommandType::BIND_PIPELINE: return "bindPipeline";
+		case NullCommandType::BIND_DESCRIPTOR_SETS: return "bindDescriptorSets";
+		case NullCommandType::PUSH_CONSTANTS: return "pushConstants";
+		case NullCommandType::BIND_VERTEX_BUFFERS: return "bindVertexBuffers";
+		case NullCommandType::BIND_INDEX_BUFFER: return "bindIndexBuffer";
+		case NullCommandType::DRAW: return "draw";
+		case NullCommandType::DRAW_INDEXED: return "drawIndexed";
+		case NullCommandType::DRAW_INDIRECT: return "drawIndirect";
+		case NullCommandType::DRAW_INDEXED_INDIRECT: return "drawIndexedIndirect";
+		case NullCommandType::DRAW_INDIRECT_COUNT: return "drawIndirectCount";
+		case NullCommandType::DRAW_INDEXED_INDIRECT_COUNT: return "drawIndexedIndirectCount";
+		case NullCommandType::DISPATCH: return "dispatch";
+		case NullCommandType::DISPATCH_INDIRECT: return "dispatchIndirect";
+		case NullCommandType::BEGIN_RENDER_PASS: return "beginRenderPass";
+		case NullCommandType::END_RENDER_PASS: return "endRenderPass";
+		case NullCommandType::EXECUTE_COMMANDS: return "executeCommands";
+		case NullCommandType::WRITE_TIMESTAMP: return "writeTimestamp";
+		case NullCommandType::RESET_QUERY_POOL: return "resetQueryPool";
+		case NullCommandType::SET_VIEWPORT: return "setViewport";
+		case NullCommandType::SET_SCISSOR: return "setScissor";
+	}
+	return "unknown";
+}
+
+std::vector<NullVulkanCall> getNullVulkanCalls() {
+	std::vector<NullVulkanCall> calls;
+	{
+		auto& callSites = getCallSites();
+		std::lock_guard<std::mutex> lock(callSites.mutex);
+		for(const auto site: callSites.sites) {
+			NullVulkanCall call;
+			call.name = site->name;
+			call.count = site->count.load(std::memory_order_relaxed);
+			call.nanoseconds = site->nanoseconds.load(std::memory_order_relaxed);
+			if(call.count)
+				calls.emplace_back(call);
+		}
+	}
+
+	std::sort(calls.begin(), calls.end(), [](const NullVulkanCall& a, const NullVulkanCall& b) { return a.nanoseconds > b.nanoseconds; });
+	return calls;
+}
+
+std::vector<NullVulkanFrame> getNullVulkanFrames() {
+	std::lock_guard<std::mutex> lock(framesMutex);
+	return frames;
+}
+
+NullVulkanFrame getNullVulkanCurrentFrame() {
+	return currentFrame.get(false);
+}
+
+void resetNullVulkanStatistics() {
+	{
+		auto& callSites = getCallSites();
+		std::lock_guard<std::mutex> lock(callSites.mutex);
+		for(auto site: callSites.sites) {
+			site->count.store(0);
+			site->nanoseconds.store(0);
+		}
+	}
+
+	currentFrame.get(true);
+	{
+		std::lock_guard<std::mutex> lock(framesMutex);
+		frames.clear();
+	}
+
+	std::lock_guard<std::mutex> lock(submissionsMutex);
+	submissions.clear();
+}
+
+std::vector<NullCommand> getNullCommands(vk::CommandBuffer commandBuffer) {
+	return static_cast<VkCommandBuffer>(commandBuffer)->commands;
+}
+
+void setNullSubmissionCapture(bool enabled) {
+	captureSubmissions.store(enabled);
+}
+
+std::vector<NullSubmission> takeNullSubmissions() {
+	std::vector<NullSubmission> taken;
+	std::lock_guard<std::mutex> lock(submissionsMutex);
+	taken.swap(submissions);
+	return taken;
+}
+
+uint64_t getNullObjectId(const void* handle) {
+	return getId(static_cast<const NullObject*>(handle));
+}
@@ -0,0 +1,150 @@
+//
+//  null_vulkan.hpp
+//  Vulkan_test
+//
+//  Created by Danny on 17/10/2026.
+//  Copyright © 2026 Danny. All rights reserved.
+//
+
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+
+#include <cstdint>
+#include <vector>
+
+// A Vulkan implementation without a gpu, for measuring what the renderer costs on the cpu on machines that have none.
+// null_vulkan.cpp defines the vk* entry points itself, so it is linked instead of the loader and the renderer runs
+// unchanged on top of it. It reports a single device with a graphics, a compute and a transfer family that supports
+// everything, and every submission completes the moment it is made.
+// Nothing is executed: host visible memory is real so mapping works, everything else only records what was asked for.
+//
+// Every entry point counts and times its calls, command buffers keep the commands recorded into them, and
+// creations, allocations, descriptor writes and submissions are summed up per frame. A frame ends with every present,
+// or without a swapchain with every submission that signals a fence.
+
+// What each command keeps in NullCommand::arguments, objects by their id.
+enum class NullCommandType
+{
+	// Source stages, destination stages, memory and buffer barriers, image barriers.
+	PIPELINE_BARRIER,
+	// Source, destination, regions, bytes.
+	COPY_BUFFER,
+	// Buffer, image, regions, image layout.
+	COPY_BUFFER_TO_IMAGE,
+	// Source, destination, regions.
+	COPY_IMAGE,
+	// Image, buffer, regions, image layout.
+	COPY_IMAGE_TO_BUFFER,
+	// Buffer, offset, size, data.
+	FILL_BUFFER,
+	// Bind point, pipeline.
+	BIND_PIPELINE,
+	// Bind point, layout, first set, set count, first set.
+	BIND_DESCRIPTOR_SETS,
+	// Layout, stages, offset, size.
+	PUSH_CONSTANTS,
+	// First binding, binding count, first buffer, its offset.
+	BIND_VERTEX_BUFFERS,
+	// Buffer, offset, index type.
+	BIND_INDEX_BUFFER,
+	// Vertex count, instance count, first vertex, first instance.
+	DRAW,
+	// Index count, instance count, first index, vertex offset, first instance.
+	DRAW_INDEXED,
+	// Buffer, offset, draw count, stride.
+	DRAW_INDIRECT,
+	DRAW_INDEXED_INDIRECT,
+	// Buffer, offset, count buffer, its offset, maximum draw count.
+	DRAW_INDIRECT_COUNT,
+	DRAW_INDEXED_INDIRECT_COUNT,
+	// Group counts.
+	DISPATCH,
+	// Buffer, offset.
+	DISPATCH_INDIRECT,
+	// Render pass, framebuffer, subpass contents, clear values.
+	BEGIN_RENDER_PASS,
+	END_RENDER_PASS,
+	// Command buffer count, first command buffer.
+	EXECUTE_COMMANDS,
+	// Stage, query pool, query.
+	WRITE_TIMESTAMP,
+	// Query pool, first query, query count.
+	RESET_QUERY_POOL,
+	// First viewport, viewport count.
+	SET_VIEWPORT,
+	// First scissor, scissor count.
+	SET_SCISSOR
+};
+
+const char* getNullCommandName(NullCommandType);
+
+// Objects are referred to by the id the null driver gave them when they were created, which starts at 1 and is never reused.
+struct NullCommand
+{
+	NullCommandType type;
+	uint64_t arguments[5] = {};
+};
+
+// One command buffer that went to a queue, with the commands of the secondary command buffers it executed inlined
+// right after their EXECUTE_COMMANDS.
+struct NullSubmission
+{
+	uint32_t queueFamily = 0;
+	uint64_t commandBuffer = 0;
+	std::vector<NullCommand> commands;
+};
+
+struct NullVulkanCall
+{
+	// An entry point like vkCreateBuffer.
+	const char* name = nullptr;
+	uint64_t count = 0;
+	uint64_t nanoseconds = 0;
+};
+
+struct NullVulkanFrame
+{
+	uint64_t calls = 0;
+	// Time spent inside the driver, a real one does more than this with every call.
+	uint64_t nanoseconds = 0;
+	uint64_t objectsCreated = 0;
+	uint64_t objectsDestroyed = 0;
+	uint64_t memoryAllocations = 0;
+	uint64_t memoryFrees = 0;
+	uint64_t bytesAllocated = 0;
+	uint64_t bytesFreed = 0;
+	uint64_t descriptorSetsAllocated = 0;
+	uint64_t descriptorWrites = 0;
+	// Descriptors written, a write of an array counts each of its elements.
+	uint64_t descriptors = 0;
+	uint64_t commands = 0;
+	uint64_t submits = 0;
+	uint64_t commandBuffersSubmitted = 0;
+};
+
+// Every entry point that was called since the last reset, most expensive first.
+std::vector<NullVulkanCall> getNullVulkanCalls();
+
+// The finished frames since the last reset, in order.
+std::vector<NullVulkanFrame> getNullVulkanFrames();
+// What happened since the last frame ended.
+NullVulkanFrame getNullVulkanCurrentFrame();
+
+// Clears calls, frames and captured submissions. Objects, memory and recorded command buffers are untouched.
+void resetNullVulkanStatistics();
+
+// The commands recorded into a command buffer since it was last begun or reset.
+std::vector<NullCommand> getNullCommands(vk::CommandBuffer);
+
+// Keeps a copy of every command buffer submitted from now on until it is switched off again. Off by default, copying
+// commands isn't free and would show up in the timings.
+void setNullSubmissionCapture(bool enabled);
+// Hands out the captured submissions and forgets them.
+std::vector<NullSubmission> takeNullSubmissions();
+
+// The id an object got when it was created, to find it in the arguments of recorded commands. 0 for null handles.
+uint64_t getNullObjectId(const void* handle);
+
+template<typename T, typename CType = typename T::CType>
+uint64_t getNullObjectId(T object) { return getNullObjectId(reinterpret_cast<const void*>(static_cast<CType>(object))); }
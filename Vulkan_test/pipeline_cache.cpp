@@ -0,0 +1,154 @@
+//
+//  pipeline_cache.cpp
+//  Vulkan_test
+//
+//  Created by Danny on 17/10/2026.
+//  Copyright © 2026 Danny. All rights reserved.
+//
+
+#include "pipeline_cache.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+namespace {
+
+	// Layout of VK_PIPELINE_CACHE_HEADER_VERSION_ONE as defined by the spec.
+	struct PipelineCacheHeader
+	{
+		uint32_t headerSize;
+		uint32_t headerVersion;
+		uint32_t vendorID;
+		uint32_t deviceID;
+		uint8_t pipelineCacheUUID[VK_UUID_SIZE];
+	};
+
+	template<typename T>
+	void append(std::string& key, const T& value) {
+		key.append(reinterpret_cast<const char*>(&value), sizeof(T));
+	}
+
+	void append(std::string& key, const std::string& value) {
+		append(key, value.size());
+		key.append(value);
+	}
+}
+
+PipelineCache::PipelineCache(const vk::PhysicalDevice& physicalDevice, const vk::Device& logicalDevice, const std::string& path)
+: logicalDevice(logicalDevice), properties(physicalDevice.getProperties()), path(path) {
+
+	std::vector<char> data;
+	if(!path.empty()) {
+		std::ifstream file(path, std::ios::binary | std::ios::ate);
+		if(file) {
+			data.resize(static_cast<size_t>(file.tellg()));
+			file.seekg(0);
+			file.read(data.data(), data.size());
+			if(!file || !validateHeader(data))
+				data.clear();
+		}
+	}
+
+	vk::PipelineCacheCreateInfo info;
+	info.setInitialDataSize(data.size());
+	info.setPInitialData(data.data());
+
+	cache = logicalDevice.createPipelineCache(info);
+	warm = !data.empty();
+}
+
+PipelineCache::~PipelineCache() {
+	logicalDevice.destroyPipelineCache(cache);
+}
+
+bool PipelineCache::save() const {
+	if(path.empty())
+		return false;
+
+	std::vector<uint8_t> data;
+	try {
+		data = logicalDevice.getPipelineCacheData(cache);
+	} catch(const vk::SystemError&) {
+		return false;
+	}
+
+	// Write to a temporary file first so a crash halfway through never leaves a truncated cache behind.
+	const auto temporaryPath = path + ".tmp";
+	{
+		std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+		if(!file)
+			return false;
+
+		file.write(reinterpret_cast<const char*>(data.data()), data.size());
+		if(!file)
+			return false;
+	}
+
+	return std::rename(temporaryPath.c_str(), path.c_str()) == 0;
+}
+
+bool PipelineCache::validateHeader(const std::vector<char>& data) const {
+	if(data.size() < sizeof(PipelineCacheHeader))
+		return false;
+
+	PipelineCacheHeader header;
+	std::memcpy(&header, data.data(), sizeof(header));
+
+	if(header.headerSize < sizeof(PipelineCacheHeader) || header.headerSize > data.size())
+		return false;
+	if(header.headerVersion != VK_PIPELINE_CACHE_HEADER_VERSION_ONE)
+		return false;
+	if(header.vendorID != properties.vendorID || header.deviceID != properties.deviceID)
+		return false;
+
+	// The UUID changes with the driver version, old blobs are useless after a driver update.
+	return std::memcmp(header.pipelineCacheUUID, &properties.pipelineCacheUUID[0], VK_UUID_SIZE) == 0;
+}
+
+std::string getPipelineKey(const RenderPipelineDescriptor& descriptor)
+{
+	std::string key;
+	key.reserve(256);
+
+	append(key, descriptor.shaderStages.size());
+	for(const auto& stage: descriptor.shaderStages) {
+		append(key, stage.type);
+		append(key, stage.module);
+		append(key, stage.entryPoint);
+	}
+
+	append(key, descriptor.vertexAttributeDescriptors.size());
+	for(const auto& attribute: descriptor.vertexAttributeDescriptors) {
+		append(key, attribute.type);
+		append(key, attribute.numElements);
+		append(key, attribute.offset);
+		append(key, attribute.location);
+	}
+
+	append(key, descriptor.viewPorts.size());
+	for(const auto& vp: descriptor.viewPorts) {
+		append(key, vp.x);
+		append(key, vp.y);
+		append(key, vp.width);
+		append(key, vp.height);
+		append(key, vp.minDepth);
+		append(key, vp.maxDepth);
+	}
+
+	append(key, descriptor.depthStencilState.test);
+	append(key, descriptor.depthStencilState.write);
+	append(key, descriptor.topology);
+	append(key, descriptor.primitiveRestart);
+	append(key, descriptor.renderPass);
+
+	return key;
+}
+
+std::string getPipelineKey(const ComputePipelineDescriptor& descriptor)
+{
+	std::string key;
+	append(key, descriptor.module);
+	append(key, descriptor.entryPoint);
+	return key;
+}
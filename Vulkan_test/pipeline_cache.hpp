@@ -0,0 +1,51 @@
+//
+//  pipeline_cache.hpp
+//  Vulkan_test
+//
+//  Created by Danny on 17/10/2026.
+//  Copyright © 2026 Danny. All rights reserved.
+//
+
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+
+#include <string>
+
+#include "resource_descriptors.hpp"
+
+// Wraps a vk::PipelineCache that persists between runs. The file on disk is only used when its header
+// matches the device we're running on, otherwise we start with an empty cache.
+class PipelineCache {
+public:
+	PipelineCache(const vk::PhysicalDevice& physicalDevice, const vk::Device& logicalDevice, const std::string& path);
+	~PipelineCache();
+
+	PipelineCache(const PipelineCache&) = delete;
+	PipelineCache& operator=(const PipelineCache&) = delete;
+
+	const vk::PipelineCache& get() const { return cache; }
+
+	// True if the cache was primed with data from a previous run.
+	bool isWarm() const { return warm; }
+
+	// Writes the cache to disk. Returns false if there is no path or the write failed.
+	bool save() const;
+
+private:
+
+	bool validateHeader(const std::vector<char>& data) const;
+
+private:
+
+	vk::Device logicalDevice;
+	vk::PhysicalDeviceProperties properties;
+	vk::PipelineCache cache;
+	std::string path;
+	bool warm = false;
+};
+
+// A byte exact description of all the state that ends up in a vk::Pipeline. Equal keys produce
+// equal pipelines, so they can be used to deduplicate createRenderPipeline calls.
+std::string getPipelineKey(const RenderPipelineDescriptor&);
+std::string getPipelineKey(const ComputePipelineDescriptor&);
@@ -0,0 +1,619 @@
+//
+//  png_decoder.cpp
+//  Vulkan_test
+//
+//  Created by Danny on 17/10/2026.
+//  Copyright © 2026 Danny. All rights reserved.
+//
+
+#include "png_decoder.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#include "texture_streamer.hpp"
+
+namespace {
+
+	const uint8_t pngSignature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+
+	// Larger than any device's maxImageDimension2D, keeps the sizes below well within 64 bits.
+	const uint32_t maxDimension = 1 << 15;
+
+	const uint16_t lengthBase[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+	const uint8_t lengthExtra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+	const uint16_t distanceBase[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073,
+									   4097, 6145, 8193, 12289, 16385, 24577};
+	const uint8_t distanceExtra[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+	// The order the lengths of the code length code are stored in.
+	const uint8_t codeLengthOrder[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+
+	uint32_t readU32BigEndian(const uint8_t* data) {
+		return uint32_t(data[0]) << 24 | uint32_t(data[1]) << 16 | uint32_t(data[2]) << 8 | uint32_t(data[3]);
+	}
+
+	// Least significant bit first, as deflate packs them. Reads zeros past the end, the caller checks overrun().
+	class BitReader {
+	public:
+		BitReader(const uint8_t* data, size_t size) : data(data), size(size) {}
+
+		void refill() {
+			while(count <= 56) {
+				if(position < size)
+					bits |= uint64_t(data[position]) << count;
+				++position;
+				count += 8;
+			}
+		}
+
+		uint32_t peek() const { return static_cast<uint32_t>(bits); }
+		void consume(uint32_t n) { bits >>= n; count -= n; }
+
+		uint32_t read(uint32_t n) {
+			if(count < n)
+				refill();
+			const auto value = static_cast<uint32_t>(bits & ((uint64_t(1) << n) - 1));
+			consume(n);
+			return value;
+		}
+
+		// Drops the bits up to the next byte boundary and returns where the stream is in bytes.
+		size_t alignToByte() {
+			consume(count % 8);
+			const size_t offset = position - count / 8;
+			bits = 0;
+			count = 0;
+			position = offset;
+			return offset;
+		}
+
+		void skipTo(size_t offset) { position = offset; }
+
+		bool overrun() const { return position - count / 8 > size; }
+
+	private:
+		const uint8_t* data;
+		size_t size;
+		size_t position = 0;
+		uint64_t bits = 0;
+		uint32_t count = 0;
+	};
+
+	// A canonical Huffman code. Codes up to fastBits long are decoded with one table lookup.
+	class Huffman {
+	public:
+		static const uint32_t fastBits = 9;
+
+		bool build(const uint8_t* lengths, uint32_t symbolCount) {
+			uint32_t counts[16] = {};
+			for(uint32_t i = 0; i < symbolCount; ++i)
+				++counts[lengths[i]];
+			counts[0] = 0;
+
+			uint32_t nextCode[16];
+			uint32_t code = 0, symbol = 0;
+			for(uint32_t length = 1; length < 16; ++length) {
+				nextCode[length] = code;
+				firstCode[length] = static_cast<uint16_t>(code);
+				firstSymbol[length] = static_cast<uint16_t>(symbol);
+				code += counts[length];
+				if(counts[length] && code > (1u << length))
+					return false;
+				maxCode[length] = code << (16 - length);
+				code <<= 1;
+				symbol += counts[length];
+			}
+			maxCode[16] = 0x10000;
+
+			std::fill(std::begin(fast), std::end(fast), 0);
+			std::fill(std::begin(sizes), std::end(sizes), 0);
+			for(uint32_t i = 0; i < symbolCount; ++i) {
+				const uint32_t length = lengths[i];
+				if(!length)
+					continue;
+
+				const uint32_t index = nextCode[length] - firstCode[length] + firstSymbol[length];
+				sizes[index] = static_cast<uint8_t>(length);
+				symbols[index] = static_cast<uint16_t>(i);
+				if(length <= fastBits)
+					for(uint32_t j = reverse(nextCode[length], length); j < (1u << fastBits); j += 1u << length)
+						fast[j] = static_cast<uint16_t>(length << fastBits | i);
+				++nextCode[length];
+			}
+			return true;
+		}
+
+		// -1 for a code that isn't part of the table.
+		int decode(BitReader& reader) const {
+			reader.refill();
+			const auto entry = fast[reader.peek() & ((1u << fastBits) - 1)];
+			if(entry) {
+				reader.consume(entry >> fastBits);
+				return entry & ((1u << fastBits) - 1);
+			}
+
+			const uint32_t code = reverse(reader.peek() & 0xFFFF, 16);
+			uint32_t length = fastBits + 1;
+			while(code >= maxCode[length])
+				if(++length == 16)
+					return -1;
+
+			const uint32_t index = (code >> (16 - length)) - firstCode[length] + firstSymbol[length];
+			if(index >= 288 || sizes[index] != length)
+				return -1;
+			reader.consume(length);
+			return symbols[index];
+		}
+
+	private:
+		static uint32_t reverse(uint32_t code, uint32_t length) {
+			uint32_t result = 0;
+			for(uint32_t i = 0; i < length; ++i)
+				result |= ((code >> i) & 1) << (length - 1 - i);
+			return result;
+		}
+
+		// length << fastBits | symbol, 0 for codes that are longer.
+		uint16_t fast[1 << fastBits];
+		uint16_t firstCode[16];
+		uint16_t firstSymbol[16];
+		uint32_t maxCode[17];
+		uint8_t sizes[288];
+		uint16_t symbols[288];
+	};
+
+	bool readDynamicCodes(BitReader& reader, Huffman& literals, Huffman& distances) {
+		const uint32_t literalCount = reader.read(5) + 257;
+		const uint32_t distanceCount = reader.read(5) + 1;
+		const uint32_t codeLengthCount = reader.read(4) + 4;
+		if(literalCount > 286 || distanceCount > 30)
+			return false;
+
+		uint8_t codeLengthLengths[19] = {};
+		for(uint32_t i = 0; i < codeLengthCount; ++i)
+			codeLengthLengths[codeLengthOrder[i]] = static_cast<uint8_t>(reader.read(3));
+		Huffman codeLengths;
+		if(!codeLengths.build(codeLengthLengths, 19))
+			return false;
+
+		// The literal and distance lengths are one sequence, repeats may run from one into the other.
+		uint8_t lengths[286 + 30] = {};
+		const uint32_t total = literalCount + distanceCount;
+		for(uint32_t i = 0; i < total;) {
+			const int symbol = codeLengths.decode(reader);
+			if(symbol < 0)
+				return false;
+
+			if(symbol < 16) {
+				lengths[i++] = static_cast<uint8_t>(symbol);
+				continue;
+			}
+
+			uint8_t value = 0;
+			uint32_t repeat;
+			if(symbol == 16) {
+				if(i == 0)
+					return false;
+				value = lengths[i - 1];
+				repeat = 3 + reader.read(2);
+			} else if(symbol == 17) {
+				repeat = 3 + reader.read(3);
+			} else {
+				repeat = 11 + reader.read(7);
+			}
+
+			if(i + repeat > total)
+				return false;
+			std::fill(lengths + i, lengths + i + repeat, value);
+			i += repeat;
+		}
+
+		// Without an end of block code the block could never end.
+		if(!lengths[256])
+			return false;
+		return literals.build(lengths, literalCount) && distances.build(lengths + literalCount, distanceCount);
+	}
+
+	// Decodes a block into output, which has room for capacity bytes and holds written of them.
+	bool inflateBlock(BitReader& reader, const Huffman& literals, const Huffman& distances, uint8_t* output, size_t capacity, size_t& written) {
+		for(;;) {
+			const int symbol = literals.decode(reader);
+			if(symbol < 0 || reader.overrun())
+				return false;
+
+			if(symbol < 256) {
+				if(written == capacity)
+					return false;
+				output[written++] = static_cast<uint8_t>(symbol);
+				continue;
+			}
+			if(symbol == 256)
+				return true;
+			if(symbol > 285)
+				return false;
+
+			const uint32_t length = lengthBase[symbol - 257] + reader.read(lengthExtra[symbol - 257]);
+			const int distanceSymbol = distances.decode(reader);
+			if(distanceSymbol < 0 || distanceSymbol >= 30)
+				return false;
+			const uint32_t distance = distanceBase[distanceSymbol] + reader.read(distanceExtra[distanceSymbol]);
+			if(distance > written || capacity - written < length)
+				return false;
+
+			// Byte by byte, the source may overlap what is being written.
+			uint8_t* target = output + written;
+			const uint8_t* source = target - distance;
+			for(uint32_t i = 0; i < length; ++i)
+				target[i] = source[i];
+			written += length;
+		}
+	}
+
+	struct PngInfo
+	{
+		uint32_t width = 0;
+		uint32_t height = 0;
+		uint32_t bitDepth = 0;
+		uint32_t colourType = 0;
+		bool interlaced = false;
+
+		uint32_t channels = 0;
+		// RGBA of every palette entry, alpha from tRNS.
+		uint8_t palette[256][4];
+		uint32_t paletteSize = 0;
+		// The grey or RGB value that is transparent, at the image's bit depth.
+		bool hasTransparentColour = false;
+		uint16_t transparentColour[3] = {};
+	};
+
+	uint32_t getChannelCount(uint32_t colourType) {
+		switch(colourType)
+		{
+			case 0: return 1;
+			case 2: return 3;
+			case 3: return 1;
+			case 4: return 2;
+			case 6: return 4;
+			default: return 0;
+		}
+	}
+
+	bool isValidBitDepth(uint32_t colourType, uint32_t bitDepth) {
+		switch(colourType)
+		{
+			case 0: return bitDepth == 1 || bitDepth == 2 || bitDepth == 4 || bitDepth == 8 || bitDepth == 16;
+			case 3: return bitDepth == 1 || bitDepth == 2 || bitDepth == 4 || bitDepth == 8;
+			default: return bitDepth == 8 || bitDepth == 16;
+		}
+	}
+
+	size_t getRowSize(const PngInfo& info, uint32_t width) {
+		return (size_t(width) * info.channels * info.bitDepth + 7) / 8;
+	}
+
+	uint8_t paeth(uint8_t a, uint8_t b, uint8_t c) {
+		const int p = int(a) + int(b) - int(c);
+		const int pa = std::abs(p - int(a)), pb = std::abs(p - int(b)), pc = std::abs(p - int(c));
+		if(pa <= pb && pa <= pc)
+			return a;
+		return pb <= pc ? b : c;
+	}
+
+	// Undoes the filter of each row in place. rows holds height rows of a filter byte and rowSize bytes.
+	bool unfilter(uint8_t* rows, uint32_t height, size_t rowSize, uint32_t pixelSize) {
+		const uint8_t* previous = nullptr;
+		for(uint32_t y = 0; y < height; ++y) {
+			uint8_t* row = rows + y * (rowSize + 1);
+			const uint8_t filter = row[0];
+			uint8_t* current = row + 1;
+
+			switch(filter)
+			{
+				case 0:
+					break;
+				case 1:
+					for(size_t i = pixelSize; i < rowSize; ++i)
+						current[i] = static_cast<uint8_t>(current[i] + current[i - pixelSize]);
+					break;
+				case 2:
+					if(previous)
+						for(size_t i = 0; i < rowSize; ++i)
+							current[i] = static_cast<uint8_t>(current[i] + previous[i]);
+					break;
+				case 3:
+					// The row above the first is zeros, the pixel left of the first too.
+					if(!previous) {
+						for(size_t i = pixelSize; i < rowSize; ++i)
+							current[i] = static_cast<uint8_t>(current[i] + current[i - pixelSize] / 2);
+						break;
+					}
+					for(size_t i = 0; i < std::min<size_t>(pixelSize, rowSize); ++i)
+						current[i] = static_cast<uint8_t>(current[i] + previous[i] / 2);
+					for(size_t i = pixelSize; i < rowSize; ++i)
+						current[i] = static_cast<uint8_t>(current[i] + (uint32_t(current[i - pixelSize]) + previous[i]) / 2);
+					break;
+				case 4:
+					// Paeth picks the left pixel on the first row and the one above in the first column.
+					if(!previous) {
+						for(size_t i = pixelSize; i < rowSize; ++i)
+							current[i] = static_cast<uint8_t>(current[i] + current[i - pixelSize]);
+						break;
+					}
+					for(size_t i = 0; i < std::min<size_t>(pixelSize, rowSize); ++i)
+						current[i] = static_cast<uint8_t>(current[i] + previous[i]);
+					for(size_t i = pixelSize; i < rowSize; ++i)
+						current[i] = static_cast<uint8_t>(current[i] + paeth(current[i - pixelSize], previous[i], previous[i - pixelSize]));
+					break;
+				default:
+					return false;
+			}
+
+			previous = current;
+		}
+		return true;
+	}
+
+	// Sample x of an unfiltered row at the image's bit depth.
+	uint32_t getSample(const PngInfo& info, const uint8_t* row, size_t index) {
+		switch(info.bitDepth)
+		{
+			case 16: return uint32_t(row[index * 2]) << 8 | row[index * 2 + 1];
+			case 8: return row[index];
+			default: {
+				const size_t bit = index * info.bitDepth;
+				return (row[bit / 8] >> (8 - info.bitDepth - bit % 8)) & ((1u << info.bitDepth) - 1);
+			}
+		}
+	}
+
+	// Converts the unfiltered rows of an image, or of an interlacing pass, to RGBA and writes them every stepX and
+	// stepY pixels of output, starting at x, y.
+	void writeRgba(const PngInfo& info, const uint8_t* rows, uint32_t width, uint32_t height, uint32_t x, uint32_t y, uint32_t stepX, uint32_t stepY, uint8_t* output) {
+		const size_t rowSize = getRowSize(info, width);
+		// Scales grey samples up to 8 bits, 16 bit ones keep their high byte.
+		const uint32_t maxValue = (1u << info.bitDepth) - 1;
+
+		for(uint32_t row = 0; row < height; ++row) {
+			const uint8_t* samples = rows + row * (rowSize + 1) + 1;
+
+			// Most images: 8 bit RGB or RGBA.
+			if(info.bitDepth == 8 && (info.colourType == 6 || (info.colourType == 2 && !info.hasTransparentColour))) {
+				uint8_t* pixel = output + ((size_t(y) + size_t(row) * stepY) * info.width + x) * 4;
+				if(info.colourType == 6 && stepX == 1) {
+					std::memcpy(pixel, samples, size_t(width) * 4);
+					continue;
+				}
+				for(uint32_t column = 0; column < width; ++column, pixel += stepX * 4, samples += info.channels) {
+					pixel[0] = samples[0];
+					pixel[1] = samples[1];
+					pixel[2] = samples[2];
+					pixel[3] = info.channels == 4 ? samples[3] : 255;
+				}
+				continue;
+			}
+
+			for(uint32_t column = 0; column < width; ++column) {
+				uint8_t* pixel = output + ((size_t(y) + size_t(row) * stepY) * info.width + x + size_t(column) * stepX) * 4;
+
+				switch(info.colourType)
+				{
+					case 0:
+					case 4: {
+						const uint32_t grey = getSample(info, samples, size_t(column) * info.channels);
+						pixel[0] = pixel[1] = pixel[2] = static_cast<uint8_t>(info.bitDepth == 16 ? grey >> 8 : grey * 255 / maxValue);
+						if(info.colourType == 4) {
+							const uint32_t alpha = getSample(info, samples, size_t(column) * 2 + 1);
+							pixel[3] = static_cast<uint8_t>(info.bitDepth == 16 ? alpha >> 8 : alpha);
+						} else {
+							pixel[3] = info.hasTransparentColour && grey == info.transparentColour[0] ? 0 : 255;
+						}
+						break;
+					}
+					case 2:
+					case 6: {
+						uint32_t rgb[3];
+						for(uint32_t c = 0; c < 3; ++c) {
+							rgb[c] = getSample(info, samples, size_t(column) * info.channels + c);
+							pixel[c] = static_cast<uint8_t>(info.bitDepth == 16 ? rgb[c] >> 8 : rgb[c]);
+						}
+						if(info.colourType == 6) {
+							const uint32_t alpha = getSample(info, samples, size_t(column) * 4 + 3);
+							pixel[3] = static_cast<uint8_t>(info.bitDepth == 16 ? alpha >> 8 : alpha);
+						} else {
+							const bool transparent = info.hasTransparentColour && rgb[0] == info.transparentColour[0] &&
+								rgb[1] == info.transparentColour[1] && rgb[2] == info.transparentColour[2];
+							pixel[3] = transparent ? 0 : 255;
+						}
+						break;
+					}
+					default: {
+						// Indices past the end of the palette are an error in the file, they come out black.
+						const uint32_t index = getSample(info, samples, column);
+						static const uint8_t black[4] = {0, 0, 0, 255};
+						std::memcpy(pixel, index < info.paletteSize ? info.palette[index] : black, 4);
+						break;
+					}
+				}
+			}
+		}
+	}
+
+	bool readChunks(const uint8_t* data, size_t size, PngInfo& info, std::vector<uint8_t>& compressed) {
+		size_t offset = sizeof(pngSignature);
+		bool first = true;
+		for(;;) {
+			if(size - offset < 12)
+				return false;
+			const uint32_t length = readU32BigEndian(data + offset);
+			const uint8_t* type = data + offset + 4;
+			const uint8_t* chunk = data + offset + 8;
+			if(length > size - offset - 12)
+				return false;
+			offset += size_t(length) + 12;
+
+			if(first != !std::memcmp(type, "IHDR", 4))
+				return false;
+			first = false;
+
+			if(!std::memcmp(type, "IHDR", 4)) {
+				if(length != 13)
+					return false;
+				info.width = readU32BigEndian(chunk);
+				info.height = readU32BigEndian(chunk + 4);
+				info.bitDepth = chunk[8];
+				info.colourType = chunk[9];
+				info.interlaced = chunk[12] == 1;
+				info.channels = getChannelCount(info.colourType);
+				if(!info.width || !info.height || info.width > maxDimension || info.height > maxDimension || !info.channels ||
+				   !isValidBitDepth(info.colourType, info.bitDepth) || chunk[10] || chunk[11] || chunk[12] > 1)
+					return false;
+			} else if(!std::memcmp(type, "PLTE", 4)) {
+				if(length % 3 || length / 3 > 256)
+					return false;
+				info.paletteSize = length / 3;
+				for(uint32_t i = 0; i < info.paletteSize; ++i) {
+					std::memcpy(info.palette[i], chunk + i * 3, 3);
+					info.palette[i][3] = 255;
+				}
+			} else if(!std::memcmp(type, "tRNS", 4)) {
+				if(info.colourType == 3) {
+					for(uint32_t i = 0; i < std::min(length, info.paletteSize); ++i)
+						info.palette[i][3] = chunk[i];
+				} else if((info.colourType == 0 && length == 2) || (info.colourType == 2 && length == 6)) {
+					info.hasTransparentColour = true;
+					for(uint32_t c = 0; c < length / 2; ++c)
+						info.transparentColour[c] = static_cast<uint16_t>(chunk[c * 2] << 8 | chunk[c * 2 + 1]);
+				}
+			} else if(!std::memcmp(type, "IDAT", 4)) {
+				compressed.insert(compressed.end(), chunk, chunk + length);
+			} else if(!std::memcmp(type, "IEND", 4)) {
+				return !compressed.empty() && (info.colourType != 3 || info.paletteSize);
+			} else if(!(type[0] & 0x20)) {
+				// An unknown critical chunk, the image can't be shown without it.
+				return false;
+			}
+		}
+	}
+
+	bool decode(const uint8_t* data, size_t size, DecodedImage& image) {
+		PngInfo info;
+		std::vector<uint8_t> compressed;
+		if(size < sizeof(pngSignature) || std::memcmp(data, pngSignature, sizeof(pngSignature)) || !readChunks(data, size, info, compressed))
+			return false;
+
+		// Adam7 passes: first column and row, and the steps between them.
+		static const uint32_t passes[7][4] = {{0, 0, 8, 8}, {4, 0, 8, 8}, {0, 4, 4, 8}, {2, 0, 4, 4}, {0, 2, 2, 4}, {1, 0, 2, 2}, {0, 1, 1, 2}};
+		static const uint32_t noInterlacing[1][4] = {{0, 0, 1, 1}};
+		const auto* layout = info.interlaced ? passes : noInterlacing;
+		const uint32_t passCount = info.interlaced ? 7 : 1;
+
+		size_t expected = 0;
+		uint32_t widths[7], heights[7];
+		for(uint32_t pass = 0; pass < passCount; ++pass) {
+			widths[pass] = (info.width - std::min(info.width, layout[pass][0]) + layout[pass][2] - 1) / layout[pass][2];
+			heights[pass] = (info.height - std::min(info.height, layout[pass][1]) + layout[pass][3] - 1) / layout[pass][3];
+			if(widths[pass] && heights[pass])
+				expected += heights[pass] * (getRowSize(info, widths[pass]) + 1);
+		}
+
+		// Also keeps tiny files from claiming huge images.
+		if(expected > compressed.size() * 1032)
+			return false;
+
+		std::vector<uint8_t> rows;
+		if(!inflateZlib(compressed.data(), compressed.size(), expected, rows) || rows.size() != expected)
+			return false;
+
+		auto& descriptor = image.descriptor;
+		descriptor = TextureDescriptor();
+		descriptor.width = info.width;
+		descriptor.height = info.height;
+		descriptor.depth = 1;
+		descriptor.layout = ChannelLayout::RGBA;
+		descriptor.dataType = DataType::UNSIGNED_BYTE;
+
+		image.firstMip = 0;
+		image.mips.clear();
+		image.mips.emplace_back(size_t(info.width) * info.height * 4);
+
+		const uint32_t pixelSize = std::max(info.channels * info.bitDepth / 8, 1u);
+		uint8_t* passRows = rows.data();
+		for(uint32_t pass = 0; pass < passCount; ++pass) {
+			if(!widths[pass] || !heights[pass])
+				continue;
+
+			if(!unfilter(passRows, heights[pass], getRowSize(info, widths[pass]), pixelSize))
+				return false;
+			writeRgba(info, passRows, widths[pass], heights[pass], layout[pass][0], layout[pass][1], layout[pass][2], layout[pass][3], image.mips[0].data());
+			passRows += heights[pass] * (getRowSize(info, widths[pass]) + 1);
+		}
+
+		return true;
+	}
+}
+
+bool inflateZlib(const uint8_t* data, size_t size, size_t maxSize, std::vector<uint8_t>& output)
+{
+	output.clear();
+	// Deflate, a window of at most 32K and no preset dictionary.
+	if(size < 2 || (data[0] & 0x0F) != 8 || (data[0] >> 4) > 7 || (data[0] << 8 | data[1]) % 31 || (data[1] & 0x20))
+		return false;
+
+	// Deflate can't expand data more than about 1032 times.
+	output.resize(std::min(maxSize, size * 1032));
+	size_t written = 0;
+
+	BitReader reader(data + 2, size - 2);
+	Huffman literals, distances;
+	bool last = false;
+	while(!last) {
+		last = reader.read(1) != 0;
+		const uint32_t type = reader.read(2);
+
+		if(type == 0) {
+			const size_t offset = reader.alignToByte();
+			if(size - 2 - offset < 4)
+				return false;
+			const uint8_t* block = data + 2 + offset;
+			const uint32_t length = block[0] | block[1] << 8;
+			if((length ^ 0xFFFF) != uint32_t(block[2] | block[3] << 8) || size - 2 - offset - 4 < length || output.size() - written < length)
+				return false;
+			std::memcpy(output.data() + written, block + 4, length);
+			written += length;
+			reader.skipTo(offset + 4 + length);
+		} else if(type == 1) {
+			uint8_t lengths[288 + 30];
+			std::fill(lengths, lengths + 144, 8);
+			std::fill(lengths + 144, lengths + 256, 9);
+			std::fill(lengths + 256, lengths + 280, 7);
+			std::fill(lengths + 280, lengths + 288, 8);
+			std::fill(lengths + 288, lengths + 318, 5);
+			if(!literals.build(lengths, 288) || !distances.build(lengths + 288, 30) ||
+			   !inflateBlock(reader, literals, distances, output.data(), output.size(), written))
+				return false;
+		} else if(type == 2) {
+			if(!readDynamicCodes(reader, literals, distances) || !inflateBlock(reader, literals, distances, output.data(), output.size(), written))
+				return false;
+		} else {
+			return false;
+		}
+
+		if(reader.overrun())
+			return false;
+	}
+
+	output.resize(written);
+	return true;
+}
+
+bool decodePng(const uint8_t* data, size_t size, uint32_t, DecodedImage& image)
+{
+	// 1 bit images take 32 times their raw size as RGBA.
+	try {
+		return decode(data, size, image);
+	} catch(const std::bad_alloc&) {
+		return false;
+	}
+}
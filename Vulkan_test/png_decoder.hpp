@@ -0,0 +1,23 @@
+//
+//  png_decoder.hpp
+//  Vulkan_test
+//
+//  Created by Danny on 17/10/2026.
+//  Copyright © 2026 Danny. All rights reserved.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct DecodedImage;
+
+// Inflates a zlib stream (RFC 1950) into output, which is resized to what came out. Fails rather than produce
+// more than maxSize bytes. The checksum isn't verified.
+bool inflateZlib(const uint8_t* data, size_t size, size_t maxSize, std::vector<uint8_t>& output);
+
+// An ImageDecoder for PNG files of any colour type, bit depth and interlacing. The top level comes out as 8 bit
+// RGBA, 16 bit channels keep their high byte. Ancillary chunks like gAMA and iCCP are ignored.
+bool decodePng(const uint8_t* data, size_t size, uint32_t maxSize, DecodedImage&);
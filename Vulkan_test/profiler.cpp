@@ -0,0 +1,124 @@
+//
+//  profiler.cpp
+//  Vulkan_test
+//
+//  Created by Danny on 17/10/2026.
+//  Copyright © 2026 Danny. All rights reserved.
+//
+
+#include "profiler.hpp"
+
+#include <chrono>
+#include <cstdio>
+
+namespace {
+
+	thread_local void* currentThreadBuffer = nullptr;
+
+	void writeEscaped(std::FILE* file, const char* text) {
+		for(; *text; ++text) {
+			const char c = *text;
+			if(c == '"' || c == '\\')
+				std::fputc('\\', file);
+
+			if(static_cast<unsigned char>(c) < 0x20)
+				std::fprintf(file, "\\u%04x", c);
+			else
+				std::fputc(c, file);
+		}
+	}
+
+	// trace_event wants microseconds.
+	void writeEvent(std::FILE* file, bool& first, const char* name, const char* category, uint32_t pid, uint32_t tid, uint64_t start, uint64_t end) {
+		std::fprintf(file, "%s\n{\"name\":\"", first ? "" : ",");
+		writeEscaped(file, name);
+		std::fprintf(file, "\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":%u,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+					 category, pid, tid, start / 1000.0, (end - start) / 1000.0);
+		first = false;
+	}
+
+	void writeName(std::FILE* file, bool& first, const char* kind, uint32_t pid, uint32_t tid, const char* name) {
+		std::fprintf(file, "%s\n{\"name\":\"%s\",\"ph\":\"M\",\"pid\":%u,\"tid\":%u,\"args\":{\"name\":\"", first ? "" : ",", kind, pid, tid);
+		writeEscaped(file, name);
+		std::fprintf(file, "\"}}");
+		first = false;
+	}
+}
+
+Profiler& Profiler::get() {
+	static Profiler profiler;
+	return profiler;
+}
+
+uint64_t Profiler::now() {
+	return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+Profiler::ThreadBuffer& Profiler::getThreadBuffer() {
+	if(!currentThreadBuffer) {
+		std::lock_guard<std::mutex> lock(mutex);
+		threads.emplace_back(new ThreadBuffer);
+		threads.back()->id = static_cast<uint32_t>(threads.size() - 1);
+		currentThreadBuffer = threads.back().get();
+	}
+
+	return *static_cast<ThreadBuffer*>(currentThreadBuffer);
+}
+
+void Profiler::recordCpu(const char* name, uint64_t start, uint64_t end) {
+	auto& buffer = getThreadBuffer();
+	std::lock_guard<std::mutex> lock(buffer.mutex);
+	if(buffer.events.size() < maximumEventsPerThread)
+		buffer.events.push_back({name, start, end});
+}
+
+void Profiler::recordGpu(const std::string& name, uint64_t start, uint64_t end) {
+	std::lock_guard<std::mutex> lock(mutex);
+	if(gpuEvents.size() < maximumEventsPerThread)
+		gpuEvents.push_back({name, start, end});
+}
+
+void Profiler::setThreadName(const std::string& name) {
+	auto& buffer = getThreadBuffer();
+	std::lock_guard<std::mutex> lock(buffer.mutex);
+	buffer.name = name;
+}
+
+bool Profiler::writeChromeTrace(const std::string& path) {
+	std::FILE* file = std::fopen(path.c_str(), "w");
+	if(!file)
+		return false;
+
+	std::lock_guard<std::mutex> lock(mutex);
+
+	// Cpu threads are process 0, the gpu queue gets a process of its own so it shows as a separate track.
+	bool first = true;
+	std::fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+	writeName(file, first, "process_name", 0, 0, "CPU");
+	writeName(file, first, "process_name", 1, 0, "GPU");
+	writeName(file, first, "thread_name", 1, 0, "Graphics queue");
+
+	for(const auto& thread: threads) {
+		std::lock_guard<std::mutex> threadLock(thread->mutex);
+		const auto name = thread->name.empty() ? "Thread " + std::to_string(thread->id) : thread->name;
+		writeName(file, first, "thread_name", 0, thread->id, name.c_str());
+		for(const auto& event: thread->events)
+			writeEvent(file, first, event.name, "cpu", 0, thread->id, event.start, event.end);
+	}
+
+	for(const auto& event: gpuEvents)
+		writeEvent(file, first, event.name.c_str(), "gpu", 1, 0, event.start, event.end);
+
+	std::fprintf(file, "\n]}\n");
+	return std::fclose(file) == 0;
+}
+
+void Profiler::clear() {
+	std::lock_guard<std::mutex> lock(mutex);
+	for(const auto& thread: threads) {
+		std::lock_guard<std::mutex> threadLock(thread->mutex);
+		thread->events.clear();
+	}
+
+	gpuEvents.clear();
+}
@@ -0,0 +1,96 @@
+//
+//  profiler.hpp
+//  Vulkan_test
+//
+//  Created by Danny on 17/10/2026.
+//  Copyright © 2026 Danny. All rights reserved.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Collects cpu scopes from any thread and gpu scopes resolved by the GpuProfiler, and writes them out in the
+// Chrome trace_event format, which chrome://tracing and Perfetto both open.
+// Instrumentation goes through the PROFILE_ macros, which compile to nothing unless RENDERER_PROFILING is defined.
+class Profiler {
+public:
+	static Profiler& get();
+
+	// Nanoseconds on the steady clock.
+	static uint64_t now();
+
+	// name has to outlive the profiler, string literals and __func__ do.
+	void recordCpu(const char* name, uint64_t start, uint64_t end);
+	// Times are in the cpu's clock domain.
+	void recordGpu(const std::string& name, uint64_t start, uint64_t end);
+
+	void setThreadName(const std::string&);
+
+	bool writeChromeTrace(const std::string& path);
+	void clear();
+
+private:
+
+	struct CpuEvent
+	{
+		const char* name;
+		uint64_t start;
+		uint64_t end;
+	};
+
+	struct GpuEvent
+	{
+		std::string name;
+		uint64_t start;
+		uint64_t end;
+	};
+
+	// Each thread only appends to its own buffer, the mutex is only ever contended while exporting.
+	struct ThreadBuffer
+	{
+		uint32_t id = 0;
+		std::string name;
+		std::mutex mutex;
+		std::vector<CpuEvent> events;
+	};
+
+	ThreadBuffer& getThreadBuffer();
+
+	// A runaway capture stops recording instead of eating all memory.
+	static constexpr size_t maximumEventsPerThread = 1 << 20;
+
+	std::mutex mutex;
+	std::vector<std::unique_ptr<ThreadBuffer>> threads;
+	std::vector<GpuEvent> gpuEvents;
+};
+
+class CpuProfileScope {
+public:
+	explicit CpuProfileScope(const char* name) : name(name), start(Profiler::now()) {}
+	~CpuProfileScope() { Profiler::get().recordCpu(name, start, Profiler::now()); }
+
+	CpuProfileScope(const CpuProfileScope&) = delete;
+	CpuProfileScope& operator=(const CpuProfileScope&) = delete;
+
+private:
+	const char* name;
+	uint64_t start;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#ifdef RENDERER_PROFILING
+#define PROFILE_SCOPE(name) CpuProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name)
+#define PROFILE_FUNCTION() PROFILE_SCOPE(__func__)
+#define PROFILE_THREAD_NAME(name) Profiler::get().setThreadName(name)
+#else
+#define PROFILE_SCOPE(name)
+#define PROFILE_FUNCTION()
+#define PROFILE_THREAD_NAME(name)
+#endif
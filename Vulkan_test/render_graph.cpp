@@ -0,0 +1,538 @@
+//
+//  render_graph.cpp
+//  Vulkan_test
+//
+//  Created by Danny on 17/10/2026.
+//  Copyright © 2026 Danny. All rights reserved.
+//
+
+#include "render_graph.hpp"
+
+#include <algorithm>
+#include <map>
+
+#include "profiler.hpp"
+#include "vulkan_renderer.hpp"
+
+namespace {
+
+	vk::DeviceSize alignUp(vk::DeviceSize value, vk::DeviceSize alignment) {
+		return (value + alignment - 1) / alignment * alignment;
+	}
+}
+
+RenderGraph::RenderGraph(VulkanRenderer& renderer)
+: renderer(renderer) {
+
+}
+
+RenderGraph::~RenderGraph() {
+	for(const auto& pass: passes) {
+		renderer.destroyFramebuffer(pass.framebuffer);
+		renderer.destroyRenderPass(pass.renderPass);
+	}
+
+	for(const auto& resource: resources)
+		if(!resource.imported)
+			renderer.destroyTexture(resource.texture);
+
+	for(const auto& heap: heaps)
+		renderer.freeMemory(heap);
+}
+
+graph_resource_t RenderGraph::createTexture(const std::string& name, const TextureDescriptor& descriptor) {
+	Resource resource;
+	resource.name = name;
+	resource.descriptor = descriptor;
+	resources.emplace_back(resource);
+	return static_cast<graph_resource_t>(resources.size() - 1);
+}
+
+graph_resource_t RenderGraph::importTexture(const std::string& name, resource_handle_t texture, bool preserveContents) {
+	Resource resource;
+	resource.name = name;
+	resource.descriptor = renderer.getTexture(texture).descriptor;
+	resource.texture = texture;
+	resource.imported = true;
+	resource.preserveContents = preserveContents;
+	resources.emplace_back(resource);
+	return static_cast<graph_resource_t>(resources.size() - 1);
+}
+
+void RenderGraph::markOutput(graph_resource_t resource) {
+	resources.at(resource).output = true;
+}
+
+uint32_t RenderGraph::addPass(const std::string& name, RenderGraphPassType type, RenderGraphExecute execute) {
+	Pass pass;
+	pass.name = name;
+	pass.type = type;
+	pass.execute = std::move(execute);
+	passes.emplace_back(std::move(pass));
+	return static_cast<uint32_t>(passes.size() - 1);
+}
+
+void RenderGraph::read(uint32_t pass, graph_resource_t resource) {
+	Access access;
+	access.resource = resource;
+	access.type = AccessType::SAMPLED;
+	passes.at(pass).accesses.emplace_back(access);
+}
+
+void RenderGraph::writeColour(uint32_t pass, graph_resource_t resource, optional<ClearColour> clear) {
+	Access access;
+	access.resource = resource;
+	access.type = AccessType::COLOUR;
+	access.clear = static_cast<bool>(clear);
+	if(clear)
+		access.clearColour = *clear;
+	passes.at(pass).accesses.emplace_back(access);
+}
+
+void RenderGraph::writeDepth(uint32_t pass, graph_resource_t resource, optional<float> clearDepth) {
+	Access access;
+	access.resource = resource;
+	access.type = AccessType::DEPTH;
+	access.clear = static_cast<bool>(clearDepth);
+	if(clearDepth)
+		access.clearDepth = *clearDepth;
+	passes.at(pass).accesses.emplace_back(access);
+}
+
+void RenderGraph::writeStorage(uint32_t pass, graph_resource_t resource) {
+	Access access;
+	access.resource = resource;
+	access.type = AccessType::STORAGE;
+	passes.at(pass).accesses.emplace_back(access);
+}
+
+vk::ImageLayout RenderGraph::getNaturalLayout(const TextureDescriptor& descriptor) {
+	switch(descriptor.usage)
+	{
+		case TextureUsage::RENDER_TARGET:
+			return isDepthFormat(descriptor) ? vk::ImageLayout::eDepthStencilAttachmentOptimal : vk::ImageLayout::eColorAttachmentOptimal;
+		case TextureUsage::WRITE:
+			return vk::ImageLayout::eGeneral;
+		default:
+			return vk::ImageLayout::eShaderReadOnlyOptimal;
+	}
+}
+
+RenderGraph::AccessInfo RenderGraph::getAccessInfo(const Pass& pass, const Access& access) const {
+	const bool compute = pass.type == RenderGraphPassType::COMPUTE;
+
+	AccessInfo info;
+	switch(access.type)
+	{
+		case AccessType::SAMPLED:
+			info.layout = vk::ImageLayout::eShaderReadOnlyOptimal;
+			info.stages = compute ? vk::PipelineStageFlags(vk::PipelineStageFlagBits::eComputeShader) : vk::PipelineStageFlagBits::eVertexShader | vk::PipelineStageFlagBits::eFragmentShader;
+			info.access = vk::AccessFlagBits::eShaderRead;
+			break;
+		case AccessType::COLOUR:
+			info.layout = vk::ImageLayout::eColorAttachmentOptimal;
+			info.stages = vk::PipelineStageFlagBits::eColorAttachmentOutput;
+			info.access = vk::AccessFlagBits::eColorAttachmentWrite;
+			if(access.load == LoadAction::LOAD)
+				info.access |= vk::AccessFlagBits::eColorAttachmentRead;
+			info.write = true;
+			break;
+		case AccessType::DEPTH:
+			info.layout = vk::ImageLayout::eDepthStencilAttachmentOptimal;
+			info.stages = vk::PipelineStageFlagBits::eEarlyFragmentTests | vk::PipelineStageFlagBits::eLateFragmentTests;
+			info.access = vk::AccessFlagBits::eDepthStencilAttachmentRead | vk::AccessFlagBits::eDepthStencilAttachmentWrite;
+			info.write = true;
+			break;
+		case AccessType::STORAGE:
+			info.layout = vk::ImageLayout::eGeneral;
+			info.stages = compute ? vk::PipelineStageFlagBits::eComputeShader : vk::PipelineStageFlagBits::eFragmentShader;
+			info.access = vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite;
+			info.write = true;
+			break;
+	}
+
+	return info;
+}
+
+bool RenderGraph::isNeededAfter(uint32_t pass, graph_resource_t resource) const {
+	if(resources[resource].output)
+		return true;
+
+	for(auto p = pass + 1; p < passes.size(); ++p) {
+		if(!passes[p].alive)
+			continue;
+
+		for(const auto& access: passes[p].accesses) {
+			// A clear throws the contents away.
+			if(access.resource == resource && !access.clear)
+				return true;
+		}
+	}
+
+	return false;
+}
+
+void RenderGraph::cullPasses() {
+	// Walk back from the outputs. A pass lives if it writes something that is needed, and then needs
+	// whatever it reads, and whatever it draws on top of.
+	std::vector<bool> needed(resources.size());
+	for(size_t i = 0; i < resources.size(); ++i)
+		needed[i] = resources[i].output;
+
+	for(auto p = passes.size(); p-- > 0;) {
+		auto& pass = passes[p];
+		pass.alive = false;
+		for(const auto& access: pass.accesses)
+			if(access.type != AccessType::SAMPLED && needed[access.resource])
+				pass.alive = true;
+
+		if(!pass.alive) {
+			statistics.culledPassCount++;
+			continue;
+		}
+
+		for(const auto& access: pass.accesses)
+			if(access.clear)
+				needed[access.resource] = false;
+
+		for(const auto& access: pass.accesses)
+			if(access.type == AccessType::SAMPLED)
+				needed[access.resource] = true;
+	}
+
+	for(uint32_t p = 0; p < passes.size(); ++p) {
+		if(!passes[p].alive)
+			continue;
+
+		for(const auto& access: passes[p].accesses) {
+			auto& resource = resources[access.resource];
+			if(resource.firstPass < 0)
+				resource.firstPass = static_cast<int32_t>(p);
+			resource.lastPass = static_cast<int32_t>(p);
+		}
+	}
+}
+
+bool RenderGraph::allocateTransients() {
+	auto& allocator = renderer.getMemoryAllocator();
+
+	// Transients that survived culling, grouped by the memory type they need.
+	std::map<uint32_t, std::vector<graph_resource_t>> groups;
+	std::map<uint32_t, vk::DeviceSize> alignments;
+	for(graph_resource_t r = 0; r < resources.size(); ++r) {
+		auto& resource = resources[r];
+		if(resource.imported || resource.firstPass < 0)
+			continue;
+
+		// Textures in a graph are always attachments or storage images.
+		if(resource.descriptor.usage == TextureUsage::READ)
+			resource.descriptor.usage = TextureUsage::RENDER_TARGET;
+
+		const auto requirements = renderer.getTextureMemoryRequirements(resource.descriptor);
+		const auto memoryType = allocator.findMemoryType(requirements.memoryTypeBits, vk::MemoryPropertyFlagBits::eDeviceLocal);
+		if(memoryType == static_cast<uint32_t>(-1))
+			return false;
+
+		resource.size = alignUp(requirements.size, requirements.alignment);
+		statistics.transientBytes += resource.size;
+		groups[memoryType].emplace_back(r);
+		alignments[memoryType] = std::max(alignments[memoryType], requirements.alignment);
+	}
+
+	for(auto& group: groups) {
+		auto& members = group.second;
+		const auto alignment = alignments[group.first];
+
+		// Largest first, each at the lowest offset that doesn't collide with a placed texture that is alive at the same time.
+		std::sort(members.begin(), members.end(), [&](graph_resource_t a, graph_resource_t b) {
+			return resources[a].size > resources[b].size;
+		});
+
+		vk::DeviceSize heapSize = 0;
+		std::vector<graph_resource_t> placed;
+		for(auto r: members) {
+			auto& resource = resources[r];
+
+			std::vector<vk::DeviceSize> candidates {0};
+			for(auto q: placed)
+				candidates.emplace_back(alignUp(resources[q].offset + resources[q].size, alignment));
+			std::sort(candidates.begin(), candidates.end());
+
+			for(auto candidate: candidates) {
+				const bool fits = std::none_of(placed.begin(), placed.end(), [&](graph_resource_t q) {
+					const auto& other = resources[q];
+					const bool overlapsInTime = !(other.lastPass < resource.firstPass || resource.lastPass < other.firstPass);
+					const bool overlapsInMemory = candidate < other.offset + other.size && other.offset < candidate + resource.size;
+					return overlapsInTime && overlapsInMemory;
+				});
+
+				if(fits) {
+					resource.offset = candidate;
+					break;
+				}
+			}
+
+			resource.heap = static_cast<uint32_t>(heaps.size());
+			heapSize = std::max(heapSize, resource.offset + resource.size);
+			placed.emplace_back(r);
+		}
+
+		vk::MemoryRequirements requirements;
+		requirements.size = heapSize;
+		requirements.alignment = alignment;
+		requirements.memoryTypeBits = 1u << group.first;
+
+		const auto heap = allocator.allocate(requirements, MemoryUsage::GPU_ONLY, ResourceTiling::OPTIMAL, AllocationStrategy::DEDICATED);
+		if(!heap)
+			return false;
+
+		heaps.emplace_back(heap);
+		statistics.heapBytes += heapSize;
+
+		for(auto r: members) {
+			auto& resource = resources[r];
+			resource.texture = renderer.createAliasedTexture(resource.descriptor, heap, resource.offset);
+			if(resource.texture == null_handle)
+				return false;
+		}
+	}
+
+	return true;
+}
+
+void RenderGraph::placeBarriers() {
+	struct State
+	{
+		vk::ImageLayout layout = vk::ImageLayout::eUndefined;
+		vk::PipelineStageFlags stages;
+		vk::AccessFlags access;
+		bool written = false;
+		bool hasContents = false;
+	};
+
+	// Load ops have to be known before access masks can be, so infer them in a first sweep.
+	std::vector<bool> hasContents(resources.size());
+	for(size_t i = 0; i < resources.size(); ++i)
+		hasContents[i] = resources[i].imported && resources[i].preserveContents;
+
+	for(auto& pass: passes) {
+		if(!pass.alive)
+			continue;
+
+		for(auto& access: pass.accesses) {
+			if(access.type == AccessType::COLOUR || access.type == AccessType::DEPTH)
+				access.load = access.clear ? LoadAction::CLEAR : hasContents[access.resource] ? LoadAction::LOAD : LoadAction::NONE;
+
+			if(access.type != AccessType::SAMPLED)
+				hasContents[access.resource] = true;
+		}
+	}
+
+	for(auto& pass: passes) {
+		if(!pass.alive)
+			continue;
+
+		for(const auto& access: pass.accesses) {
+			const auto info = getAccessInfo(pass, access);
+			resources[access.resource].lastStages = info.stages;
+			resources[access.resource].lastAccess = info.access;
+		}
+	}
+
+	std::vector<State> states(resources.size());
+	for(size_t i = 0; i < resources.size(); ++i) {
+		const auto& resource = resources[i];
+		auto& state = states[i];
+		state.hasContents = resource.imported && resource.preserveContents;
+
+		if(resource.imported) {
+			// Whatever ran before the graph. Only sampled textures are assumed not to be written outside of it.
+			const auto natural = getNaturalLayout(resource.descriptor);
+			state.layout = resource.preserveContents ? natural : vk::ImageLayout::eUndefined;
+			state.stages = vk::PipelineStageFlagBits::eAllCommands;
+			state.written = natural != vk::ImageLayout::eShaderReadOnlyOptimal;
+			state.access = state.written ? vk::AccessFlagBits::eMemoryWrite : vk::AccessFlags();
+			continue;
+		}
+
+		// A transient follows its own last use in the previous frame, and every texture it shares memory with.
+		state.written = true;
+		for(const auto& other: resources) {
+			if(other.imported || other.firstPass < 0 || other.heap != resource.heap)
+				continue;
+
+			if(other.offset < resource.offset + resource.size && resource.offset < other.offset + other.size) {
+				state.stages |= other.lastStages;
+				state.access |= other.lastAccess;
+			}
+		}
+	}
+
+	for(auto& pass: passes) {
+		if(!pass.alive)
+			continue;
+
+		for(const auto& access: pass.accesses) {
+			const auto info = getAccessInfo(pass, access);
+			auto& state = states[access.resource];
+
+			// Read after read in the same layout needs nothing, everything else at least an execution dependency.
+			const bool needsBarrier = state.layout != info.layout || state.written || info.write;
+			if(needsBarrier) {
+				const bool discard = info.write && (access.clear || !state.hasContents);
+
+				vk::ImageMemoryBarrier barrier;
+				barrier.setImage(renderer.getTexture(resources[access.resource].texture).image);
+				barrier.setSubresourceRange(vk::ImageSubresourceRange(getVulkanImageAspect(resources[access.resource].descriptor), 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS));
+				barrier.setSrcQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED);
+				barrier.setDstQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED);
+				barrier.setOldLayout(discard ? vk::ImageLayout::eUndefined : state.layout);
+				barrier.setNewLayout(info.layout);
+				barrier.setSrcAccessMask(state.written ? state.access : vk::AccessFlags());
+				barrier.setDstAccessMask(info.access);
+				pass.barriers.emplace_back(barrier);
+
+				pass.srcStages |= state.stages ? state.stages : vk::PipelineStageFlags(vk::PipelineStageFlagBits::eTopOfPipe);
+				pass.dstStages |= info.stages;
+
+				state.stages = info.stages;
+				state.access = info.access;
+			} else {
+				state.stages |= info.stages;
+				state.access |= info.access;
+			}
+
+			state.layout = info.layout;
+			state.written = info.write;
+			if(info.write)
+				state.hasContents = true;
+		}
+
+		statistics.barrierCount += static_cast<uint32_t>(pass.barriers.size());
+	}
+
+	for(size_t i = 0; i < resources.size(); ++i) {
+		const auto& resource = resources[i];
+		const auto& state = states[i];
+		if(!resource.imported || resource.firstPass < 0)
+			continue;
+
+		const auto natural = getNaturalLayout(resource.descriptor);
+		if(state.layout == natural)
+			continue;
+
+		vk::ImageMemoryBarrier barrier;
+		barrier.setImage(renderer.getTexture(resource.texture).image);
+		barrier.setSubresourceRange(vk::ImageSubresourceRange(getVulkanImageAspect(resource.descriptor), 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS));
+		barrier.setSrcQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED);
+		barrier.setDstQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED);
+		barrier.setOldLayout(state.layout);
+		barrier.setNewLayout(natural);
+		barrier.setSrcAccessMask(state.written ? state.access : vk::AccessFlags());
+		barrier.setDstAccessMask(vk::AccessFlagBits::eMemoryRead | vk::AccessFlagBits::eMemoryWrite);
+		finalBarriers.emplace_back(barrier);
+		finalSrcStages |= state.stages;
+	}
+
+	statistics.barrierCount += static_cast<uint32_t>(finalBarriers.size());
+}
+
+bool RenderGraph::createRenderPasses() {
+	for(uint32_t p = 0; p < passes.size(); ++p) {
+		auto& pass = passes[p];
+		if(!pass.alive || pass.type != RenderGraphPassType::GRAPHICS)
+			continue;
+
+		RenderPassDescriptor descriptor;
+		std::vector<resource_handle_t> attachments;
+		resource_handle_t depthTexture = null_handle;
+
+		for(const auto& access: pass.accesses) {
+			const auto storeAction = isNeededAfter(p, access.resource) ? StoreAction::STORE : StoreAction::DONT_CARE;
+			const auto texture = resources[access.resource].texture;
+
+			if(access.type == AccessType::COLOUR) {
+				RenderPassColourAttachmentDescriptor colour;
+				colour.loadAction = access.load;
+				colour.storeAction = storeAction;
+				colour.clearColour = access.clearColour;
+				colour.texture = texture;
+				descriptor.colourAttachments.emplace_back(colour);
+				attachments.emplace_back(texture);
+			} else if(access.type == AccessType::DEPTH) {
+				RenderPassDepthAttachmentDescriptor depth;
+				depth.loadAction = access.load;
+				depth.storeAction = storeAction;
+				depth.clearDepth = access.clearDepth;
+				depth.texture = texture;
+				descriptor.depthAttachment = depth;
+				depthTexture = texture;
+			}
+		}
+
+		// Depth comes after the colour attachments, like createRenderpass lays them out.
+		if(depthTexture != null_handle)
+			attachments.emplace_back(depthTexture);
+
+		if(attachments.empty())
+			continue;
+
+		pass.renderPass = renderer.createRenderpass(descriptor);
+		if(pass.renderPass == null_handle)
+			return false;
+
+		pass.framebuffer = renderer.createFramebuffer(pass.renderPass, attachments);
+		if(pass.framebuffer == null_handle)
+			return false;
+	}
+
+	return true;
+}
+
+bool RenderGraph::compile() {
+	PROFILE_FUNCTION();
+
+	if(compiled)
+		return true;
+
+	statistics = RenderGraphStatistics();
+	statistics.passCount = static_cast<uint32_t>(passes.size());
+
+	cullPasses();
+	if(!allocateTransients())
+		return false;
+
+	placeBarriers();
+	if(!createRenderPasses())
+		return false;
+
+	compiled = true;
+	return true;
+}
+
+void RenderGraph::execute(vk::CommandBuffer commandBuffer) {
+	PROFILE_FUNCTION();
+
+	if(!compiled)
+		return;
+
+	for(const auto& pass: passes) {
+		if(!pass.alive)
+			continue;
+
+		PROFILE_GPU_SCOPE(renderer.getGpuProfiler(), commandBuffer, pass.name);
+		if(!pass.barriers.empty())
+			commandBuffer.pipelineBarrier(pass.srcStages, pass.dstStages, vk::DependencyFlags(), nullptr, nullptr, pass.barriers);
+
+		if(pass.renderPass != null_handle) {
+			renderer.beginRenderPass(commandBuffer, pass.renderPass, pass.framebuffer);
+			pass.execute(commandBuffer, *this);
+			commandBuffer.endRenderPass();
+		} else {
+			pass.execute(commandBuffer, *this);
+		}
+	}
+
+	if(!finalBarriers.empty())
+		commandBuffer.pipelineBarrier(finalSrcStages, vk::PipelineStageFlagBits::eAllCommands, vk::DependencyFlags(), nullptr, nullptr, finalBarriers);
+}
@@ -0,0 +1,183 @@
+//
+//  render_graph.hpp
+//  Vulkan_test
+//
+//  Created by Danny on 17/10/2026.
+//  Copyright © 2026 Danny. All rights reserved.
+//
+
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "memory_allocator.hpp"
+#include "resource_descriptors.hpp"
+
+class VulkanRenderer;
+class RenderGraph;
+
+// Index of a texture within a render graph.
+using graph_resource_t = uint32_t;
+
+enum class RenderGraphPassType
+{
+	// Runs inside a render pass made of the pass's colour and depth writes.
+	GRAPHICS,
+	// Runs outside of any render pass, writes go through storage images.
+	COMPUTE
+};
+
+using RenderGraphExecute = std::function<void(vk::CommandBuffer, const RenderGraph&)>;
+
+struct RenderGraphStatistics
+{
+	uint32_t passCount 			= 0;
+	uint32_t culledPassCount 	= 0;
+	// Image barriers recorded per execution.
+	uint32_t barrierCount 		= 0;
+	// What the transient textures would take with their own memory, and what they take aliased.
+	uint64_t transientBytes 	= 0;
+	uint64_t heapBytes 			= 0;
+};
+
+// A frame described as passes that read and write textures. compile() works out everything a hand written frame
+// would: passes whose results nobody uses are culled, load and store ops follow from who reads what, barriers are
+// only placed where a hazard or layout change demands one, and transient textures whose lifetimes don't overlap
+// share memory. The graph is compiled once and executed every frame.
+class RenderGraph {
+public:
+	explicit RenderGraph(VulkanRenderer&);
+	~RenderGraph();
+
+	RenderGraph(const RenderGraph&) = delete;
+	RenderGraph& operator=(const RenderGraph&) = delete;
+
+	// A texture that only lives within the graph. Its contents never survive to the next execution.
+	graph_resource_t createTexture(const std::string& name, const TextureDescriptor&);
+	// A texture created by the renderer. With preserveContents the texture has to be in its natural layout
+	// (see getNaturalLayout) when the graph executes, and the first pass writing to it loads what is there.
+	// Imported textures are returned to their natural layout at the end of the graph.
+	graph_resource_t importTexture(const std::string& name, resource_handle_t texture, bool preserveContents = false);
+	// Textures that are needed after the graph ran. Passes that don't contribute to an output are culled.
+	void markOutput(graph_resource_t);
+
+	// Passes execute in the order they are added.
+	uint32_t addPass(const std::string& name, RenderGraphPassType, RenderGraphExecute);
+	// Sampled in a shader.
+	void read(uint32_t pass, graph_resource_t);
+	// Attachments are loaded when earlier contents exist and cleared only when asked to.
+	void writeColour(uint32_t pass, graph_resource_t, optional<ClearColour> clear = {});
+	void writeDepth(uint32_t pass, graph_resource_t, optional<float> clearDepth = {});
+	// Read and written as a storage image.
+	void writeStorage(uint32_t pass, graph_resource_t);
+
+	// Creates the textures, render passes and framebuffers. Returns false if something couldn't be created.
+	bool compile();
+	void execute(vk::CommandBuffer);
+
+	resource_handle_t getTexture(graph_resource_t resource) const { return resources.at(resource).texture; }
+	bool isPassCulled(uint32_t pass) const { return !passes.at(pass).alive; }
+	RenderGraphStatistics getStatistics() const { return statistics; }
+
+	// The layout imported textures are expected in and returned to, depending on their usage.
+	static vk::ImageLayout getNaturalLayout(const TextureDescriptor&);
+
+private:
+
+	enum class AccessType
+	{
+		SAMPLED,
+		COLOUR,
+		DEPTH,
+		STORAGE
+	};
+
+	struct Access
+	{
+		graph_resource_t resource = 0;
+		AccessType type = AccessType::SAMPLED;
+		bool clear = false;
+		// Inferred by compile() for attachments.
+		LoadAction load = LoadAction::NONE;
+		ClearColour clearColour {0, 0, 0, 0};
+		float clearDepth = 1;
+	};
+
+	// How a pass touches a texture.
+	struct AccessInfo
+	{
+		vk::ImageLayout layout = vk::ImageLayout::eUndefined;
+		vk::PipelineStageFlags stages;
+		vk::AccessFlags access;
+		bool write = false;
+	};
+
+	struct Pass
+	{
+		std::string name;
+		RenderGraphPassType type = RenderGraphPassType::GRAPHICS;
+		RenderGraphExecute execute;
+		std::vector<Access> accesses;
+		bool alive = false;
+
+		resource_handle_t renderPass = null_handle;
+		resource_handle_t framebuffer = null_handle;
+
+		// Recorded before the pass.
+		std::vector<vk::ImageMemoryBarrier> barriers;
+		vk::PipelineStageFlags srcStages;
+		vk::PipelineStageFlags dstStages;
+	};
+
+	struct Resource
+	{
+		std::string name;
+		TextureDescriptor descriptor;
+		resource_handle_t texture = null_handle;
+		bool imported = false;
+		bool preserveContents = false;
+		bool output = false;
+
+		// First and last pass that touches the resource, only counting passes that survived culling.
+		int32_t firstPass = -1;
+		int32_t lastPass = -1;
+
+		// Placement in the transient heap.
+		uint32_t heap = 0;
+		vk::DeviceSize offset = 0;
+		vk::DeviceSize size = 0;
+
+		// The stages and accesses of the last pass touching the resource.
+		vk::PipelineStageFlags lastStages;
+		vk::AccessFlags lastAccess;
+	};
+
+	AccessInfo getAccessInfo(const Pass&, const Access&) const;
+	// Whether a pass after the given one, or the world after the graph, needs the contents of a resource.
+	bool isNeededAfter(uint32_t pass, graph_resource_t) const;
+	void cullPasses();
+	bool allocateTransients();
+	bool createRenderPasses();
+	void placeBarriers();
+
+private:
+
+	VulkanRenderer& renderer;
+
+	std::vector<Pass> passes;
+	std::vector<Resource> resources;
+
+	// Memory the transient textures are placed in, one per memory type.
+	std::vector<MemoryAllocation> heaps;
+
+	// Returns imported textures to their natural layout.
+	std::vector<vk::ImageMemoryBarrier> finalBarriers;
+	vk::PipelineStageFlags finalSrcStages;
+
+	RenderGraphStatistics statistics;
+	bool compiled = false;
+};
@@ -20,15 +20,6 @@ using std::experimental::optional;
 using resource_handle_t = std::size_t;
 constexpr resource_handle_t null_handle = -1;
 
-struct DeviceRequirements
-{
-	bool swapchainSupport 		= false;
-	bool graphicsQueueSupport 	= false;
-	bool createDepthBuffer		= false;
-	
-	void* nativeWindowHandle	= nullptr;
-};
-
 struct ClearColour
 {
 	float r;
@@ -63,9 +54,38 @@ enum class ChannelLayout
 	RGBA,
 	BGRA,
 	
-	CO_CG_Y
+	CO_CG_Y,
+	
+	DEPTH,
+	DEPTH_STENCIL
 };
 
+// Formats of 4x4 texel blocks. The channel layout of a compressed texture says what the blocks decode to.
+enum class BlockCompression
+{
+	NONE,
+	
+	// RGB or RGBA with 1 bit alpha, 8 bytes a block.
+	BC1,
+	// BC1 colour with BC4 alpha, 16 bytes.
+	BC3,
+	// A single channel, 8 bytes.
+	BC4,
+	// Two BC4 channels, 16 bytes.
+	BC5,
+	// RGBA, 16 bytes.
+	BC7,
+	
+	ETC2_RGB,
+	ETC2_RGBA,
+	EAC_R,
+	EAC_RG,
+	
+	ASTC_4x4
+};
+
+constexpr uint32_t block_compression_count = static_cast<uint32_t>(BlockCompression::ASTC_4x4) + 1;
+
 enum class LoadAction
 {
 	NONE,
@@ -73,6 +93,12 @@ enum class LoadAction
 	CLEAR
 };
 
+enum class StoreAction
+{
+	STORE,
+	DONT_CARE
+};
+
 enum class TextureType
 {
 	ONE_DIMENSIONAL,
@@ -100,23 +126,149 @@ enum class PrimitiveTopology
 	POINTS
 };
 
+enum class StorageMode
+{
+	// Only accessible by the gpu.
+	PRIVATE,
+	// Written by the cpu and read by the gpu.
+	SHARED,
+	// Written by the gpu and read back by the cpu.
+	READBACK
+};
+
+enum class BufferUsage : uint32_t
+{
+	VERTEX		= 1 << 0,
+	INDEX		= 1 << 1,
+	UNIFORM		= 1 << 2,
+	STORAGE		= 1 << 3,
+	INDIRECT	= 1 << 4
+};
+
+inline BufferUsage operator|(BufferUsage a, BufferUsage b)
+{
+	return static_cast<BufferUsage>(static_cast<uint32_t>(a) | static_cast<uint32_t>(b));
+}
+
+inline bool operator&(BufferUsage a, BufferUsage b)
+{
+	return (static_cast<uint32_t>(a) & static_cast<uint32_t>(b)) != 0;
+}
+
+enum class BindingType
+{
+	UNIFORM_BUFFER,
+	STORAGE_BUFFER,
+	SAMPLED_TEXTURE,
+	STORAGE_TEXTURE
+};
+
 struct TextureDescriptor
 {
 	uint32_t width    = 0;
 	uint32_t height   = 0;
 	uint32_t depth    = 0;
 	
+	uint32_t mipLevels = 1;
 	uint32_t samplesPerPixel = 1;
 	
 	ChannelLayout layout	= ChannelLayout::RGBA;
 	DataType dataType    	= DataType::UNSIGNED_BYTE;
+	BlockCompression compression = BlockCompression::NONE;
+	// Colour that is stored sRGB encoded. Only 8 bit RGBA, BGRA and the colour block formats have sRGB variants.
+	bool srgb = false;
 	
 	TextureType type = TextureType::TWO_DIMENSIONAL;
+	TextureUsage usage = TextureUsage::READ;
+};
+
+struct BufferDescriptor
+{
+	uint64_t size = 0;
+	BufferUsage usage = BufferUsage::VERTEX;
+	StorageMode storageMode = StorageMode::PRIVATE;
+};
+
+// How frames reach the window. Policies the surface can't do fall back to VSYNC, which every surface supports.
+enum class PresentPolicy
+{
+	// Waits for the vertical blank, the cpu and gpu stall once the swapchain is full.
+	VSYNC,
+	// Triple buffering: never tears, never stalls, frames that weren't shown in time are replaced by newer ones.
+	MAILBOX,
+	// Presents straight away and may tear. Falls back to MAILBOX before VSYNC.
+	IMMEDIATE,
+	// Waits for the vertical blank, but every frame only starts once the previous one was presented, so input is
+	// read as late as possible. Uses VK_KHR_present_wait where available, otherwise waits for the previous frame's rendering.
+	LOW_LATENCY
+};
+
+struct DeviceRequirements
+{
+	bool swapchainSupport 		= false;
+	bool graphicsQueueSupport 	= false;
+	bool createDepthBuffer		= false;
+	
+	// How many frames the cpu may record ahead of the gpu, between 1 and 3.
+	uint32_t framesInFlight		= 2;
+	
+	// Threads used for parallel command recording, 0 uses one per hardware thread.
+	uint32_t workerThreads		= 0;
+	
+	void* nativeWindowHandle	= nullptr;
+	
+	PresentPolicy presentPolicy	= PresentPolicy::MAILBOX;
+	// Holds frames back so they start at most this often, in milliseconds. 0 starts them as soon as possible.
+	double targetFrameInterval	= 0;
+	
+	// Run without a window. Devices are picked on graphics (or compute, without graphicsQueueSupport)
+	// capability alone and rendering goes to the offscreen targets.
+	bool headless				= false;
+	TextureDescriptor offscreenColourTarget;
+	
+	// Where the pipeline cache is loaded from, and saved to when the renderer is destroyed. Empty keeps it in memory only.
+	std::string pipelineCachePath;
+	
+	// Directory compiled SPIR-V is cached in. Empty compiles every shader from source.
+	std::string shaderCachePath;
+	
+	// Sampled textures, samplers and storage buffers get an index into one large descriptor set, see
+	// BindlessTable. Ignored if the device lacks descriptor indexing.
+	bool bindless				= false;
+	
+	// Where the chosen device is remembered between runs, which skips probing every device. Empty always probes.
+	std::string deviceCachePath;
+	
+#ifdef DEBUG
+	// The validation layer, if it is installed.
+	bool validation				= true;
+	// Every feature the device supports instead of only those the renderer uses. Features like
+	// robustBufferAccess aren't free, release builds leave them off.
+	bool allDeviceFeatures		= true;
+#else
+	bool validation				= false;
+	bool allDeviceFeatures		= false;
+#endif
+};
+
+// A buffer or texture bound to a binding of a pipeline's descriptor set.
+struct ResourceBinding
+{
+	uint32_t binding = 0;
+	BindingType type = BindingType::UNIFORM_BUFFER;
+	
+	resource_handle_t buffer 	= null_handle;
+	uint64_t offset 			= 0;
+	// 0 binds the rest of the buffer.
+	uint64_t size 				= 0;
+	
+	resource_handle_t texture 	= null_handle;
 };
 
 struct RenderPassAttachmentDescriptor
 {
 	LoadAction loadAction;
+	StoreAction storeAction = StoreAction::STORE;
 	resource_handle_t texture = null_handle;
 };
 
@@ -153,6 +305,25 @@ struct ShaderStageDescriptor
 	resource_handle_t module;
 };
 
+enum class ShaderLanguage
+{
+	GLSL,
+	HLSL
+};
+
+struct ShaderSourceDescriptor
+{
+	std::string source;
+	// Shows up in compiler errors, relative includes are resolved from its directory.
+	std::string path;
+	
+	ShaderLanguage language = ShaderLanguage::GLSL;
+	ShaderStageDescriptor::Type stage = ShaderStageDescriptor::Type::VERTEX;
+	std::string entryPoint = "main";
+	
+	std::map<std::string, std::string> defines;
+};
+
 struct VertexAttributeDescriptor
 {
 	DataType type;
@@ -193,6 +364,12 @@ struct RenderPipelineDescriptor
 	resource_handle_t renderPass		= null_handle;
 };
 
+struct ComputePipelineDescriptor
+{
+	resource_handle_t module = null_handle;
+	std::string entryPoint = "main";
+};
+
 struct NodeResourceDescriptor
 {
 	int32_t camera = -1;
@@ -210,12 +387,22 @@ struct NodeResourceDescriptor
 	std::string name;
 };
 
+// A lower level of detail of a primitive, indexing the same vertices.
+struct PrimitiveLod
+{
+	int32_t indices		= -1;
+	// How far the surface moved, relative to the size of the primitive.
+	float error			= 0;
+};
+
 struct Primitive
 {
-	std::map<char*, int32_t> attributes;
+	std::map<std::string, int32_t> attributes;
 	int32_t indices		= -1;
 	int32_t material	= -1;
 	int32_t mode		= 4;
+	// Coarsest last. Stored in the primitive's extras as "lods": [{"indices": ..., "error": ...}].
+	std::vector<PrimitiveLod> lods;
 };
 
 struct Mesh
@@ -263,5 +450,15 @@ struct SamplerResourceDescriptor
 
 struct Accessor
 {
-	
+	int32_t bufferView		= -1;
+	int32_t byteOffset		= 0;
+	// GL enum of the component type, e.g. 5126 for FLOAT.
+	int32_t componentType	= -1;
+	bool normalized			= false;
+	int32_t count			= -1;
+	// "SCALAR", "VEC2", "VEC3", "VEC4", "MAT2", "MAT3" or "MAT4".
+	std::string type;
+	std::vector<float> min;
+	std::vector<float> max;
+	std::string name;
 };
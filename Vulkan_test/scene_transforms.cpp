@@ -0,0 +1,359 @@
+//
+//  scene_transforms.cpp
+//  Vulkan_test
+//
+//  Created by Danny on 17/10/2026.
+//  Copyright © 2026 Danny. All rights reserved.
+//
+
+#include "scene_transforms.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "job_system.hpp"
+#include "scene_transforms_avx2.hpp"
+
+#if defined(__SSE__) || defined(_M_X64)
+#include <immintrin.h>
+#define SCENE_TRANSFORMS_SSE 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define SCENE_TRANSFORMS_NEON 1
+#endif
+
+namespace {
+
+	// Local matrices are composed in blocks of this many nodes, the arrays are padded to a multiple of it.
+	const uint32_t blockSize = 8;
+	// Subtrees up to this size are updated as a single job.
+	const uint32_t subtreeJobSize = 4096;
+
+	const float identity[16] {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1};
+
+	// result = a * b, all column major. result may not alias a or b.
+	void multiply(const float* a, const float* b, float* result) {
+#if defined(SCENE_TRANSFORMS_SSE)
+		const __m128 a0 = _mm_loadu_ps(a);
+		const __m128 a1 = _mm_loadu_ps(a + 4);
+		const __m128 a2 = _mm_loadu_ps(a + 8);
+		const __m128 a3 = _mm_loadu_ps(a + 12);
+		for(int c = 0; c < 16; c += 4) {
+			const __m128 column = _mm_loadu_ps(b + c);
+			__m128 r = _mm_mul_ps(a0, _mm_shuffle_ps(column, column, 0x00));
+			r = _mm_add_ps(r, _mm_mul_ps(a1, _mm_shuffle_ps(column, column, 0x55)));
+			r = _mm_add_ps(r, _mm_mul_ps(a2, _mm_shuffle_ps(column, column, 0xAA)));
+			r = _mm_add_ps(r, _mm_mul_ps(a3, _mm_shuffle_ps(column, column, 0xFF)));
+			_mm_storeu_ps(result + c, r);
+		}
+#elif defined(SCENE_TRANSFORMS_NEON)
+		const float32x4_t a0 = vld1q_f32(a);
+		const float32x4_t a1 = vld1q_f32(a + 4);
+		const float32x4_t a2 = vld1q_f32(a + 8);
+		const float32x4_t a3 = vld1q_f32(a + 12);
+		for(int c = 0; c < 16; c += 4) {
+			float32x4_t r = vmulq_n_f32(a0, b[c]);
+			r = vmlaq_n_f32(r, a1, b[c + 1]);
+			r = vmlaq_n_f32(r, a2, b[c + 2]);
+			r = vmlaq_n_f32(r, a3, b[c + 3]);
+			vst1q_f32(result + c, r);
+		}
+#else
+		for(int c = 0; c < 4; ++c)
+			for(int r = 0; r < 4; ++r)
+				result[c * 4 + r] = a[r] * b[c * 4] + a[4 + r] * b[c * 4 + 1] + a[8 + r] * b[c * 4 + 2] + a[12 + r] * b[c * 4 + 3];
+#endif
+	}
+
+	// Splits a matrix into translation, rotation and scale. Assumes there is no shear.
+	void decompose(const float* m, float* translation, float* rotation, float* scale) {
+		translation[0] = m[12];
+		translation[1] = m[13];
+		translation[2] = m[14];
+
+		for(int c = 0; c < 3; ++c)
+			scale[c] = std::sqrt(m[c * 4] * m[c * 4] + m[c * 4 + 1] * m[c * 4 + 1] + m[c * 4 + 2] * m[c * 4 + 2]);
+
+		const float determinant = m[0] * (m[5] * m[10] - m[9] * m[6]) - m[4] * (m[1] * m[10] - m[9] * m[2]) + m[8] * (m[1] * m[6] - m[5] * m[2]);
+		if(determinant < 0)
+			scale[0] = -scale[0];
+
+		float r[9];
+		for(int c = 0; c < 3; ++c)
+			for(int row = 0; row < 3; ++row)
+				r[c * 3 + row] = scale[c] != 0 ? m[c * 4 + row] / scale[c] : 0;
+
+		// r is column major, r[c * 3 + row].
+		const float trace = r[0] + r[4] + r[8];
+		if(trace > 0) {
+			const float s = std::sqrt(trace + 1) * 2;
+			rotation[3] = s / 4;
+			rotation[0] = (r[5] - r[7]) / s;
+			rotation[1] = (r[6] - r[2]) / s;
+			rotation[2] = (r[1] - r[3]) / s;
+		} else if(r[0] > r[4] && r[0] > r[8]) {
+			const float s = std::sqrt(1 + r[0] - r[4] - r[8]) * 2;
+			rotation[3] = (r[5] - r[7]) / s;
+			rotation[0] = s / 4;
+			rotation[1] = (r[3] + r[1]) / s;
+			rotation[2] = (r[6] + r[2]) / s;
+		} else if(r[4] > r[8]) {
+			const float s = std::sqrt(1 + r[4] - r[0] - r[8]) * 2;
+			rotation[3] = (r[6] - r[2]) / s;
+			rotation[0] = (r[3] + r[1]) / s;
+			rotation[1] = s / 4;
+			rotation[2] = (r[7] + r[5]) / s;
+		} else {
+			const float s = std::sqrt(1 + r[8] - r[0] - r[4]) * 2;
+			rotation[3] = (r[1] - r[3]) / s;
+			rotation[0] = (r[6] + r[2]) / s;
+			rotation[1] = (r[7] + r[5]) / s;
+			rotation[2] = s / 4;
+		}
+	}
+}
+
+void SceneTransforms::build(const std::vector<NodeResourceDescriptor>& nodes, const std::vector<int32_t>& roots) {
+	// Depth first, children in declaration order. Iterative, so deep hierarchies can't overflow the stack.
+	lookup.assign(nodes.size(), -1);
+	sourceNodes.clear();
+	parents.clear();
+
+	std::vector<std::pair<int32_t, int32_t>> stack;
+	for(auto root = roots.rbegin(); root != roots.rend(); ++root)
+		stack.emplace_back(*root, -1);
+
+	while(!stack.empty()) {
+		const auto node = stack.back().first;
+		const auto parent = stack.back().second;
+		stack.pop_back();
+
+		// A node can only have one parent, ignore any further references.
+		if(node < 0 || node >= static_cast<int32_t>(nodes.size()) || lookup[node] >= 0)
+			continue;
+
+		const auto index = static_cast<int32_t>(sourceNodes.size());
+		lookup[node] = index;
+		sourceNodes.emplace_back(node);
+		parents.emplace_back(parent);
+
+		const auto& children = nodes[node].children;
+		for(auto child = children.rbegin(); child != children.rend(); ++child)
+			stack.emplace_back(*child, index);
+	}
+
+	count = static_cast<uint32_t>(sourceNodes.size());
+	const uint32_t padded = (count + blockSize - 1) / blockSize * blockSize;
+
+	tx.assign(padded, 0); ty.assign(padded, 0); tz.assign(padded, 0);
+	rx.assign(padded, 0); ry.assign(padded, 0); rz.assign(padded, 0); rw.assign(padded, 1);
+	sx.assign(padded, 1); sy.assign(padded, 1); sz.assign(padded, 1);
+
+	for(uint32_t i = 0; i < count; ++i) {
+		const auto& node = nodes[sourceNodes[i]];
+
+		float translation[3] {node.translation[0], node.translation[1], node.translation[2]};
+		float rotation[4] {node.rotation[0], node.rotation[1], node.rotation[2], node.rotation[3]};
+		float scale[3] {node.scale[0], node.scale[1], node.scale[2]};
+		if(std::memcmp(node.matrix, identity, sizeof(identity)) != 0)
+			decompose(node.matrix, translation, rotation, scale);
+
+		tx[i] = translation[0]; ty[i] = translation[1]; tz[i] = translation[2];
+		rx[i] = rotation[0]; ry[i] = rotation[1]; rz[i] = rotation[2]; rw[i] = rotation[3];
+		sx[i] = scale[0]; sy[i] = scale[1]; sz[i] = scale[2];
+	}
+
+	localMatrices.assign(padded * 16, 0);
+	worldMatrices.assign(padded * 16, 0);
+	dirty.assign(padded, 1);
+	changed.assign(padded, 0);
+
+	// Subtree sizes, children always come after their parent.
+	std::vector<uint32_t> subtreeSizes(count, 1);
+	for(uint32_t i = count; i-- > 0;)
+		if(parents[i] >= 0)
+			subtreeSizes[parents[i]] += subtreeSizes[i];
+
+	// Cut the hierarchy into the largest subtrees that still make a reasonable job. What is left above them is small.
+	upperNodes.clear();
+	subtreeJobs.clear();
+	for(uint32_t i = 0; i < count;) {
+		if(subtreeSizes[i] <= subtreeJobSize) {
+			// Merge neighbouring small subtrees, they are contiguous anyway.
+			if(!subtreeJobs.empty() && subtreeJobs.back().second == i && subtreeJobs.back().second - subtreeJobs.back().first + subtreeSizes[i] <= subtreeJobSize)
+				subtreeJobs.back().second = i + subtreeSizes[i];
+			else
+				subtreeJobs.emplace_back(i, i + subtreeSizes[i]);
+
+			i += subtreeSizes[i];
+		} else {
+			upperNodes.emplace_back(i);
+			i++;
+		}
+	}
+}
+
+void SceneTransforms::setTranslation(uint32_t index, const float translation[3]) {
+	tx[index] = translation[0];
+	ty[index] = translation[1];
+	tz[index] = translation[2];
+	dirty[index] = 1;
+}
+
+void SceneTransforms::setRotation(uint32_t index, const float rotation[4]) {
+	rx[index] = rotation[0];
+	ry[index] = rotation[1];
+	rz[index] = rotation[2];
+	rw[index] = rotation[3];
+	dirty[index] = 1;
+}
+
+void SceneTransforms::setScale(uint32_t index, const float scale[3]) {
+	sx[index] = scale[0];
+	sy[index] = scale[1];
+	sz[index] = scale[2];
+	dirty[index] = 1;
+}
+
+void SceneTransforms::setLocalMatrix(uint32_t index, const float matrix[16]) {
+	float translation[3], rotation[4], scale[3];
+	decompose(matrix, translation, rotation, scale);
+	setTranslation(index, translation);
+	setRotation(index, rotation);
+	setScale(index, scale);
+}
+
+void SceneTransforms::composeLocalMatrices(uint32_t beginBlock, uint32_t endBlock) {
+	for(auto block = beginBlock; block < endBlock; ++block) {
+		const uint32_t first = block * blockSize;
+
+		// Blocks are cheap enough that it doesn't pay to skip clean nodes within one.
+		uint64_t anyDirty = 0;
+		std::memcpy(&anyDirty, &dirty[first], sizeof(anyDirty));
+		if(!anyDirty)
+			continue;
+
+#if defined(SCENE_TRANSFORMS_SSE) || defined(SCENE_TRANSFORMS_NEON)
+		for(uint32_t i = first; i < first + blockSize; i += 4) {
+#if defined(SCENE_TRANSFORMS_SSE)
+			const __m128 one = _mm_set1_ps(1), two = _mm_set1_ps(2), zero = _mm_setzero_ps();
+			const __m128 x = _mm_loadu_ps(&rx[i]), y = _mm_loadu_ps(&ry[i]), z = _mm_loadu_ps(&rz[i]), w = _mm_loadu_ps(&rw[i]);
+			const __m128 xx = _mm_mul_ps(x, x), yy = _mm_mul_ps(y, y), zz = _mm_mul_ps(z, z);
+			const __m128 xy = _mm_mul_ps(x, y), xz = _mm_mul_ps(x, z), yz = _mm_mul_ps(y, z);
+			const __m128 xw = _mm_mul_ps(x, w), yw = _mm_mul_ps(y, w), zw = _mm_mul_ps(z, w);
+			const __m128 scaleX = _mm_loadu_ps(&sx[i]), scaleY = _mm_loadu_ps(&sy[i]), scaleZ = _mm_loadu_ps(&sz[i]);
+
+			// Element [column][row] of the four matrices, one node per lane.
+			__m128 m[4][4] = {
+				{_mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz))), scaleX), _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xy, zw)), scaleX), _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xz, yw)), scaleX), zero},
+				{_mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xy, zw)), scaleY), _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz))), scaleY), _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(yz, xw)), scaleY), zero},
+				{_mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xz, yw)), scaleZ), _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(yz, xw)), scaleZ), _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy))), scaleZ), zero},
+				{_mm_loadu_ps(&tx[i]), _mm_loadu_ps(&ty[i]), _mm_loadu_ps(&tz[i]), one}
+			};
+
+			// Transposing the rows of a column gives that column for each of the four nodes.
+			for(int c = 0; c < 4; ++c) {
+				_MM_TRANSPOSE4_PS(m[c][0], m[c][1], m[c][2], m[c][3]);
+				for(int n = 0; n < 4; ++n)
+					_mm_storeu_ps(&localMatrices[(i + n) * 16 + c * 4], m[c][n]);
+			}
+#else
+			const float32x4_t one = vdupq_n_f32(1), two = vdupq_n_f32(2), zero = vdupq_n_f32(0);
+			const float32x4_t x = vld1q_f32(&rx[i]), y = vld1q_f32(&ry[i]), z = vld1q_f32(&rz[i]), w = vld1q_f32(&rw[i]);
+			const float32x4_t xx = vmulq_f32(x, x), yy = vmulq_f32(y, y), zz = vmulq_f32(z, z);
+			const float32x4_t xy = vmulq_f32(x, y), xz = vmulq_f32(x, z), yz = vmulq_f32(y, z);
+			const float32x4_t xw = vmulq_f32(x, w), yw = vmulq_f32(y, w), zw = vmulq_f32(z, w);
+			const float32x4_t scaleX = vld1q_f32(&sx[i]), scaleY = vld1q_f32(&sy[i]), scaleZ = vld1q_f32(&sz[i]);
+
+			const float32x4_t m[4][4] = {
+				{vmulq_f32(vmlsq_f32(one, two, vaddq_f32(yy, zz)), scaleX), vmulq_f32(vmulq_f32(two, vaddq_f32(xy, zw)), scaleX), vmulq_f32(vmulq_f32(two, vsubq_f32(xz, yw)), scaleX), zero},
+				{vmulq_f32(vmulq_f32(two, vsubq_f32(xy, zw)), scaleY), vmulq_f32(vmlsq_f32(one, two, vaddq_f32(xx, zz)), scaleY), vmulq_f32(vmulq_f32(two, vaddq_f32(yz, xw)), scaleY), zero},
+				{vmulq_f32(vmulq_f32(two, vaddq_f32(xz, yw)), scaleZ), vmulq_f32(vmulq_f32(two, vsubq_f32(yz, xw)), scaleZ), vmulq_f32(vmlsq_f32(one, two, vaddq_f32(xx, yy)), scaleZ), zero},
+				{vld1q_f32(&tx[i]), vld1q_f32(&ty[i]), vld1q_f32(&tz[i]), one}
+			};
+
+			for(int c = 0; c < 4; ++c) {
+				const float32x4x2_t low = vzipq_f32(m[c][0], m[c][1]);
+				const float32x4x2_t high = vzipq_f32(m[c][2], m[c][3]);
+				vst1q_f32(&localMatrices[i * 16 + c * 4], vcombine_f32(vget_low_f32(low.val[0]), vget_low_f32(high.val[0])));
+				vst1q_f32(&localMatrices[(i + 1) * 16 + c * 4], vcombine_f32(vget_high_f32(low.val[0]), vget_high_f32(high.val[0])));
+				vst1q_f32(&localMatrices[(i + 2) * 16 + c * 4], vcombine_f32(vget_low_f32(low.val[1]), vget_low_f32(high.val[1])));
+				vst1q_f32(&localMatrices[(i + 3) * 16 + c * 4], vcombine_f32(vget_high_f32(low.val[1]), vget_high_f32(high.val[1])));
+			}
+#endif
+		}
+#else
+		for(uint32_t i = first; i < first + blockSize; ++i) {
+			const float x = rx[i], y = ry[i], z = rz[i], w = rw[i];
+			float* m = &localMatrices[i * 16];
+			m[0] = (1 - 2 * (y * y + z * z)) * sx[i];
+			m[1] = 2 * (x * y + z * w) * sx[i];
+			m[2] = 2 * (x * z - y * w) * sx[i];
+			m[3] = 0;
+			m[4] = 2 * (x * y - z * w) * sy[i];
+			m[5] = (1 - 2 * (x * x + z * z)) * sy[i];
+			m[6] = 2 * (y * z + x * w) * sy[i];
+			m[7] = 0;
+			m[8] = 2 * (x * z + y * w) * sz[i];
+			m[9] = 2 * (y * z - x * w) * sz[i];
+			m[10] = (1 - 2 * (x * x + y * y)) * sz[i];
+			m[11] = 0;
+			m[12] = tx[i];
+			m[13] = ty[i];
+			m[14] = tz[i];
+			m[15] = 1;
+		}
+#endif
+	}
+}
+
+void SceneTransforms::propagateNode(uint32_t index) {
+	const auto parent = parents[index];
+	changed[index] = dirty[index] || (parent >= 0 && changed[parent]);
+	if(!changed[index])
+		return;
+
+	if(parent < 0)
+		std::memcpy(&worldMatrices[index * 16], &localMatrices[index * 16], 16 * sizeof(float));
+	else
+		multiply(&worldMatrices[parent * 16], &localMatrices[index * 16], &worldMatrices[index * 16]);
+}
+
+void SceneTransforms::propagate(uint32_t begin, uint32_t end) {
+	if(hasSceneTransformsAvx2()) {
+		propagateAvx2(parents.data(), dirty.data(), changed.data(), localMatrices.data(), worldMatrices.data(), begin, end);
+		return;
+	}
+
+	for(auto i = begin; i < end; ++i)
+		propagateNode(i);
+}
+
+void SceneTransforms::update(JobSystem* jobSystem) {
+	const uint32_t blockCount = (count + blockSize - 1) / blockSize;
+
+	if(jobSystem) {
+		jobSystem->parallelFor(blockCount, 512, [this](uint32_t begin, uint32_t end) {
+			composeLocalMatrices(begin, end);
+		});
+	} else {
+		composeLocalMatrices(0, blockCount);
+	}
+
+	// The few nodes above the job sized subtrees go first, the subtrees only depend on them.
+	for(auto node: upperNodes)
+		propagate(node, node + 1);
+
+	if(jobSystem) {
+		jobSystem->parallelFor(static_cast<uint32_t>(subtreeJobs.size()), 1, [this](uint32_t begin, uint32_t end) {
+			for(auto job = begin; job < end; ++job)
+				propagate(subtreeJobs[job].first, subtreeJobs[job].second);
+		});
+	} else {
+		for(const auto& job: subtreeJobs)
+			propagate(job.first, job.second);
+	}
+
+	std::fill(dirty.begin(), dirty.end(), 0);
+}
@@ -0,0 +1,83 @@
+//
+//  scene_transforms.hpp
+//  Vulkan_test
+//
+//  Created by Danny on 17/10/2026.
+//  Copyright © 2026 Danny. All rights reserved.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "resource_descriptors.hpp"
+
+class JobSystem;
+
+// The runtime form of a node hierarchy. Nodes are flattened depth first, so every parent comes before its children
+// and every subtree is one contiguous range. Transforms are kept as separate arrays per component, matrices are
+// column major like glTF. Only nodes whose transform changed, and their descendants, are recomputed by update().
+class SceneTransforms {
+public:
+	// Nodes that can't be reached from the roots are left out. Nodes given as a matrix are decomposed into
+	// translation, rotation and scale, as glTF requires those matrices to be decomposable.
+	void build(const std::vector<NodeResourceDescriptor>& nodes, const std::vector<int32_t>& roots);
+
+	uint32_t size() const { return count; }
+
+	// Flattened index of a source node, or -1 if it wasn't reachable.
+	int32_t getIndex(int32_t node) const { return node >= 0 && node < static_cast<int32_t>(lookup.size()) ? lookup[node] : -1; }
+	int32_t getSourceNode(uint32_t index) const { return sourceNodes[index]; }
+	int32_t getParent(uint32_t index) const { return parents[index]; }
+
+	void setTranslation(uint32_t index, const float translation[3]);
+	// A unit quaternion as x, y, z, w.
+	void setRotation(uint32_t index, const float rotation[4]);
+	void setScale(uint32_t index, const float scale[3]);
+	void setLocalMatrix(uint32_t index, const float matrix[16]);
+
+	// Recomputes the local and world matrices of changed nodes. With a job system, independent subtrees are
+	// updated in parallel.
+	void update(JobSystem* jobSystem = nullptr);
+
+	const float* getLocalMatrix(uint32_t index) const { return &localMatrices[index * 16]; }
+	const float* getWorldMatrix(uint32_t index) const { return &worldMatrices[index * 16]; }
+	const float* getWorldMatrices() const { return worldMatrices.data(); }
+
+	// Whether the world matrix of a node changed in the last update.
+	bool hasChanged(uint32_t index) const { return changed[index] != 0; }
+
+private:
+
+	void composeLocalMatrices(uint32_t beginBlock, uint32_t endBlock);
+	void propagate(uint32_t begin, uint32_t end);
+	void propagateNode(uint32_t index);
+
+private:
+
+	uint32_t count = 0;
+
+	// Translation, rotation and scale per component, padded with identity transforms to a multiple of the simd width.
+	std::vector<float> tx, ty, tz;
+	std::vector<float> rx, ry, rz, rw;
+	std::vector<float> sx, sy, sz;
+
+	std::vector<float> localMatrices;
+	std::vector<float> worldMatrices;
+
+	std::vector<int32_t> parents;
+	std::vector<int32_t> sourceNodes;
+	std::vector<int32_t> lookup;
+
+	// Local transform changed since the last update.
+	std::vector<uint8_t> dirty;
+	// World transform changed in the last update.
+	std::vector<uint8_t> changed;
+
+	// Nodes with subtrees too large for one job, updated in order before the jobs run.
+	std::vector<uint32_t> upperNodes;
+	// Ranges of whole subtrees that are updated as one job each.
+	std::vector<std::pair<uint32_t, uint32_t>> subtreeJobs;
+};
@@ -0,0 +1,66 @@
+//
+//  scene_transforms_avx2.cpp
+//  Vulkan_test
+//
+//  Created by Danny on 17/10/2026.
+//  Copyright © 2026 Danny. All rights reserved.
+//
+
+#include "scene_transforms_avx2.hpp"
+
+#include "cpu_features.hpp"
+
+#if defined(__AVX2__) && defined(__FMA__)
+#include <immintrin.h>
+
+namespace {
+
+	// result = a * b, all column major. result may not alias a or b.
+	void multiply(const float* a, const float* b, float* result) {
+		// Two result columns per iteration: each 128 bit lane holds one column.
+		const __m256 a0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a));
+		const __m256 a1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a + 4));
+		const __m256 a2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a + 8));
+		const __m256 a3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a + 12));
+		for(int c = 0; c < 16; c += 8) {
+			const __m256 columns = _mm256_loadu_ps(b + c);
+			__m256 r = _mm256_mul_ps(a0, _mm256_permute_ps(columns, 0x00));
+			r = _mm256_fmadd_ps(a1, _mm256_permute_ps(columns, 0x55), r);
+			r = _mm256_fmadd_ps(a2, _mm256_permute_ps(columns, 0xAA), r);
+			r = _mm256_fmadd_ps(a3, _mm256_permute_ps(columns, 0xFF), r);
+			_mm256_storeu_ps(result + c, r);
+		}
+	}
+}
+
+bool hasSceneTransformsAvx2() {
+	return cpuHasAvx2Fma();
+}
+
+void propagateAvx2(const int32_t* parents, const uint8_t* dirty, uint8_t* changed, const float* localMatrices, float* worldMatrices,
+				   uint32_t begin, uint32_t end) {
+	for(auto i = begin; i < end; ++i) {
+		const auto parent = parents[i];
+		changed[i] = dirty[i] || (parent >= 0 && changed[parent]);
+		if(!changed[i])
+			continue;
+
+		if(parent < 0) {
+			_mm256_storeu_ps(worldMatrices + i * 16, _mm256_loadu_ps(localMatrices + i * 16));
+			_mm256_storeu_ps(worldMatrices + i * 16 + 8, _mm256_loadu_ps(localMatrices + i * 16 + 8));
+		} else {
+			multiply(worldMatrices + parent * 16, localMatrices + i * 16, worldMatrices + i * 16);
+		}
+	}
+}
+
+#else
+
+// Built without -mavx2 -mfma, like the arm64 slice of a universal build.
+bool hasSceneTransformsAvx2() {
+	return false;
+}
+
+void propagateAvx2(const int32_t*, const uint8_t*, uint8_t*, const float*, float*, uint32_t, uint32_t) {}
+
+#endif
@@ -0,0 +1,22 @@
+//
+//  scene_transforms_avx2.hpp
+//  Vulkan_test
+//
+//  Created by Danny on 17/10/2026.
+//  Copyright © 2026 Danny. All rights reserved.
+//
+
+#pragma once
+
+#include <cstdint>
+
+// The AVX2 path of SceneTransforms. Like frustum_culling_avx2.cpp, its file is built with -mavx2 -mfma and shares
+// no inline code with the rest of the app.
+
+// True when the kernel was built for AVX2 and the cpu has it, false on other architectures.
+bool hasSceneTransformsAvx2();
+
+// SceneTransforms::propagate over [begin, end): marks the nodes whose own or parent's transform changed and
+// recomputes their world matrices. Parents must come before their children.
+void propagateAvx2(const int32_t* parents, const uint8_t* dirty, uint8_t* changed, const float* localMatrices, float* worldMatrices,
+				   uint32_t begin, uint32_t end);
@@ -0,0 +1,235 @@
+//
+//  shader_compiler.cpp
+//  Vulkan_test
+//
+//  Created by Danny on 17/10/2026.
+//  Copyright © 2026 Danny. All rights reserved.
+//
+
+#include "shader_compiler.hpp"
+
+#include <shaderc/shaderc.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <thread>
+
+#include "profiler.hpp"
+
+namespace {
+
+	// Bump when anything about how shaders are compiled changes, it invalidates every cached blob.
+	const uint64_t cacheFormatVersion = 1;
+
+	const uint32_t spirvMagicNumber = 0x07230203;
+
+	uint64_t hash(uint64_t value, const void* data, size_t size) {
+		const auto* bytes = static_cast<const uint8_t*>(data);
+		for(size_t i = 0; i < size; ++i) {
+			value ^= bytes[i];
+			value *= 0x100000001b3ull;
+		}
+		return value;
+	}
+
+	template<typename T>
+	uint64_t hash(uint64_t value, const T& data) {
+		return hash(value, &data, sizeof(T));
+	}
+
+	uint64_t hash(uint64_t value, const std::string& text) {
+		return hash(hash(value, text.size()), text.data(), text.size());
+	}
+
+	shaderc_shader_kind getShaderKind(ShaderStageDescriptor::Type stage) {
+		switch(stage) {
+			case ShaderStageDescriptor::Type::VERTEX: return shaderc_vertex_shader;
+			case ShaderStageDescriptor::Type::FRAGMENT: return shaderc_fragment_shader;
+			case ShaderStageDescriptor::Type::GEOMETRY: return shaderc_geometry_shader;
+			case ShaderStageDescriptor::Type::TESSELLATION_CONTROL: return shaderc_tess_control_shader;
+			case ShaderStageDescriptor::Type::TESSELATION_EVALUATION: return shaderc_tess_evaluation_shader;
+			case ShaderStageDescriptor::Type::COMPUTE: return shaderc_compute_shader;
+		}
+		return shaderc_vertex_shader;
+	}
+
+	// Resolves #include "file" relative to the including file and #include <file> relative to the working directory.
+	class FileIncluder: public shaderc::CompileOptions::IncluderInterface {
+	public:
+		shaderc_include_result* GetInclude(const char* requestedSource, shaderc_include_type type, const char* requestingSource, size_t) override {
+			auto* include = new Include;
+
+			std::string path = requestedSource;
+			if(type == shaderc_include_type_relative) {
+				const std::string requesting = requestingSource;
+				const auto slash = requesting.find_last_of("/\\");
+				if(slash != std::string::npos)
+					path = requesting.substr(0, slash + 1) + path;
+			}
+
+			std::ifstream file(path, std::ios::binary);
+			if(file) {
+				std::stringstream content;
+				content << file.rdbuf();
+				include->name = path;
+				include->content = content.str();
+			} else {
+				// An empty name tells shaderc the include failed, the content is the error.
+				include->content = "can't open " + path;
+			}
+
+			include->result.source_name = include->name.c_str();
+			include->result.source_name_length = include->name.size();
+			include->result.content = include->content.c_str();
+			include->result.content_length = include->content.size();
+			include->result.user_data = include;
+			return &include->result;
+		}
+
+		void ReleaseInclude(shaderc_include_result* result) override {
+			delete static_cast<Include*>(result->user_data);
+		}
+
+	private:
+
+		struct Include
+		{
+			shaderc_include_result result;
+			std::string name;
+			std::string content;
+		};
+	};
+}
+
+ShaderCompiler::ShaderCompiler(const std::string& cacheDirectory)
+: compiler(new shaderc::Compiler), cacheDirectory(cacheDirectory) {
+
+	// shaderc doesn't report a version of its own, the SPIR-V version and revision it generates stand in for it.
+	unsigned int version = 0;
+	unsigned int revision = 0;
+	shaderc_get_spv_version(&version, &revision);
+	compilerVersion = (static_cast<uint64_t>(version) << 32 | revision) ^ cacheFormatVersion;
+}
+
+ShaderCompiler::~ShaderCompiler() = default;
+
+ShaderCompileResult ShaderCompiler::compile(const ShaderSourceDescriptor& descriptor) {
+	PROFILE_FUNCTION();
+
+	ShaderCompileResult result;
+	const auto kind = getShaderKind(descriptor.stage);
+	const auto name = descriptor.path.empty() ? std::string("shader") : descriptor.path;
+
+	shaderc::CompileOptions options;
+	options.SetSourceLanguage(descriptor.language == ShaderLanguage::HLSL ? shaderc_source_language_hlsl : shaderc_source_language_glsl);
+	options.SetTargetEnvironment(shaderc_target_env_vulkan, shaderc_env_version_vulkan_1_2);
+	options.SetOptimizationLevel(shaderc_optimization_level_performance);
+	options.SetIncluder(std::unique_ptr<shaderc::CompileOptions::IncluderInterface>(new FileIncluder));
+	for(const auto& define: descriptor.defines)
+		options.AddMacroDefinition(define.first, define.second);
+
+	// Preprocessing resolves includes and defines, so the text it produces is all the source there is.
+	const auto preprocessed = compiler->PreprocessGlsl(descriptor.source, kind, name.c_str(), options);
+	if(preprocessed.GetCompilationStatus() != shaderc_compilation_status_success) {
+		result.log = preprocessed.GetErrorMessage();
+		++failed;
+		return result;
+	}
+
+	const std::string source(preprocessed.cbegin(), preprocessed.cend());
+
+	uint64_t key = 0xcbf29ce484222325ull;
+	key = hash(key, compilerVersion);
+	key = hash(key, descriptor.stage);
+	key = hash(key, descriptor.language);
+	key = hash(key, descriptor.entryPoint);
+	key = hash(key, source);
+
+	if(readCache(key, result.spirv)) {
+		result.cached = true;
+		++cacheHits;
+		return result;
+	}
+
+	const auto spirv = compiler->CompileGlslToSpv(source.data(), source.size(), kind, name.c_str(), descriptor.entryPoint.c_str(), options);
+	result.log = spirv.GetErrorMessage();
+	if(spirv.GetCompilationStatus() != shaderc_compilation_status_success) {
+		++failed;
+		return result;
+	}
+
+	result.spirv.assign(spirv.cbegin(), spirv.cend());
+	writeCache(key, result.spirv);
+	++compiled;
+	return result;
+}
+
+std::vector<ShaderCompileResult> ShaderCompiler::compile(const std::vector<ShaderSourceDescriptor>& descriptors, JobSystem& jobSystem) {
+	std::vector<ShaderCompileResult> results(descriptors.size());
+	jobSystem.parallelFor(static_cast<uint32_t>(descriptors.size()), 1, [&](uint32_t begin, uint32_t end) {
+		for(auto i = begin; i < end; ++i)
+			results[i] = compile(descriptors[i]);
+	});
+
+	return results;
+}
+
+ShaderCompilerStatistics ShaderCompiler::getStatistics() const {
+	ShaderCompilerStatistics statistics;
+	statistics.compiled = compiled;
+	statistics.cacheHits = cacheHits;
+	statistics.failed = failed;
+	return statistics;
+}
+
+bool ShaderCompiler::readCache(uint64_t key, std::vector<uint32_t>& spirv) const {
+	if(cacheDirectory.empty())
+		return false;
+
+	char fileName[32];
+	std::snprintf(fileName, sizeof(fileName), "/%016llx.spv", static_cast<unsigned long long>(key));
+
+	std::ifstream file(cacheDirectory + fileName, std::ios::binary | std::ios::ate);
+	if(!file)
+		return false;
+
+	const auto size = static_cast<size_t>(file.tellg());
+	if(size < sizeof(uint32_t) || size % sizeof(uint32_t))
+		return false;
+
+	spirv.resize(size / sizeof(uint32_t));
+	file.seekg(0);
+	file.read(reinterpret_cast<char*>(spirv.data()), size);
+	if(!file || spirv[0] != spirvMagicNumber) {
+		spirv.clear();
+		return false;
+	}
+
+	return true;
+}
+
+void ShaderCompiler::writeCache(uint64_t key, const std::vector<uint32_t>& spirv) const {
+	if(cacheDirectory.empty())
+		return;
+
+	char fileName[32];
+	std::snprintf(fileName, sizeof(fileName), "/%016llx.spv", static_cast<unsigned long long>(key));
+	const auto path = cacheDirectory + fileName;
+
+	// Other threads may be writing the same blob, each goes through a temporary of its own.
+	const auto temporaryPath = path + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+	{
+		std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+		if(!file)
+			return;
+
+		file.write(reinterpret_cast<const char*>(spirv.data()), spirv.size() * sizeof(uint32_t));
+		if(!file)
+			return;
+	}
+
+	if(std::rename(temporaryPath.c_str(), path.c_str()) != 0)
+		std::remove(temporaryPath.c_str());
+}
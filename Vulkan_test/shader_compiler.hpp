@@ -0,0 +1,75 @@
+//
+//  shader_compiler.hpp
+//  Vulkan_test
+//
+//  Created by Danny on 17/10/2026.
+//  Copyright © 2026 Danny. All rights reserved.
+//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "job_system.hpp"
+#include "resource_descriptors.hpp"
+
+namespace shaderc {
+	class Compiler;
+}
+
+struct ShaderCompileResult
+{
+	std::vector<uint32_t> spirv;
+	// Errors and warnings of the compiler.
+	std::string log;
+	bool cached = false;
+
+	explicit operator bool() const { return !spirv.empty(); }
+};
+
+struct ShaderCompilerStatistics
+{
+	uint32_t compiled = 0;
+	uint32_t cacheHits = 0;
+	uint32_t failed = 0;
+};
+
+// Compiles GLSL and HLSL to SPIR-V in process with shaderc. Sources are preprocessed first and the
+// preprocessed text is hashed together with everything else that changes the output, so edits to
+// included files and defines are picked up without tracking dependencies. Hits are read from the cache
+// directory instead of being compiled again.
+class ShaderCompiler {
+public:
+	// An empty cacheDirectory disables the disk cache. The directory has to exist.
+	explicit ShaderCompiler(const std::string& cacheDirectory);
+	~ShaderCompiler();
+
+	ShaderCompiler(const ShaderCompiler&) = delete;
+	ShaderCompiler& operator=(const ShaderCompiler&) = delete;
+
+	// Thread safe.
+	ShaderCompileResult compile(const ShaderSourceDescriptor&);
+	// Compiles every source on the job system, the results are in the order of the sources.
+	std::vector<ShaderCompileResult> compile(const std::vector<ShaderSourceDescriptor>&, JobSystem&);
+
+	ShaderCompilerStatistics getStatistics() const;
+
+private:
+
+	bool readCache(uint64_t key, std::vector<uint32_t>& spirv) const;
+	void writeCache(uint64_t key, const std::vector<uint32_t>& spirv) const;
+
+private:
+
+	std::unique_ptr<shaderc::Compiler> compiler;
+	std::string cacheDirectory;
+	uint64_t compilerVersion = 0;
+
+	std::atomic<uint32_t> compiled {0};
+	std::atomic<uint32_t> cacheHits {0};
+	std::atomic<uint32_t> failed {0};
+};
@@ -0,0 +1,101 @@
+//
+//  slot_map.hpp
+//  Vulkan_test
+//
+//  Created by Danny on 17/10/2026.
+//  Copyright © 2026 Danny. All rights reserved.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "resource_descriptors.hpp"
+
+static_assert(sizeof(resource_handle_t) == sizeof(uint64_t), "handles need 64 bits for their generation");
+
+// The slot a handle refers to, handles keep the generation of their slot in the upper 32 bits.
+inline uint32_t getHandleIndex(resource_handle_t handle) { return static_cast<uint32_t>(handle); }
+inline uint32_t getHandleGeneration(resource_handle_t handle) { return static_cast<uint32_t>(static_cast<uint64_t>(handle) >> 32); }
+
+// Values addressed by generational handles. Erased slots go on a free list and are reused by the next insert with
+// a new generation, so handles to erased values are detected instead of silently reaching whatever took their slot.
+template<typename T>
+class SlotMap {
+public:
+	resource_handle_t insert(T value) {
+		uint32_t index;
+		if(freeSlots.empty()) {
+			index = static_cast<uint32_t>(slots.size());
+			slots.emplace_back();
+		} else {
+			index = freeSlots.back();
+			freeSlots.pop_back();
+		}
+		auto& slot = slots[index];
+		slot.value = std::move(value);
+		slot.alive = true;
+		++count;
+		return getHandle(index, slot.generation);
+	}
+
+	bool contains(resource_handle_t handle) const {
+		const auto index = getHandleIndex(handle);
+		return handle != null_handle && index < slots.size() && slots[index].alive && slots[index].generation == getHandleGeneration(handle);
+	}
+
+	// Throws std::out_of_range for null, erased and stale handles.
+	T& at(resource_handle_t handle) {
+		if(!contains(handle))
+			throw std::out_of_range("SlotMap: invalid handle");
+		return slots[getHandleIndex(handle)].value;
+	}
+	const T& at(resource_handle_t handle) const {
+		if(!contains(handle))
+			throw std::out_of_range("SlotMap: invalid handle");
+		return slots[getHandleIndex(handle)].value;
+	}
+
+	// Takes the value out and frees its slot, the handle is stale from now on.
+	T erase(resource_handle_t handle) {
+		if(!contains(handle))
+			throw std::out_of_range("SlotMap: invalid handle");
+		const auto index = getHandleIndex(handle);
+		auto& slot = slots[index];
+		slot.alive = false;
+		++slot.generation;
+		freeSlots.push_back(index);
+		--count;
+		return std::move(slot.value);
+	}
+
+	// Calls f(handle, value) for every live value.
+	template<typename F>
+	void forEach(F f) {
+		for(uint32_t i = 0; i < slots.size(); ++i)
+			if(slots[i].alive)
+				f(getHandle(i, slots[i].generation), slots[i].value);
+	}
+
+	size_t size() const { return count; }
+	bool empty() const { return count == 0; }
+
+private:
+	static resource_handle_t getHandle(uint32_t index, uint32_t generation) {
+		return static_cast<resource_handle_t>(static_cast<uint64_t>(generation) << 32 | index);
+	}
+
+	struct Slot
+	{
+		T value{};
+		uint32_t generation = 0;
+		bool alive = false;
+	};
+
+	std::vector<Slot> slots;
+	std::vector<uint32_t> freeSlots;
+	size_t count = 0;
+};
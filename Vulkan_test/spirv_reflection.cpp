@@ -0,0 +1,384 @@
+//
+//  spirv_reflection.cpp
+//  Vulkan_test
+//
+//  Created by Danny on 17/10/2026.
+//  Copyright © 2026 Danny. All rights reserved.
+//
+
+#include "spirv_reflection.hpp"
+
+#include <algorithm>
+#include <limits>
+
+namespace {
+
+	const uint32_t magicNumber = 0x07230203;
+	const size_t headerWords = 5;
+
+	// The handful of opcodes, decorations and enums of the spec we care about.
+	enum Op : uint32_t
+	{
+		OpEntryPoint = 15,
+		OpExecutionMode = 16,
+		OpTypeInt = 21,
+		OpTypeFloat = 22,
+		OpTypeVector = 23,
+		OpTypeMatrix = 24,
+		OpTypeImage = 25,
+		OpTypeSampler = 26,
+		OpTypeSampledImage = 27,
+		OpTypeArray = 28,
+		OpTypeRuntimeArray = 29,
+		OpTypeStruct = 30,
+		OpTypePointer = 32,
+		OpConstant = 43,
+		OpSpecConstant = 50,
+		OpVariable = 59,
+		OpDecorate = 71,
+		OpMemberDecorate = 72,
+		OpFunction = 54
+	};
+
+	enum Decoration : uint32_t
+	{
+		DecorationBufferBlock = 3,
+		DecorationRowMajor = 4,
+		DecorationArrayStride = 6,
+		DecorationMatrixStride = 7,
+		DecorationBinding = 33,
+		DecorationDescriptorSet = 34,
+		DecorationOffset = 35
+	};
+
+	enum StorageClass : uint32_t
+	{
+		StorageClassUniformConstant = 0,
+		StorageClassUniform = 2,
+		StorageClassPushConstant = 9,
+		StorageClassStorageBuffer = 12
+	};
+
+	const uint32_t dimBuffer = 5;
+	const uint32_t dimSubpassData = 6;
+	const uint32_t executionModeLocalSize = 17;
+	const uint32_t none = std::numeric_limits<uint32_t>::max();
+
+	struct Member
+	{
+		uint32_t offset = 0;
+		uint32_t matrixStride = 0;
+		bool rowMajor = false;
+	};
+
+	struct Id
+	{
+		uint32_t opcode = 0;
+		// Operands of the instruction that defined the id, without the result id itself.
+		const uint32_t* operands = nullptr;
+		uint32_t operandCount = 0;
+
+		uint32_t set = none;
+		uint32_t binding = none;
+		uint32_t arrayStride = 0;
+		bool bufferBlock = false;
+		std::vector<Member> members;
+	};
+
+	class Module {
+	public:
+		explicit Module(uint32_t bound) : ids(bound) {}
+
+		std::vector<Id> ids;
+
+		Id* get(uint32_t id) {
+			return id < ids.size() ? &ids[id] : nullptr;
+		}
+
+		uint32_t getConstant(uint32_t id) {
+			const auto* constant = get(id);
+			if(!constant || (constant->opcode != OpConstant && constant->opcode != OpSpecConstant) || constant->operandCount < 3)
+				return 1;
+			return constant->operands[2];
+		}
+
+		uint32_t getSize(uint32_t type, const Member* member = nullptr, uint32_t depth = 0) {
+			const auto* t = get(type);
+			if(!t || depth > 64)
+				return 0;
+
+			switch(t->opcode) {
+				case OpTypeInt:
+				case OpTypeFloat:
+					return t->operands[0] / 8;
+
+				case OpTypeVector:
+					return getSize(t->operands[0], nullptr, depth + 1) * t->operands[1];
+
+				case OpTypeMatrix: {
+					const auto columns = t->operands[1];
+					const auto* column = get(t->operands[0]);
+					const auto rows = column && column->opcode == OpTypeVector ? column->operands[1] : 1;
+					if(member && member->matrixStride)
+						return member->matrixStride * (member->rowMajor ? rows : columns);
+					return getSize(t->operands[0], nullptr, depth + 1) * columns;
+				}
+
+				case OpTypeArray: {
+					const auto length = getConstant(t->operands[1]);
+					const auto stride = t->arrayStride ? t->arrayStride : getSize(t->operands[0], member, depth + 1);
+					return stride * length;
+				}
+
+				case OpTypeStruct: {
+					uint32_t size = 0;
+					for(uint32_t i = 0; i < t->operandCount && i < t->members.size(); ++i)
+						size = std::max(size, t->members[i].offset + getSize(t->operands[i], &t->members[i], depth + 1));
+					return size;
+				}
+
+				case OpTypePointer:
+					return 8;
+
+				default:
+					return 0;
+			}
+		}
+	};
+
+	bool getStage(uint32_t executionModel, ShaderStageDescriptor::Type& stage) {
+		switch(executionModel) {
+			case 0: stage = ShaderStageDescriptor::Type::VERTEX; return true;
+			case 1: stage = ShaderStageDescriptor::Type::TESSELLATION_CONTROL; return true;
+			case 2: stage = ShaderStageDescriptor::Type::TESSELATION_EVALUATION; return true;
+			case 3: stage = ShaderStageDescriptor::Type::GEOMETRY; return true;
+			case 4: stage = ShaderStageDescriptor::Type::FRAGMENT; return true;
+			case 5: stage = ShaderStageDescriptor::Type::COMPUTE; return true;
+			default: return false;
+		}
+	}
+
+	// Literal strings are nul terminated and packed four characters to a word.
+	std::string readString(const uint32_t* words, uint32_t count) {
+		std::string text;
+		for(uint32_t i = 0; i < count; ++i) {
+			for(uint32_t byte = 0; byte < 4; ++byte) {
+				const char c = static_cast<char>((words[i] >> (byte * 8)) & 0xff);
+				if(!c)
+					return text;
+				text += c;
+			}
+		}
+		return text;
+	}
+}
+
+bool reflectSpirV(const uint32_t* words, size_t wordCount, ShaderReflection& reflection) {
+	if(!words || wordCount < headerWords || words[0] != magicNumber)
+		return false;
+
+	Module module(words[3]);
+	std::vector<uint32_t> variables;
+	uint32_t entryPoint = none;
+
+	// Types, decorations and global variables all come before the first function.
+	for(size_t offset = headerWords; offset < wordCount;) {
+		const auto opcode = words[offset] & 0xffff;
+		const auto length = words[offset] >> 16;
+		if(!length || offset + length > wordCount)
+			return false;
+
+		const auto* operands = words + offset + 1;
+		const auto operandCount = length - 1;
+		offset += length;
+
+		switch(opcode) {
+			case OpFunction:
+				offset = wordCount;
+				break;
+
+			case OpEntryPoint:
+				if(entryPoint == none && operandCount >= 3 && getStage(operands[0], reflection.stage)) {
+					entryPoint = operands[1];
+					reflection.entryPoint = readString(operands + 2, operandCount - 2);
+				}
+				break;
+
+			case OpExecutionMode:
+				if(operandCount >= 5 && operands[0] == entryPoint && operands[1] == executionModeLocalSize)
+					std::copy(operands + 2, operands + 5, reflection.localSize);
+				break;
+
+			case OpDecorate: {
+				auto* target = operandCount >= 2 ? module.get(operands[0]) : nullptr;
+				if(!target)
+					break;
+
+				const auto value = operandCount >= 3 ? operands[2] : 0;
+				switch(operands[1]) {
+					case DecorationBufferBlock: target->bufferBlock = true; break;
+					case DecorationArrayStride: target->arrayStride = value; break;
+					case DecorationBinding: target->binding = value; break;
+					case DecorationDescriptorSet: target->set = value; break;
+					default: break;
+				}
+				break;
+			}
+
+			case OpMemberDecorate: {
+				auto* target = operandCount >= 3 ? module.get(operands[0]) : nullptr;
+				if(!target)
+					break;
+
+				if(target->members.size() <= operands[1])
+					target->members.resize(operands[1] + 1);
+
+				auto& member = target->members[operands[1]];
+				const auto value = operandCount >= 4 ? operands[3] : 0;
+				switch(operands[2]) {
+					case DecorationOffset: member.offset = value; break;
+					case DecorationMatrixStride: member.matrixStride = value; break;
+					case DecorationRowMajor: member.rowMajor = true; break;
+					default: break;
+				}
+				break;
+			}
+
+			case OpTypeInt:
+			case OpTypeFloat:
+			case OpTypeVector:
+			case OpTypeMatrix:
+			case OpTypeImage:
+			case OpTypeSampler:
+			case OpTypeSampledImage:
+			case OpTypeArray:
+			case OpTypeRuntimeArray:
+			case OpTypeStruct:
+			case OpTypePointer: {
+				auto* id = operandCount >= 1 ? module.get(operands[0]) : nullptr;
+				if(!id)
+					return false;
+
+				id->opcode = opcode;
+				id->operands = operands + 1;
+				id->operandCount = operandCount - 1;
+				if(opcode == OpTypeStruct && id->members.size() < id->operandCount)
+					id->members.resize(id->operandCount);
+				break;
+			}
+
+			case OpConstant:
+			case OpSpecConstant:
+			case OpVariable: {
+				auto* id = operandCount >= 3 ? module.get(operands[1]) : nullptr;
+				if(!id)
+					return false;
+
+				id->opcode = opcode;
+				id->operands = operands;
+				id->operandCount = operandCount;
+				if(opcode == OpVariable)
+					variables.emplace_back(operands[1]);
+				break;
+			}
+
+			default:
+				break;
+		}
+	}
+
+	if(entryPoint == none)
+		return false;
+
+	reflection.bindings.clear();
+	reflection.pushConstantOffset = 0;
+	reflection.pushConstantSize = 0;
+
+	for(const auto variableId: variables) {
+		const auto& variable = module.ids[variableId];
+		const auto storageClass = variable.operands[2];
+		const auto* pointer = module.get(variable.operands[0]);
+		if(!pointer || pointer->opcode != OpTypePointer)
+			continue;
+
+		auto typeId = pointer->operands[1];
+		auto* type = module.get(typeId);
+		if(!type)
+			continue;
+
+		if(storageClass == StorageClassPushConstant) {
+			if(type->opcode != OpTypeStruct)
+				continue;
+
+			uint32_t begin = std::numeric_limits<uint32_t>::max();
+			for(uint32_t i = 0; i < type->operandCount && i < type->members.size(); ++i)
+				begin = std::min(begin, type->members[i].offset);
+
+			reflection.pushConstantOffset = begin == std::numeric_limits<uint32_t>::max() ? 0 : begin;
+			reflection.pushConstantSize = module.getSize(typeId) - reflection.pushConstantOffset;
+			continue;
+		}
+
+		if(storageClass != StorageClassUniformConstant && storageClass != StorageClassUniform && storageClass != StorageClassStorageBuffer)
+			continue;
+		if(variable.binding == none)
+			continue;
+
+		ShaderResourceBinding binding;
+		binding.set = variable.set == none ? 0 : variable.set;
+		binding.binding = variable.binding;
+
+		// Arrays of resources are a single binding with a count.
+		if(type->opcode == OpTypeArray) {
+			binding.count = module.getConstant(type->operands[1]);
+			type = module.get(type->operands[0]);
+		} else if(type->opcode == OpTypeRuntimeArray) {
+			binding.count = 0;
+			type = module.get(type->operands[0]);
+		}
+
+		if(!type)
+			continue;
+
+		switch(type->opcode) {
+			case OpTypeSampler:
+				binding.type = ShaderResourceType::SAMPLER;
+				break;
+
+			case OpTypeSampledImage:
+				binding.type = ShaderResourceType::COMBINED_IMAGE_SAMPLER;
+				break;
+
+			case OpTypeImage: {
+				const auto dim = type->operands[1];
+				const bool storage = type->operands[5] == 2;
+				if(dim == dimSubpassData)
+					binding.type = ShaderResourceType::INPUT_ATTACHMENT;
+				else if(dim == dimBuffer)
+					binding.type = storage ? ShaderResourceType::STORAGE_TEXEL_BUFFER : ShaderResourceType::UNIFORM_TEXEL_BUFFER;
+				else
+					binding.type = storage ? ShaderResourceType::STORAGE_IMAGE : ShaderResourceType::SAMPLED_IMAGE;
+				break;
+			}
+
+			case OpTypeStruct:
+				// Before SPIR-V 1.3 storage buffers were Uniform blocks decorated BufferBlock.
+				if(storageClass == StorageClassStorageBuffer || type->bufferBlock)
+					binding.type = ShaderResourceType::STORAGE_BUFFER;
+				else
+					binding.type = ShaderResourceType::UNIFORM_BUFFER;
+				break;
+
+			default:
+				continue;
+		}
+
+		reflection.bindings.emplace_back(binding);
+	}
+
+	std::sort(reflection.bindings.begin(), reflection.bindings.end(), [](const ShaderResourceBinding& a, const ShaderResourceBinding& b) {
+		return a.set != b.set ? a.set < b.set : a.binding < b.binding;
+	});
+
+	return true;
+}
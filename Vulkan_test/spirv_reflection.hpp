@@ -0,0 +1,58 @@
+//
+//  spirv_reflection.hpp
+//  Vulkan_test
+//
+//  Created by Danny on 17/10/2026.
+//  Copyright © 2026 Danny. All rights reserved.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "resource_descriptors.hpp"
+
+// Same order as VkDescriptorType, without the dynamic variants.
+enum class ShaderResourceType
+{
+	SAMPLER,
+	COMBINED_IMAGE_SAMPLER,
+	SAMPLED_IMAGE,
+	STORAGE_IMAGE,
+	UNIFORM_TEXEL_BUFFER,
+	STORAGE_TEXEL_BUFFER,
+	UNIFORM_BUFFER,
+	STORAGE_BUFFER,
+	INPUT_ATTACHMENT
+};
+
+struct ShaderResourceBinding
+{
+	uint32_t set = 0;
+	uint32_t binding = 0;
+	ShaderResourceType type = ShaderResourceType::UNIFORM_BUFFER;
+	// Array length, 0 for runtime sized arrays.
+	uint32_t count = 1;
+};
+
+struct ShaderReflection
+{
+	ShaderStageDescriptor::Type stage = ShaderStageDescriptor::Type::VERTEX;
+	std::string entryPoint;
+
+	std::vector<ShaderResourceBinding> bindings;
+
+	// The bytes of the push constant block the stage actually declares, size 0 without one.
+	uint32_t pushConstantOffset = 0;
+	uint32_t pushConstantSize = 0;
+
+	// Workgroup size of compute shaders.
+	uint32_t localSize[3] = {1, 1, 1};
+};
+
+// Pulls the descriptor bindings, push constants and workgroup size of the first entry point out of a
+// SPIR-V module. Only looks at what layouts need, returns false if the words aren't a SPIR-V module.
+bool reflectSpirV(const uint32_t* words, size_t wordCount, ShaderReflection&);
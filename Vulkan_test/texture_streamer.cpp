@@ -0,0 +1,498 @@
+//
+//  texture_streamer.cpp
+//  Vulkan_test
+//
+//  Created by Danny on 17/10/2026.
+//  Copyright © 2026 Danny. All rights reserved.
+//
+
+#include "texture_streamer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "jpeg_decoder.hpp"
+#include "ktx2_loader.hpp"
+#include "png_decoder.hpp"
+#include "profiler.hpp"
+#include "texture_transcoder.hpp"
+#include "vulkan_renderer.hpp"
+#include "vulkan_resources.hpp"
+
+namespace {
+
+	const uint8_t placeholderTexel[4] = {128, 128, 128, 255};
+
+	uint32_t getMaxDimension(const TextureDescriptor& descriptor, uint32_t mipLevel) {
+		const auto extent = getMipExtent(descriptor, mipLevel);
+		return std::max(extent.width, extent.height);
+	}
+
+	uint32_t getFullMipCount(const TextureDescriptor& descriptor) {
+		uint32_t levels = 1;
+		while(getMaxDimension(descriptor, levels - 1) > 1)
+			++levels;
+		return levels;
+	}
+
+	// Halves a level with a box filter, clamping at odd edges. Only for 8 bit channels.
+	std::vector<uint8_t> downsample(const std::vector<uint8_t>& source, uint32_t width, uint32_t height, uint32_t channels) {
+		const uint32_t w = std::max(width / 2, 1u);
+		const uint32_t h = std::max(height / 2, 1u);
+		std::vector<uint8_t> result(size_t(w) * h * channels);
+
+		for(uint32_t y = 0; y < h; ++y) {
+			const uint32_t y0 = std::min(y * 2, height - 1);
+			const uint32_t y1 = std::min(y * 2 + 1, height - 1);
+			for(uint32_t x = 0; x < w; ++x) {
+				const uint32_t x0 = std::min(x * 2, width - 1);
+				const uint32_t x1 = std::min(x * 2 + 1, width - 1);
+				for(uint32_t c = 0; c < channels; ++c) {
+					const uint32_t sum = source[(size_t(y0) * width + x0) * channels + c] + source[(size_t(y0) * width + x1) * channels + c] +
+										 source[(size_t(y1) * width + x0) * channels + c] + source[(size_t(y1) * width + x1) * channels + c];
+					result[(size_t(y) * w + x) * channels + c] = static_cast<uint8_t>((sum + 2) / 4);
+				}
+			}
+		}
+
+		return result;
+	}
+
+	// Checks what a decoder returned, builds the mip chain of images that come without one, drops the levels
+	// larger than maxSize and transcodes the rest. Runs on the worker that decoded the image.
+	bool finishDecode(DecodedImage& image, uint32_t maxSize, uint32_t supportedCompressions, const BlockCompression* compression) {
+		auto& descriptor = image.descriptor;
+		if(!descriptor.width || image.mips.empty() || descriptor.type != TextureType::TWO_DIMENSIONAL)
+			return false;
+
+		descriptor.height = std::max(descriptor.height, 1u);
+		descriptor.depth = 1;
+		descriptor.mipLevels = std::max(descriptor.mipLevels, 1u);
+		descriptor.usage = TextureUsage::READ;
+
+		const auto texelSize = getTexelSize(descriptor);
+		if(descriptor.dataType == DataType::UNSIGNED_BYTE && descriptor.compression == BlockCompression::NONE && descriptor.mipLevels == 1 && image.firstMip == 0 && image.mips.size() == 1) {
+			descriptor.mipLevels = getFullMipCount(descriptor);
+			for(uint32_t level = 1; level < descriptor.mipLevels; ++level) {
+				const auto extent = getMipExtent(descriptor, level - 1);
+				image.mips.emplace_back(downsample(image.mips.back(), extent.width, extent.height, texelSize));
+			}
+		}
+
+		if(image.firstMip + image.mips.size() > descriptor.mipLevels)
+			return false;
+		for(size_t i = 0; i < image.mips.size(); ++i)
+			if(image.mips[i].size() != getTextureByteSize(descriptor, image.firstMip + static_cast<uint32_t>(i)))
+				return false;
+
+		size_t dropped = 0;
+		while(dropped + 1 < image.mips.size() && getMaxDimension(descriptor, image.firstMip + static_cast<uint32_t>(dropped)) > maxSize)
+			++dropped;
+		image.mips.erase(image.mips.begin(), image.mips.begin() + dropped);
+		image.firstMip += static_cast<uint32_t>(dropped);
+
+		// Later loads stick to the format of the first, which chose by the levels it had.
+		return transcodeImage(image, compression ? *compression : chooseBlockCompression(image, supportedCompressions));
+	}
+
+	uint32_t toBits(float value) {
+		uint32_t bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+		return bits;
+	}
+
+	float toFloat(uint32_t bits) {
+		float value;
+		std::memcpy(&value, &bits, sizeof(value));
+		return value;
+	}
+}
+
+float getScreenFootprint(float radius, float distance, float verticalFov, float viewportHeight)
+{
+	if(distance <= radius)
+		return viewportHeight;
+	return viewportHeight * radius / (distance * std::tan(verticalFov * 0.5f));
+}
+
+TextureStreamer::TextureStreamer(VulkanRenderer& renderer, const TextureStreamerSettings& settings)
+: renderer(renderer), settings(settings) {
+	supportedCompressions = getCompressionBit(BlockCompression::NONE);
+	for(uint32_t i = 1; i < block_compression_count; ++i) {
+		TextureDescriptor descriptor;
+		descriptor.width = descriptor.height = 4;
+		descriptor.depth = 1;
+		descriptor.compression = static_cast<BlockCompression>(i);
+		switch(descriptor.compression)
+		{
+			case BlockCompression::BC1:
+			case BlockCompression::ETC2_RGB: descriptor.layout = ChannelLayout::RGB; break;
+			case BlockCompression::BC4:
+			case BlockCompression::EAC_R: descriptor.layout = ChannelLayout::R; break;
+			case BlockCompression::BC5:
+			case BlockCompression::EAC_RG: descriptor.layout = ChannelLayout::RG; break;
+			default: break;
+		}
+
+		if(renderer.isTextureFormatSupported(descriptor))
+			supportedCompressions |= getCompressionBit(descriptor.compression);
+	}
+
+	decoders["image/ktx2"] = decodeKtx2;
+	decoders["image/png"] = decodePng;
+	decoders["image/jpeg"] = decodeJpeg;
+}
+
+TextureStreamer::~TextureStreamer() {
+	loadCounter.wait();
+	for(const auto& replacement: replacements)
+		renderer.destroyTexture(replacement.handle);
+}
+
+void TextureStreamer::setDecoder(const std::string& mimeType, ImageDecoder decoder) {
+	decoders[mimeType] = std::move(decoder);
+}
+
+resource_handle_t TextureStreamer::addImage(const GltfScene& scene, int32_t image) {
+	if(image < 0 || image >= static_cast<int32_t>(scene.images.size()))
+		return null_handle;
+
+	Source source;
+	source.scene = &scene;
+	source.image = image;
+	return add(std::move(source));
+}
+
+resource_handle_t TextureStreamer::addTexture(const void* data, size_t size, const std::string& mimeType) {
+	Source source;
+	source.data = static_cast<const uint8_t*>(data);
+	source.size = size;
+	source.mimeType = mimeType;
+	return add(std::move(source));
+}
+
+resource_handle_t TextureStreamer::add(Source&& source) {
+	TextureDescriptor placeholder;
+	placeholder.width = 1;
+	placeholder.height = 1;
+
+	auto texture = std::make_unique<Texture>();
+	texture->handle = renderer.createTexture(placeholder);
+	if(texture->handle == null_handle)
+		return null_handle;
+
+	renderer.uploadTexture(texture->handle, placeholderTexel, sizeof(placeholderTexel));
+	texture->source = std::move(source);
+
+	lookup.emplace(texture->handle, static_cast<uint32_t>(textures.size()));
+	textures.emplace_back(std::move(texture));
+	return textures.back()->handle;
+}
+
+void TextureStreamer::reportFootprint(resource_handle_t texture, float pixels) {
+	const auto found = lookup.find(texture);
+	if(found == lookup.end() || !(pixels > 0))
+		return;
+
+	// Positive floats order like their bits.
+	auto& reported = textures[found->second]->reportedSize;
+	const auto bits = toBits(pixels);
+	auto current = reported.load(std::memory_order_relaxed);
+	while(bits > current && !reported.compare_exchange_weak(current, bits, std::memory_order_relaxed))
+		;
+}
+
+uint64_t TextureStreamer::getLevelBytes(const Texture& texture, uint32_t first, uint32_t end) const {
+	uint64_t bytes = 0;
+	for(uint32_t level = first; level < end; ++level)
+		bytes += getTextureByteSize(texture.descriptor, level);
+	return bytes;
+}
+
+void TextureStreamer::update(vk::CommandBuffer commandBuffer) {
+	PROFILE_FUNCTION();
+
+	++frame;
+
+	// Their uploads went out with this frame's beginFrame.
+	auto ready = std::partition(replacements.begin(), replacements.end(), [&](const Replacement& r) { return r.swapFrame >= frame; });
+	for(auto it = ready; it != replacements.end(); ++it) {
+		auto& texture = *textures[it->texture];
+		renderer.swapTextures(texture.handle, it->handle);
+		renderer.destroyTexture(it->handle);
+		texture.imageMip = it->firstMip;
+		texture.loading = false;
+	}
+	replacements.erase(ready, replacements.end());
+
+	std::vector<std::unique_ptr<Load>> loads;
+	{
+		std::lock_guard<std::mutex> lock(loadMutex);
+		loads.swap(finishedLoads);
+	}
+	for(auto& load: loads) {
+		--pendingLoads;
+		finishLoad(*load, commandBuffer);
+	}
+
+	// The finest level with at least a texel per pixel.
+	std::vector<uint32_t> candidates;
+	for(uint32_t i = 0; i < textures.size(); ++i) {
+		auto& texture = *textures[i];
+		const auto pixels = toFloat(texture.reportedSize.exchange(0, std::memory_order_relaxed));
+		if(pixels > 0) {
+			texture.lastUsed = frame;
+			if(texture.mipCount) {
+				const auto ratio = static_cast<float>(getMaxDimension(texture.descriptor, 0)) / pixels;
+				const auto level = ratio > 1 ? static_cast<uint32_t>(std::floor(std::log2(ratio))) : 0;
+				texture.desiredMip = std::min(level, texture.tailMip);
+			}
+		}
+
+		if(texture.loading || texture.failed)
+			continue;
+		if(!texture.mipCount || (texture.lastUsed == frame && texture.desiredMip < texture.residentMip))
+			candidates.emplace_back(i);
+	}
+
+	// A lowered budget gives memory back straight away, even if it hurts what is on screen.
+	while(residentBytes > settings.budget && evictOne(static_cast<uint32_t>(textures.size()), true))
+		;
+
+	// Textures without any levels first, then the ones furthest from what they need.
+	std::sort(candidates.begin(), candidates.end(), [&](uint32_t a, uint32_t b) {
+		const auto& ta = *textures[a];
+		const auto& tb = *textures[b];
+		if(!ta.mipCount || !tb.mipCount)
+			return ta.mipCount < tb.mipCount;
+		return ta.residentMip - ta.desiredMip > tb.residentMip - tb.desiredMip;
+	});
+
+	for(auto i: candidates) {
+		if(pendingLoads >= settings.maxPendingLoads)
+			break;
+
+		auto& texture = *textures[i];
+		if(!texture.mipCount) {
+			startLoad(i, settings.minResidentSize);
+			continue;
+		}
+
+		// Make room by evicting, or settle for coarser levels if nothing can go.
+		auto target = texture.desiredMip;
+		while(target < texture.residentMip && residentBytes + getLevelBytes(texture, target, texture.residentMip) > settings.budget)
+			if(!evictOne(i))
+				++target;
+
+		if(target == texture.residentMip)
+			continue;
+
+		texture.reservedBytes = getLevelBytes(texture, target, texture.residentMip);
+		residentBytes += texture.reservedBytes;
+		startLoad(i, getMaxDimension(texture.descriptor, target));
+	}
+
+	std::sort(evictions.begin(), evictions.end());
+	evictions.erase(std::unique(evictions.begin(), evictions.end()), evictions.end());
+	for(auto i: evictions)
+		replace(i, textures[i]->residentMip, nullptr, commandBuffer);
+	evictions.clear();
+}
+
+void TextureStreamer::startLoad(uint32_t index, uint32_t maxSize) {
+	auto& texture = *textures[index];
+	texture.loading = true;
+	++pendingLoads;
+
+	const auto* source = &texture.source;
+	const bool known = texture.mipCount != 0;
+	const auto compression = texture.descriptor.compression;
+	renderer.getJobSystem().schedule([this, index, source, maxSize, known, compression]() {
+		PROFILE_SCOPE("decodeTexture");
+
+		auto load = std::make_unique<Load>();
+		load->texture = index;
+
+		ImageData data;
+		if(source->scene) {
+			getImageData(*source->scene, source->scene->images[source->image], data);
+		} else {
+			data.data = source->data;
+			data.size = source->size;
+			data.mimeType = source->mimeType;
+		}
+
+		// Decoders are only added before the first texture, reading them here is safe.
+		const auto decoder = decoders.find(data.mimeType);
+		load->ok = data.data && decoder != decoders.end() && decoder->second(data.data, data.size, maxSize, load->image) &&
+				   finishDecode(load->image, maxSize, supportedCompressions, known ? &compression : nullptr);
+
+		std::lock_guard<std::mutex> lock(loadMutex);
+		finishedLoads.emplace_back(std::move(load));
+	}, loadCounter);
+}
+
+void TextureStreamer::finishLoad(Load& load, vk::CommandBuffer commandBuffer) {
+	auto& texture = *textures[load.texture];
+	texture.loading = false;
+	residentBytes -= texture.reservedBytes;
+	texture.reservedBytes = 0;
+
+	const auto& image = load.image;
+	if(!texture.mipCount) {
+		if(!load.ok) {
+			texture.failed = true;
+			return;
+		}
+
+		texture.descriptor = image.descriptor;
+		texture.mipCount = image.descriptor.mipLevels;
+		texture.tailMip = 0;
+		while(texture.tailMip + 1 < texture.mipCount && getMaxDimension(texture.descriptor, texture.tailMip) > settings.minResidentSize)
+			++texture.tailMip;
+		texture.imageMip = texture.mipCount;
+		texture.residentMip = texture.mipCount;
+		texture.desiredMip = texture.tailMip;
+	}
+
+	// A decoder that changed its mind about the image, or didn't deliver the levels in between.
+	const auto& d = image.descriptor;
+	if(!load.ok || d.width != texture.descriptor.width || d.height != texture.descriptor.height || d.mipLevels != texture.mipCount ||
+	   d.layout != texture.descriptor.layout || d.dataType != texture.descriptor.dataType ||
+	   d.compression != texture.descriptor.compression || d.srgb != texture.descriptor.srgb ||
+	   image.firstMip >= texture.residentMip || image.firstMip + image.mips.size() < std::min(texture.imageMip, texture.mipCount))
+		return;
+
+	if(!replace(load.texture, image.firstMip, &image, commandBuffer))
+		return;
+
+	residentBytes += getLevelBytes(texture, image.firstMip, texture.residentMip);
+	loadedMips += texture.residentMip - image.firstMip;
+	texture.residentMip = image.firstMip;
+}
+
+bool TextureStreamer::replace(uint32_t index, uint32_t firstMip, const DecodedImage* image, vk::CommandBuffer commandBuffer) {
+	auto& texture = *textures[index];
+
+	auto descriptor = texture.descriptor;
+	const auto extent = getMipExtent(descriptor, firstMip);
+	descriptor.width = extent.width;
+	descriptor.height = extent.height;
+	descriptor.mipLevels = texture.mipCount - firstMip;
+
+	const auto handle = renderer.createTexture(descriptor);
+	if(handle == null_handle)
+		return false;
+
+	// Levels the current image has are copied on the gpu, the finer ones come from the decoded image.
+	const auto firstCopied = std::max(firstMip, std::min(texture.imageMip, texture.mipCount));
+	if(image) {
+		for(auto level = firstMip; level < firstCopied; ++level) {
+			const auto& mip = image->mips[level - image->firstMip];
+			renderer.uploadTexture(handle, mip.data(), mip.size(), level - firstMip);
+		}
+	}
+
+	if(firstCopied < texture.mipCount)
+		copyMips(commandBuffer, texture, handle, firstMip);
+
+	if(image && firstMip < firstCopied) {
+		replacements.push_back(Replacement{index, handle, firstMip, frame});
+		texture.loading = true;
+	} else {
+		renderer.swapTextures(texture.handle, handle);
+		renderer.destroyTexture(handle);
+		texture.imageMip = firstMip;
+	}
+
+	return true;
+}
+
+void TextureStreamer::copyMips(vk::CommandBuffer commandBuffer, const Texture& texture, resource_handle_t destination, uint32_t destinationFirstMip) {
+	const auto& source = renderer.getTexture(texture.handle);
+	const auto& target = renderer.getTexture(destination);
+
+	const auto first = std::max(texture.imageMip, destinationFirstMip);
+	const auto count = texture.mipCount - first;
+	const vk::ImageSubresourceRange sourceRange(vk::ImageAspectFlagBits::eColor, first - texture.imageMip, count, 0, 1);
+	const vk::ImageSubresourceRange targetRange(vk::ImageAspectFlagBits::eColor, first - destinationFirstMip, count, 0, 1);
+
+	// The source stays in use for sampling, it goes back to where it was.
+	const vk::ImageMemoryBarrier before[] = {
+		vk::ImageMemoryBarrier(vk::AccessFlagBits::eShaderRead, vk::AccessFlagBits::eTransferRead, vk::ImageLayout::eShaderReadOnlyOptimal,
+							   vk::ImageLayout::eTransferSrcOptimal, VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, source.image, sourceRange),
+		vk::ImageMemoryBarrier(vk::AccessFlags(), vk::AccessFlagBits::eTransferWrite, vk::ImageLayout::eUndefined,
+							   vk::ImageLayout::eTransferDstOptimal, VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, target.image, targetRange)
+	};
+	commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eAllCommands, vk::PipelineStageFlagBits::eTransfer, vk::DependencyFlags(),
+								  nullptr, nullptr, before);
+
+	std::vector<vk::ImageCopy> regions;
+	for(uint32_t level = 0; level < count; ++level) {
+		const auto extent = getMipExtent(texture.descriptor, first + level);
+		vk::ImageCopy region;
+		region.setSrcSubresource(vk::ImageSubresourceLayers(vk::ImageAspectFlagBits::eColor, sourceRange.baseMipLevel + level, 0, 1));
+		region.setDstSubresource(vk::ImageSubresourceLayers(vk::ImageAspectFlagBits::eColor, targetRange.baseMipLevel + level, 0, 1));
+		region.setExtent(extent);
+		regions.emplace_back(region);
+	}
+	commandBuffer.copyImage(source.image, vk::ImageLayout::eTransferSrcOptimal, target.image, vk::ImageLayout::eTransferDstOptimal, regions);
+
+	const vk::ImageMemoryBarrier after[] = {
+		vk::ImageMemoryBarrier(vk::AccessFlagBits::eTransferRead, vk::AccessFlagBits::eShaderRead, vk::ImageLayout::eTransferSrcOptimal,
+							   vk::ImageLayout::eShaderReadOnlyOptimal, VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, source.image, sourceRange),
+		vk::ImageMemoryBarrier(vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eShaderRead, vk::ImageLayout::eTransferDstOptimal,
+							   vk::ImageLayout::eShaderReadOnlyOptimal, VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, target.image, targetRange)
+	};
+	commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eAllCommands, vk::DependencyFlags(),
+								  nullptr, nullptr, after);
+}
+
+bool TextureStreamer::evictOne(uint32_t except, bool evenIfUsed) {
+	// Levels finer than their texture asked for go first, then the textures that were used least recently.
+	// Unless evenIfUsed, textures used this frame only give up levels they don't need.
+	uint32_t best = static_cast<uint32_t>(textures.size());
+	for(uint32_t i = 0; i < textures.size(); ++i) {
+		const auto& texture = *textures[i];
+		if(i == except || texture.loading || !texture.mipCount || texture.residentMip >= texture.tailMip)
+			continue;
+
+		const bool surplus = texture.residentMip < texture.desiredMip;
+		if(!surplus && !evenIfUsed && texture.lastUsed == frame)
+			continue;
+
+		if(best == textures.size()) {
+			best = i;
+			continue;
+		}
+
+		const auto& other = *textures[best];
+		const bool otherSurplus = other.residentMip < other.desiredMip;
+		if(surplus != otherSurplus ? surplus : texture.lastUsed < other.lastUsed)
+			best = i;
+	}
+
+	if(best == textures.size())
+		return false;
+
+	auto& texture = *textures[best];
+	residentBytes -= getTextureByteSize(texture.descriptor, texture.residentMip);
+	++texture.residentMip;
+	++evictedMips;
+	evictions.emplace_back(best);
+	return true;
+}
+
+TextureStreamerStatistics TextureStreamer::getStatistics() const {
+	TextureStreamerStatistics statistics;
+	statistics.textures = static_cast<uint32_t>(textures.size());
+	statistics.pendingLoads = pendingLoads;
+	for(const auto& texture: textures)
+		statistics.failed += texture->failed ? 1 : 0;
+	statistics.residentBytes = residentBytes;
+	statistics.budget = settings.budget;
+	statistics.loadedMips = loadedMips;
+	statistics.evictedMips = evictedMips;
+	return statistics;
+}
@@ -0,0 +1,195 @@
+//
+//  texture_streamer.hpp
+//  Vulkan_test
+//
+//  Created by Danny on 17/10/2026.
+//  Copyright © 2026 Danny. All rights reserved.
+//
+
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "gltf_loader.hpp"
+#include "job_system.hpp"
+#include "resource_descriptors.hpp"
+
+class VulkanRenderer;
+
+// Consecutive mip levels of an image, finest first, each tightly packed.
+struct DecodedImage
+{
+	// Size of the top level and the number of levels the image has, which may be more than were decoded.
+	TextureDescriptor descriptor;
+	uint32_t firstMip = 0;
+	std::vector<std::vector<uint8_t>> mips;
+};
+
+// Decodes the levels of an image that are at most maxSize texels wide and high. Formats that store mip levels
+// should skip the finer ones, formats that don't decode their top level and the streamer builds the rest.
+// Block compressed levels are decompressed by the streamer if the device can't sample them. Runs on worker threads.
+using ImageDecoder = std::function<bool(const uint8_t* data, size_t size, uint32_t maxSize, DecodedImage&)>;
+
+struct TextureStreamerSettings
+{
+	// Bytes the resident mip levels of all streamed textures may take up. Images that are being replaced stay
+	// alive a few frames longer on top of this.
+	uint64_t budget = 256 * 1024 * 1024;
+	// Levels this size or smaller are loaded first and never evicted.
+	uint32_t minResidentSize = 64;
+	// Decodes in flight on the job system at any time.
+	uint32_t maxPendingLoads = 4;
+};
+
+struct TextureStreamerStatistics
+{
+	uint32_t textures = 0;
+	uint32_t pendingLoads = 0;
+	// Textures no decoder could make sense of. They stay at their placeholder.
+	uint32_t failed = 0;
+
+	uint64_t residentBytes = 0;
+	uint64_t budget = 0;
+
+	// Mip levels since the streamer was created.
+	uint64_t loadedMips = 0;
+	uint64_t evictedMips = 0;
+};
+
+// Pixels a sphere covers on screen along the vertical axis of a perspective view, e.g. to report the footprint of
+// the textures of a mesh from its bounding sphere.
+float getScreenFootprint(float radius, float distance, float verticalFov, float viewportHeight);
+
+// Keeps the mip levels of textures resident that the screen needs, within a memory budget. Textures start out
+// as a 1x1 placeholder and get their small levels first. Every frame the renderer reports how large textures
+// appear on screen, update() then loads the finer levels they need on the job system, uploads them through the
+// staging ring and swaps the larger image in under the same handle. When the budget runs out the finest levels
+// of the textures that were used least recently are dropped, which is a copy into a smaller image on the gpu.
+class TextureStreamer {
+public:
+	TextureStreamer(VulkanRenderer&, const TextureStreamerSettings& = TextureStreamerSettings());
+	~TextureStreamer();
+
+	TextureStreamer(const TextureStreamer&) = delete;
+	TextureStreamer& operator=(const TextureStreamer&) = delete;
+
+	// Decoders are picked by mime type, KTX2, PNG and JPEG are built in. Set them up before adding textures.
+	void setDecoder(const std::string& mimeType, ImageDecoder);
+
+	// An image of a glTF scene, which has to outlive the streamer. Returns the texture handle, which stays valid
+	// while the images behind it change.
+	resource_handle_t addImage(const GltfScene&, int32_t image);
+	// Encoded data the caller keeps alive for the lifetime of the streamer.
+	resource_handle_t addTexture(const void* data, size_t size, const std::string& mimeType);
+
+	// The texture covers about pixels pixels on screen along its larger axis this frame. The finest level that
+	// still has a texel per pixel is kept resident. Thread safe, but not while textures are added or update runs.
+	void reportFootprint(resource_handle_t texture, float pixels);
+
+	// Swaps in finished loads, evicts, and starts new loads for the footprints reported since the last call.
+	// Call once per frame, outside of a render pass, before anything samples the textures.
+	void update(vk::CommandBuffer);
+
+	void setBudget(uint64_t bytes) { settings.budget = bytes; }
+	TextureStreamerStatistics getStatistics() const;
+	// Bit i is set if the device samples BlockCompression(i).
+	uint32_t getSupportedCompressions() const { return supportedCompressions; }
+
+private:
+
+	struct Source
+	{
+		const GltfScene* scene = nullptr;
+		int32_t image = -1;
+
+		const uint8_t* data = nullptr;
+		size_t size = 0;
+		std::string mimeType;
+	};
+
+	struct Texture
+	{
+		resource_handle_t handle = null_handle;
+		Source source;
+
+		// Known once the first load finished, until then the texture is its placeholder.
+		TextureDescriptor descriptor;
+		uint32_t mipCount = 0;
+		// Levels from tailMip on are never evicted.
+		uint32_t tailMip = 0;
+		// The finest level of the image behind the handle, mipCount for the placeholder.
+		uint32_t imageMip = 0;
+		// The finest level the budget accounts for, which the image catches up with once a load is swapped in.
+		uint32_t residentMip = 0;
+		// The finest level the last footprint asked for.
+		uint32_t desiredMip = 0;
+		// Bits of the largest footprint reported since the last update, 0 if there was none.
+		std::atomic<uint32_t> reportedSize {0};
+		uint64_t lastUsed = 0;
+		// Budget held for the levels a decode in flight is going to add.
+		uint64_t reservedBytes = 0;
+
+		bool loading = false;
+		bool failed = false;
+	};
+
+	struct Load
+	{
+		uint32_t texture = 0;
+		DecodedImage image;
+		bool ok = false;
+	};
+
+	// A larger image that replaces the texture's current one once its uploads arrived.
+	struct Replacement
+	{
+		uint32_t texture = 0;
+		resource_handle_t handle = null_handle;
+		uint32_t firstMip = 0;
+		// Uploads become visible to frames that begin after they were made, the swap waits for the next update.
+		uint64_t swapFrame = 0;
+	};
+
+	resource_handle_t add(Source&&);
+	void startLoad(uint32_t texture, uint32_t maxSize);
+	void finishLoad(Load&, vk::CommandBuffer);
+	bool replace(uint32_t texture, uint32_t firstMip, const DecodedImage* image, vk::CommandBuffer);
+	void copyMips(vk::CommandBuffer, const Texture&, resource_handle_t destination, uint32_t destinationFirstMip);
+	// Drops a level from the least recently used texture that isn't needed this frame. False if there is none.
+	bool evictOne(uint32_t except, bool evenIfUsed = false);
+	uint64_t getLevelBytes(const Texture&, uint32_t first, uint32_t end) const;
+
+private:
+
+	VulkanRenderer& renderer;
+	TextureStreamerSettings settings;
+	std::unordered_map<std::string, ImageDecoder> decoders;
+	uint32_t supportedCompressions = 0;
+
+	// Pointers, so textures keep their address and atomics while the vector grows.
+	std::vector<std::unique_ptr<Texture>> textures;
+	std::unordered_map<resource_handle_t, uint32_t> lookup;
+
+	std::vector<Replacement> replacements;
+	// Textures that had levels evicted this update. They get their smaller image at its end.
+	std::vector<uint32_t> evictions;
+
+	uint64_t frame = 0;
+	uint64_t residentBytes = 0;
+	uint64_t loadedMips = 0;
+	uint64_t evictedMips = 0;
+	uint32_t pendingLoads = 0;
+
+	// Finished decodes, handed over from the workers.
+	std::mutex loadMutex;
+	std::vector<std::unique_ptr<Load>> finishedLoads;
+	JobCounter loadCounter;
+};
@@ -0,0 +1,167 @@
+//
+//  texture_transcoder.cpp
+//  Vulkan_test
+//
+//  Created by Danny on 17/10/2026.
+//  Copyright © 2026 Danny. All rights reserved.
+//
+
+#include "texture_transcoder.hpp"
+
+#include <algorithm>
+
+#include "texture_streamer.hpp"
+#include "vulkan_resources.hpp"
+
+namespace {
+
+	uint32_t getBlockBytes(BlockCompression compression) {
+		return compression == BlockCompression::BC1 || compression == BlockCompression::BC4 ? 8 : 16;
+	}
+
+	void from565(uint16_t colour, int32_t result[3]) {
+		const int32_t r = colour >> 11 & 31;
+		const int32_t g = colour >> 5 & 63;
+		const int32_t b = colour & 31;
+		result[0] = r << 3 | r >> 2;
+		result[1] = g << 2 | g >> 4;
+		result[2] = b << 3 | b >> 2;
+	}
+
+	void getColourPalette(uint16_t c0, uint16_t c1, bool fourColours, int32_t palette[4][4]) {
+		from565(c0, palette[0]);
+		from565(c1, palette[1]);
+		palette[0][3] = palette[1][3] = palette[2][3] = 255;
+		palette[3][3] = fourColours ? 255 : 0;
+		for(int c = 0; c < 3; ++c) {
+			if(fourColours) {
+				palette[2][c] = (2 * palette[0][c] + palette[1][c] + 1) / 3;
+				palette[3][c] = (palette[0][c] + 2 * palette[1][c] + 1) / 3;
+			}
+			else {
+				palette[2][c] = (palette[0][c] + palette[1][c] + 1) / 2;
+				palette[3][c] = 0;
+			}
+		}
+	}
+
+	void getChannelPalette(uint8_t a0, uint8_t a1, int32_t palette[8]) {
+		palette[0] = a0;
+		palette[1] = a1;
+		if(a0 > a1) {
+			for(int i = 1; i < 7; ++i)
+				palette[i + 1] = ((7 - i) * a0 + i * a1 + 3) / 7;
+		}
+		else {
+			for(int i = 1; i < 5; ++i)
+				palette[i + 1] = ((5 - i) * a0 + i * a1 + 2) / 5;
+			palette[6] = 0;
+			palette[7] = 255;
+		}
+	}
+
+	void decompressColourBlock(const uint8_t* input, bool alwaysFourColours, uint8_t block[16][4]) {
+		const auto c0 = static_cast<uint16_t>(input[0] | input[1] << 8);
+		const auto c1 = static_cast<uint16_t>(input[2] | input[3] << 8);
+		const uint32_t indices = input[4] | input[5] << 8 | input[6] << 16 | uint32_t(input[7]) << 24;
+
+		int32_t palette[4][4];
+		getColourPalette(c0, c1, alwaysFourColours || c0 > c1, palette);
+		for(int i = 0; i < 16; ++i) {
+			const auto& colour = palette[indices >> (i * 2) & 3];
+			for(int c = 0; c < 4; ++c)
+				block[i][c] = static_cast<uint8_t>(colour[c]);
+		}
+	}
+
+	void decompressChannelBlock(const uint8_t* input, uint32_t channel, uint8_t block[16][4]) {
+		int32_t palette[8];
+		getChannelPalette(input[0], input[1], palette);
+
+		uint64_t indices = 0;
+		for(int i = 0; i < 6; ++i)
+			indices |= uint64_t(input[2 + i]) << (i * 8);
+		for(int i = 0; i < 16; ++i)
+			block[i][channel] = static_cast<uint8_t>(palette[indices >> (i * 3) & 7]);
+	}
+}
+
+bool decompressBlocks(const uint8_t* blocks, uint32_t width, uint32_t height, BlockCompression compression, std::vector<uint8_t>& rgba)
+{
+	if(compression != BlockCompression::BC1 && compression != BlockCompression::BC3 &&
+	   compression != BlockCompression::BC4 && compression != BlockCompression::BC5)
+		return false;
+
+	const uint32_t columns = (width + 3) / 4;
+	const uint32_t rows = (height + 3) / 4;
+	const auto blockBytes = getBlockBytes(compression);
+	rgba.assign(size_t(width) * height * 4, 0);
+
+	uint8_t block[16][4];
+	for(uint32_t row = 0; row < rows; ++row) {
+		for(uint32_t column = 0; column < columns; ++column) {
+			const auto input = blocks + (size_t(row) * columns + column) * blockBytes;
+			switch(compression)
+			{
+				case BlockCompression::BC1:
+					decompressColourBlock(input, false, block);
+					break;
+				case BlockCompression::BC3:
+					decompressColourBlock(input + 8, true, block);
+					decompressChannelBlock(input, 3, block);
+					break;
+				default:
+					for(int i = 0; i < 16; ++i) {
+						block[i][1] = block[i][2] = 0;
+						block[i][3] = 255;
+					}
+					decompressChannelBlock(input, 0, block);
+					if(compression == BlockCompression::BC5)
+						decompressChannelBlock(input + 8, 1, block);
+					break;
+			}
+
+			for(uint32_t i = 0; i < 16; ++i) {
+				const auto x = column * 4 + i % 4;
+				const auto y = row * 4 + i / 4;
+				if(x < width && y < height)
+					std::copy(block[i], block[i] + 4, &rgba[(size_t(y) * width + x) * 4]);
+			}
+		}
+	}
+
+	return true;
+}
+
+uint32_t getCompressionBit(BlockCompression compression)
+{
+	return 1u << static_cast<uint32_t>(compression);
+}
+
+BlockCompression chooseBlockCompression(const DecodedImage& image, uint32_t supportedCompressions)
+{
+	const auto compression = image.descriptor.compression;
+	return supportedCompressions & getCompressionBit(compression) ? compression : BlockCompression::NONE;
+}
+
+bool transcodeImage(DecodedImage& image, BlockCompression compression)
+{
+	auto& descriptor = image.descriptor;
+	if(descriptor.compression == compression)
+		return true;
+	if(compression != BlockCompression::NONE)
+		return false;
+
+	for(size_t i = 0; i < image.mips.size(); ++i) {
+		const auto extent = getMipExtent(descriptor, image.firstMip + static_cast<uint32_t>(i));
+		std::vector<uint8_t> rgba;
+		if(!decompressBlocks(image.mips[i].data(), extent.width, extent.height, descriptor.compression, rgba))
+			return false;
+		image.mips[i] = std::move(rgba);
+	}
+
+	descriptor.srgb = descriptor.srgb && descriptor.compression != BlockCompression::BC4 && descriptor.compression != BlockCompression::BC5;
+	descriptor.compression = BlockCompression::NONE;
+	descriptor.layout = ChannelLayout::RGBA;
+	return true;
+}
@@ -0,0 +1,30 @@
+//
+//  texture_transcoder.hpp
+//  Vulkan_test
+//
+//  Created by Danny on 17/10/2026.
+//  Copyright © 2026 Danny. All rights reserved.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "resource_descriptors.hpp"
+
+struct DecodedImage;
+
+// Decodes BC1 to BC5 to 8 bit RGBA, single and two channel formats leave the other channels at 0 and alpha at 255.
+// Returns false for the other block formats.
+bool decompressBlocks(const uint8_t* blocks, uint32_t width, uint32_t height, BlockCompression, std::vector<uint8_t>& rgba);
+
+// Bit i is set if the device can sample BlockCompression(i). NONE is always supported.
+uint32_t getCompressionBit(BlockCompression);
+
+// The format a decoded image should be uploaded in: its own if the device supports it, NONE to decompress it.
+BlockCompression chooseBlockCompression(const DecodedImage&, uint32_t supportedCompressions);
+
+// Converts every level of a decoded image to compression. Only decompressing BC1 to BC5 to RGBA is supported, false
+// for anything else.
+bool transcodeImage(DecodedImage&, BlockCompression);
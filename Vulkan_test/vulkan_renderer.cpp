@@ -11,12 +11,151 @@
 #endif
 
 #include "vulkan_renderer.hpp"
+#include "profiler.hpp"
 
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <exception>
+#include <limits>
 #include <map>
 
-VulkanRenderer::VulkanRenderer(const DeviceRequirements& reqs) {
+namespace {
+	
+	double getMilliseconds(uint64_t start, uint64_t end) {
+		return static_cast<double>(end - start) / 1e6;
+	}
+	
+	uint32_t getFramesInFlight(const DeviceRequirements& reqs) {
+		return std::min(std::max(reqs.framesInFlight, 1u), 3u);
+	}
+	
+#ifdef VK_KHR_present_wait
+	bool supportsPresentWait(const vk::PhysicalDevice& device) {
+		const auto extensions = device.enumerateDeviceExtensionProperties();
+		auto supported = [&](const char* name) {
+			return std::any_of(extensions.begin(), extensions.end(), [&](const vk::ExtensionProperties& extension) {
+				return std::strcmp(extension.extensionName, name) == 0;
+			});
+		};
+		
+		if(!supported(VK_KHR_PRESENT_ID_EXTENSION_NAME) || !supported(VK_KHR_PRESENT_WAIT_EXTENSION_NAME))
+			return false;
+		
+		const auto features = device.getFeatures2<vk::PhysicalDeviceFeatures2, vk::PhysicalDevicePresentIdFeaturesKHR, vk::PhysicalDevicePresentWaitFeaturesKHR>();
+		return features.get<vk::PhysicalDevicePresentIdFeaturesKHR>().presentId && features.get<vk::PhysicalDevicePresentWaitFeaturesKHR>().presentWait;
+	}
+#endif
+	
+	// The features something in the renderer uses, as far as the device supports them.
+	void selectDeviceFeatures(const vk::PhysicalDeviceFeatures& supported, const vk::PhysicalDeviceVulkan12Features& supported12, bool bindless,
+							  vk::PhysicalDeviceFeatures& enabled, vk::PhysicalDeviceVulkan12Features& enabled12) {
+		// GpuDrivenScene and block compressed textures.
+		enabled.multiDrawIndirect = supported.multiDrawIndirect;
+		enabled.drawIndirectFirstInstance = supported.drawIndirectFirstInstance;
+		enabled.textureCompressionBC = supported.textureCompressionBC;
+		
+		// Frame and async compute synchronisation.
+		enabled12.timelineSemaphore = supported12.timelineSemaphore;
+		enabled12.drawIndirectCount = supported12.drawIndirectCount;
+		
+		if(bindless) {
+			enabled12.runtimeDescriptorArray = supported12.runtimeDescriptorArray;
+			enabled12.descriptorBindingPartiallyBound = supported12.descriptorBindingPartiallyBound;
+			enabled12.descriptorBindingUpdateUnusedWhilePending = supported12.descriptorBindingUpdateUnusedWhilePending;
+			enabled12.descriptorBindingSampledImageUpdateAfterBind = supported12.descriptorBindingSampledImageUpdateAfterBind;
+			enabled12.descriptorBindingStorageBufferUpdateAfterBind = supported12.descriptorBindingStorageBufferUpdateAfterBind;
+			enabled12.shaderSampledImageArrayNonUniformIndexing = supported12.shaderSampledImageArrayNonUniformIndexing;
+			enabled12.shaderStorageBufferArrayNonUniformIndexing = supported12.shaderStorageBufferArrayNonUniformIndexing;
+		}
+	}
+}
+
+VulkanRenderer::VulkanRenderer(const DeviceRequirements& reqs)
+: shaderCachePath(reqs.shaderCachePath), presentPolicy(reqs.presentPolicy), swapChainDepthBuffer(reqs.createDepthBuffer) {
+	
+	auto phaseStart = Profiler::now();
+	const auto start = phaseStart;
+	auto endPhase = [&](double& timing) {
+		const auto now = Profiler::now();
+		timing = getMilliseconds(phaseStart, now);
+		phaseStart = now;
+	};
+	
+	// The workers start up while the instance and device are created.
+	jobSystem = std::make_unique<JobSystem>(reqs.workerThreads);
+	framePacer.setTargetInterval(reqs.targetFrameInterval);
+	
+	createInstance(reqs);
+	endPhase(startupTimings.instance);
+	
+	// One surface for every device that is considered.
+	if(reqs.swapchainSupport)
+		createPlatformSpecificSurface(reqs.nativeWindowHandle);
+	
+	const auto devices = instance.enumeratePhysicalDevices();
+	const auto requirements = getDeviceCacheRequirements(reqs);
+	DeviceCacheEntry cached;
+	if(!reqs.deviceCachePath.empty() && loadDeviceCache(reqs.deviceCachePath, cached) && cached.requirements == requirements) {
+		physicalDevice = findCachedDevice(devices, cached);
+		// A different window may end up on a different display.
+		if(physicalDevice && reqs.swapchainSupport && !checkSwapChainCompatibilityForDevice(physicalDevice))
+			physicalDevice = nullptr;
+	}
+	
+	startupTimings.deviceCacheHit = static_cast<bool>(physicalDevice);
+	if(!physicalDevice)
+		chooseBestDevice(devices, reqs);
+	endPhase(startupTimings.deviceSelection);
+	
+	bool bindless = false;
+	if(physicalDevice && (reqs.graphicsQueueSupport || reqs.headless)) {
+		createLogicalDeviceAndPresentQueue(reqs, startupTimings.deviceCacheHit ? &cached : nullptr);
+		bindless = reqs.bindless && (startupTimings.deviceCacheHit ? cached.bindless : BindlessTable::isSupported(physicalDevice));
+		
+		if(!startupTimings.deviceCacheHit && !reqs.deviceCachePath.empty()) {
+			auto entry = getDeviceCacheEntry(physicalDevice);
+			entry.requirements = requirements;
+			entry.graphicsQueueIndex = graphicsQueueIndex;
+			entry.transferQueueIndex = transferQueueIndex;
+			entry.computeQueueIndex = computeQueueIndex;
+			entry.bindless = bindless;
+			saveDeviceCache(reqs.deviceCachePath, entry);
+		}
+	}
+	endPhase(startupTimings.device);
+	
+	if(logicalDevice) {
+		createObjects(reqs, bindless);
+		startupTimings.pipelineCacheHit = pipelineCache->isWarm();
+	}
+	endPhase(startupTimings.objects);
+	
+	if(reqs.headless && logicalDevice)
+		createOffscreenTargets(reqs);
+	endPhase(startupTimings.offscreenTargets);
+	
+	startupTimings.total = getMilliseconds(start, phaseStart);
+}
+
+void VulkanRenderer::createInstance(const DeviceRequirements& reqs) {
+	
+	std::vector<const char*> validationLayers;
+	if(reqs.validation) {
+		// Older SDKs only have the LunarG meta layer.
+		const auto available = vk::enumerateInstanceLayerProperties();
+		for(const auto name: {"VK_LAYER_KHRONOS_validation", "VK_LAYER_LUNARG_standard_validation"}) {
+			const bool found = std::any_of(available.begin(), available.end(), [&](const vk::LayerProperties& layer) {
+				return std::strcmp(layer.layerName, name) == 0;
+			});
+			
+			if(found) {
+				validationLayers.emplace_back(name);
+				break;
+			}
+		}
+	}
 	
-	const std::vector<const char* const> validationLayers { "VK_LAYER_LUNARG_standard_validation" };
 	std::vector<const char*> requiredExtensions;
 	if(reqs.swapchainSupport)
 	{
@@ -28,22 +167,143 @@ VulkanRenderer::VulkanRenderer(const DeviceRequirements& reqs) {
 		
 	}
 	
+	// Timeline semaphores are core in 1.2.
+	vk::ApplicationInfo applicationInfo;
+	applicationInfo.setApiVersion(VK_API_VERSION_1_2);
+	
 	vk::InstanceCreateInfo info;
+	info.setPApplicationInfo(&applicationInfo);
 	info.setPpEnabledLayerNames(validationLayers.data()).
 	setEnabledLayerCount(static_cast<uint32_t>(validationLayers.size())).
 	setPpEnabledExtensionNames(requiredExtensions.data()).
 	setEnabledExtensionCount(static_cast<uint32_t>(requiredExtensions.size()));
 	
 	instance = vk::createInstance(info);
-	chooseBestDevice(instance.enumeratePhysicalDevices(), reqs);
-	if(reqs.graphicsQueueSupport)
-		createLogicalDeviceAndPresentQueue(reqs);
+}
+
+void VulkanRenderer::createObjects(const DeviceRequirements& reqs, bool bindless) {
+	
+	// Everything here only depends on the device, so it is created in parallel. Vulkan allows creating
+	// objects from any thread, only the allocator has to come before its users.
+	JobCounter counter;
+	std::mutex errorMutex;
+	std::exception_ptr error;
+	auto run = [&](std::function<void()> create) {
+		jobSystem->schedule([&, create] {
+			try {
+				create();
+			} catch(...) {
+				std::lock_guard<std::mutex> lock(errorMutex);
+				error = std::current_exception();
+			}
+		}, counter);
+	};
 	
-	if(reqs.swapchainSupport)
-		createSwapChain(reqs);
+	run([&] {
+		memoryAllocator = std::make_unique<MemoryAllocator>(physicalDevice, logicalDevice);
+		
+		// Without a dedicated queue the uploader shares the graphics or compute queue and has to lock it.
+		std::mutex* uploadQueueMutex = nullptr;
+		if(transferQueue == graphicsQueue)
+			uploadQueueMutex = &graphicsQueueMutex;
+		else if(transferQueue == computeQueue)
+			uploadQueueMutex = &computeQueueMutex;
+		uploader = std::make_unique<GpuUploader>(logicalDevice, *memoryAllocator, transferQueue, transferQueueIndex,
+												 graphicsQueue, graphicsQueueIndex, uploadQueueMutex, graphicsQueueMutex);
+		
+		if(reqs.swapchainSupport)
+			createSwapChain();
+	});
+	
+	run([&] { pipelineCache = std::make_unique<PipelineCache>(physicalDevice, logicalDevice, reqs.pipelineCachePath); });
+	
+	if(bindless)
+		run([&] { bindlessTable = std::make_unique<BindlessTable>(physicalDevice, logicalDevice); });
+	
+	run([&] {
+		createCommandPool();
+		createFrameContexts(reqs);
+	});
+	
+#ifdef RENDERER_PROFILING
+	run([&] { gpuProfiler = std::make_unique<GpuProfiler>(physicalDevice, logicalDevice, graphicsQueueIndex, getFramesInFlight(reqs)); });
+#endif
+	
+	descriptorSetCache = std::make_unique<DescriptorSetCache>(logicalDevice);
+	
+	counter.wait();
+	if(error)
+		std::rethrow_exception(error);
+}
+
+ShaderCompiler& VulkanRenderer::getShaderCompiler() {
+	std::call_once(shaderCompilerCreated, [&] { shaderCompiler = std::make_unique<ShaderCompiler>(shaderCachePath); });
+	return *shaderCompiler;
+}
+
+VulkanRenderer::~VulkanRenderer() {
+	
+	if(logicalDevice) {
+		logicalDevice.waitIdle();
+		jobSystem.reset();
+		
+		// Does nothing without a pipelineCachePath.
+		if(pipelineCache)
+			pipelineCache->save();
+		
+		// The sets go with their pools, no need to release them one by one.
+		descriptorSetCache.reset();
+		
+		// Nothing is in flight anymore.
+		destroyRetiredObjects(std::numeric_limits<uint64_t>::max());
+		
+		// Its framebuffers go first, the loops below would destroy them a second time.
+		destroySwapChain();
+		
+		framebuffers.forEach([&](resource_handle_t, VulkanFramebuffer& f) { logicalDevice.destroyFramebuffer(f.framebuffer); });
+		renderPasses.forEach([&](resource_handle_t, VulkanRenderPass& rp) { logicalDevice.destroyRenderPass(rp.renderPass); });
+		shaderModules.forEach([&](resource_handle_t, VulkanShaderModule& m) { logicalDevice.destroyShaderModule(m.module); });
+		pipelines.forEach([&](resource_handle_t, VulkanPipeline& p) {
+			logicalDevice.destroyPipeline(p.pipeline);
+			logicalDevice.destroyPipelineLayout(p.layout);
+		});
+		textures.forEach([&](resource_handle_t, VulkanTexture& t) { destroyTextureNow(t); });
+		buffers.forEach([&](resource_handle_t, VulkanBuffer& b) { destroyBufferNow(b); });
+		samplers.forEach([&](resource_handle_t, VulkanSampler& s) { logicalDevice.destroySampler(s.sampler); });
+		
+		for(const auto& layout: descriptorSetLayoutLookup)
+			logicalDevice.destroyDescriptorSetLayout(layout.second);
+		
+		for(auto& frame: frames) {
+			logicalDevice.destroyCommandPool(frame.commandPool);
+			for(auto& threadPool: frame.threadCommandPools)
+				logicalDevice.destroyCommandPool(threadPool.commandPool);
+			logicalDevice.destroyCommandPool(frame.computeCommandPool);
+			logicalDevice.destroySemaphore(frame.imageAvailable);
+			logicalDevice.destroySemaphore(frame.renderFinished);
+			logicalDevice.destroyFence(frame.inFlight);
+		}
+		frames.clear();
+		
+		logicalDevice.destroySemaphore(graphicsTimeline);
+		logicalDevice.destroySemaphore(computeTimeline);
+		logicalDevice.destroyCommandPool(graphicsCommandPool);
+		
+		// The uploader and the depth buffer still free into the allocator.
+		uploader.reset();
+		bindlessTable.reset();
+		pipelineCache.reset();
+#ifdef RENDERER_PROFILING
+		gpuProfiler.reset();
+#endif
+		memoryAllocator.reset();
+		
+		logicalDevice.destroy();
+	}
 	
-	createCommandPool();
-	createDescriptorPool();
+	if(surface)
+		instance.destroySurfaceKHR(surface);
+	instance.destroy();
 }
 
 void VulkanRenderer::chooseBestDevice(const std::vector<vk::PhysicalDevice>& devices, const DeviceRequirements& reqs) {
@@ -54,16 +314,19 @@ void VulkanRenderer::chooseBestDevice(const std::vector<vk::PhysicalDevice>& dev
 	
 	if(reqs.swapchainSupport) {
 		for(const auto& device: devices) {
-			if(checkSwapChainCompatibilityForDevice(device, reqs)) {
+			if(checkSwapChainCompatibilityForDevice(device)) {
 				suitableDevices.emplace_back(device);
 			}
 		}
 	} else {
-		// Filter out devices that don't have a graphics queue
+		// Filter out devices that don't have a graphics queue, or a compute queue if we don't rasterize.
+		// Nothing here depends on a display, so software implementations like lavapipe qualify.
+		const auto requiredQueue = reqs.graphicsQueueSupport ? vk::QueueFlagBits::eGraphics : vk::QueueFlagBits::eCompute;
 		for(const auto& device: devices) {
 			for(auto& property: device.getQueueFamilyProperties()) {
-				if(property.queueFlags & vk::QueueFlagBits::eGraphics && property.queueCount > 0) {
+				if(property.queueFlags & requiredQueue && property.queueCount > 0) {
 					suitableDevices.emplace_back(device);
+					break;
 				}
 			}
 		}
@@ -105,16 +368,17 @@ void VulkanRenderer::createPlatformSpecificSurface(void* nativeWindowHandle) {
 #endif
 }
 
-void VulkanRenderer::createLogicalDeviceAndPresentQueue(const DeviceRequirements& reqs) {
+void VulkanRenderer::createLogicalDeviceAndPresentQueue(const DeviceRequirements& reqs, const DeviceCacheEntry* cached) {
 	
-	auto layers 	= physicalDevice.enumerateDeviceLayerProperties();
-	auto features 	= physicalDevice.getFeatures();
-	auto extensions = physicalDevice.enumerateDeviceExtensionProperties();
+	auto features 	= physicalDevice.getFeatures2<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceVulkan12Features>();
 	auto queueFamilyProperties = physicalDevice.getQueueFamilyProperties();
 	
+	// A compute only headless renderer submits everything to a compute queue.
+	const auto requiredQueue = reqs.graphicsQueueSupport ? vk::QueueFlagBits::eGraphics : vk::QueueFlagBits::eCompute;
+	
 	uint32_t index = 0;
 	for(auto& p: queueFamilyProperties) {
-		if(p.queueCount > 0 && p.queueFlags & vk::QueueFlagBits::eGraphics) {
+		if(!cached && p.queueCount > 0 && p.queueFlags & requiredQueue) {
 			graphicsQueueIndex = index;
 		}
 		
@@ -128,41 +392,135 @@ void VulkanRenderer::createLogicalDeviceAndPresentQueue(const DeviceRequirements
 		index++;
 	}
 	
+	if(cached) {
+		graphicsQueueIndex = cached->graphicsQueueIndex;
+		transferQueueIndex = cached->transferQueueIndex;
+		computeQueueIndex = cached->computeQueueIndex;
+	} else {
+		// Prefer a family that can only transfer (the copy engine), then one that at least can't render.
+		transferQueueIndex = graphicsQueueIndex;
+		uint32_t bestTransferScore = 0;
+		index = 0;
+		for(auto& p: queueFamilyProperties) {
+			const bool transfer = p.queueCount > 0 && p.queueFlags & vk::QueueFlagBits::eTransfer;
+			const bool graphics = static_cast<bool>(p.queueFlags & vk::QueueFlagBits::eGraphics);
+			const bool compute = static_cast<bool>(p.queueFlags & vk::QueueFlagBits::eCompute);
+			const uint32_t score = !transfer || graphics ? 0 : compute ? 1 : 2;
+			if(score > bestTransferScore) {
+				bestTransferScore = score;
+				transferQueueIndex = index;
+			}
+			
+			index++;
+		}
+		
+		// Async compute wants a family that can't render, preferably not the one the uploader took.
+		computeQueueIndex = graphicsQueueIndex;
+		uint32_t bestComputeScore = 0;
+		index = 0;
+		for(auto& p: queueFamilyProperties) {
+			const bool compute = p.queueCount > 0 && p.queueFlags & vk::QueueFlagBits::eCompute;
+			const bool graphics = static_cast<bool>(p.queueFlags & vk::QueueFlagBits::eGraphics);
+			const uint32_t score = !compute || graphics || index == graphicsQueueIndex ? 0 : index == transferQueueIndex ? 1 : 2;
+			if(score > bestComputeScore) {
+				bestComputeScore = score;
+				computeQueueIndex = index;
+			}
+			
+			index++;
+		}
+	}
+	
 	std::vector<const char*> extensionNames;
-	extensionNames.emplace_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+	if(reqs.swapchainSupport)
+		extensionNames.emplace_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+	
+#ifdef VK_KHR_present_wait
+	// Present ids time presents exactly, and let LOW_LATENCY start a frame right after the previous one was shown.
+	vk::PhysicalDevicePresentIdFeaturesKHR presentIdFeatures;
+	vk::PhysicalDevicePresentWaitFeaturesKHR presentWaitFeatures;
+	const bool presentWait = reqs.swapchainSupport && supportsPresentWait(physicalDevice);
+	if(presentWait) {
+		extensionNames.emplace_back(VK_KHR_PRESENT_ID_EXTENSION_NAME);
+		extensionNames.emplace_back(VK_KHR_PRESENT_WAIT_EXTENSION_NAME);
+		presentIdFeatures.setPresentId(true);
+		presentWaitFeatures.setPresentWait(true);
+		presentIdFeatures.setPNext(&presentWaitFeatures);
+	}
+#endif
 	
-	std::vector<const char*> layerNames;
-	for(auto& l: layers)
-		layerNames.emplace_back(l.layerName);
+	// Each user takes the next queue of its family, and shares the last one once the family runs out. Without
+	// a transfer family that gives the uploader a second graphics queue if there is one.
+	std::vector<uint32_t> queueCounts(queueFamilyProperties.size(), 0);
+	auto takeQueue = [&](uint32_t family) {
+		const auto queue = std::min(queueCounts[family], queueFamilyProperties[family].queueCount - 1);
+		queueCounts[family] = queue + 1;
+		return queue;
+	};
+	takeQueue(graphicsQueueIndex);
+	const auto transferSlot = takeQueue(transferQueueIndex);
+	const auto computeSlot = hasAsyncCompute() ? takeQueue(computeQueueIndex) : 0;
+	
+	const float queuePriorities[] = {1.0, 1.0, 1.0};
+	std::vector<vk::DeviceQueueCreateInfo> queueInfos;
+	for(uint32_t family = 0; family < queueCounts.size(); ++family) {
+		if(!queueCounts[family])
+			continue;
+		
+		queueInfos.emplace_back();
+		queueInfos.back().setQueueCount(queueCounts[family]).
+		setPQueuePriorities(queuePriorities).
+		setQueueFamilyIndex(family);
+	}
 	
-	float queuePriority = 1.0;
-	vk::DeviceQueueCreateInfo queueInfo;
-	queueInfo.setQueueCount(1).
-	setPQueuePriorities(&queuePriority).
-	setQueueFamilyIndex(graphicsQueueIndex);
+	// Device layers are deprecated, validation comes from the instance.
+	const auto& supported = features.get<vk::PhysicalDeviceFeatures2>().features;
+	const auto& supported12 = features.get<vk::PhysicalDeviceVulkan12Features>();
+	vk::PhysicalDeviceFeatures2 enabled;
+	vk::PhysicalDeviceVulkan12Features enabled12;
+	if(reqs.allDeviceFeatures) {
+		enabled.features = supported;
+		enabled12 = supported12;
+	} else {
+		selectDeviceFeatures(supported, supported12, reqs.bindless, enabled.features, enabled12);
+	}
+	enabled12.setPNext(nullptr);
+	enabled.setPNext(&enabled12);
+#ifdef VK_KHR_present_wait
+	if(presentWait)
+		enabled12.setPNext(&presentIdFeatures);
+#endif
 	
 	vk::DeviceCreateInfo logicalDeviceCreateInfo;
-	logicalDeviceCreateInfo.setPEnabledFeatures(&features).
+	logicalDeviceCreateInfo.setPNext(&enabled).
 	setEnabledExtensionCount(static_cast<uint32_t>(extensionNames.size())).
 	setPpEnabledExtensionNames(extensionNames.data()).
-	setEnabledLayerCount(static_cast<uint32_t>(layerNames.size())).
-	setPpEnabledLayerNames(layerNames.data()).
-	setQueueCreateInfoCount(1).
-	setPQueueCreateInfos(&queueInfo);
+	setQueueCreateInfoCount(static_cast<uint32_t>(queueInfos.size())).
+	setPQueueCreateInfos(queueInfos.data());
 	
 	logicalDevice = physicalDevice.createDevice(logicalDeviceCreateInfo);
-	presentQueue = logicalDevice.getQueue(graphicsQueueIndex, 0);
+	deviceFeatures = enabled.features;
+	deviceFeatures12 = enabled12;
+	graphicsQueue = logicalDevice.getQueue(graphicsQueueIndex, 0);
+	presentQueue = graphicsQueue;
+	transferQueue = logicalDevice.getQueue(transferQueueIndex, transferSlot);
+	computeQueue = hasAsyncCompute() ? logicalDevice.getQueue(computeQueueIndex, computeSlot) : graphicsQueue;
+	
+#ifdef VK_KHR_present_wait
+	// Not exported by the loader, extension commands come through the device.
+	if(presentWait)
+		waitForPresent = reinterpret_cast<PFN_vkWaitForPresentKHR>(logicalDevice.getProcAddr("vkWaitForPresentKHR"));
+#endif
 	
 	if(surface) {
 		surfaceCababilities 	= physicalDevice.getSurfaceCapabilitiesKHR(surface);
 		supportedSurfaceFormats = physicalDevice.getSurfaceFormatsKHR(surface);
 		supportedPresentModes 	= physicalDevice.getSurfacePresentModesKHR(surface);
 		chooseSurfaceFormatForSwapChain();
-		choosePresentModeForSwapChain();
 	}
 }
 
-bool VulkanRenderer::checkSwapChainCompatibilityForDevice(const vk::PhysicalDevice &device, const DeviceRequirements& reqs) {
+bool VulkanRenderer::checkSwapChainCompatibilityForDevice(const vk::PhysicalDevice &device) {
 
 	std::string surfaceExtension;
 #ifdef __APPLE__
@@ -177,10 +535,7 @@ bool VulkanRenderer::checkSwapChainCompatibilityForDevice(const vk::PhysicalDevi
 		}
 	}
 	
-	if(compatible) {
-		
-		createPlatformSpecificSurface(reqs.nativeWindowHandle);
-		
+	if(compatible && surface) {
 		uint32_t queueIndex = 0;
 		for(auto& property: device.getQueueFamilyProperties()) {
 			if(property.queueFlags & vk::QueueFlagBits::eGraphics && property.queueCount > 0) {
@@ -214,33 +569,70 @@ void VulkanRenderer::chooseSurfaceFormatForSwapChain() {
 }
 
 void VulkanRenderer::choosePresentModeForSwapChain() { 
-	vk::PresentModeKHR mode = vk::PresentModeKHR::eFifo;
+	auto supported = [&](vk::PresentModeKHR mode) {
+		return std::find(supportedPresentModes.begin(), supportedPresentModes.end(), mode) != supportedPresentModes.end();
+	};
 	
-	for(const auto& pMode: supportedPresentModes) {
-		if(pMode == vk::PresentModeKHR::eMailbox) {
-			swapChainPresentMode = mode;
-			return;
-		} else if (pMode == vk::PresentModeKHR::eImmediate) {
-			mode = pMode;
-		}
+	// Fifo is the only mode every surface has to support.
+	swapChainPresentMode = vk::PresentModeKHR::eFifo;
+	switch(presentPolicy)
+	{
+		case PresentPolicy::IMMEDIATE:
+			if(supported(vk::PresentModeKHR::eImmediate))
+				swapChainPresentMode = vk::PresentModeKHR::eImmediate;
+			else if(supported(vk::PresentModeKHR::eMailbox))
+				swapChainPresentMode = vk::PresentModeKHR::eMailbox;
+			break;
+			
+		case PresentPolicy::MAILBOX:
+			if(supported(vk::PresentModeKHR::eMailbox))
+				swapChainPresentMode = vk::PresentModeKHR::eMailbox;
+			break;
+			
+		case PresentPolicy::VSYNC:
+		case PresentPolicy::LOW_LATENCY:
+			break;
 	}
-	
-	swapChainPresentMode = mode;
 }
 
-void VulkanRenderer::createSwapChain(const DeviceRequirements& reqs) {
+void VulkanRenderer::createSwapChain() {
+	surfaceCababilities = physicalDevice.getSurfaceCapabilitiesKHR(surface);
+	choosePresentModeForSwapChain();
+	
+	// Surfaces that take their size from the swapchain report an extent of all ones.
+	swapChainExtent = surfaceCababilities.currentExtent;
+	if(swapChainExtent.width == std::numeric_limits<uint32_t>::max()) {
+		const auto& minExtent = surfaceCababilities.minImageExtent;
+		const auto& maxExtent = surfaceCababilities.maxImageExtent;
+		swapChainExtent.width = std::min(std::max(requestedSwapChainExtent.width, minExtent.width), maxExtent.width);
+		swapChainExtent.height = std::min(std::max(requestedSwapChainExtent.height, minExtent.height), maxExtent.height);
+	}
+	
+	// A minimised window, there is nothing to present to until it comes back.
+	if(!swapChainExtent.width || !swapChainExtent.height)
+		return;
+	
+	// Mailbox needs an image more than the minimum to never wait for the display.
+	uint32_t imageCount = surfaceCababilities.minImageCount + (swapChainPresentMode == vk::PresentModeKHR::eMailbox ? 1 : 0);
+	if(surfaceCababilities.maxImageCount)
+		imageCount = std::min(imageCount, surfaceCababilities.maxImageCount);
+	
 	vk::SwapchainCreateInfoKHR swapChainInfo;
 	swapChainInfo.setSurface(surface);
 	swapChainInfo.setImageFormat(swapChainFormat.format);
-	swapChainInfo.setMinImageCount(surfaceCababilities.minImageCount);
-	swapChainInfo.setImageExtent(surfaceCababilities.currentExtent);
+	swapChainInfo.setImageColorSpace(swapChainFormat.colorSpace);
+	swapChainInfo.setMinImageCount(imageCount);
+	swapChainInfo.setImageExtent(swapChainExtent);
 	swapChainInfo.setPresentMode(swapChainPresentMode);
+	swapChainInfo.setPreTransform(surfaceCababilities.currentTransform);
+	swapChainInfo.setClipped(true);
 	swapChainInfo.setImageSharingMode(vk::SharingMode::eExclusive);
 	swapChainInfo.setImageUsage(vk::ImageUsageFlagBits::eColorAttachment);
 	swapChainInfo.setImageArrayLayers(1);
 	
 	swapChain = logicalDevice.createSwapchainKHR(swapChainInfo);
 	swapChainImages = logicalDevice.getSwapchainImagesKHR(swapChain);
+	imagesInFlight.assign(swapChainImages.size(), vk::Fence());
 	
 	// Create image views for all swapchain images
 	for(const auto& image: swapChainImages) {
@@ -261,15 +653,14 @@ void VulkanRenderer::createSwapChain(const DeviceRequirements& reqs) {
 		swapChainImageViews.emplace_back(logicalDevice.createImageView(viewInfo));
 	}
 	
-	if(reqs.createDepthBuffer)
+	if(swapChainDepthBuffer)
 	{
 		// Create depthbuffer
 		vk::ImageCreateInfo depthBufferCreateInfo;
 		depthBufferCreateInfo.setUsage(vk::ImageUsageFlagBits::eDepthStencilAttachment);
 		depthBufferCreateInfo.setFormat(vk::Format::eD24UnormS8Uint);
 		depthBufferCreateInfo.setImageType(vk::ImageType::e2D);
-		const auto& windowSize = surfaceCababilities.currentExtent;
-		depthBufferCreateInfo.setExtent(vk::Extent3D{windowSize.width, windowSize.height, 1});
+		depthBufferCreateInfo.setExtent(vk::Extent3D{swapChainExtent.width, swapChainExtent.height, 1});
 		depthBufferCreateInfo.setMipLevels(1);
 		depthBufferCreateInfo.setSamples(vk::SampleCountFlagBits::e1);
 		depthBufferCreateInfo.setArrayLayers(1);
@@ -277,16 +668,8 @@ void VulkanRenderer::createSwapChain(const DeviceRequirements& reqs) {
 		
 		depthBuffer = logicalDevice.createImage(depthBufferCreateInfo);
 		
-		// Allocate devicememory for depthbuffer.
-		auto memoryProperties = physicalDevice.getMemoryProperties();
-		const auto memoryRequirements = logicalDevice.getImageMemoryRequirements(depthBuffer);
-		vk::MemoryAllocateInfo memoryInfo;
-		memoryInfo.setAllocationSize(memoryRequirements.size);
-		memoryInfo.setMemoryTypeIndex(memoryProperties.memoryTypes[0].heapIndex);
-		depthBufferDeviceMemory = logicalDevice.allocateMemory(memoryInfo);
-		
-		// Bind it to the depthbuffer
-		logicalDevice.bindImageMemory(depthBuffer, depthBufferDeviceMemory, 0);
+		// Allocate devicememory for depthbuffer and bind it.
+		depthBufferMemory = memoryAllocator->allocateForImage(depthBuffer, MemoryUsage::GPU_ONLY);
 		
 		// Create imageview for depthbuffer
 		vk::ImageSubresourceRange subResource;
@@ -304,267 +687,1372 @@ void VulkanRenderer::createSwapChain(const DeviceRequirements& reqs) {
 		depthBufferView = logicalDevice.createImageView(viewInfo);
 	}
 	
-	vk::AttachmentDescription attachmentDescription;
-	attachmentDescription.setLoadOp(vk::AttachmentLoadOp::eClear);
-	attachmentDescription.setStoreOp(vk::AttachmentStoreOp::eStore);
-	attachmentDescription.setSamples(vk::SampleCountFlagBits::e1);
-	attachmentDescription.setInitialLayout(vk::ImageLayout::eUndefined);
-	attachmentDescription.setFinalLayout(vk::ImageLayout::ePresentSrcKHR);
-	attachmentDescription.setFormat(vk::Format::eB8G8R8A8Unorm);
-	
-	vk::AttachmentReference attachmentRef;
-	attachmentRef.setAttachment(0);
-	attachmentRef.setLayout(vk::ImageLayout::eColorAttachmentOptimal);
-	
-	vk::SubpassDescription subDescription;
-	subDescription.setPipelineBindPoint(vk::PipelineBindPoint::eGraphics);
-	subDescription.setColorAttachmentCount(1);
-	subDescription.setPColorAttachments(&attachmentRef);
-	
-	vk::RenderPassCreateInfo rpCreateInfo;
-	rpCreateInfo.setSubpassCount(1);
-	rpCreateInfo.setPSubpasses(&subDescription);
-	rpCreateInfo.setAttachmentCount(1);
-	rpCreateInfo.setPAttachments(&attachmentDescription);
-	
-	swapChainRenderPass = logicalDevice.createRenderPass(rpCreateInfo);
+	// Attachments without a texture are the swapchain's image and depth buffer.
+	if(swapChainRenderPass == null_handle)
+	{
+		RenderPassColourAttachmentDescriptor colourAttachment;
+		colourAttachment.loadAction = LoadAction::CLEAR;
+		colourAttachment.clearColour = {0, 0, 0, 1};
+		
+		RenderPassDescriptor descriptor;
+		descriptor.colourAttachments.emplace_back(colourAttachment);
+		if(swapChainDepthBuffer) {
+			RenderPassDepthAttachmentDescriptor depthAttachment;
+			depthAttachment.loadAction = LoadAction::CLEAR;
+			depthAttachment.storeAction = StoreAction::DONT_CARE;
+			depthAttachment.clearDepth = 1;
+			descriptor.depthAttachment = depthAttachment;
+		}
+		
+		swapChainRenderPass = createRenderpass(descriptor);
+	}
 	
-	for(auto i = 0; i < swapChainImages.size(); ++i)
+	for(const auto& view: swapChainImageViews)
 	{
+		std::vector<vk::ImageView> attachments {view};
+		if(depthBufferView)
+			attachments.emplace_back(depthBufferView);
+		
 		vk::FramebufferCreateInfo info;
 		info.setLayers(1);
-		info.setWidth(surfaceCababilities.currentExtent.width);
-		info.setHeight(surfaceCababilities.currentExtent.height);
-		info.setRenderPass(swapChainRenderPass);
-		info.setPAttachments(&swapChainImageViews[i]);
-		info.setAttachmentCount(1);
+		info.setWidth(swapChainExtent.width);
+		info.setHeight(swapChainExtent.height);
+		info.setRenderPass(renderPasses.at(swapChainRenderPass).renderPass);
+		info.setPAttachments(attachments.data());
+		info.setAttachmentCount(static_cast<uint32_t>(attachments.size()));
 		
-		swapChainFrameBuffers.emplace_back(logicalDevice.createFramebuffer(info));
+		VulkanFramebuffer framebuffer;
+		framebuffer.framebuffer = logicalDevice.createFramebuffer(info);
+		framebuffer.renderPass = swapChainRenderPass;
+		framebuffer.width = swapChainExtent.width;
+		framebuffer.height = swapChainExtent.height;
+		swapChainFramebuffers.emplace_back(framebuffers.insert(framebuffer));
 	}
 }
 
-void VulkanRenderer::createCommandPool() { 
-	vk::CommandPoolCreateInfo poolInfo;
-	poolInfo.setQueueFamilyIndex(graphicsQueueIndex);
-	
-	graphicsCommandPool = logicalDevice.createCommandPool(poolInfo);
-	
-	vk::CommandBufferAllocateInfo commandBufferInfo;
-	commandBufferInfo.setLevel(vk::CommandBufferLevel::ePrimary);
-	commandBufferInfo.setCommandPool(graphicsCommandPool);
-	commandBufferInfo.setCommandBufferCount(1);
+void VulkanRenderer::destroySwapChain() {
+	for(auto framebuffer: swapChainFramebuffers)
+		logicalDevice.destroyFramebuffer(framebuffers.erase(framebuffer).framebuffer);
+	for(auto view: swapChainImageViews)
+		logicalDevice.destroyImageView(view);
+	swapChainFramebuffers.clear();
+	swapChainImageViews.clear();
+	swapChainImages.clear();
+	
+	if(depthBuffer) {
+		logicalDevice.destroyImageView(depthBufferView);
+		logicalDevice.destroyImage(depthBuffer);
+		memoryAllocator->free(depthBufferMemory);
+		depthBufferView = nullptr;
+		depthBuffer = nullptr;
+	}
 	
-	commandBuffers = logicalDevice.allocateCommandBuffers(commandBufferInfo);
+	logicalDevice.destroySwapchainKHR(swapChain);
+	swapChain = nullptr;
 }
 
-void VulkanRenderer::createDescriptorPool() {
-	std::vector<vk::DescriptorPoolSize> poolSizes;
-	
-	vk::DescriptorPoolSize size;
-	size.setType(vk::DescriptorType::eUniformBuffer);
-	size.setDescriptorCount(32);
-	poolSizes.push_back(size);
-	
-	size.setType(vk::DescriptorType::eUniformBufferDynamic);
-	size.setDescriptorCount(32);
-	poolSizes.push_back(size);
-	
-	size.setType(vk::DescriptorType::eSampler);
-	size.setDescriptorCount(32);
-	poolSizes.push_back(size);
-	
-	size.setType(vk::DescriptorType::eSampledImage);
-	size.setDescriptorCount(32);
-	poolSizes.push_back(size);
+void VulkanRenderer::recreateSwapChain() {
+	PROFILE_FUNCTION();
 	
-	size.setType(vk::DescriptorType::eStorageImage);
-	size.setDescriptorCount(32);
-	poolSizes.push_back(size);
-	
-	size.setType(vk::DescriptorType::eStorageBuffer);
-	size.setDescriptorCount(32);
-	poolSizes.push_back(size);
+	// Every frame that rendered to the old images, and their presents, have to be done with them.
+	{
+		std::lock_guard<std::mutex> lock(graphicsQueueMutex);
+		presentQueue.waitIdle();
+	}
 	
-	size.setType(vk::DescriptorType::eStorageBufferDynamic);
-	size.setDescriptorCount(32);
-	poolSizes.push_back(size);
+	// Presents of the old swapchain can't be waited for anymore.
+	timePresents(false);
+	pendingPresents.clear();
 	
-	vk::DescriptorPoolCreateInfo info;
-	info.setPPoolSizes(poolSizes.data());
-	info.setPoolSizeCount(static_cast<uint32_t>(poolSizes.size()));
-	info.setMaxSets(32);
+	destroySwapChain();
+	createSwapChain();
 	
-	descriptorPool = logicalDevice.createDescriptorPool(info);
+	swapChainOutOfDate = false;
+	if(swapChain)
+		++swapChainRecreations;
 }
 
-resource_handle_t VulkanRenderer::createShaderModule(const std::string& descriptor)
-{
-	// give source to SPIR-V compiler which outputs a uint32*
-	std::vector<uint32_t> code;
-	return createShaderModuleFromSpirV(code);
+void VulkanRenderer::createCommandPool() { 
+	vk::CommandPoolCreateInfo poolInfo;
+	poolInfo.setQueueFamilyIndex(graphicsQueueIndex);
+	poolInfo.setFlags(vk::CommandPoolCreateFlagBits::eTransient | vk::CommandPoolCreateFlagBits::eResetCommandBuffer);
+	
+	graphicsCommandPool = logicalDevice.createCommandPool(poolInfo);
 }
 
-resource_handle_t VulkanRenderer::createShaderModuleFromSpirV(const std::vector<uint32_t> instructions)
-{
-	vk::ShaderModuleCreateInfo info;
-	info.setCodeSize(instructions.size());
-	info.setPCode(instructions.data());
-	
-	auto module = logicalDevice.createShaderModule(info);
-	if(module)
-		shaderModules.emplace_back(module);
+void VulkanRenderer::createFrameContexts(const DeviceRequirements& reqs) {
+	frames.resize(getFramesInFlight(reqs));
+	
+	for(auto& frame: frames) {
+		vk::CommandPoolCreateInfo poolInfo;
+		poolInfo.setQueueFamilyIndex(graphicsQueueIndex);
+		poolInfo.setFlags(vk::CommandPoolCreateFlagBits::eTransient);
+		frame.commandPool = logicalDevice.createCommandPool(poolInfo);
+		
+		vk::CommandBufferAllocateInfo commandBufferInfo;
+		commandBufferInfo.setLevel(vk::CommandBufferLevel::ePrimary);
+		commandBufferInfo.setCommandPool(frame.commandPool);
+		commandBufferInfo.setCommandBufferCount(1);
+		frame.commandBuffer = logicalDevice.allocateCommandBuffers(commandBufferInfo).front();
+		
+		// The extra pool is for the thread that calls recordParallel, it helps out while waiting.
+		frame.threadCommandPools.resize(jobSystem->getWorkerCount() + 1);
+		for(auto& threadPool: frame.threadCommandPools)
+			threadPool.commandPool = logicalDevice.createCommandPool(poolInfo);
+		
+		frame.imageAvailable = logicalDevice.createSemaphore(vk::SemaphoreCreateInfo());
+		frame.renderFinished = logicalDevice.createSemaphore(vk::SemaphoreCreateInfo());
+		
+		// Created signaled so the first beginFrame on this context doesn't wait.
+		frame.inFlight = logicalDevice.createFence(vk::FenceCreateInfo(vk::FenceCreateFlagBits::eSignaled));
+		
+		frame.descriptorSets = std::make_unique<TransientDescriptorSets>(logicalDevice);
+		
+		vk::CommandPoolCreateInfo computePoolInfo;
+		computePoolInfo.setQueueFamilyIndex(computeQueueIndex);
+		computePoolInfo.setFlags(vk::CommandPoolCreateFlagBits::eTransient);
+		frame.computeCommandPool = logicalDevice.createCommandPool(computePoolInfo);
+	}
 	
-	return shaderModules.size() - 1;
+	vk::SemaphoreTypeCreateInfo typeInfo(vk::SemaphoreType::eTimeline, 0);
+	vk::SemaphoreCreateInfo semaphoreInfo;
+	semaphoreInfo.setPNext(&typeInfo);
+	graphicsTimeline = logicalDevice.createSemaphore(semaphoreInfo);
+	computeTimeline = logicalDevice.createSemaphore(semaphoreInfo);
 }
 
-vk::VertexInputAttributeDescription VulkanRenderer::createAttributeDescription(const VertexAttributeDescriptor &attribute)
-{
-	vk::VertexInputAttributeDescription d;
-	d.setOffset(attribute.offset);
-	d.setLocation(attribute.location);
+vk::CommandBuffer VulkanRenderer::beginFrame() {
+	PROFILE_FUNCTION();
 	
-	switch(attribute.type)
+	auto& frame = frames[currentFrame];
+	
+	// Only blocks when the cpu got framesInFlight frames ahead of the gpu.
 	{
-		case DataType::FLOAT_32:
-		{
-			switch(attribute.numElements)
-			{
-				case 1: d.setFormat(vk::Format::eR32Sfloat); break;
-				case 2: d.setFormat(vk::Format::eR32G32Sfloat); break;
-				case 3: d.setFormat(vk::Format::eR32G32B32Sfloat); break;
-				case 4: d.setFormat(vk::Format::eR32G32B32A32Sfloat); break;
-			}
-		}
-			
-		case DataType::INT_32:
-		{
-			switch(attribute.numElements)
-			{
-				case 1: d.setFormat(vk::Format::eR32Sint); break;
-				case 2: d.setFormat(vk::Format::eR32G32Sint); break;
-				case 3: d.setFormat(vk::Format::eR32G32B32Sint); break;
-				case 4: d.setFormat(vk::Format::eR32G32B32A32Sint); break;
-			}
-		}
-			
-		default: break;
+		PROFILE_SCOPE("waitForFrame");
+		logicalDevice.waitForFences(frame.inFlight, true, std::numeric_limits<uint64_t>::max());
 	}
 	
-	return d;
-}
-
-resource_handle_t VulkanRenderer::createRenderPipeline(const RenderPipelineDescriptor &descriptor)
-{
-	vk::PipelineVertexInputStateCreateInfo vertexInputInfo;
-	std::vector<vk::VertexInputAttributeDescription> vkAttributes;
-	for(const auto& attribute: descriptor.vertexAttributeDescriptors)
-		vkAttributes.emplace_back(createAttributeDescription(attribute));
-
-	vertexInputInfo.setPVertexAttributeDescriptions(vkAttributes.data()).
-	setVertexAttributeDescriptionCount(static_cast<uint32_t>(vkAttributes.size()));
-	
-	vk::PipelineInputAssemblyStateCreateInfo assemblyInfo;
-	if(descriptor.primitiveRestart)
-		assemblyInfo.setPrimitiveRestartEnable(true);
+	// LOW_LATENCY only starts a frame once the one before it was presented, other policies just take note of presents.
+	{
+		PROFILE_SCOPE("waitForPresent");
+		timePresents(presentPolicy == PresentPolicy::LOW_LATENCY);
+	}
 	
-	switch(descriptor.topology)
 	{
-		case PrimitiveTopology::POINTS: assemblyInfo.setTopology(vk::PrimitiveTopology::ePointList); break;
-		case PrimitiveTopology::LINES: assemblyInfo.setTopology(vk::PrimitiveTopology::eLineList); break;
-		case PrimitiveTopology::TRIANGLES: assemblyInfo.setTopology(vk::PrimitiveTopology::eTriangleList); break;
+		PROFILE_SCOPE("pace");
+		framePacer.wait();
 	}
+	framePacer.setInputTime(frameNumber, Profiler::now());
 	
-	vk::DescriptorSetLayoutBinding layoutBinding;
-	layoutBinding.setDescriptorType(vk::DescriptorType::eStorageBuffer);
-	layoutBinding.setBinding(0);
+	frame.swapChainImageAcquired = false;
+	if(surface) {
+		PROFILE_SCOPE("acquireNextImage");
+		frame.swapChainImageAcquired = acquireSwapChainImage(frame);
+	}
 	
-	vk::DescriptorSetLayoutCreateInfo layoutInfo;
-	layoutInfo.setPBindings(&layoutBinding);
-	layoutInfo.setBindingCount(0);
+	// Everything recorded last time this context was used is done, recycle it all at once.
+	logicalDevice.resetCommandPool(frame.commandPool, vk::CommandPoolResetFlags());
+	for(auto& threadPool: frame.threadCommandPools) {
+		logicalDevice.resetCommandPool(threadPool.commandPool, vk::CommandPoolResetFlags());
+		threadPool.used = 0;
+	}
 	
-	auto descriptorSetLayout = logicalDevice.createDescriptorSetLayout(layoutInfo);
+	frame.descriptorSets->reset();
+	
+	// Compute work isn't covered by the fence, unless the frame happened to wait for it.
+	if(frame.usedComputeCommandBuffers) {
+		if(frame.lastComputeValue) {
+			PROFILE_SCOPE("waitForAsyncCompute");
+			vk::SemaphoreWaitInfo waitInfo;
+			waitInfo.setSemaphoreCount(1);
+			waitInfo.setPSemaphores(&computeTimeline);
+			waitInfo.setPValues(&frame.lastComputeValue);
+			logicalDevice.waitSemaphores(waitInfo, std::numeric_limits<uint64_t>::max());
+		}
+		
+		logicalDevice.resetCommandPool(frame.computeCommandPool, vk::CommandPoolResetFlags());
+		frame.usedComputeCommandBuffers = 0;
+		frame.lastComputeValue = 0;
+	}
+	frame.computeWaitValue = 0;
+	frame.computeWaitStages = vk::PipelineStageFlags();
+	
+	// The frame that used this context before is done, and so is everything before it.
+	if(frameNumber >= frames.size()) {
+		if(bindlessTable)
+			bindlessTable->recycle(frameNumber - frames.size());
+		destroyRetiredObjects(frameNumber - frames.size());
+	}
 	
-	vk::PipelineLayoutCreateInfo pipelineLayoutInfo;
-	pipelineLayoutInfo.setPSetLayouts(&descriptorSetLayout);
-	pipelineLayoutInfo.setSetLayoutCount(1);
+	frame.frameNumber = frameNumber;
 	
-	auto pipelineLayout = logicalDevice.createPipelineLayout(pipelineLayoutInfo);
+	vk::CommandBufferBeginInfo beginInfo;
+	beginInfo.setFlags(vk::CommandBufferUsageFlagBits::eOneTimeSubmit);
+	frame.commandBuffer.begin(beginInfo);
 	
-	vk::PipelineViewportStateCreateInfo vpInfo;
+#ifdef RENDERER_PROFILING
+	gpuProfiler->beginFrame(frame.commandBuffer, currentFrame);
+	frameScope = gpuProfiler->beginScope(frame.commandBuffer, "frame");
+#endif
 	
-	std::vector<vk::Viewport> viewports;
-	for(const auto& vp: descriptor.viewPorts)
-		viewports.emplace_back(vp.x, vp.y, vp.width, vp.height, vp.minDepth, vp.maxDepth);
+	// Everything uploaded so far goes out as one batch, and becomes usable in this frame.
+	uploader->flush();
+	frame.uploadWaitValue = uploader->recordAcquireBarriers(frame.commandBuffer);
 	
-	vpInfo.setViewportCount(static_cast<uint32_t>(viewports.size()));
-	vpInfo.setPViewports(viewports.data());
+	bindBindlessTable(frame.commandBuffer);
 	
-	vk::ClearDepthStencilValue clearDepth;
-	clearDepth.setDepth(0);
-	clearDepth.setStencil(0);
+	return frame.commandBuffer;
+}
+
+void VulkanRenderer::endFrame() {
+	PROFILE_FUNCTION();
 	
-	vk::PipelineDepthStencilStateCreateInfo depthInfo;
-	depthInfo.setDepthTestEnable(descriptor.depthStencilState.test);
-	depthInfo.setDepthWriteEnable(descriptor.depthStencilState.write);
+	auto& frame = frames[currentFrame];
 	
-	std::vector<vk::PipelineShaderStageCreateInfo> stages;
-	for(const auto& stage: descriptor.shaderStages)
-	{
-		vk::PipelineShaderStageCreateInfo stageInfo;
-		stageInfo.setModule(shaderModules[stage.module]);
-		stageInfo.setPName(stage.entryPoint.c_str());
-		
-		switch(stage.type)
-		{
-			case ShaderStageDescriptor::Type::VERTEX: stageInfo.setStage(vk::ShaderStageFlagBits::eVertex); break;
-			case ShaderStageDescriptor::Type::FRAGMENT: stageInfo.setStage(vk::ShaderStageFlagBits::eFragment); break;
-			case ShaderStageDescriptor::Type::GEOMETRY: stageInfo.setStage(vk::ShaderStageFlagBits::eGeometry); break;
-			case ShaderStageDescriptor::Type::TESSELATION_EVALUATION: stageInfo.setStage(vk::ShaderStageFlagBits::eTessellationEvaluation); break;
-			case ShaderStageDescriptor::Type::TESSELLATION_CONTROL: stageInfo.setStage(vk::ShaderStageFlagBits::eTessellationControl); break;
-			case ShaderStageDescriptor::Type::COMPUTE: stageInfo.setStage(vk::ShaderStageFlagBits::eCompute); break;
-		}
+#ifdef RENDERER_PROFILING
+	gpuProfiler->endScope(frame.commandBuffer, frameScope);
+	gpuProfiler->endFrame();
+#endif
+	
+	frame.commandBuffer.end();
+	
+	// The timeline semaphore of the uploader, and the swapchain image if there is one. The value
+	// belonging to the binary semaphore is ignored.
+	std::vector<vk::Semaphore> waitSemaphores {uploader->getTimelineSemaphore()};
+	std::vector<vk::PipelineStageFlags> waitStages {GpuUploader::getConsumerStages()};
+	std::vector<uint64_t> waitValues {frame.uploadWaitValue};
+	if(frame.swapChainImageAcquired) {
+		waitSemaphores.emplace_back(frame.imageAvailable);
+		waitStages.emplace_back(vk::PipelineStageFlagBits::eColorAttachmentOutput);
+		waitValues.emplace_back(0);
+	}
+	if(frame.computeWaitValue) {
+		waitSemaphores.emplace_back(computeTimeline);
+		waitStages.emplace_back(frame.computeWaitStages);
+		waitValues.emplace_back(frame.computeWaitValue);
 	}
 	
-	vk::PipelineInputAssemblyStateCreateInfo inputAssemblyInfo;
+	std::vector<vk::Semaphore> signalSemaphores {graphicsTimeline};
+	std::vector<uint64_t> signalValues {getFrameTimelineValue(frame.frameNumber)};
+	if(frame.swapChainImageAcquired) {
+		signalSemaphores.emplace_back(frame.renderFinished);
+		signalValues.emplace_back(0);
+	}
 	
-	vk::GraphicsPipelineCreateInfo pipelineInfo;
-	pipelineInfo.setLayout(pipelineLayout);
-	auto& rp = renderPasses.at(descriptor.renderPass);
-	pipelineInfo.setRenderPass(rp);
-	pipelineInfo.setSubpass(0);
-	pipelineInfo.setPViewportState(&vpInfo);
-	pipelineInfo.setPDepthStencilState(&depthInfo);
-	pipelineInfo.setLayout(pipelineLayout);
-	pipelineInfo.setPVertexInputState(&vertexInputInfo);
-	pipelineInfo.setPInputAssemblyState(&assemblyInfo);
-	pipelineInfo.setPStages(stages.data());
-	pipelineInfo.setStageCount(static_cast<uint32_t>(stages.size()));
+	vk::TimelineSemaphoreSubmitInfo timelineInfo;
+	timelineInfo.setWaitSemaphoreValueCount(static_cast<uint32_t>(waitValues.size()));
+	timelineInfo.setPWaitSemaphoreValues(waitValues.data());
+	timelineInfo.setSignalSemaphoreValueCount(static_cast<uint32_t>(signalValues.size()));
+	timelineInfo.setPSignalSemaphoreValues(signalValues.data());
+	
+	vk::SubmitInfo submitInfo;
+	submitInfo.setPNext(&timelineInfo);
+	submitInfo.setCommandBufferCount(1);
+	submitInfo.setPCommandBuffers(&frame.commandBuffer);
+	submitInfo.setWaitSemaphoreCount(static_cast<uint32_t>(waitSemaphores.size()));
+	submitInfo.setPWaitSemaphores(waitSemaphores.data());
+	submitInfo.setPWaitDstStageMask(waitStages.data());
+	submitInfo.setSignalSemaphoreCount(static_cast<uint32_t>(signalSemaphores.size()));
+	submitInfo.setPSignalSemaphores(signalSemaphores.data());
+	
+	std::lock_guard<std::mutex> queueLock(graphicsQueueMutex);
+	
+	logicalDevice.resetFences(frame.inFlight);
+	graphicsQueue.submit(submitInfo, frame.inFlight);
+	
+	if(frame.swapChainImageAcquired) {
+		vk::PresentInfoKHR presentInfo;
+		presentInfo.setWaitSemaphoreCount(1);
+		presentInfo.setPWaitSemaphores(&frame.renderFinished);
+		presentInfo.setSwapchainCount(1);
+		presentInfo.setPSwapchains(&swapChain);
+		presentInfo.setPImageIndices(&frame.swapChainImageIndex);
+		
+#ifdef VK_KHR_present_wait
+		// Present ids have to be above 0.
+		const uint64_t presentId = frame.frameNumber + 1;
+		vk::PresentIdKHR presentIdInfo(1, &presentId);
+		if(waitForPresent)
+			presentInfo.setPNext(&presentIdInfo);
+#endif
+		
+		// Either way the next beginFrame recreates the swapchain, a suboptimal one still presented this frame.
+		try {
+			if(presentQueue.presentKHR(presentInfo) == vk::Result::eSuboptimalKHR)
+				swapChainOutOfDate = true;
+			pendingPresents.emplace_back(frame.frameNumber);
+		} catch(const vk::OutOfDateKHRError&) {
+			swapChainOutOfDate = true;
+		}
+	}
 	
-	return 0;
+	currentFrame = (currentFrame + 1) % frames.size();
+	frameNumber++;
 }
 
-resource_handle_t VulkanRenderer::createRenderpass(const RenderPassDescriptor& descriptor)
-{
-	std::vector<vk::AttachmentDescription> vkAttachmentDescriptors;
-	std::vector<vk::AttachmentReference> vkAttachmentRefs;
-	uint32_t index = 0;
-	for(const auto& attachment: descriptor.colourAttachments)
-	{
-		vk::AttachmentDescription desc;
-		desc.setInitialLayout(vk::ImageLayout::eUndefined);
-		desc.setFinalLayout(vk::ImageLayout::eColorAttachmentOptimal);
-		desc.setSamples(vk::SampleCountFlagBits::e1);
-		
-		switch(attachment.loadAction)
-		{
-			case LoadAction::LOAD: desc.setLoadOp(vk::AttachmentLoadOp::eLoad);
-			case LoadAction::CLEAR: desc.setLoadOp(vk::AttachmentLoadOp::eClear);
-			default: desc.setLoadOp(vk::AttachmentLoadOp::eDontCare);
+bool VulkanRenderer::acquireSwapChainImage(FrameContext& frame) {
+	// Also keeps trying while the window is minimised and there is no swapchain.
+	if(swapChainOutOfDate || !swapChain)
+		recreateSwapChain();
+	
+	for(uint32_t attempt = 0; swapChain && attempt < 2; ++attempt) {
+		try {
+			const auto result = logicalDevice.acquireNextImageKHR(swapChain, std::numeric_limits<uint64_t>::max(), frame.imageAvailable, nullptr);
+			// Still presentable, the next frame gets a new one.
+			if(result.result == vk::Result::eSuboptimalKHR)
+				swapChainOutOfDate = true;
+			frame.swapChainImageIndex = result.value;
+		} catch(const vk::OutOfDateKHRError&) {
+			recreateSwapChain();
+			continue;
 		}
 		
-		vkAttachmentDescriptors.emplace_back(desc);
+		// The swapchain can hand out images in any order, make sure no older frame is still rendering to this one.
+		auto& imageFence = imagesInFlight[frame.swapChainImageIndex];
+		if(imageFence && imageFence != frame.inFlight)
+			logicalDevice.waitForFences(imageFence, true, std::numeric_limits<uint64_t>::max());
 		
-		vk::AttachmentReference ref;
+		imageFence = frame.inFlight;
+		return true;
+	}
+	
+	return false;
+}
+
+void VulkanRenderer::timePresents(bool wait) {
+	while(!pendingPresents.empty()) {
+		const auto frame = pendingPresents.front();
+		if(!isPresented(frame, wait))
+			return;
+		
+		framePacer.setPresentTime(frame, Profiler::now());
+		pendingPresents.pop_front();
+	}
+}
+
+bool VulkanRenderer::isPresented(uint64_t frame, bool wait) {
+#ifdef VK_KHR_present_wait
+	if(waitForPresent) {
+		// Long enough for any display, short enough not to hang on a window that stopped presenting.
+		const uint64_t timeout = wait ? 100000000 : 0;
+		const auto result = waitForPresent(logicalDevice, swapChain, frame + 1, timeout);
+		if(result == VK_ERROR_OUT_OF_DATE_KHR)
+			swapChainOutOfDate = true;
+		
+		// Asking again won't help after an error, the frame counts as presented so the ones after it are still timed.
+		return result != VK_TIMEOUT;
+	}
+#endif
+	
+	// Without present ids all there is to go on is the frame's rendering.
+	const auto value = getFrameTimelineValue(frame);
+	if(wait) {
+		vk::SemaphoreWaitInfo waitInfo;
+		waitInfo.setSemaphoreCount(1);
+		waitInfo.setPSemaphores(&graphicsTimeline);
+		waitInfo.setPValues(&value);
+		logicalDevice.waitSemaphores(waitInfo, std::numeric_limits<uint64_t>::max());
+		return true;
+	}
+	
+	return logicalDevice.getSemaphoreCounterValue(graphicsTimeline) >= value;
+}
+
+resource_handle_t VulkanRenderer::getSwapChainFramebuffer() const {
+	if(frames.empty())
+		return null_handle;
+	
+	const auto& frame = frames[currentFrame];
+	return frame.swapChainImageAcquired ? swapChainFramebuffers[frame.swapChainImageIndex] : null_handle;
+}
+
+void VulkanRenderer::resizeSwapChain(uint32_t width, uint32_t height) {
+	requestedSwapChainExtent = vk::Extent2D(width, height);
+	swapChainOutOfDate = true;
+}
+
+void VulkanRenderer::setPresentPolicy(PresentPolicy policy) {
+	if(policy == presentPolicy)
+		return;
+	
+	presentPolicy = policy;
+	swapChainOutOfDate = true;
+}
+
+void VulkanRenderer::markInputSampled() {
+	framePacer.setInputTime(frameNumber, Profiler::now());
+}
+
+PresentStatistics VulkanRenderer::getPresentStatistics() const {
+	auto statistics = framePacer.getStatistics();
+#ifdef VK_KHR_present_wait
+	statistics.presentWait = waitForPresent != nullptr;
+#endif
+	statistics.swapChainRecreations = swapChainRecreations;
+	return statistics;
+}
+
+vk::CommandBuffer VulkanRenderer::beginAsyncCompute() {
+	auto& frame = frames[currentFrame];
+	if(frame.usedComputeCommandBuffers == frame.computeCommandBuffers.size()) {
+		vk::CommandBufferAllocateInfo info;
+		info.setLevel(vk::CommandBufferLevel::ePrimary);
+		info.setCommandPool(frame.computeCommandPool);
+		info.setCommandBufferCount(1);
+		frame.computeCommandBuffers.emplace_back(logicalDevice.allocateCommandBuffers(info).front());
+	}
+	
+	auto commandBuffer = frame.computeCommandBuffers[frame.usedComputeCommandBuffers++];
+	commandBuffer.begin(vk::CommandBufferBeginInfo(vk::CommandBufferUsageFlagBits::eOneTimeSubmit));
+	if(bindlessTable)
+		bindlessTable->bind(commandBuffer, !hasAsyncCompute());
+	return commandBuffer;
+}
+
+uint64_t VulkanRenderer::submitAsyncCompute(vk::CommandBuffer commandBuffer, uint64_t graphicsWaitValue) {
+	PROFILE_FUNCTION();
+	
+	auto& frame = frames[currentFrame];
+	commandBuffer.end();
+	
+	std::lock_guard<std::mutex> queueLock(getComputeQueueMutex());
+	
+	const auto value = ++computeTimelineValue;
+	const vk::PipelineStageFlags waitStage = vk::PipelineStageFlagBits::eAllCommands;
+	
+	vk::TimelineSemaphoreSubmitInfo timelineInfo;
+	timelineInfo.setWaitSemaphoreValueCount(graphicsWaitValue ? 1 : 0);
+	timelineInfo.setPWaitSemaphoreValues(&graphicsWaitValue);
+	timelineInfo.setSignalSemaphoreValueCount(1);
+	timelineInfo.setPSignalSemaphoreValues(&value);
+	
+	vk::SubmitInfo submitInfo;
+	submitInfo.setPNext(&timelineInfo);
+	submitInfo.setCommandBufferCount(1);
+	submitInfo.setPCommandBuffers(&commandBuffer);
+	if(graphicsWaitValue) {
+		submitInfo.setWaitSemaphoreCount(1);
+		submitInfo.setPWaitSemaphores(&graphicsTimeline);
+		submitInfo.setPWaitDstStageMask(&waitStage);
+	}
+	submitInfo.setSignalSemaphoreCount(1);
+	submitInfo.setPSignalSemaphores(&computeTimeline);
+	
+	computeQueue.submit(submitInfo, nullptr);
+	frame.lastComputeValue = value;
+	return value;
+}
+
+void VulkanRenderer::waitForAsyncCompute(uint64_t value, vk::PipelineStageFlags stages) {
+	auto& frame = frames[currentFrame];
+	frame.computeWaitValue = std::max(frame.computeWaitValue, value);
+	frame.computeWaitStages |= stages;
+}
+
+namespace {
+	
+	// Ownership transfers don't know what either queue does with the resource, so they make everything
+	// available and visible that a compute or graphics queue can do to a buffer or image outside of attachments.
+	const vk::AccessFlags transferredAccess = vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite | vk::AccessFlagBits::eUniformRead |
+		vk::AccessFlagBits::eTransferRead | vk::AccessFlagBits::eTransferWrite | vk::AccessFlagBits::eIndirectCommandRead;
+	
+	template<typename Barrier>
+	void setOwnershipTransfer(Barrier& barrier, uint32_t graphicsFamily, uint32_t computeFamily, bool toCompute, bool release)
+	{
+		barrier.setSrcQueueFamilyIndex(toCompute ? graphicsFamily : computeFamily);
+		barrier.setDstQueueFamilyIndex(toCompute ? computeFamily : graphicsFamily);
+		barrier.setSrcAccessMask(release ? transferredAccess : vk::AccessFlags());
+		barrier.setDstAccessMask(release ? vk::AccessFlags() : transferredAccess);
+	}
+	
+	vk::PipelineStageFlags getOwnershipSrcStage(bool release) {
+		return release ? vk::PipelineStageFlagBits::eAllCommands : vk::PipelineStageFlagBits::eTopOfPipe;
+	}
+	
+	vk::PipelineStageFlags getOwnershipDstStage(bool release) {
+		return release ? vk::PipelineStageFlagBits::eBottomOfPipe : vk::PipelineStageFlagBits::eAllCommands;
+	}
+}
+
+void VulkanRenderer::transferBufferOwnership(vk::CommandBuffer commandBuffer, resource_handle_t buffer, bool toCompute, bool release) {
+	if(!hasAsyncCompute())
+		return;
+	
+	vk::BufferMemoryBarrier barrier;
+	barrier.setBuffer(buffers.at(buffer).buffer);
+	barrier.setSize(VK_WHOLE_SIZE);
+	setOwnershipTransfer(barrier, graphicsQueueIndex, computeQueueIndex, toCompute, release);
+	commandBuffer.pipelineBarrier(getOwnershipSrcStage(release), getOwnershipDstStage(release), vk::DependencyFlags(), nullptr, barrier, nullptr);
+}
+
+void VulkanRenderer::transferTextureOwnership(vk::CommandBuffer commandBuffer, resource_handle_t texture, vk::ImageLayout layout, bool toCompute, bool release) {
+	if(!hasAsyncCompute())
+		return;
+	
+	const auto& t = textures.at(texture);
+	vk::ImageMemoryBarrier barrier;
+	barrier.setImage(t.image);
+	barrier.setOldLayout(layout);
+	barrier.setNewLayout(layout);
+	barrier.setSubresourceRange(vk::ImageSubresourceRange(getVulkanImageAspect(t.descriptor), 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS));
+	setOwnershipTransfer(barrier, graphicsQueueIndex, computeQueueIndex, toCompute, release);
+	commandBuffer.pipelineBarrier(getOwnershipSrcStage(release), getOwnershipDstStage(release), vk::DependencyFlags(), nullptr, nullptr, barrier);
+}
+
+vk::CommandBuffer VulkanRenderer::acquireSecondaryCommandBuffer(ThreadCommandPool& threadPool) {
+	// Command buffers survive the pool reset, so they're allocated once and reused every frame.
+	if(threadPool.used == threadPool.secondaryCommandBuffers.size()) {
+		vk::CommandBufferAllocateInfo info;
+		info.setLevel(vk::CommandBufferLevel::eSecondary);
+		info.setCommandPool(threadPool.commandPool);
+		info.setCommandBufferCount(1);
+		threadPool.secondaryCommandBuffers.emplace_back(logicalDevice.allocateCommandBuffers(info).front());
+	}
+	
+	return threadPool.secondaryCommandBuffers[threadPool.used++];
+}
+
+void VulkanRenderer::recordParallel(resource_handle_t renderPass, resource_handle_t framebuffer, uint32_t chunkCount,
+									const std::function<void(vk::CommandBuffer, uint32_t)>& record) {
+	PROFILE_FUNCTION();
+	auto& frame = frames[currentFrame];
+	const auto& fb = framebuffers.at(framebuffer);
+	const auto& rp = renderPasses.at(renderPass).renderPass;
+	
+	vk::CommandBufferInheritanceInfo inheritance;
+	inheritance.setRenderPass(rp);
+	inheritance.setSubpass(0);
+	inheritance.setFramebuffer(fb.framebuffer);
+	
+	vk::CommandBufferBeginInfo beginInfo;
+	beginInfo.setFlags(vk::CommandBufferUsageFlagBits::eOneTimeSubmit | vk::CommandBufferUsageFlagBits::eRenderPassContinue);
+	beginInfo.setPInheritanceInfo(&inheritance);
+	
+	// Chunk i always lands in slot i, whichever thread recorded it, so execution order is deterministic.
+	std::vector<vk::CommandBuffer> secondaries(chunkCount);
+	jobSystem->parallelFor(chunkCount, 1, [&](uint32_t begin, uint32_t end) {
+		auto& threadPool = frame.threadCommandPools[jobSystem->getWorkerIndex()];
+		for(auto chunk = begin; chunk < end; ++chunk) {
+			auto commandBuffer = acquireSecondaryCommandBuffer(threadPool);
+			commandBuffer.begin(beginInfo);
+			bindBindlessTable(commandBuffer);
+			record(commandBuffer, chunk);
+			commandBuffer.end();
+			secondaries[chunk] = commandBuffer;
+		}
+	});
+	
+	PROFILE_GPU_SCOPE(gpuProfiler.get(), frame.commandBuffer, "recordParallel");
+	beginRenderPass(frame.commandBuffer, renderPass, framebuffer, vk::SubpassContents::eSecondaryCommandBuffers);
+	if(!secondaries.empty())
+		frame.commandBuffer.executeCommands(secondaries);
+	frame.commandBuffer.endRenderPass();
+}
+
+void VulkanRenderer::beginRenderPass(vk::CommandBuffer commandBuffer, resource_handle_t renderPass, resource_handle_t framebuffer, vk::SubpassContents contents)
+{
+	const auto& fb = framebuffers.at(framebuffer);
+	const auto& descriptor = renderPasses.at(renderPass).descriptor;
+	std::vector<vk::ClearValue> clearValues;
+	for(const auto& attachment: descriptor.colourAttachments) {
+		const auto& c = attachment.clearColour;
+		clearValues.emplace_back(vk::ClearColorValue(std::array<float, 4>{{c.r, c.g, c.b, c.a}}));
+	}
+	
+	if(descriptor.depthAttachment)
+		clearValues.emplace_back(vk::ClearDepthStencilValue(descriptor.depthAttachment->clearDepth, 0));
+	
+	vk::RenderPassBeginInfo passInfo;
+	passInfo.setRenderPass(renderPasses.at(renderPass).renderPass);
+	passInfo.setFramebuffer(fb.framebuffer);
+	passInfo.setRenderArea(vk::Rect2D(vk::Offset2D(0, 0), vk::Extent2D(fb.width, fb.height)));
+	passInfo.setClearValueCount(static_cast<uint32_t>(clearValues.size()));
+	passInfo.setPClearValues(clearValues.data());
+	
+	commandBuffer.beginRenderPass(passInfo, contents);
+}
+
+resource_handle_t VulkanRenderer::createShaderModule(const ShaderSourceDescriptor& descriptor, std::string* errors)
+{
+	auto result = getShaderCompiler().compile(descriptor);
+	if(errors)
+		*errors = result.log;
+	
+	if(!result)
+		return null_handle;
+	
+	return createShaderModuleFromSpirV(result.spirv);
+}
+
+std::vector<resource_handle_t> VulkanRenderer::createShaderModules(const std::vector<ShaderSourceDescriptor>& descriptors, std::string* errors)
+{
+	PROFILE_FUNCTION();
+	
+	const auto results = getShaderCompiler().compile(descriptors, *jobSystem);
+	
+	std::vector<resource_handle_t> modules;
+	for(size_t i = 0; i < results.size(); ++i)
+	{
+		if(errors && !results[i].log.empty())
+			*errors += (descriptors[i].path.empty() ? "shader " + std::to_string(i) : descriptors[i].path) + ":\n" + results[i].log;
+		
+		modules.emplace_back(results[i] ? createShaderModuleFromSpirV(results[i].spirv) : null_handle);
+	}
+	
+	return modules;
+}
+
+resource_handle_t VulkanRenderer::createShaderModuleFromSpirV(const std::vector<uint32_t>& instructions)
+{
+	PROFILE_FUNCTION();
+	
+	ShaderReflection reflection;
+	if(!reflectSpirV(instructions.data(), instructions.size(), reflection))
+		return null_handle;
+	
+	// codeSize is in bytes, even though the code is made of words.
+	vk::ShaderModuleCreateInfo info;
+	info.setCodeSize(instructions.size() * sizeof(uint32_t));
+	info.setPCode(instructions.data());
+	
+	// Failures are thrown, like everywhere else in Vulkan-Hpp.
+	vk::ShaderModule module;
+	try {
+		module = logicalDevice.createShaderModule(info);
+	} catch(const vk::SystemError&) {
+		return null_handle;
+	}
+	
+	return shaderModules.insert(VulkanShaderModule{module, std::move(reflection)});
+}
+
+vk::VertexInputAttributeDescription VulkanRenderer::createAttributeDescription(const VertexAttributeDescriptor &attribute)
+{
+	vk::VertexInputAttributeDescription d;
+	d.setOffset(attribute.offset);
+	d.setLocation(attribute.location);
+	
+	switch(attribute.type)
+	{
+		case DataType::FLOAT_32:
+		{
+			switch(attribute.numElements)
+			{
+				case 1: d.setFormat(vk::Format::eR32Sfloat); break;
+				case 2: d.setFormat(vk::Format::eR32G32Sfloat); break;
+				case 3: d.setFormat(vk::Format::eR32G32B32Sfloat); break;
+				case 4: d.setFormat(vk::Format::eR32G32B32A32Sfloat); break;
+			}
+			break;
+		}
+			
+		case DataType::INT_32:
+		{
+			switch(attribute.numElements)
+			{
+				case 1: d.setFormat(vk::Format::eR32Sint); break;
+				case 2: d.setFormat(vk::Format::eR32G32Sint); break;
+				case 3: d.setFormat(vk::Format::eR32G32B32Sint); break;
+				case 4: d.setFormat(vk::Format::eR32G32B32A32Sint); break;
+			}
+			break;
+		}
+			
+		default: break;
+	}
+	
+	return d;
+}
+
+uint32_t VulkanRenderer::getVertexStride(const std::vector<VertexAttributeDescriptor>& attributes)
+{
+	uint32_t stride = 0;
+	for(const auto& attribute: attributes)
+	{
+		uint32_t elementSize = 4;
+		switch(attribute.type)
+		{
+			case DataType::UNSIGNED_BYTE:
+			case DataType::BYTE: elementSize = 1; break;
+			case DataType::UNSIGNED_INT_16:
+			case DataType::INT_16:
+			case DataType::FLOAT_16: elementSize = 2; break;
+			case DataType::UNSIGNED_INT_64:
+			case DataType::INT_64:
+			case DataType::DOUBLE: elementSize = 8; break;
+			default: break;
+		}
+		
+		stride = std::max(stride, attribute.offset + elementSize * attribute.numElements);
+	}
+	
+	return stride;
+}
+
+resource_handle_t VulkanRenderer::createRenderPipeline(const RenderPipelineDescriptor &descriptor)
+{
+	PROFILE_FUNCTION();
+	
+	// Compute stages can't be part of a graphics pipeline.
+	for(const auto& stage: descriptor.shaderStages)
+		if(stage.type == ShaderStageDescriptor::Type::COMPUTE)
+			return null_handle;
+	
+	// Identical descriptors produce identical pipelines, hand out the one we already have.
+	auto key = getPipelineKey(descriptor);
+	{
+		std::lock_guard<std::mutex> lock(pipelineMutex);
+		auto existing = pipelineLookup.find(key);
+		if(existing != pipelineLookup.end())
+			return existing->second;
+	}
+	
+	vk::PipelineVertexInputStateCreateInfo vertexInputInfo;
+	std::vector<vk::VertexInputAttributeDescription> vkAttributes;
+	for(const auto& attribute: descriptor.vertexAttributeDescriptors)
+		vkAttributes.emplace_back(createAttributeDescription(attribute));
+
+	vk::VertexInputBindingDescription vertexBinding;
+	vertexBinding.setBinding(0);
+	vertexBinding.setStride(getVertexStride(descriptor.vertexAttributeDescriptors));
+	vertexBinding.setInputRate(vk::VertexInputRate::eVertex);
+	
+	vertexInputInfo.setPVertexAttributeDescriptions(vkAttributes.data()).
+	setVertexAttributeDescriptionCount(static_cast<uint32_t>(vkAttributes.size()));
+	if(!vkAttributes.empty())
+		vertexInputInfo.setPVertexBindingDescriptions(&vertexBinding).
+		setVertexBindingDescriptionCount(1);
+	
+	vk::PipelineInputAssemblyStateCreateInfo assemblyInfo;
+	if(descriptor.primitiveRestart)
+		assemblyInfo.setPrimitiveRestartEnable(true);
+	
+	switch(descriptor.topology)
+	{
+		case PrimitiveTopology::POINTS: assemblyInfo.setTopology(vk::PrimitiveTopology::ePointList); break;
+		case PrimitiveTopology::LINES: assemblyInfo.setTopology(vk::PrimitiveTopology::eLineList); break;
+		case PrimitiveTopology::TRIANGLES: assemblyInfo.setTopology(vk::PrimitiveTopology::eTriangleList); break;
+	}
+	
+	VulkanPipeline vulkanPipeline;
+	if(!createPipelineLayout(descriptor.shaderStages, vulkanPipeline))
+		return null_handle;
+	
+	vk::PipelineViewportStateCreateInfo vpInfo;
+	
+	std::vector<vk::Viewport> viewports;
+	std::vector<vk::Rect2D> scissors;
+	for(const auto& vp: descriptor.viewPorts)
+	{
+		viewports.emplace_back(vp.x, vp.y, vp.width, vp.height, vp.minDepth, vp.maxDepth);
+		scissors.emplace_back(vk::Offset2D(static_cast<int32_t>(vp.x), static_cast<int32_t>(vp.y)),
+							  vk::Extent2D(static_cast<uint32_t>(vp.width), static_cast<uint32_t>(vp.height)));
+	}
+	
+	// Without viewports in the descriptor they are set while recording.
+	std::vector<vk::DynamicState> dynamicStates;
+	if(viewports.empty())
+	{
+		dynamicStates = {vk::DynamicState::eViewport, vk::DynamicState::eScissor};
+		vpInfo.setViewportCount(1);
+		vpInfo.setScissorCount(1);
+	}
+	else
+	{
+		vpInfo.setViewportCount(static_cast<uint32_t>(viewports.size()));
+		vpInfo.setPViewports(viewports.data());
+		vpInfo.setScissorCount(static_cast<uint32_t>(scissors.size()));
+		vpInfo.setPScissors(scissors.data());
+	}
+	
+	vk::PipelineDynamicStateCreateInfo dynamicInfo;
+	dynamicInfo.setDynamicStateCount(static_cast<uint32_t>(dynamicStates.size()));
+	dynamicInfo.setPDynamicStates(dynamicStates.data());
+	
+	vk::PipelineDepthStencilStateCreateInfo depthInfo;
+	depthInfo.setDepthTestEnable(descriptor.depthStencilState.test);
+	depthInfo.setDepthWriteEnable(descriptor.depthStencilState.write);
+	depthInfo.setDepthCompareOp(vk::CompareOp::eLessOrEqual);
+	
+	vk::PipelineRasterizationStateCreateInfo rasterizationInfo;
+	rasterizationInfo.setPolygonMode(vk::PolygonMode::eFill);
+	rasterizationInfo.setCullMode(vk::CullModeFlagBits::eBack);
+	rasterizationInfo.setFrontFace(vk::FrontFace::eCounterClockwise);
+	rasterizationInfo.setLineWidth(1.0f);
+	
+	vk::PipelineMultisampleStateCreateInfo multisampleInfo;
+	multisampleInfo.setRasterizationSamples(vk::SampleCountFlagBits::e1);
+	
+	const auto& renderPassDescriptor = renderPasses.at(descriptor.renderPass).descriptor;
+	vk::PipelineColorBlendAttachmentState blendAttachment;
+	blendAttachment.setColorWriteMask(vk::ColorComponentFlagBits::eR | vk::ColorComponentFlagBits::eG | vk::ColorComponentFlagBits::eB | vk::ColorComponentFlagBits::eA);
+	std::vector<vk::PipelineColorBlendAttachmentState> blendAttachments(renderPassDescriptor.colourAttachments.size(), blendAttachment);
+	
+	vk::PipelineColorBlendStateCreateInfo blendInfo;
+	blendInfo.setAttachmentCount(static_cast<uint32_t>(blendAttachments.size()));
+	blendInfo.setPAttachments(blendAttachments.data());
+	
+	std::vector<vk::PipelineShaderStageCreateInfo> stages;
+	for(const auto& stage: descriptor.shaderStages)
+	{
+		vk::PipelineShaderStageCreateInfo stageInfo;
+		stageInfo.setModule(shaderModules.at(stage.module).module);
+		stageInfo.setPName(stage.entryPoint.c_str());
+		stageInfo.setStage(getVulkanShaderStage(stage.type));
+		stages.emplace_back(stageInfo);
+	}
+	
+	vk::GraphicsPipelineCreateInfo pipelineInfo;
+	pipelineInfo.setLayout(vulkanPipeline.layout);
+	auto& rp = renderPasses.at(descriptor.renderPass).renderPass;
+	pipelineInfo.setRenderPass(rp);
+	pipelineInfo.setSubpass(0);
+	pipelineInfo.setPViewportState(&vpInfo);
+	pipelineInfo.setPDepthStencilState(&depthInfo);
+	pipelineInfo.setPRasterizationState(&rasterizationInfo);
+	pipelineInfo.setPMultisampleState(&multisampleInfo);
+	pipelineInfo.setPColorBlendState(&blendInfo);
+	pipelineInfo.setPDynamicState(&dynamicInfo);
+	pipelineInfo.setPVertexInputState(&vertexInputInfo);
+	pipelineInfo.setPInputAssemblyState(&assemblyInfo);
+	pipelineInfo.setPStages(stages.data());
+	pipelineInfo.setStageCount(static_cast<uint32_t>(stages.size()));
+	
+	// The overload taking pointers returns errors rather than throwing them, and unlike the one returning the pipeline
+	// it has had the same signature in every Vulkan-Hpp version. eCompileRequired is a success code without a pipeline.
+	const auto result = logicalDevice.createGraphicsPipelines(pipelineCache->get(), 1, &pipelineInfo, nullptr, &vulkanPipeline.pipeline);
+	if(result != vk::Result::eSuccess || !vulkanPipeline.pipeline)
+	{
+		logicalDevice.destroyPipelineLayout(vulkanPipeline.layout);
+		return null_handle;
+	}
+	
+	return insertPipeline(pipelineLookup, std::move(key), vulkanPipeline);
+}
+
+resource_handle_t VulkanRenderer::createComputePipeline(const ComputePipelineDescriptor& descriptor)
+{
+	PROFILE_FUNCTION();
+	
+	auto key = getPipelineKey(descriptor);
+	{
+		std::lock_guard<std::mutex> lock(pipelineMutex);
+		auto existing = computePipelineLookup.find(key);
+		if(existing != computePipelineLookup.end())
+			return existing->second;
+	}
+	
+	ShaderStageDescriptor stage;
+	stage.type = ShaderStageDescriptor::Type::COMPUTE;
+	stage.module = descriptor.module;
+	stage.entryPoint = descriptor.entryPoint;
+	
+	VulkanPipeline vulkanPipeline;
+	vulkanPipeline.bindPoint = vk::PipelineBindPoint::eCompute;
+	if(!createPipelineLayout({stage}, vulkanPipeline))
+		return null_handle;
+	
+	const auto& module = shaderModules.at(descriptor.module);
+	std::copy(module.reflection.localSize, module.reflection.localSize + 3, vulkanPipeline.workgroupSize);
+	
+	vk::PipelineShaderStageCreateInfo stageInfo;
+	stageInfo.setModule(module.module);
+	stageInfo.setPName(descriptor.entryPoint.c_str());
+	stageInfo.setStage(vk::ShaderStageFlagBits::eCompute);
+	
+	vk::ComputePipelineCreateInfo pipelineInfo;
+	pipelineInfo.setLayout(vulkanPipeline.layout);
+	pipelineInfo.setStage(stageInfo);
+	
+	const auto result = logicalDevice.createComputePipelines(pipelineCache->get(), 1, &pipelineInfo, nullptr, &vulkanPipeline.pipeline);
+	if(result != vk::Result::eSuccess || !vulkanPipeline.pipeline)
+	{
+		logicalDevice.destroyPipelineLayout(vulkanPipeline.layout);
+		return null_handle;
+	}
+	
+	return insertPipeline(computePipelineLookup, std::move(key), vulkanPipeline);
+}
+
+resource_handle_t VulkanRenderer::insertPipeline(std::unordered_map<std::string, resource_handle_t>& lookup, std::string key, VulkanPipeline& pipeline)
+{
+	std::lock_guard<std::mutex> lock(pipelineMutex);
+	
+	// Another thread may have created the same pipeline in the meantime, only one of them is kept.
+	auto existing = lookup.find(key);
+	if(existing != lookup.end()) {
+		logicalDevice.destroyPipeline(pipeline.pipeline);
+		logicalDevice.destroyPipelineLayout(pipeline.layout);
+		return existing->second;
+	}
+	
+	const auto handle = pipelines.insert(std::move(pipeline));
+	lookup.emplace(std::move(key), handle);
+	return handle;
+}
+
+std::vector<resource_handle_t> VulkanRenderer::createRenderPipelines(const std::vector<RenderPipelineDescriptor>& descriptors)
+{
+	PROFILE_FUNCTION();
+	
+	std::vector<resource_handle_t> handles(descriptors.size(), null_handle);
+	jobSystem->parallelFor(static_cast<uint32_t>(descriptors.size()), 1, [&](uint32_t begin, uint32_t end) {
+		for(auto i = begin; i < end; ++i)
+			handles[i] = createRenderPipeline(descriptors[i]);
+	});
+	
+	return handles;
+}
+
+std::vector<resource_handle_t> VulkanRenderer::createComputePipelines(const std::vector<ComputePipelineDescriptor>& descriptors)
+{
+	PROFILE_FUNCTION();
+	
+	std::vector<resource_handle_t> handles(descriptors.size(), null_handle);
+	jobSystem->parallelFor(static_cast<uint32_t>(descriptors.size()), 1, [&](uint32_t begin, uint32_t end) {
+		for(auto i = begin; i < end; ++i)
+			handles[i] = createComputePipeline(descriptors[i]);
+	});
+	
+	return handles;
+}
+
+resource_handle_t VulkanRenderer::createFramebuffer(resource_handle_t renderPass, const std::vector<resource_handle_t>& attachments)
+{
+	PROFILE_FUNCTION();
+	
+	if(attachments.empty())
+		return null_handle;
+	
+	std::vector<vk::ImageView> views;
+	for(const auto& attachment: attachments)
+		views.emplace_back(textures.at(attachment).view);
+	
+	const auto& first = textures.at(attachments.front()).descriptor;
+	
+	VulkanFramebuffer framebuffer;
+	framebuffer.renderPass = renderPass;
+	framebuffer.width = first.width;
+	framebuffer.height = std::max(first.height, 1u);
+	
+	vk::FramebufferCreateInfo info;
+	info.setRenderPass(renderPasses.at(renderPass).renderPass);
+	info.setAttachmentCount(static_cast<uint32_t>(views.size()));
+	info.setPAttachments(views.data());
+	info.setWidth(framebuffer.width);
+	info.setHeight(framebuffer.height);
+	info.setLayers(1);
+	
+	try {
+		framebuffer.framebuffer = logicalDevice.createFramebuffer(info);
+	} catch(const vk::SystemError&) {
+		return null_handle;
+	}
+	return framebuffers.insert(framebuffer);
+}
+
+std::vector<DescriptorBinding> VulkanRenderer::getDescriptorBindings(const std::vector<ResourceBinding>& resources)
+{
+	std::vector<DescriptorBinding> bindings;
+	for(const auto& resource: resources)
+	{
+		DescriptorBinding binding;
+		binding.binding = resource.binding;
+		
+		switch(resource.type)
+		{
+			case BindingType::UNIFORM_BUFFER: binding.type = vk::DescriptorType::eUniformBuffer; break;
+			case BindingType::STORAGE_BUFFER: binding.type = vk::DescriptorType::eStorageBuffer; break;
+			case BindingType::SAMPLED_TEXTURE: binding.type = vk::DescriptorType::eSampledImage; break;
+			case BindingType::STORAGE_TEXTURE: binding.type = vk::DescriptorType::eStorageImage; break;
+		}
+		
+		if(resource.buffer != null_handle)
+		{
+			binding.buffer = buffers.at(resource.buffer).buffer;
+			binding.offset = resource.offset;
+			binding.range = resource.size ? resource.size : VK_WHOLE_SIZE;
+		}
+		else
+		{
+			binding.imageView = textures.at(resource.texture).view;
+			binding.imageLayout = resource.type == BindingType::STORAGE_TEXTURE ? vk::ImageLayout::eGeneral : vk::ImageLayout::eShaderReadOnlyOptimal;
+		}
+		
+		bindings.emplace_back(binding);
+	}
+	
+	return bindings;
+}
+
+vk::DescriptorSet VulkanRenderer::getDescriptorSet(resource_handle_t pipeline, const std::vector<ResourceBinding>& resources, uint32_t set)
+{
+	PROFILE_FUNCTION();
+	
+	return descriptorSetCache->get(pipelines.at(pipeline).setLayouts.at(set), getDescriptorBindings(resources));
+}
+
+vk::DescriptorSet VulkanRenderer::acquireTransientDescriptorSet(resource_handle_t pipeline, const std::vector<ResourceBinding>& resources, uint32_t set)
+{
+	PROFILE_FUNCTION();
+	
+	auto descriptorSet = frames[currentFrame].descriptorSets->acquire(pipelines.at(pipeline).setLayouts.at(set));
+	writeDescriptorSet(logicalDevice, descriptorSet, getDescriptorBindings(resources));
+	return descriptorSet;
+}
+
+void VulkanRenderer::pushConstants(vk::CommandBuffer commandBuffer, resource_handle_t pipeline, const void* data, uint32_t size, uint32_t offset)
+{
+	const auto& p = pipelines.at(pipeline);
+	const auto end = offset + size;
+	
+	// Each byte has to be pushed with exactly the stages of the ranges it lies in, so the data is split at every
+	// range boundary and each piece pushed with the stages of the ranges covering it.
+	std::vector<uint32_t> bounds = {offset, end};
+	for(const auto& range: p.pushConstantRanges) {
+		if(range.offset > offset && range.offset < end)
+			bounds.emplace_back(range.offset);
+		if(range.offset + range.size > offset && range.offset + range.size < end)
+			bounds.emplace_back(range.offset + range.size);
+	}
+	std::sort(bounds.begin(), bounds.end());
+	bounds.erase(std::unique(bounds.begin(), bounds.end()), bounds.end());
+	
+	const auto* bytes = static_cast<const uint8_t*>(data);
+	uint32_t start = offset;
+	vk::ShaderStageFlags stages;
+	for(size_t i = 0; i + 1 < bounds.size(); ++i) {
+		vk::ShaderStageFlags pieceStages;
+		for(const auto& range: p.pushConstantRanges)
+			if(range.offset <= bounds[i] && bounds[i + 1] <= range.offset + range.size)
+				pieceStages |= range.stageFlags;
+		
+		// Neighbouring pieces with the same stages go in one push.
+		if(pieceStages != stages) {
+			if(stages)
+				commandBuffer.pushConstants(p.layout, stages, start, bounds[i] - start, bytes + (start - offset));
+			start = bounds[i];
+			stages = pieceStages;
+		}
+	}
+	
+	if(stages)
+		commandBuffer.pushConstants(p.layout, stages, start, end - start, bytes + (start - offset));
+}
+
+void VulkanRenderer::dispatch(vk::CommandBuffer commandBuffer, resource_handle_t pipeline, uint32_t groupsX, uint32_t groupsY, uint32_t groupsZ)
+{
+	const auto& p = pipelines.at(pipeline);
+	commandBuffer.bindPipeline(vk::PipelineBindPoint::eCompute, p.pipeline);
+	commandBuffer.dispatch(groupsX, groupsY, groupsZ);
+}
+
+void VulkanRenderer::dispatchThreads(vk::CommandBuffer commandBuffer, resource_handle_t pipeline, uint32_t x, uint32_t y, uint32_t z)
+{
+	const auto& size = pipelines.at(pipeline).workgroupSize;
+	dispatch(commandBuffer, pipeline, (x + size[0] - 1) / size[0], (y + size[1] - 1) / size[1], (z + size[2] - 1) / size[2]);
+}
+
+void VulkanRenderer::dispatchIndirect(vk::CommandBuffer commandBuffer, resource_handle_t pipeline, resource_handle_t buffer, vk::DeviceSize offset)
+{
+	commandBuffer.bindPipeline(vk::PipelineBindPoint::eCompute, pipelines.at(pipeline).pipeline);
+	commandBuffer.dispatchIndirect(buffers.at(buffer).buffer, offset);
+}
+
+bool VulkanRenderer::createPipelineLayout(const std::vector<ShaderStageDescriptor>& shaderStages, VulkanPipeline& pipeline)
+{
+	// Runtime sized arrays in the bindless set make it a bindless pipeline.
+	bool bindless = false;
+	for(const auto& stage: shaderStages)
+	{
+		if(!shaderModules.contains(stage.module))
+			return false;
+		
+		for(const auto& binding: shaderModules.at(stage.module).reflection.bindings)
+			bindless |= bindlessTable && binding.set == BindlessTable::set && binding.count == 0;
+	}
+	
+	// The union of the bindings of all stages, per set.
+	std::map<uint32_t, std::map<uint32_t, vk::DescriptorSetLayoutBinding>> sets;
+	for(const auto& stage: shaderStages)
+	{
+		const auto& reflection = shaderModules.at(stage.module).reflection;
+		const auto stageFlag = getVulkanShaderStage(stage.type);
+		
+		if(bindless && reflection.pushConstantOffset + reflection.pushConstantSize > BindlessTable::pushConstantSize)
+			return false;
+		
+		for(const auto& binding: reflection.bindings)
+		{
+			// The table's layout is used as is, the shader just has to agree with it.
+			if(bindless && binding.set == BindlessTable::set)
+			{
+				if(binding.binding > static_cast<uint32_t>(BindlessResourceType::STORAGE_BUFFER) ||
+				   BindlessTable::getDescriptorType(static_cast<BindlessResourceType>(binding.binding)) != getVulkanDescriptorType(binding.type))
+					return false;
+				continue;
+			}
+			
+			auto& layoutBinding = sets[binding.set][binding.binding];
+			if(layoutBinding.stageFlags && layoutBinding.descriptorType != getVulkanDescriptorType(binding.type))
+				return false;
+			
+			layoutBinding.setBinding(binding.binding);
+			layoutBinding.setDescriptorType(getVulkanDescriptorType(binding.type));
+			// Runtime sized arrays get a single descriptor.
+			layoutBinding.setDescriptorCount(std::max(layoutBinding.descriptorCount, std::max(binding.count, 1u)));
+			layoutBinding.stageFlags |= stageFlag;
+		}
+		
+		if(reflection.pushConstantSize && !bindless)
+			pipeline.pushConstantRanges.emplace_back(stageFlag, reflection.pushConstantOffset, reflection.pushConstantSize);
+	}
+	
+	// Bindless pipelines all have the same push constants, otherwise their layouts aren't compatible and
+	// binding a pipeline would invalidate the table.
+	if(bindless)
+		pipeline.pushConstantRanges.emplace_back(BindlessTable::getStages(), 0, BindlessTable::pushConstantSize);
+	
+	// Set numbers the shaders skip still need a (empty) layout.
+	uint32_t setCount = sets.empty() ? 0 : sets.rbegin()->first + 1;
+	if(bindless)
+		setCount = std::max(setCount, BindlessTable::set + 1);
+	
+	// Set layouts are shared and cached, only the pipeline layout belongs to the pipeline.
+	try {
+		for(uint32_t set = 0; set < setCount; ++set)
+		{
+			if(bindless && set == BindlessTable::set)
+			{
+				pipeline.setLayouts.emplace_back(bindlessTable->getSetLayout());
+				continue;
+			}
+			
+			std::vector<vk::DescriptorSetLayoutBinding> bindings;
+			for(const auto& binding: sets[set])
+				bindings.emplace_back(binding.second);
+			
+			pipeline.setLayouts.emplace_back(getDescriptorSetLayout(bindings));
+		}
+		
+		vk::PipelineLayoutCreateInfo info;
+		info.setSetLayoutCount(static_cast<uint32_t>(pipeline.setLayouts.size()));
+		info.setPSetLayouts(pipeline.setLayouts.data());
+		info.setPushConstantRangeCount(static_cast<uint32_t>(pipeline.pushConstantRanges.size()));
+		info.setPPushConstantRanges(pipeline.pushConstantRanges.data());
+		
+		pipeline.layout = logicalDevice.createPipelineLayout(info);
+	} catch(const vk::SystemError&) {
+		return false;
+	}
+	return true;
+}
+
+vk::DescriptorSetLayout VulkanRenderer::getDescriptorSetLayout(const std::vector<vk::DescriptorSetLayoutBinding>& bindings)
+{
+	std::string key;
+	for(const auto& binding: bindings)
+	{
+		const uint32_t fields[] = {binding.binding, static_cast<uint32_t>(binding.descriptorType), binding.descriptorCount,
+			static_cast<uint32_t>(binding.stageFlags)};
+		key.append(reinterpret_cast<const char*>(fields), sizeof(fields));
+	}
+	
+	std::lock_guard<std::mutex> lock(pipelineMutex);
+	auto existing = descriptorSetLayoutLookup.find(key);
+	if(existing != descriptorSetLayoutLookup.end())
+		return existing->second;
+	
+	vk::DescriptorSetLayoutCreateInfo info;
+	info.setBindingCount(static_cast<uint32_t>(bindings.size()));
+	info.setPBindings(bindings.data());
+	
+	auto layout = logicalDevice.createDescriptorSetLayout(info);
+	descriptorSetLayoutLookup.emplace(std::move(key), layout);
+	return layout;
+}
+
+DescriptorStatistics VulkanRenderer::getDescriptorStatistics()
+{
+	auto total = descriptorSetCache->getStatistics();
+	for(auto& frame: frames)
+	{
+		const auto& s = frame.descriptorSets->getStatistics();
+		total.allocateCalls += s.allocateCalls;
+		total.poolsCreated += s.poolsCreated;
+		total.cacheHits += s.cacheHits;
+		total.cacheMisses += s.cacheMisses;
+	}
+	
+	return total;
+}
+
+void VulkanRenderer::createOffscreenTargets(const DeviceRequirements& reqs)
+{
+	if(!reqs.offscreenColourTarget.width)
+		return;
+	
+	RenderPassDescriptor passDescriptor;
+	
+	auto colour = reqs.offscreenColourTarget;
+	colour.usage = TextureUsage::RENDER_TARGET;
+	offscreenColourTarget = createTexture(colour);
+	
+	RenderPassColourAttachmentDescriptor colourAttachment;
+	colourAttachment.loadAction = LoadAction::CLEAR;
+	colourAttachment.clearColour = {0, 0, 0, 1};
+	colourAttachment.texture = offscreenColourTarget;
+	passDescriptor.colourAttachments.emplace_back(colourAttachment);
+	
+	std::vector<resource_handle_t> attachments {offscreenColourTarget};
+	
+	if(reqs.createDepthBuffer)
+	{
+		TextureDescriptor depth;
+		depth.width = colour.width;
+		depth.height = colour.height;
+		depth.layout = ChannelLayout::DEPTH;
+		depth.dataType = DataType::FLOAT_32;
+		depth.usage = TextureUsage::RENDER_TARGET;
+		offscreenDepthTarget = createTexture(depth);
+		
+		RenderPassDepthAttachmentDescriptor depthAttachment;
+		depthAttachment.loadAction = LoadAction::CLEAR;
+		depthAttachment.clearDepth = 1;
+		depthAttachment.texture = offscreenDepthTarget;
+		passDescriptor.depthAttachment = depthAttachment;
+		
+		attachments.emplace_back(offscreenDepthTarget);
+	}
+	
+	offscreenRenderPass = createRenderpass(passDescriptor);
+	offscreenFramebuffer = createFramebuffer(offscreenRenderPass, attachments);
+}
+
+void VulkanRenderer::copyTextureToBuffer(vk::CommandBuffer commandBuffer, resource_handle_t texture, resource_handle_t buffer)
+{
+	const auto& t = textures.at(texture);
+	const auto aspect = isDepthFormat(t.descriptor) ? vk::ImageAspectFlagBits::eDepth : vk::ImageAspectFlagBits::eColor;
+	
+	// Render targets are left in attachment layout by their render pass.
+	const auto attachmentLayout = isDepthFormat(t.descriptor) ? vk::ImageLayout::eDepthStencilAttachmentOptimal : vk::ImageLayout::eColorAttachmentOptimal;
+	const auto attachmentAccess = isDepthFormat(t.descriptor) ? vk::AccessFlagBits::eDepthStencilAttachmentWrite : vk::AccessFlagBits::eColorAttachmentWrite;
+	const auto attachmentStage = isDepthFormat(t.descriptor) ? vk::PipelineStageFlagBits::eLateFragmentTests : vk::PipelineStageFlagBits::eColorAttachmentOutput;
+	
+	vk::ImageMemoryBarrier barrier;
+	barrier.setImage(t.image);
+	barrier.setSrcQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED);
+	barrier.setDstQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED);
+	barrier.setSubresourceRange(vk::ImageSubresourceRange(aspect, 0, 1, 0, 1));
+	barrier.setOldLayout(attachmentLayout);
+	barrier.setNewLayout(vk::ImageLayout::eTransferSrcOptimal);
+	barrier.setSrcAccessMask(attachmentAccess);
+	barrier.setDstAccessMask(vk::AccessFlagBits::eTransferRead);
+	commandBuffer.pipelineBarrier(attachmentStage, vk::PipelineStageFlagBits::eTransfer, vk::DependencyFlags(), nullptr, nullptr, barrier);
+	
+	vk::BufferImageCopy region;
+	region.setImageSubresource(vk::ImageSubresourceLayers(aspect, 0, 0, 1));
+	region.setImageExtent(vk::Extent3D(t.descriptor.width, std::max(t.descriptor.height, 1u), 1));
+	commandBuffer.copyImageToBuffer(t.image, vk::ImageLayout::eTransferSrcOptimal, buffers.at(buffer).buffer, region);
+	
+	barrier.setOldLayout(vk::ImageLayout::eTransferSrcOptimal);
+	barrier.setNewLayout(attachmentLayout);
+	barrier.setSrcAccessMask(vk::AccessFlagBits::eTransferRead);
+	barrier.setDstAccessMask(attachmentAccess);
+	commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, attachmentStage, vk::DependencyFlags(), nullptr, nullptr, barrier);
+	
+	// Make the copy visible to the host once the submission's fence signaled.
+	vk::BufferMemoryBarrier hostBarrier;
+	hostBarrier.setBuffer(buffers.at(buffer).buffer);
+	hostBarrier.setSize(VK_WHOLE_SIZE);
+	hostBarrier.setSrcQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED);
+	hostBarrier.setDstQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED);
+	hostBarrier.setSrcAccessMask(vk::AccessFlagBits::eTransferWrite);
+	hostBarrier.setDstAccessMask(vk::AccessFlagBits::eHostRead);
+	commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eHost, vk::DependencyFlags(), nullptr, hostBarrier, nullptr);
+}
+
+bool VulkanRenderer::readTexture(resource_handle_t texture, void* destination)
+{
+	PROFILE_FUNCTION();
+	
+	const auto& t = textures.at(texture);
+	const auto size = getTextureByteSize(t.descriptor);
+	
+	// The staging buffer is kept and only grows, repeated readbacks of the same target don't allocate.
+	if(readbackBuffer == null_handle || buffers.at(readbackBuffer).descriptor.size < size)
+	{
+		BufferDescriptor descriptor;
+		descriptor.size = size;
+		descriptor.storageMode = StorageMode::READBACK;
+		if(readbackBuffer != null_handle)
+			destroyBuffer(readbackBuffer);
+		readbackBuffer = createBuffer(descriptor);
+		if(readbackBuffer == null_handle)
+			return false;
+	}
+	
+	vk::CommandBufferAllocateInfo info;
+	info.setCommandPool(graphicsCommandPool);
+	info.setLevel(vk::CommandBufferLevel::ePrimary);
+	info.setCommandBufferCount(1);
+	auto commandBuffer = logicalDevice.allocateCommandBuffers(info).front();
+	
+	commandBuffer.begin(vk::CommandBufferBeginInfo(vk::CommandBufferUsageFlagBits::eOneTimeSubmit));
+	copyTextureToBuffer(commandBuffer, texture, readbackBuffer);
+	commandBuffer.end();
+	
+	auto fence = logicalDevice.createFence(vk::FenceCreateInfo());
+	vk::SubmitInfo submitInfo;
+	submitInfo.setCommandBufferCount(1);
+	submitInfo.setPCommandBuffers(&commandBuffer);
+	{
+		std::lock_guard<std::mutex> queueLock(graphicsQueueMutex);
+		graphicsQueue.submit(submitInfo, fence);
+	}
+	logicalDevice.waitForFences(fence, true, std::numeric_limits<uint64_t>::max());
+	
+	logicalDevice.destroyFence(fence);
+	logicalDevice.freeCommandBuffers(graphicsCommandPool, commandBuffer);
+	
+	// Readback memory may be cached but not coherent.
+	const auto& memory = buffers.at(readbackBuffer).memory;
+	logicalDevice.invalidateMappedMemoryRanges(vk::MappedMemoryRange(memory.memory, 0, VK_WHOLE_SIZE));
+	std::memcpy(destination, memory.mapped, size);
+	return true;
+}
+
+bool VulkanRenderer::savePipelineCache()
+{
+	return pipelineCache->save();
+}
+
+resource_handle_t VulkanRenderer::createRenderpass(const RenderPassDescriptor& descriptor)
+{
+	PROFILE_FUNCTION();
+	
+	std::vector<vk::AttachmentDescription> vkAttachmentDescriptors;
+	std::vector<vk::AttachmentReference> vkAttachmentRefs;
+	uint32_t index = 0;
+	for(const auto& attachment: descriptor.colourAttachments)
+	{
+		// Without a texture it is the swapchain's image, which is presented afterwards.
+		const auto layout = attachment.texture != null_handle ? vk::ImageLayout::eColorAttachmentOptimal : vk::ImageLayout::ePresentSrcKHR;
+		vk::AttachmentDescription desc;
+		desc.setFinalLayout(layout);
+		desc.setSamples(vk::SampleCountFlagBits::e1);
+		desc.setLoadOp(getVulkanLoadOp(attachment.loadAction));
+		desc.setStoreOp(getVulkanStoreOp(attachment.storeAction));
+		// Loading needs the previous contents, which an undefined initial layout would discard.
+		desc.setInitialLayout(attachment.loadAction == LoadAction::LOAD ? layout : vk::ImageLayout::eUndefined);
+		if(attachment.texture != null_handle)
+			desc.setFormat(textures.at(attachment.texture).format);
+		else
+			desc.setFormat(swapChainFormat.format);
+		
+		vkAttachmentDescriptors.emplace_back(desc);
+		
+		vk::AttachmentReference ref;
 		ref.setAttachment(index);
 		ref.setLayout(vk::ImageLayout::eColorAttachmentOptimal);
 		vkAttachmentRefs.emplace_back(ref);
@@ -572,39 +2060,448 @@ resource_handle_t VulkanRenderer::createRenderpass(const RenderPassDescriptor& d
 		index++;
 	}
 	
-	vk::SubpassDescription subpass;
-	subpass.setColorAttachmentCount(static_cast<uint32_t>(descriptor.colourAttachments.size()));
-	subpass.setPColorAttachments(vkAttachmentRefs.data());
-	subpass.setPipelineBindPoint(vk::PipelineBindPoint::eGraphics);
-	
+	// Outlives the subpass that points at it.
+	vk::AttachmentReference depthRef;
 	if(descriptor.depthAttachment)
 	{
+		const auto loadAction = descriptor.depthAttachment->loadAction;
 		vk::AttachmentDescription desc;
-		desc.setInitialLayout(vk::ImageLayout::eUndefined);
+		desc.setInitialLayout(loadAction == LoadAction::LOAD ? vk::ImageLayout::eDepthStencilAttachmentOptimal : vk::ImageLayout::eUndefined);
 		desc.setFinalLayout(vk::ImageLayout::eDepthStencilAttachmentOptimal);
-		desc.setLoadOp(vk::AttachmentLoadOp::eClear);
+		desc.setLoadOp(getVulkanLoadOp(loadAction));
+		desc.setStoreOp(getVulkanStoreOp(descriptor.depthAttachment->storeAction));
+		desc.setStencilLoadOp(desc.loadOp);
+		desc.setStencilStoreOp(desc.storeOp);
+		desc.setSamples(vk::SampleCountFlagBits::e1);
+		if(descriptor.depthAttachment->texture != null_handle)
+			desc.setFormat(textures.at(descriptor.depthAttachment->texture).format);
+		else
+			desc.setFormat(vk::Format::eD24UnormS8Uint);
 		
-		vk::AttachmentReference depthRef;
 		depthRef.setLayout(vk::ImageLayout::eDepthStencilAttachmentOptimal);
 		depthRef.setAttachment(index);
 		
-		subpass.setPDepthStencilAttachment(&depthRef);
-		subpass.setPipelineBindPoint(vk::PipelineBindPoint::eGraphics);
-		
 		vkAttachmentDescriptors.emplace_back(desc);
-		vkAttachmentRefs.emplace_back(depthRef);
 	}
 	
+	// Pointed at once every reference is in place, adding to the vector may move it.
+	vk::SubpassDescription subpass;
+	subpass.setPipelineBindPoint(vk::PipelineBindPoint::eGraphics);
+	subpass.setColorAttachmentCount(static_cast<uint32_t>(vkAttachmentRefs.size()));
+	subpass.setPColorAttachments(vkAttachmentRefs.data());
+	if(descriptor.depthAttachment)
+		subpass.setPDepthStencilAttachment(&depthRef);
+	
 	vk::RenderPassCreateInfo info;
 	info.setAttachmentCount(static_cast<uint32_t>(vkAttachmentDescriptors.size()));
 	info.setPAttachments(vkAttachmentDescriptors.data());
 	info.setSubpassCount(1);
 	info.setPSubpasses(&subpass);
 	
-	auto renderpass = logicalDevice.createRenderPass(info);
-	if(!renderpass)
-		return -1;
+	// The frame waits for the swapchain image at colour attachment output, the implicit dependency would start the
+	// layout transition at the top of the pipe before the image was acquired. The swapchain's depth buffer is shared
+	// by every frame in flight, the previous frame's depth writes have to be done before this one clears it.
+	const bool swapChainColour = std::any_of(descriptor.colourAttachments.begin(), descriptor.colourAttachments.end(),
+											 [](const RenderPassColourAttachmentDescriptor& attachment) { return attachment.texture == null_handle; });
+	const bool swapChainDepth = descriptor.depthAttachment && descriptor.depthAttachment->texture == null_handle;
+	vk::SubpassDependency dependency;
+	dependency.setSrcSubpass(VK_SUBPASS_EXTERNAL);
+	dependency.setDstSubpass(0);
+	if(swapChainColour) {
+		dependency.srcStageMask |= vk::PipelineStageFlagBits::eColorAttachmentOutput;
+		dependency.dstStageMask |= vk::PipelineStageFlagBits::eColorAttachmentOutput;
+		dependency.dstAccessMask |= vk::AccessFlagBits::eColorAttachmentRead | vk::AccessFlagBits::eColorAttachmentWrite;
+	}
+	if(swapChainDepth) {
+		dependency.srcStageMask |= vk::PipelineStageFlagBits::eLateFragmentTests;
+		dependency.dstStageMask |= vk::PipelineStageFlagBits::eEarlyFragmentTests | vk::PipelineStageFlagBits::eLateFragmentTests;
+		dependency.srcAccessMask |= vk::AccessFlagBits::eDepthStencilAttachmentWrite;
+		dependency.dstAccessMask |= vk::AccessFlagBits::eDepthStencilAttachmentRead | vk::AccessFlagBits::eDepthStencilAttachmentWrite;
+	}
+	if(swapChainColour || swapChainDepth) {
+		info.setDependencyCount(1);
+		info.setPDependencies(&dependency);
+	}
+	
+	vk::RenderPass renderpass;
+	try {
+		renderpass = logicalDevice.createRenderPass(info);
+	} catch(const vk::SystemError&) {
+		return null_handle;
+	}
+	
+	return renderPasses.insert(VulkanRenderPass{renderpass, descriptor});
+}
+
+vk::ImageCreateInfo VulkanRenderer::getImageCreateInfo(const TextureDescriptor& descriptor)
+{
+	const bool isCube = descriptor.type == TextureType::CUBE;
+	const bool isArray = descriptor.type == TextureType::ARRAY_ONE_DIMENSIONAL || descriptor.type == TextureType::ARRAY_TWO_DIMENSIONAL;
+	const bool is3D = descriptor.type == TextureType::THREE_DIMENSIONAL;
+	const uint32_t layers = isCube ? 6 : isArray ? std::max(descriptor.depth, 1u) : 1;
+	
+	vk::ImageCreateInfo info;
+	info.setImageType(getVulkanImageType(descriptor.type));
+	info.setFormat(getVulkanFormat(descriptor));
+	info.setExtent(vk::Extent3D{descriptor.width, std::max(descriptor.height, 1u), is3D ? std::max(descriptor.depth, 1u) : 1});
+	info.setMipLevels(std::max(descriptor.mipLevels, 1u));
+	info.setArrayLayers(layers);
+	info.setSamples(getVulkanSampleCount(descriptor.samplesPerPixel));
+	info.setTiling(vk::ImageTiling::eOptimal);
+	info.setUsage(getVulkanImageUsage(descriptor));
+	info.setSharingMode(vk::SharingMode::eExclusive);
+	info.setInitialLayout(vk::ImageLayout::eUndefined);
+	if(isCube)
+		info.setFlags(vk::ImageCreateFlagBits::eCubeCompatible);
+	
+	return info;
+}
+
+bool VulkanRenderer::createImageView(VulkanTexture& texture, const vk::ImageCreateInfo& info)
+{
+	vk::ImageSubresourceRange subResource;
+	subResource.setAspectMask(getVulkanImageAspect(texture.descriptor));
+	subResource.setLevelCount(info.mipLevels);
+	subResource.setLayerCount(info.arrayLayers);
+	
+	vk::ImageViewCreateInfo viewInfo;
+	viewInfo.setImage(texture.image);
+	viewInfo.setFormat(texture.format);
+	viewInfo.setViewType(getVulkanImageViewType(texture.descriptor.type));
+	viewInfo.setComponents(vk::ComponentMapping());
+	viewInfo.setSubresourceRange(subResource);
+	
+	try {
+		texture.view = logicalDevice.createImageView(viewInfo);
+	} catch(const vk::SystemError&) {
+		return false;
+	}
+	return true;
+}
+
+resource_handle_t VulkanRenderer::createTexture(const TextureDescriptor& descriptor)
+{
+	PROFILE_FUNCTION();
+	
+	VulkanTexture texture;
+	texture.descriptor = descriptor;
+	texture.format = getVulkanFormat(descriptor);
+	if(texture.format == vk::Format::eUndefined)
+		return null_handle;
+	
+	const auto info = getImageCreateInfo(descriptor);
+	try {
+		texture.image = logicalDevice.createImage(info);
+	} catch(const vk::SystemError&) {
+		return null_handle;
+	}
+	
+	// Render targets are usually large and long lived, give them their own allocation.
+	const auto strategy = descriptor.usage == TextureUsage::RENDER_TARGET ? AllocationStrategy::DEDICATED : AllocationStrategy::DEFAULT;
+	texture.memory = memoryAllocator->allocateForImage(texture.image, MemoryUsage::GPU_ONLY, strategy);
+	if(!texture.memory) {
+		logicalDevice.destroyImage(texture.image);
+		return null_handle;
+	}
+	
+	if(!createImageView(texture, info)) {
+		logicalDevice.destroyImage(texture.image);
+		memoryAllocator->free(texture.memory);
+		return null_handle;
+	}
+	
+	// Everything shaders can sample goes in the table. Uploads and render graphs leave them shader readable.
+	if(bindlessTable)
+	{
+		const auto layout = descriptor.usage == TextureUsage::WRITE ? vk::ImageLayout::eGeneral : vk::ImageLayout::eShaderReadOnlyOptimal;
+		texture.bindlessIndex = bindlessTable->addTexture(texture.view, layout);
+	}
+	
+	return textures.insert(texture);
+}
+
+resource_handle_t VulkanRenderer::createAliasedTexture(const TextureDescriptor& descriptor, const MemoryAllocation& memory, vk::DeviceSize offset)
+{
+	PROFILE_FUNCTION();
+	
+	VulkanTexture texture;
+	texture.descriptor = descriptor;
+	texture.format = getVulkanFormat(descriptor);
+	texture.aliased = true;
+	if(texture.format == vk::Format::eUndefined)
+		return null_handle;
+	
+	const auto info = getImageCreateInfo(descriptor);
+	try {
+		texture.image = logicalDevice.createImage(info);
+	} catch(const vk::SystemError&) {
+		return null_handle;
+	}
+	
+	const auto requirements = logicalDevice.getImageMemoryRequirements(texture.image);
+	if(!(requirements.memoryTypeBits & (1u << memory.memoryType)) || offset % requirements.alignment != 0 || offset + requirements.size > memory.size) {
+		logicalDevice.destroyImage(texture.image);
+		return null_handle;
+	}
+	
+	texture.memory = memory;
+	texture.memory.offset = memory.offset + offset;
+	texture.memory.size = requirements.size;
+	try {
+		logicalDevice.bindImageMemory(texture.image, memory.memory, texture.memory.offset);
+	} catch(const vk::SystemError&) {
+		logicalDevice.destroyImage(texture.image);
+		return null_handle;
+	}
+	
+	if(!createImageView(texture, info)) {
+		logicalDevice.destroyImage(texture.image);
+		return null_handle;
+	}
+	
+	return textures.insert(texture);
+}
+
+void VulkanRenderer::destroyTexture(resource_handle_t texture)
+{
+	if(!textures.contains(texture))
+		return;
+	
+	const auto t = textures.erase(texture);
+	if(bindlessTable && t.bindlessIndex != invalid_bindless_index)
+		bindlessTable->remove(BindlessResourceType::SAMPLED_IMAGE, t.bindlessIndex, frameNumber);
+	
+	retire([this, t] { destroyTextureNow(t); });
+}
+
+void VulkanRenderer::destroyTextureNow(const VulkanTexture& texture)
+{
+	if(descriptorSetCache)
+		descriptorSetCache->release(texture.view);
+	if(uploader)
+		uploader->forget(texture.image);
+	logicalDevice.destroyImageView(texture.view);
+	logicalDevice.destroyImage(texture.image);
+	// Aliased memory belongs to whoever placed the texture.
+	if(!texture.aliased)
+		memoryAllocator->free(texture.memory);
+}
+
+void VulkanRenderer::swapTextures(resource_handle_t a, resource_handle_t b)
+{
+	std::swap(textures.at(a), textures.at(b));
+}
+
+void VulkanRenderer::destroyShaderModule(resource_handle_t module)
+{
+	if(!shaderModules.contains(module))
+		return;
+	
+	const auto shaderModule = shaderModules.erase(module).module;
+	retire([this, shaderModule] { logicalDevice.destroyShaderModule(shaderModule); });
+}
+
+void VulkanRenderer::destroyRenderPass(resource_handle_t renderPass)
+{
+	if(!renderPasses.contains(renderPass))
+		return;
+	
+	const auto rp = renderPasses.erase(renderPass).renderPass;
+	retire([this, rp] { logicalDevice.destroyRenderPass(rp); });
+}
+
+void VulkanRenderer::destroyPipeline(resource_handle_t pipeline)
+{
+	if(!pipelines.contains(pipeline))
+		return;
+	
+	// Identical descriptors have to create a new one from now on.
+	auto& lookup = pipelines.at(pipeline).bindPoint == vk::PipelineBindPoint::eCompute ? computePipelineLookup : pipelineLookup;
+	for(auto it = lookup.begin(); it != lookup.end(); ++it) {
+		if(it->second == pipeline) {
+			lookup.erase(it);
+			break;
+		}
+	}
+	
+	// Set layouts are shared and live as long as the renderer.
+	const auto p = pipelines.erase(pipeline);
+	retire([this, p] {
+		logicalDevice.destroyPipeline(p.pipeline);
+		logicalDevice.destroyPipelineLayout(p.layout);
+	});
+}
+
+void VulkanRenderer::destroyFramebuffer(resource_handle_t framebuffer)
+{
+	if(!framebuffers.contains(framebuffer))
+		return;
+	
+	const auto fb = framebuffers.erase(framebuffer).framebuffer;
+	retire([this, fb] { logicalDevice.destroyFramebuffer(fb); });
+}
+
+void VulkanRenderer::destroyBuffer(resource_handle_t buffer)
+{
+	if(!buffers.contains(buffer))
+		return;
+	
+	const auto b = buffers.erase(buffer);
+	if(bindlessTable && b.bindlessIndex != invalid_bindless_index)
+		bindlessTable->remove(BindlessResourceType::STORAGE_BUFFER, b.bindlessIndex, frameNumber);
+	
+	retire([this, b] { destroyBufferNow(b); });
+}
+
+void VulkanRenderer::destroyBufferNow(const VulkanBuffer& buffer)
+{
+	if(descriptorSetCache)
+		descriptorSetCache->release(buffer.buffer);
+	if(uploader)
+		uploader->forget(buffer.buffer);
+	logicalDevice.destroyBuffer(buffer.buffer);
+	memoryAllocator->free(buffer.memory);
+}
+
+void VulkanRenderer::destroySampler(resource_handle_t sampler)
+{
+	if(!samplers.contains(sampler))
+		return;
+	
+	const auto s = samplers.erase(sampler);
+	if(bindlessTable && s.bindlessIndex != invalid_bindless_index)
+		bindlessTable->remove(BindlessResourceType::SAMPLER, s.bindlessIndex, frameNumber);
+	
+	retire([this, s] {
+		if(descriptorSetCache)
+			descriptorSetCache->release(s.sampler);
+		logicalDevice.destroySampler(s.sampler);
+	});
+}
+
+void VulkanRenderer::freeMemory(const MemoryAllocation& memory)
+{
+	retire([this, memory] { memoryAllocator->free(memory); });
+}
+
+void VulkanRenderer::retire(std::function<void()> destroy)
+{
+	// Uploads queued during this frame go out with the next one, which then is the last to touch the object.
+	retiredObjects.push_back(RetiredObject{frameNumber + 1, std::move(destroy)});
+}
+
+void VulkanRenderer::destroyRetiredObjects(uint64_t completedFrameNumber)
+{
+	// In the order they were destroyed.
+	auto retired = std::stable_partition(retiredObjects.begin(), retiredObjects.end(), [&](const RetiredObject& r) {
+		return r.frameNumber > completedFrameNumber;
+	});
+	
+	for(auto it = retired; it != retiredObjects.end(); ++it)
+		it->destroy();
+	
+	retiredObjects.erase(retired, retiredObjects.end());
+}
+
+vk::MemoryRequirements VulkanRenderer::getTextureMemoryRequirements(const TextureDescriptor& descriptor)
+{
+	// Only happens when a render graph compiles, a throwaway image is cheap enough for that.
+	auto image = logicalDevice.createImage(getImageCreateInfo(descriptor));
+	const auto requirements = logicalDevice.getImageMemoryRequirements(image);
+	logicalDevice.destroyImage(image);
+	return requirements;
+}
+
+bool VulkanRenderer::isTextureFormatSupported(const TextureDescriptor& descriptor) const
+{
+	const auto format = getVulkanFormat(descriptor);
+	if(format == vk::Format::eUndefined)
+		return false;
+	
+	const auto required = vk::FormatFeatureFlagBits::eSampledImage | vk::FormatFeatureFlagBits::eTransferDst | vk::FormatFeatureFlagBits::eTransferSrc;
+	return (physicalDevice.getFormatProperties(format).optimalTilingFeatures & required) == required;
+}
+
+resource_handle_t VulkanRenderer::createBuffer(const BufferDescriptor& descriptor)
+{
+	PROFILE_FUNCTION();
+	
+	VulkanBuffer buffer;
+	buffer.descriptor = descriptor;
+	
+	vk::BufferCreateInfo info;
+	info.setSize(descriptor.size);
+	info.setUsage(getVulkanBufferUsage(descriptor));
+	info.setSharingMode(vk::SharingMode::eExclusive);
+	
+	try {
+		buffer.buffer = logicalDevice.createBuffer(info);
+	} catch(const vk::SystemError&) {
+		return null_handle;
+	}
+	buffer.memory = memoryAllocator->allocateForBuffer(buffer.buffer, getMemoryUsage(descriptor.storageMode));
+	if(!buffer.memory) {
+		logicalDevice.destroyBuffer(buffer.buffer);
+		return null_handle;
+	}
+	
+	if(bindlessTable && descriptor.usage & BufferUsage::STORAGE)
+		buffer.bindlessIndex = bindlessTable->addBuffer(buffer.buffer);
+	
+	return buffers.insert(buffer);
+}
+
+resource_handle_t VulkanRenderer::createSampler(const SamplerResourceDescriptor& descriptor)
+{
+	VulkanSampler sampler;
+	try {
+		sampler.sampler = logicalDevice.createSampler(getVulkanSamplerInfo(descriptor));
+	} catch(const vk::SystemError&) {
+		return null_handle;
+	}
+	if(bindlessTable)
+		sampler.bindlessIndex = bindlessTable->addSampler(sampler.sampler);
+	
+	return samplers.insert(sampler);
+}
+
+void* VulkanRenderer::getBufferContents(resource_handle_t buffer)
+{
+	return buffers.at(buffer).memory.mapped;
+}
+
+UploadToken VulkanRenderer::uploadBuffer(resource_handle_t buffer, const void* data, uint64_t size, uint64_t offset)
+{
+	PROFILE_FUNCTION();
+	
+	const auto& b = buffers.at(buffer);
+	if(offset + size > b.descriptor.size)
+		return UploadToken();
+	
+	// Mapped buffers too, frames still in flight may be reading them.
+	return uploader->uploadBuffer(b.buffer, offset, data, size);
+}
+
+UploadToken VulkanRenderer::uploadTexture(resource_handle_t texture, const void* data, uint64_t size, uint32_t mipLevel, uint32_t layer)
+{
+	PROFILE_FUNCTION();
 	
-	renderPasses.emplace_back(renderpass);
-	return renderPasses.size() - 1;
+	const auto& t = textures.at(texture);
+	return uploader->uploadImage(t.image, getVulkanImageAspect(t.descriptor), getMipExtent(t.descriptor, mipLevel), mipLevel, layer,
+								 getTexelSize(t.descriptor), data, size, getBlockDimension(t.descriptor));
+}
+
+bool VulkanRenderer::isUploadComplete(UploadToken token) const
+{
+	return uploader->isComplete(token);
+}
+
+void VulkanRenderer::waitForUpload(UploadToken token)
+{
+	uploader->wait(token);
+}
+
+MemoryStatistics VulkanRenderer::getMemoryStatistics() const
+{
+	return memoryAllocator->getStatistics();
 }
@@ -9,33 +9,293 @@
 #pragma once
 
 #include <vulkan/vulkan.hpp>
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "descriptor_allocator.hpp"
+#include "device_cache.hpp"
+#include "frame_context.hpp"
+#include "frame_pacer.hpp"
+#include "gpu_profiler.hpp"
+#include "gpu_uploader.hpp"
+#include "job_system.hpp"
+#include "memory_allocator.hpp"
+#include "pipeline_cache.hpp"
 #include "resource_descriptors.hpp"
+#include "shader_compiler.hpp"
+#include "slot_map.hpp"
+#include "vulkan_resources.hpp"
+
+// Where the constructor spent its time, in milliseconds.
+struct StartupTimings
+{
+	double instance = 0;
+	// Enumerating and picking a device, little more than a lookup with a device cache hit.
+	double deviceSelection = 0;
+	double device = 0;
+	// The allocator, uploader, pipeline cache, bindless table, swapchain, frame contexts and profiler, which are
+	// created in parallel on the job system.
+	double objects = 0;
+	double offscreenTargets = 0;
+	double total = 0;
+	bool deviceCacheHit = false;
+	// The pipeline cache was loaded from DeviceRequirements::pipelineCachePath.
+	bool pipelineCacheHit = false;
+};
 
 class VulkanRenderer {
 public:
 	VulkanRenderer(const DeviceRequirements& reqs);
+	// Waits for the gpu and destroys everything that is left, including resources that were never destroyed.
+	~VulkanRenderer();
+	
+	VulkanRenderer(const VulkanRenderer&) = delete;
+	VulkanRenderer& operator=(const VulkanRenderer&) = delete;
 
 private:
 	
+	void createInstance(const DeviceRequirements& reqs);
 	void chooseBestDevice(const std::vector<vk::PhysicalDevice>&, const DeviceRequirements& reqs);
 	void createPlatformSpecificSurface(void* nativeWindowHandle);
-	bool checkSwapChainCompatibilityForDevice(const vk::PhysicalDevice& device, const DeviceRequirements& reqs);
-	void createLogicalDeviceAndPresentQueue(const DeviceRequirements& reqs);
+	bool checkSwapChainCompatibilityForDevice(const vk::PhysicalDevice& device);
+	// Picks the queue families itself unless cached has them.
+	void createLogicalDeviceAndPresentQueue(const DeviceRequirements& reqs, const DeviceCacheEntry* cached);
+	void createObjects(const DeviceRequirements& reqs, bool bindless);
 	void chooseSurfaceFormatForSwapChain();
 	void choosePresentModeForSwapChain();
-	void createSwapChain(const DeviceRequirements&);
+	void createSwapChain();
+	void destroySwapChain();
+	// Waits for the gpu and rebuilds the swapchain for the surface's current size and the present policy.
+	void recreateSwapChain();
+	// Recreates the swapchain if it went out of date on the way. False if there is no image to render to.
+	bool acquireSwapChainImage(FrameContext&);
+	// Reports the frames that were presented since the last call to the frame pacer. With wait, blocks until the last
+	// frame that was handed to the swapchain was presented.
+	void timePresents(bool wait);
+	bool isPresented(uint64_t frame, bool wait);
 	void createCommandPool();
-	void createDescriptorPool();
+	void createFrameContexts(const DeviceRequirements&);
+	void createOffscreenTargets(const DeviceRequirements&);
+	vk::CommandBuffer acquireSecondaryCommandBuffer(ThreadCommandPool&);
+	vk::ImageCreateInfo getImageCreateInfo(const TextureDescriptor&);
+	// False if the view couldn't be created, the image is left to the caller.
+	bool createImageView(VulkanTexture&, const vk::ImageCreateInfo&);
+	// Runs destroy once the gpu finished every frame that may still use what it destroys.
+	void retire(std::function<void()> destroy);
+	void destroyRetiredObjects(uint64_t completedFrameNumber);
+	void destroyTextureNow(const VulkanTexture&);
+	void destroyBufferNow(const VulkanBuffer&);
 	
-	vk::VertexInputAttributeDescription createAttributeDescription(const VertexAttributeDescriptor&);
+	std::vector<DescriptorBinding> getDescriptorBindings(const std::vector<ResourceBinding>&);
+	bool createPipelineLayout(const std::vector<ShaderStageDescriptor>&, VulkanPipeline&);
+	resource_handle_t insertPipeline(std::unordered_map<std::string, resource_handle_t>& lookup, std::string key, VulkanPipeline&);
+	vk::DescriptorSetLayout getDescriptorSetLayout(const std::vector<vk::DescriptorSetLayoutBinding>&);
+	std::mutex& getComputeQueueMutex() { return computeQueue == graphicsQueue ? graphicsQueueMutex : computeQueueMutex; }
 	
 public:
 	
-	resource_handle_t createShaderModule(const std::string& source);
-	resource_handle_t createShaderModuleFromSpirV(const std::vector<uint32_t> instructions);
+	// Compiles GLSL or HLSL, going through the shader cache. Returns null_handle if compilation failed,
+	// errors then holds what the compiler had to say.
+	resource_handle_t createShaderModule(const ShaderSourceDescriptor&, std::string* errors = nullptr);
+	// Compiles all sources in parallel on the job system. Sources that failed get null_handle.
+	std::vector<resource_handle_t> createShaderModules(const std::vector<ShaderSourceDescriptor>&, std::string* errors = nullptr);
+	resource_handle_t createShaderModuleFromSpirV(const std::vector<uint32_t>& instructions);
+	// The bindings and push constants pipeline layouts are built from.
+	const ShaderReflection& getShaderReflection(resource_handle_t module) const { return shaderModules.at(module).reflection; }
+	
+	// The vertex input state createRenderPipeline builds from the descriptor's attributes.
+	vk::VertexInputAttributeDescription createAttributeDescription(const VertexAttributeDescriptor&);
+	uint32_t getVertexStride(const std::vector<VertexAttributeDescriptor>&);
 	
 	resource_handle_t createRenderpass(const RenderPassDescriptor&);
+	// The pipeline layout is generated from the reflected stages. Stages using the same set number have to
+	// agree on its bindings. Compute stages go through createComputePipeline.
 	resource_handle_t createRenderPipeline(const RenderPipelineDescriptor& );
+	resource_handle_t createComputePipeline(const ComputePipelineDescriptor&);
+	// Create the pipelines in parallel on the job system, which hides most of the driver's compile time. Failed
+	// ones get null_handle. Nothing else may be created or destroyed meanwhile.
+	std::vector<resource_handle_t> createRenderPipelines(const std::vector<RenderPipelineDescriptor>&);
+	std::vector<resource_handle_t> createComputePipelines(const std::vector<ComputePipelineDescriptor>&);
+	const VulkanPipeline& getPipeline(resource_handle_t pipeline) const { return pipelines.at(pipeline); }
+	resource_handle_t createFramebuffer(resource_handle_t renderPass, const std::vector<resource_handle_t>& textures);
+	
+	// Handles are generational: once destroyed they are stale, and using them throws std::out_of_range instead of
+	// reaching whatever reuses the slot. The objects themselves live until every frame recorded so far and the
+	// uploads queued for them completed. Pipelines created from a module or with a render pass stay valid without them.
+	void destroyShaderModule(resource_handle_t module);
+	void destroyRenderPass(resource_handle_t renderPass);
+	void destroyPipeline(resource_handle_t pipeline);
+	void destroyFramebuffer(resource_handle_t framebuffer);
+	void destroyBuffer(resource_handle_t buffer);
+	void destroySampler(resource_handle_t sampler);
+	
+	// Like every create function, these return null_handle if the driver fails to create the object.
+	resource_handle_t createTexture(const TextureDescriptor&);
+	resource_handle_t createBuffer(const BufferDescriptor&);
+	resource_handle_t createSampler(const SamplerResourceDescriptor&);
+	
+	// A texture placed at offset in memory the caller owns. Textures sharing memory may only be in use one at a time,
+	// the first use of each has to treat its contents as undefined. Returns null_handle if it doesn't fit.
+	resource_handle_t createAliasedTexture(const TextureDescriptor&, const MemoryAllocation& memory, vk::DeviceSize offset);
+	vk::MemoryRequirements getTextureMemoryRequirements(const TextureDescriptor&);
+	// Gives memory from getMemoryAllocator back once the gpu is done with everything placed in it.
+	void freeMemory(const MemoryAllocation&);
+	// Whether the device can sample and upload to optimally tiled textures of the format, e.g. to pick a block compression.
+	bool isTextureFormatSupported(const TextureDescriptor&) const;
+	const VulkanTexture& getTexture(resource_handle_t texture) const { return textures.at(texture); }
+	
+	void destroyTexture(resource_handle_t texture);
+	// Exchanges the images behind two handles, so a texture can be replaced without its users noticing. Both keep
+	// their bindless indices with their images, those have to be looked up again.
+	void swapTextures(resource_handle_t a, resource_handle_t b);
+	const VulkanBuffer& getBuffer(resource_handle_t buffer) const { return buffers.at(buffer); }
+	
+	// Returns the persistently mapped contents of a SHARED or READBACK buffer. Writes through it are seen by frames
+	// in flight straight away, so they go to ranges no such frame reads, e.g. one per frame in flight.
+	void* getBufferContents(resource_handle_t buffer);
+	
+	// Copies data into a buffer or one mip level of a texture through the staging ring. The copies go out with the
+	// next beginFrame (or earlier when the ring fills up) and are visible to every frame that begins after this call,
+	// frames that began before never see them. Mapped buffers go the same way. Textures end up in eShaderReadOnlyOptimal.
+	UploadToken uploadBuffer(resource_handle_t buffer, const void* data, uint64_t size, uint64_t offset = 0);
+	UploadToken uploadTexture(resource_handle_t texture, const void* data, uint64_t size, uint32_t mipLevel = 0, uint32_t layer = 0);
+	// Never blocks, true once the copies of the token are done and their staging memory is reusable.
+	bool isUploadComplete(UploadToken) const;
+	void waitForUpload(UploadToken);
+	
+	MemoryStatistics getMemoryStatistics() const;
+	
+	// Headless rendering. The offscreen targets are created from DeviceRequirements::offscreenColourTarget.
+	resource_handle_t getOffscreenColourTarget() const { return offscreenColourTarget; }
+	resource_handle_t getOffscreenDepthTarget() const { return offscreenDepthTarget; }
+	resource_handle_t getOffscreenRenderPass() const { return offscreenRenderPass; }
+	resource_handle_t getOffscreenFramebuffer() const { return offscreenFramebuffer; }
+	
+	// Records a copy of a render target into a READBACK buffer. Once the command buffer finished the
+	// texels can be read through getBufferContents without stalling anything else.
+	void copyTextureToBuffer(vk::CommandBuffer, resource_handle_t texture, resource_handle_t buffer);
+	// Blocking convenience around copyTextureToBuffer, copies the texels of a render target into destination.
+	bool readTexture(resource_handle_t texture, void* destination);
+	
+	// Starts recording the next frame and returns its primary command buffer. Only waits when the
+	// gpu is still busy with the frame that last used this frame context.
+	vk::CommandBuffer beginFrame();
+	// Submits the frame and presents it if there is a swapchain.
+	void endFrame();
+	
+	// The render pass of the swapchain, with a depth attachment with DeviceRequirements::createDepthBuffer. It clears
+	// both and leaves the image ready to be presented, and stays the same when the swapchain is recreated.
+	resource_handle_t getSwapChainRenderPass() const { return swapChainRenderPass; }
+	// The framebuffer of the image beginFrame acquired. null_handle when there is none, e.g. while the window is minimised,
+	// the frame must not render to the swapchain then.
+	resource_handle_t getSwapChainFramebuffer() const;
+	vk::Extent2D getSwapChainExtent() const { return swapChainExtent; }
+	
+	// The swapchain is recreated with the next beginFrame. The size only matters on platforms where the surface
+	// takes its size from the swapchain, elsewhere the swapchain follows the surface.
+	void resizeSwapChain(uint32_t width, uint32_t height);
+	// Takes effect with the swapchain the next beginFrame recreates.
+	void setPresentPolicy(PresentPolicy);
+	PresentPolicy getPresentPolicy() const { return presentPolicy; }
+	vk::PresentModeKHR getPresentMode() const { return swapChainPresentMode; }
+	
+	// Frames start at most this often, 0 as soon as possible.
+	void setTargetFrameInterval(double milliseconds) { framePacer.setTargetInterval(milliseconds); }
+	// Marks when the application read the input the current frame shows, where input to present latency starts. Without
+	// it that is when beginFrame returned.
+	void markInputSampled();
+	// Over the last few hundred presented frames.
+	PresentStatistics getPresentStatistics() const;
+	
+	// Begins a render pass over the whole framebuffer with the clear values of the pass's descriptor.
+	void beginRenderPass(vk::CommandBuffer, resource_handle_t renderPass, resource_handle_t framebuffer, vk::SubpassContents = vk::SubpassContents::eInline);
+	
+	// Records chunkCount secondary command buffers on the job system, each inside the given render pass,
+	// and executes them from the frame's primary command buffer in chunk order. Secondary command
+	// buffers don't inherit dynamic state, so record() has to set its own viewport and scissor.
+	void recordParallel(resource_handle_t renderPass, resource_handle_t framebuffer, uint32_t chunkCount,
+						const std::function<void(vk::CommandBuffer, uint32_t chunk)>& record);
+	
+	// A set for the pipeline's layout with the given resources bound. Sets are cached by layout and
+	// resources, so asking for the same combination again doesn't allocate or write anything.
+	vk::DescriptorSet getDescriptorSet(resource_handle_t pipeline, const std::vector<ResourceBinding>&, uint32_t set = 0);
+	// A set that is only valid for the current frame. Recycled once the frame context comes around again.
+	vk::DescriptorSet acquireTransientDescriptorSet(resource_handle_t pipeline, const std::vector<ResourceBinding>&, uint32_t set = 0);
+	
+	// Updates the bytes [offset, offset + size) for every stage of the pipeline that declares them.
+	void pushConstants(vk::CommandBuffer, resource_handle_t pipeline, const void* data, uint32_t size, uint32_t offset = 0);
+	
+	// Binds a compute pipeline and dispatches it. Sets and push constants can be bound before, they only depend on the layout.
+	void dispatch(vk::CommandBuffer, resource_handle_t pipeline, uint32_t groupsX, uint32_t groupsY = 1, uint32_t groupsZ = 1);
+	// Enough workgroups of the size the shader declares to cover x * y * z invocations. Shaders have to skip the ones past the end.
+	void dispatchThreads(vk::CommandBuffer, resource_handle_t pipeline, uint32_t x, uint32_t y = 1, uint32_t z = 1);
+	// Group counts read from a VkDispatchIndirectCommand in buffer.
+	void dispatchIndirect(vk::CommandBuffer, resource_handle_t pipeline, resource_handle_t buffer, vk::DeviceSize offset = 0);
+	
+	// Async compute. On devices with a compute family apart from graphics, work recorded into these command buffers
+	// runs on its own queue and overlaps with the frame's rendering; elsewhere it goes to the graphics queue in
+	// submission order. Both queues have a timeline semaphore: the graphics one reaches getFrameTimelineValue(n)
+	// when frame n finished, the compute one the value submitAsyncCompute returned when that work finished.
+	bool hasAsyncCompute() const { return computeQueueIndex != graphicsQueueIndex; }
+	uint32_t getComputeQueueFamily() const { return computeQueueIndex; }
+	uint32_t getGraphicsQueueFamily() const { return graphicsQueueIndex; }
+	// A command buffer of the current frame, between beginFrame and endFrame. Recycled with the frame context.
+	vk::CommandBuffer beginAsyncCompute();
+	// Submits straight away. The work waits for the graphics timeline to reach graphicsWaitValue first, which has to
+	// belong to a frame that was already submitted; 0 waits for nothing. Returns its value on the compute timeline.
+	uint64_t submitAsyncCompute(vk::CommandBuffer, uint64_t graphicsWaitValue = 0);
+	// The current frame waits at stages until the compute timeline reached value, e.g. before drawing what it culled.
+	void waitForAsyncCompute(uint64_t value, vk::PipelineStageFlags stages);
+	uint64_t getFrameTimelineValue(uint64_t frame) const { return frame + 1; }
+	uint64_t getFrameNumber() const { return frameNumber; }
+	
+	// Half of a queue family ownership transfer between the graphics and compute families, which exclusive resources
+	// need when both queues use them. The release half is recorded on the queue that used the resource last, the
+	// acquire half with the same arguments on the one that uses it next, after it waited for the other's timeline.
+	// Uploads are acquired by the graphics family in the frame that began after them, compute work reading them waits
+	// for that frame. Nothing is recorded without a separate compute family.
+	void transferBufferOwnership(vk::CommandBuffer, resource_handle_t buffer, bool toCompute, bool release);
+	void transferTextureOwnership(vk::CommandBuffer, resource_handle_t texture, vk::ImageLayout, bool toCompute, bool release);
+	
+	// With DeviceRequirements::bindless, pipelines whose shaders declare runtime sized arrays in set 0 use the
+	// BindlessTable for that set. It is bound once in beginFrame, draws only push the indices they need.
+	// Other sets of such pipelines work as usual, set 0 must not be asked for through getDescriptorSet.
+	bool isBindless() const { return bindlessTable != nullptr; }
+	// Indices into the table's arrays, invalid_bindless_index if the resource isn't in the table.
+	uint32_t getBindlessIndex(resource_handle_t texture) const { return textures.at(texture).bindlessIndex; }
+	uint32_t getBufferBindlessIndex(resource_handle_t buffer) const { return buffers.at(buffer).bindlessIndex; }
+	uint32_t getSamplerBindlessIndex(resource_handle_t sampler) const { return samplers.at(sampler).bindlessIndex; }
+	// Secondary command buffers don't inherit bound sets, recordParallel binds it for its chunks.
+	void bindBindlessTable(vk::CommandBuffer commandBuffer) const { if(bindlessTable) bindlessTable->bind(commandBuffer); }
+	
+	DescriptorStatistics getDescriptorStatistics();
+	
+	JobSystem& getJobSystem() { return *jobSystem; }
+	// Created on first use, shaderc takes a while to set up and applications with cached SPIR-V never need it.
+	ShaderCompiler& getShaderCompiler();
+	MemoryAllocator& getMemoryAllocator() { return *memoryAllocator; }
+	
+	// What the device was created with, which is everything it supports.
+	const vk::PhysicalDeviceFeatures& getDeviceFeatures() const { return deviceFeatures; }
+	const vk::PhysicalDeviceVulkan12Features& getDeviceFeatures12() const { return deviceFeatures12; }
+	
+	uint32_t getFramesInFlight() const { return static_cast<uint32_t>(frames.size()); }
+	uint32_t getCurrentFrameIndex() const { return currentFrame; }
+	
+	// Writes the pipeline cache to DeviceRequirements::pipelineCachePath. The destructor saves it as well, this is for
+	// checkpoints in between.
+	bool savePipelineCache();
+	
+	const StartupTimings& getStartupTimings() const { return startupTimings; }
+	
+#ifdef RENDERER_PROFILING
+	// Timestamps of the frame and its render passes. Only exists in profiling builds.
+	GpuProfiler* getGpuProfiler() { return gpuProfiler.get(); }
+#endif
 	
 private:
 	
@@ -46,14 +306,49 @@ private:
 	vk::PhysicalDevice physicalDevice;
 	// The software wrapper around the physical device.
 	vk::Device logicalDevice;
+	vk::PhysicalDeviceFeatures deviceFeatures;
+	vk::PhysicalDeviceVulkan12Features deviceFeatures12;
 	
+	// The queue we submit rendering work to.
+	vk::Queue graphicsQueue;
 	// The queue we use to present images to the screen.
 	vk::Queue presentQueue;
+	// The queue uploads are copied on. Only the same as graphicsQueue if the device has a single queue.
+	vk::Queue transferQueue;
+	// Guards graphicsQueue, which the uploader may submit to from other threads.
+	std::mutex graphicsQueueMutex;
+	// The queue async compute goes to, graphicsQueue without a separate compute family.
+	vk::Queue computeQueue;
+	// Guards computeQueue if the uploader shares it.
+	std::mutex computeQueueMutex;
+	
+	// Signaled with getFrameTimelineValue by every frame, and with the last submitAsyncCompute value by compute work.
+	vk::Semaphore graphicsTimeline;
+	vk::Semaphore computeTimeline;
+	uint64_t computeTimelineValue = 0;
+	
+	// Driver side cache of compiled pipelines, persisted between runs.
+	std::unique_ptr<PipelineCache> pipelineCache;
+	
+	// Maps the key of a RenderPipelineDescriptor to the pipeline that was created for it.
+	std::unordered_map<std::string, resource_handle_t> pipelineLookup;
+	std::unordered_map<std::string, resource_handle_t> computePipelineLookup;
+	
+	// Set layouts by their bindings. Sharing them lets the descriptor set cache hand out the same set
+	// to every pipeline with a compatible layout.
+	std::unordered_map<std::string, vk::DescriptorSetLayout> descriptorSetLayoutLookup;
+	
+	// Guards the lookups above and pipelines while createRenderPipelines or createComputePipelines run.
+	std::mutex pipelineMutex;
 	
-	// The information used to create a pipeline on the gpu that's ready to render.
-	vk::GraphicsPipelineCreateInfo pipelineState;
-	// The pipeline itself
-	vk::Pipeline pipeline;
+	std::unique_ptr<ShaderCompiler> shaderCompiler;
+	std::once_flag shaderCompilerCreated;
+	std::string shaderCachePath;
+	
+	StartupTimings startupTimings;
+	
+	// Only exists with DeviceRequirements::bindless on a device that supports it.
+	std::unique_ptr<BindlessTable> bindlessTable;
 	
 	// If the context is given a native window handle than these are
 	vk::SurfaceKHR surface;
@@ -64,27 +359,91 @@ private:
 	// The swapchain and it's images and imageviews
 	vk::SwapchainKHR swapChain;
 	vk::SurfaceFormatKHR swapChainFormat;
-	vk::PresentModeKHR swapChainPresentMode;
+	vk::PresentModeKHR swapChainPresentMode = vk::PresentModeKHR::eFifo;
+	vk::Extent2D swapChainExtent;
 	std::vector<vk::Image> swapChainImages;
 	std::vector<vk::ImageView> swapChainImageViews;
-	std::vector<vk::Framebuffer> swapChainFrameBuffers;
+	std::vector<resource_handle_t> swapChainFramebuffers;
 	vk::Image depthBuffer;
 	vk::ImageView depthBufferView;
 	
-	vk::RenderPass swapChainRenderPass;
+	// Created with the first swapchain and kept for all that follow, the format doesn't change.
+	resource_handle_t swapChainRenderPass = null_handle;
+	
+	PresentPolicy presentPolicy = PresentPolicy::MAILBOX;
+	bool swapChainDepthBuffer = false;
+	// What resizeSwapChain asked for, for surfaces without a size of their own.
+	vk::Extent2D requestedSwapChainExtent;
+	// Acquire or present found the swapchain out of date, or it has to change. Recreated by the next beginFrame.
+	bool swapChainOutOfDate = false;
+	uint32_t swapChainRecreations = 0;
+	
+	// Frame numbers handed to the swapchain that weren't timed yet. The present id of a frame is its number + 1.
+	std::deque<uint64_t> pendingPresents;
+	FramePacer framePacer;
+#ifdef VK_KHR_present_wait
+	// Only loaded if the device has VK_KHR_present_id and VK_KHR_present_wait.
+	PFN_vkWaitForPresentKHR waitForPresent = nullptr;
+#endif
 	
 	// Memory to back up the depth buffer
-	vk::DeviceMemory depthBufferDeviceMemory;
+	MemoryAllocation depthBufferMemory;
+	
+	// Every image and buffer gets its memory from here.
+	std::unique_ptr<MemoryAllocator> memoryAllocator;
+	
+	// Streams buffer and texture data through a staging ring on the transfer queue. Declared after the
+	// allocator so it is destroyed first.
+	std::unique_ptr<GpuUploader> uploader;
 	
 	uint32_t graphicsQueueIndex = 0;
 	uint32_t presentQueueIndex = 0;
+	uint32_t transferQueueIndex = 0;
+	uint32_t computeQueueIndex = 0;
 	
-	// The commandpool from which we allocate commandbuffers.
+	// The commandpool from which we allocate commandbuffers for one-off work outside of a frame.
 	vk::CommandPool graphicsCommandPool;
-	std::vector<vk::CommandBuffer> commandBuffers;
 	
-	vk::DescriptorPool descriptorPool;
+	// The ring of frames the cpu can record while the gpu is still working on earlier ones.
+	std::vector<FrameContext> frames;
+	uint32_t currentFrame = 0;
+	uint64_t frameNumber = 0;
+	
+	// The fence of the frame that last rendered to each swapchain image.
+	std::vector<vk::Fence> imagesInFlight;
+	
+#ifdef RENDERER_PROFILING
+	std::unique_ptr<GpuProfiler> gpuProfiler;
+	int32_t frameScope = -1;
+#endif
+	
+	// Workers for parallel recording. Each worker records into its own pool of the current frame.
+	std::unique_ptr<JobSystem> jobSystem;
+	
+	resource_handle_t offscreenColourTarget = null_handle;
+	resource_handle_t offscreenDepthTarget = null_handle;
+	resource_handle_t offscreenRenderPass = null_handle;
+	resource_handle_t offscreenFramebuffer = null_handle;
+	resource_handle_t readbackBuffer = null_handle;
+	
+	// Persistent descriptor sets. Transient ones live in the frame contexts.
+	std::unique_ptr<DescriptorSetCache> descriptorSetCache;
+	
+	SlotMap<VulkanShaderModule> shaderModules;
+	SlotMap<VulkanRenderPass> renderPasses;
+	SlotMap<VulkanPipeline> pipelines;
+	SlotMap<VulkanTexture> textures;
+	SlotMap<VulkanBuffer> buffers;
+	SlotMap<VulkanSampler> samplers;
+	SlotMap<VulkanFramebuffer> framebuffers;
+	
+	struct RetiredObject
+	{
+		// The last frame that may use it.
+		uint64_t frameNumber;
+		std::function<void()> destroy;
+	};
 	
-	std::vector<vk::ShaderModule> shaderModules;
-	std::vector<vk::RenderPass> renderPasses;
+	// Destroyed objects the gpu may still be using.
+	std::vector<RetiredObject> retiredObjects;
 };
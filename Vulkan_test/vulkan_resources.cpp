@@ -0,0 +1,421 @@
+//
+//  vulkan_resources.cpp
+//  Vulkan_test
+//
+//  Created by Danny on 17/10/2026.
+//  Copyright © 2026 Danny. All rights reserved.
+//
+
+#include "vulkan_resources.hpp"
+
+#include <algorithm>
+
+namespace {
+
+	vk::Format getCompressedFormat(const TextureDescriptor& descriptor)
+	{
+		const bool srgb = descriptor.srgb;
+		switch(descriptor.compression)
+		{
+			case BlockCompression::BC1:
+				if(descriptor.layout == ChannelLayout::RGBA)
+					return srgb ? vk::Format::eBc1RgbaSrgbBlock : vk::Format::eBc1RgbaUnormBlock;
+				return srgb ? vk::Format::eBc1RgbSrgbBlock : vk::Format::eBc1RgbUnormBlock;
+			case BlockCompression::BC3: return srgb ? vk::Format::eBc3SrgbBlock : vk::Format::eBc3UnormBlock;
+			case BlockCompression::BC4: return vk::Format::eBc4UnormBlock;
+			case BlockCompression::BC5: return vk::Format::eBc5UnormBlock;
+			case BlockCompression::BC7: return srgb ? vk::Format::eBc7SrgbBlock : vk::Format::eBc7UnormBlock;
+			case BlockCompression::ETC2_RGB: return srgb ? vk::Format::eEtc2R8G8B8SrgbBlock : vk::Format::eEtc2R8G8B8UnormBlock;
+			case BlockCompression::ETC2_RGBA: return srgb ? vk::Format::eEtc2R8G8B8A8SrgbBlock : vk::Format::eEtc2R8G8B8A8UnormBlock;
+			case BlockCompression::EAC_R: return vk::Format::eEacR11UnormBlock;
+			case BlockCompression::EAC_RG: return vk::Format::eEacR11G11UnormBlock;
+			case BlockCompression::ASTC_4x4: return srgb ? vk::Format::eAstc4x4SrgbBlock : vk::Format::eAstc4x4UnormBlock;
+			case BlockCompression::NONE: break;
+		}
+		
+		return vk::Format::eUndefined;
+	}
+}
+
+vk::Format getVulkanFormat(const TextureDescriptor& descriptor)
+{
+	if(descriptor.compression != BlockCompression::NONE)
+		return getCompressedFormat(descriptor);
+	
+	switch(descriptor.layout)
+	{
+		case ChannelLayout::DEPTH:
+			return descriptor.dataType == DataType::UNSIGNED_INT_16 ? vk::Format::eD16Unorm : vk::Format::eD32Sfloat;
+		case ChannelLayout::DEPTH_STENCIL:
+			return descriptor.dataType == DataType::FLOAT_32 ? vk::Format::eD32SfloatS8Uint : vk::Format::eD24UnormS8Uint;
+		default: break;
+	}
+
+	switch(descriptor.dataType)
+	{
+		case DataType::UNSIGNED_BYTE:
+		{
+			switch(descriptor.layout)
+			{
+				case ChannelLayout::R: return vk::Format::eR8Unorm;
+				case ChannelLayout::RG: return vk::Format::eR8G8Unorm;
+				case ChannelLayout::RGB: return vk::Format::eR8G8B8Unorm;
+				case ChannelLayout::BGR: return vk::Format::eB8G8R8Unorm;
+				case ChannelLayout::RGBA: return descriptor.srgb ? vk::Format::eR8G8B8A8Srgb : vk::Format::eR8G8B8A8Unorm;
+				case ChannelLayout::BGRA: return descriptor.srgb ? vk::Format::eB8G8R8A8Srgb : vk::Format::eB8G8R8A8Unorm;
+				default: break;
+			}
+			break;
+		}
+
+		case DataType::BYTE:
+		{
+			switch(descriptor.layout)
+			{
+				case ChannelLayout::R: return vk::Format::eR8Snorm;
+				case ChannelLayout::RG: return vk::Format::eR8G8Snorm;
+				case ChannelLayout::RGBA: return vk::Format::eR8G8B8A8Snorm;
+				default: break;
+			}
+			break;
+		}
+
+		case DataType::UNSIGNED_INT_16:
+		{
+			switch(descriptor.layout)
+			{
+				case ChannelLayout::R: return vk::Format::eR16Uint;
+				case ChannelLayout::RG: return vk::Format::eR16G16Uint;
+				case ChannelLayout::RGBA: return vk::Format::eR16G16B16A16Uint;
+				default: break;
+			}
+			break;
+		}
+
+		case DataType::UNSIGNED_INT_32:
+		{
+			switch(descriptor.layout)
+			{
+				case ChannelLayout::R: return vk::Format::eR32Uint;
+				case ChannelLayout::RG: return vk::Format::eR32G32Uint;
+				case ChannelLayout::RGBA: return vk::Format::eR32G32B32A32Uint;
+				default: break;
+			}
+			break;
+		}
+
+		case DataType::INT_32:
+		{
+			switch(descriptor.layout)
+			{
+				case ChannelLayout::R: return vk::Format::eR32Sint;
+				case ChannelLayout::RG: return vk::Format::eR32G32Sint;
+				case ChannelLayout::RGBA: return vk::Format::eR32G32B32A32Sint;
+				default: break;
+			}
+			break;
+		}
+
+		case DataType::FLOAT_16:
+		{
+			switch(descriptor.layout)
+			{
+				case ChannelLayout::R: return vk::Format::eR16Sfloat;
+				case ChannelLayout::RG: return vk::Format::eR16G16Sfloat;
+				case ChannelLayout::RGBA: return vk::Format::eR16G16B16A16Sfloat;
+				default: break;
+			}
+			break;
+		}
+
+		case DataType::FLOAT_32:
+		{
+			switch(descriptor.layout)
+			{
+				case ChannelLayout::R: return vk::Format::eR32Sfloat;
+				case ChannelLayout::RG: return vk::Format::eR32G32Sfloat;
+				case ChannelLayout::RGB: return vk::Format::eR32G32B32Sfloat;
+				case ChannelLayout::RGBA: return vk::Format::eR32G32B32A32Sfloat;
+				default: break;
+			}
+			break;
+		}
+
+		default: break;
+	}
+
+	return vk::Format::eUndefined;
+}
+
+vk::ImageType getVulkanImageType(TextureType type)
+{
+	switch(type)
+	{
+		case TextureType::ONE_DIMENSIONAL:
+		case TextureType::ARRAY_ONE_DIMENSIONAL: return vk::ImageType::e1D;
+		case TextureType::THREE_DIMENSIONAL: return vk::ImageType::e3D;
+		default: return vk::ImageType::e2D;
+	}
+}
+
+vk::ImageViewType getVulkanImageViewType(TextureType type)
+{
+	switch(type)
+	{
+		case TextureType::ONE_DIMENSIONAL: return vk::ImageViewType::e1D;
+		case TextureType::TWO_DIMENSIONAL: return vk::ImageViewType::e2D;
+		case TextureType::THREE_DIMENSIONAL: return vk::ImageViewType::e3D;
+		case TextureType::CUBE: return vk::ImageViewType::eCube;
+		case TextureType::ARRAY_ONE_DIMENSIONAL: return vk::ImageViewType::e1DArray;
+		case TextureType::ARRAY_TWO_DIMENSIONAL: return vk::ImageViewType::e2DArray;
+		case TextureType::MULTI_SAMPLE_TWO_DIMENSIONAL: return vk::ImageViewType::e2D;
+	}
+
+	return vk::ImageViewType::e2D;
+}
+
+bool isDepthFormat(const TextureDescriptor& descriptor)
+{
+	return descriptor.layout == ChannelLayout::DEPTH || descriptor.layout == ChannelLayout::DEPTH_STENCIL;
+}
+
+uint32_t getTexelSize(const TextureDescriptor& descriptor)
+{
+	switch(descriptor.compression)
+	{
+		case BlockCompression::NONE: break;
+		case BlockCompression::BC1:
+		case BlockCompression::BC4:
+		case BlockCompression::ETC2_RGB:
+		case BlockCompression::EAC_R: return 8;
+		default: return 16;
+	}
+	
+	uint32_t channelSize = 1;
+	switch(descriptor.dataType)
+	{
+		case DataType::UNSIGNED_BYTE:
+		case DataType::BYTE: channelSize = 1; break;
+		case DataType::UNSIGNED_INT_16:
+		case DataType::INT_16:
+		case DataType::FLOAT_16: channelSize = 2; break;
+		case DataType::UNSIGNED_INT_32:
+		case DataType::INT_32:
+		case DataType::FLOAT_32: channelSize = 4; break;
+		case DataType::UNSIGNED_INT_64:
+		case DataType::INT_64:
+		case DataType::DOUBLE: channelSize = 8; break;
+	}
+
+	uint32_t channels = 4;
+	switch(descriptor.layout)
+	{
+		case ChannelLayout::R: channels = 1; break;
+		case ChannelLayout::RG: channels = 2; break;
+		case ChannelLayout::RGB:
+		case ChannelLayout::BGR:
+		case ChannelLayout::CO_CG_Y: channels = 3; break;
+		case ChannelLayout::RGBA:
+		case ChannelLayout::BGRA: channels = 4; break;
+		// Copies of the depth aspect are 4 bytes per texel, except for 16 bit depth.
+		case ChannelLayout::DEPTH:
+		case ChannelLayout::DEPTH_STENCIL:
+			channels = 1;
+			channelSize = descriptor.dataType == DataType::UNSIGNED_INT_16 ? 2 : 4;
+			break;
+	}
+
+	return channels * channelSize;
+}
+
+vk::Extent3D getMipExtent(const TextureDescriptor& descriptor, uint32_t mipLevel)
+{
+	const uint32_t width = std::max(descriptor.width >> mipLevel, 1u);
+	const uint32_t height = std::max(std::max(descriptor.height, 1u) >> mipLevel, 1u);
+	const uint32_t depth = descriptor.type == TextureType::THREE_DIMENSIONAL ? std::max(std::max(descriptor.depth, 1u) >> mipLevel, 1u) : 1;
+	return vk::Extent3D(width, height, depth);
+}
+
+uint32_t getBlockDimension(const TextureDescriptor& descriptor)
+{
+	return descriptor.compression == BlockCompression::NONE ? 1 : 4;
+}
+
+uint64_t getTextureByteSize(const TextureDescriptor& descriptor, uint32_t mipLevel)
+{
+	const auto extent = getMipExtent(descriptor, mipLevel);
+	const auto block = getBlockDimension(descriptor);
+	const uint64_t columns = (extent.width + block - 1) / block;
+	const uint64_t rows = (extent.height + block - 1) / block;
+	return columns * rows * extent.depth * getTexelSize(descriptor);
+}
+
+vk::ImageUsageFlags getVulkanImageUsage(const TextureDescriptor& descriptor)
+{
+	vk::ImageUsageFlags usage = vk::ImageUsageFlagBits::eTransferSrc | vk::ImageUsageFlagBits::eTransferDst;
+
+	switch(descriptor.usage)
+	{
+		case TextureUsage::READ:
+			usage |= vk::ImageUsageFlagBits::eSampled;
+			break;
+		case TextureUsage::WRITE:
+			usage |= vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eStorage;
+			break;
+		case TextureUsage::RENDER_TARGET:
+			usage |= vk::ImageUsageFlagBits::eSampled;
+			if(isDepthFormat(descriptor))
+				usage |= vk::ImageUsageFlagBits::eDepthStencilAttachment;
+			else
+				usage |= vk::ImageUsageFlagBits::eColorAttachment;
+			break;
+	}
+
+	return usage;
+}
+
+vk::ImageAspectFlags getVulkanImageAspect(const TextureDescriptor& descriptor)
+{
+	switch(descriptor.layout)
+	{
+		case ChannelLayout::DEPTH: return vk::ImageAspectFlagBits::eDepth;
+		case ChannelLayout::DEPTH_STENCIL: return vk::ImageAspectFlagBits::eDepth | vk::ImageAspectFlagBits::eStencil;
+		default: return vk::ImageAspectFlagBits::eColor;
+	}
+}
+
+vk::SampleCountFlagBits getVulkanSampleCount(uint32_t samplesPerPixel)
+{
+	switch(samplesPerPixel)
+	{
+		case 2: return vk::SampleCountFlagBits::e2;
+		case 4: return vk::SampleCountFlagBits::e4;
+		case 8: return vk::SampleCountFlagBits::e8;
+		case 16: return vk::SampleCountFlagBits::e16;
+		default: return vk::SampleCountFlagBits::e1;
+	}
+}
+
+vk::AttachmentLoadOp getVulkanLoadOp(LoadAction action)
+{
+	switch(action)
+	{
+		case LoadAction::LOAD: return vk::AttachmentLoadOp::eLoad;
+		case LoadAction::CLEAR: return vk::AttachmentLoadOp::eClear;
+		default: return vk::AttachmentLoadOp::eDontCare;
+	}
+}
+
+vk::AttachmentStoreOp getVulkanStoreOp(StoreAction action)
+{
+	switch(action)
+	{
+		case StoreAction::STORE: return vk::AttachmentStoreOp::eStore;
+		default: return vk::AttachmentStoreOp::eDontCare;
+	}
+}
+
+vk::BufferUsageFlags getVulkanBufferUsage(const BufferDescriptor& descriptor)
+{
+	vk::BufferUsageFlags usage = vk::BufferUsageFlagBits::eTransferSrc | vk::BufferUsageFlagBits::eTransferDst;
+
+	if(descriptor.usage & BufferUsage::VERTEX)
+		usage |= vk::BufferUsageFlagBits::eVertexBuffer;
+	if(descriptor.usage & BufferUsage::INDEX)
+		usage |= vk::BufferUsageFlagBits::eIndexBuffer;
+	if(descriptor.usage & BufferUsage::UNIFORM)
+		usage |= vk::BufferUsageFlagBits::eUniformBuffer;
+	if(descriptor.usage & BufferUsage::STORAGE)
+		usage |= vk::BufferUsageFlagBits::eStorageBuffer;
+	if(descriptor.usage & BufferUsage::INDIRECT)
+		usage |= vk::BufferUsageFlagBits::eIndirectBuffer;
+
+	return usage;
+}
+
+MemoryUsage getMemoryUsage(StorageMode mode)
+{
+	switch(mode)
+	{
+		case StorageMode::PRIVATE: return MemoryUsage::GPU_ONLY;
+		case StorageMode::SHARED: return MemoryUsage::CPU_TO_GPU;
+		case StorageMode::READBACK: return MemoryUsage::GPU_TO_CPU;
+	}
+
+	return MemoryUsage::GPU_ONLY;
+}
+
+vk::ShaderStageFlagBits getVulkanShaderStage(ShaderStageDescriptor::Type type)
+{
+	switch(type)
+	{
+		case ShaderStageDescriptor::Type::VERTEX: return vk::ShaderStageFlagBits::eVertex;
+		case ShaderStageDescriptor::Type::FRAGMENT: return vk::ShaderStageFlagBits::eFragment;
+		case ShaderStageDescriptor::Type::GEOMETRY: return vk::ShaderStageFlagBits::eGeometry;
+		case ShaderStageDescriptor::Type::TESSELATION_EVALUATION: return vk::ShaderStageFlagBits::eTessellationEvaluation;
+		case ShaderStageDescriptor::Type::TESSELLATION_CONTROL: return vk::ShaderStageFlagBits::eTessellationControl;
+		case ShaderStageDescriptor::Type::COMPUTE: return vk::ShaderStageFlagBits::eCompute;
+	}
+
+	return vk::ShaderStageFlagBits::eVertex;
+}
+
+vk::SamplerCreateInfo getVulkanSamplerInfo(const SamplerResourceDescriptor& descriptor)
+{
+	auto getAddressMode = [](int32_t wrap) {
+		switch(wrap)
+		{
+			case 33071: return vk::SamplerAddressMode::eClampToEdge;
+			case 33648: return vk::SamplerAddressMode::eMirroredRepeat;
+			default: return vk::SamplerAddressMode::eRepeat;
+		}
+	};
+	
+	vk::SamplerCreateInfo info;
+	info.setMagFilter(descriptor.magFilter == 9728 ? vk::Filter::eNearest : vk::Filter::eLinear);
+	
+	// NEAREST, LINEAR and the four NEAREST/LINEAR_MIPMAP_NEAREST/LINEAR combinations. Undefined filters are linear.
+	switch(descriptor.minFilter)
+	{
+		case 9728:
+		case 9984:
+		case 9986: info.setMinFilter(vk::Filter::eNearest); break;
+		default: info.setMinFilter(vk::Filter::eLinear); break;
+	}
+	
+	switch(descriptor.minFilter)
+	{
+		case 9728:
+		case 9729:
+			// No mipmapping, only ever sample the top level.
+			info.setMipmapMode(vk::SamplerMipmapMode::eNearest);
+			info.setMaxLod(0.25f);
+			break;
+		case 9984:
+		case 9985: info.setMipmapMode(vk::SamplerMipmapMode::eNearest); info.setMaxLod(VK_LOD_CLAMP_NONE); break;
+		default: info.setMipmapMode(vk::SamplerMipmapMode::eLinear); info.setMaxLod(VK_LOD_CLAMP_NONE); break;
+	}
+	
+	info.setAddressModeU(getAddressMode(descriptor.wrapS));
+	info.setAddressModeV(getAddressMode(descriptor.wrapT));
+	info.setAddressModeW(getAddressMode(descriptor.wrapT));
+	return info;
+}
+
+vk::DescriptorType getVulkanDescriptorType(ShaderResourceType type)
+{
+	switch(type)
+	{
+		case ShaderResourceType::SAMPLER: return vk::DescriptorType::eSampler;
+		case ShaderResourceType::COMBINED_IMAGE_SAMPLER: return vk::DescriptorType::eCombinedImageSampler;
+		case ShaderResourceType::SAMPLED_IMAGE: return vk::DescriptorType::eSampledImage;
+		case ShaderResourceType::STORAGE_IMAGE: return vk::DescriptorType::eStorageImage;
+		case ShaderResourceType::UNIFORM_TEXEL_BUFFER: return vk::DescriptorType::eUniformTexelBuffer;
+		case ShaderResourceType::STORAGE_TEXEL_BUFFER: return vk::DescriptorType::eStorageTexelBuffer;
+		case ShaderResourceType::UNIFORM_BUFFER: return vk::DescriptorType::eUniformBuffer;
+		case ShaderResourceType::STORAGE_BUFFER: return vk::DescriptorType::eStorageBuffer;
+		case ShaderResourceType::INPUT_ATTACHMENT: return vk::DescriptorType::eInputAttachment;
+	}
+
+	return vk::DescriptorType::eUniformBuffer;
+}
@@ -0,0 +1,101 @@
+//
+//  vulkan_resources.hpp
+//  Vulkan_test
+//
+//  Created by Danny on 17/10/2026.
+//  Copyright © 2026 Danny. All rights reserved.
+//
+
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+
+#include "bindless_table.hpp"
+#include "memory_allocator.hpp"
+#include "resource_descriptors.hpp"
+#include "spirv_reflection.hpp"
+
+struct VulkanTexture
+{
+	vk::Image image;
+	vk::ImageView view;
+	vk::Format format = vk::Format::eUndefined;
+	MemoryAllocation memory;
+	TextureDescriptor descriptor;
+	// Placed in memory owned by someone else, like the transient heap of a render graph.
+	bool aliased = false;
+	uint32_t bindlessIndex = invalid_bindless_index;
+};
+
+struct VulkanBuffer
+{
+	vk::Buffer buffer;
+	MemoryAllocation memory;
+	BufferDescriptor descriptor;
+	uint32_t bindlessIndex = invalid_bindless_index;
+};
+
+struct VulkanSampler
+{
+	vk::Sampler sampler;
+	uint32_t bindlessIndex = invalid_bindless_index;
+};
+
+struct VulkanFramebuffer
+{
+	vk::Framebuffer framebuffer;
+	resource_handle_t renderPass = null_handle;
+	uint32_t width = 0;
+	uint32_t height = 0;
+};
+
+struct VulkanShaderModule
+{
+	vk::ShaderModule module;
+	ShaderReflection reflection;
+};
+
+struct VulkanRenderPass
+{
+	vk::RenderPass renderPass;
+	RenderPassDescriptor descriptor;
+};
+
+struct VulkanPipeline
+{
+	vk::Pipeline pipeline;
+	vk::PipelineLayout layout;
+	vk::PipelineBindPoint bindPoint = vk::PipelineBindPoint::eGraphics;
+	// Indexed by set number. Layouts are shared between pipelines with the same bindings.
+	std::vector<vk::DescriptorSetLayout> setLayouts;
+	std::vector<vk::PushConstantRange> pushConstantRanges;
+	// Of compute pipelines, as the shader declares it.
+	uint32_t workgroupSize[3] = {1, 1, 1};
+};
+
+// Translation from the api agnostic descriptors to Vulkan.
+vk::Format getVulkanFormat(const TextureDescriptor&);
+vk::ImageType getVulkanImageType(TextureType);
+vk::ImageViewType getVulkanImageViewType(TextureType);
+vk::ImageUsageFlags getVulkanImageUsage(const TextureDescriptor&);
+vk::ImageAspectFlags getVulkanImageAspect(const TextureDescriptor&);
+vk::SampleCountFlagBits getVulkanSampleCount(uint32_t samplesPerPixel);
+vk::AttachmentLoadOp getVulkanLoadOp(LoadAction);
+vk::AttachmentStoreOp getVulkanStoreOp(StoreAction);
+vk::BufferUsageFlags getVulkanBufferUsage(const BufferDescriptor&);
+MemoryUsage getMemoryUsage(StorageMode);
+vk::ShaderStageFlagBits getVulkanShaderStage(ShaderStageDescriptor::Type);
+vk::DescriptorType getVulkanDescriptorType(ShaderResourceType);
+// Samplers are described with the GL enums glTF uses.
+vk::SamplerCreateInfo getVulkanSamplerInfo(const SamplerResourceDescriptor&);
+
+bool isDepthFormat(const TextureDescriptor&);
+
+// Bytes per texel as laid out in a buffer, or per block of a block compressed format.
+uint32_t getTexelSize(const TextureDescriptor&);
+// Width and height of a block in texels, 1 for uncompressed formats.
+uint32_t getBlockDimension(const TextureDescriptor&);
+vk::Extent3D getMipExtent(const TextureDescriptor&, uint32_t mipLevel);
+
+// Bytes of one mip level, as laid out tightly packed in a buffer.
+uint64_t getTextureByteSize(const TextureDescriptor&, uint32_t mipLevel = 0);
@@ -0,0 +1,346 @@
+//
+//  renderer_benchmarks.cpp
+//  benchmarks
+//
+//  Created by Danny on 17/10/2026.
+//  Copyright © 2026 Danny. All rights reserved.
+//
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "draw_queue.hpp"
+#include "vulkan_renderer.hpp"
+
+// The renderer's hot paths on whatever device the loader hands out, e.g. lavapipe on a machine without a gpu.
+// Benchmarks that need a device are skipped with an error if there is none.
+namespace {
+
+	const char* vertexShader = R"(
+		#version 450
+		layout(location = 0) in vec3 position;
+		layout(push_constant) uniform Push { vec4 tint; } push;
+		layout(location = 0) out vec4 colour;
+		void main() {
+			colour = push.tint;
+			gl_Position = vec4(position, 1.0);
+		}
+	)";
+
+	const char* fragmentShader = R"(
+		#version 450
+		layout(location = 0) in vec4 colour;
+		layout(location = 0) out vec4 result;
+		void main() {
+			result = colour * float(VARIANT + 1);
+		}
+	)";
+
+	const uint32_t pipelineCount = 8;
+
+	// Created once and shared by every benchmark, creating a renderer takes far longer than most of them run.
+	// The targets are tiny so the device spends next to no time on the draws that are recorded.
+	struct Fixture
+	{
+		std::unique_ptr<VulkanRenderer> renderer;
+		std::vector<RenderPipelineDescriptor> pipelineDescriptors;
+		std::vector<resource_handle_t> pipelines;
+		resource_handle_t vertexBuffer = null_handle;
+		resource_handle_t indexBuffer = null_handle;
+		std::string error;
+	};
+
+	Fixture* createFixture(uint32_t workerThreads) {
+		auto fixture = new Fixture();
+
+		DeviceRequirements requirements;
+		requirements.graphicsQueueSupport = true;
+		requirements.headless = true;
+		requirements.createDepthBuffer = true;
+		requirements.offscreenColourTarget.width = 64;
+		requirements.offscreenColourTarget.height = 64;
+		requirements.validation = false;
+		requirements.workerThreads = workerThreads;
+		fixture->renderer.reset(new VulkanRenderer(requirements));
+
+		auto& renderer = *fixture->renderer;
+		if(renderer.getOffscreenRenderPass() == null_handle) {
+			fixture->error = "no device";
+			return fixture;
+		}
+
+		// Variants of the fragment shader make pipelines that only differ in their modules.
+		ShaderSourceDescriptor vertexSource;
+		vertexSource.source = vertexShader;
+		vertexSource.path = "benchmark.vert";
+		std::vector<ShaderSourceDescriptor> sources {vertexSource};
+		for(uint32_t i = 0; i < pipelineCount; ++i) {
+			ShaderSourceDescriptor fragmentSource;
+			fragmentSource.source = fragmentShader;
+			fragmentSource.path = "benchmark.frag";
+			fragmentSource.stage = ShaderStageDescriptor::Type::FRAGMENT;
+			fragmentSource.defines["VARIANT"] = std::to_string(i);
+			sources.emplace_back(fragmentSource);
+		}
+
+		const auto modules = renderer.createShaderModules(sources, &fixture->error);
+		if(std::find(modules.begin(), modules.end(), null_handle) != modules.end()) {
+			fixture->error = "failed to compile the shaders: " + fixture->error;
+			return fixture;
+		}
+
+		fixture->pipelineDescriptors.resize(pipelineCount);
+		for(uint32_t i = 0; i < pipelineCount; ++i) {
+			auto& descriptor = fixture->pipelineDescriptors[i];
+			descriptor.renderPass = renderer.getOffscreenRenderPass();
+			descriptor.topology = PrimitiveTopology::TRIANGLES;
+			descriptor.shaderStages = {{"main", ShaderStageDescriptor::Type::VERTEX, modules[0]}, {"main", ShaderStageDescriptor::Type::FRAGMENT, modules[i + 1]}};
+			descriptor.depthStencilState.test = 1;
+			descriptor.depthStencilState.write = 1;
+
+			VertexAttributeDescriptor position;
+			position.type = DataType::FLOAT_32;
+			position.numElements = 3;
+			descriptor.vertexAttributeDescriptors = {position};
+		}
+
+		fixture->pipelines = renderer.createRenderPipelines(fixture->pipelineDescriptors);
+		if(std::find(fixture->pipelines.begin(), fixture->pipelines.end(), null_handle) != fixture->pipelines.end()) {
+			fixture->error = "failed to create the pipelines";
+			return fixture;
+		}
+
+		// Zeroed vertices make every triangle degenerate, so drawing them costs the device almost nothing.
+		std::vector<uint8_t> zeros(1 << 16);
+		BufferDescriptor vertexDescriptor;
+		vertexDescriptor.size = zeros.size();
+		vertexDescriptor.usage = BufferUsage::VERTEX;
+		fixture->vertexBuffer = renderer.createBuffer(vertexDescriptor);
+		renderer.waitForUpload(renderer.uploadBuffer(fixture->vertexBuffer, zeros.data(), zeros.size()));
+
+		BufferDescriptor indexDescriptor;
+		indexDescriptor.size = zeros.size();
+		indexDescriptor.usage = BufferUsage::INDEX;
+		fixture->indexBuffer = renderer.createBuffer(indexDescriptor);
+		renderer.waitForUpload(renderer.uploadBuffer(fixture->indexBuffer, zeros.data(), zeros.size()));
+
+		return fixture;
+	}
+
+	// Null with the reason in state if there is no device to run on. 0 worker threads uses one per hardware thread,
+	// every other count gets a renderer of its own.
+	VulkanRenderer* getRenderer(benchmark::State& state, Fixture** result = nullptr, uint32_t workerThreads = 0) {
+		// Never destroyed, the benchmark library doesn't say when the last benchmark ran.
+		static std::map<uint32_t, Fixture*> fixtures;
+		auto& fixture = fixtures[workerThreads];
+		if(!fixture)
+			fixture = createFixture(workerThreads);
+		if(!fixture->error.empty()) {
+			state.SkipWithError(fixture->error.c_str());
+			return nullptr;
+		}
+
+		if(result)
+			*result = fixture;
+		return fixture->renderer.get();
+	}
+
+	// Destroyed objects and uploads are only dealt with once a frame began, run an empty one now and then.
+	void runEmptyFrame(benchmark::State& state, VulkanRenderer& renderer) {
+		state.PauseTiming();
+		renderer.beginFrame();
+		renderer.endFrame();
+		state.ResumeTiming();
+	}
+
+	void BM_CreateAttributeDescription(benchmark::State& state) {
+		auto* renderer = getRenderer(state);
+		if(!renderer)
+			return;
+
+		std::vector<VertexAttributeDescriptor> attributes;
+		for(auto type: {DataType::FLOAT_32, DataType::INT_32}) {
+			for(uint8_t elements = 1; elements <= 4; ++elements) {
+				VertexAttributeDescriptor attribute;
+				attribute.type = type;
+				attribute.numElements = elements;
+				attribute.offset = static_cast<uint32_t>(attributes.size()) * 16;
+				attribute.location = static_cast<uint32_t>(attributes.size());
+				attributes.emplace_back(attribute);
+			}
+		}
+
+		for(auto _: state) {
+			for(const auto& attribute: attributes)
+				benchmark::DoNotOptimize(renderer->createAttributeDescription(attribute));
+			benchmark::DoNotOptimize(renderer->getVertexStride(attributes));
+		}
+		state.SetItemsProcessed(state.iterations() * attributes.size());
+	}
+	BENCHMARK(BM_CreateAttributeDescription);
+
+	void BM_CreateRenderpass(benchmark::State& state) {
+		auto* renderer = getRenderer(state);
+		if(!renderer)
+			return;
+
+		RenderPassColourAttachmentDescriptor colour;
+		colour.loadAction = LoadAction::CLEAR;
+		colour.texture = renderer->getOffscreenColourTarget();
+		RenderPassDepthAttachmentDescriptor depth;
+		depth.loadAction = LoadAction::CLEAR;
+		depth.clearDepth = 1;
+		depth.texture = renderer->getOffscreenDepthTarget();
+
+		RenderPassDescriptor descriptor;
+		descriptor.colourAttachments = {colour};
+		descriptor.depthAttachment = depth;
+
+		uint64_t created = 0;
+		for(auto _: state) {
+			renderer->destroyRenderPass(renderer->createRenderpass(descriptor));
+			if(++created % 256 == 0)
+				runEmptyFrame(state, *renderer);
+		}
+	}
+	BENCHMARK(BM_CreateRenderpass)->Unit(benchmark::kMicrosecond);
+
+	// A new pipeline every time, which goes all the way to the driver (and its pipeline cache).
+	void BM_CreateRenderPipeline(benchmark::State& state) {
+		Fixture* fixture = nullptr;
+		auto* renderer = getRenderer(state, &fixture);
+		if(!renderer)
+			return;
+
+		// Differs from the fixture's pipelines in its viewport, so it isn't one of them.
+		auto descriptor = fixture->pipelineDescriptors[0];
+		descriptor.viewPorts.resize(1);
+		descriptor.viewPorts[0].width = 32;
+		descriptor.viewPorts[0].height = 32;
+
+		uint64_t created = 0;
+		for(auto _: state) {
+			renderer->destroyPipeline(renderer->createRenderPipeline(descriptor));
+			if(++created % 256 == 0)
+				runEmptyFrame(state, *renderer);
+		}
+	}
+	BENCHMARK(BM_CreateRenderPipeline)->Unit(benchmark::kMicrosecond);
+
+	// Asking for a pipeline that already exists, which is answered from the renderer's lookup.
+	void BM_CreateRenderPipelineExisting(benchmark::State& state) {
+		Fixture* fixture = nullptr;
+		auto* renderer = getRenderer(state, &fixture);
+		if(!renderer)
+			return;
+
+		for(auto _: state)
+			benchmark::DoNotOptimize(renderer->createRenderPipeline(fixture->pipelineDescriptors[0]));
+	}
+	BENCHMARK(BM_CreateRenderPipelineExisting);
+
+	// Sorting and recording a frame's draws. Beginning and submitting the frame isn't measured.
+	void BM_RecordDraws(benchmark::State& state) {
+		Fixture* fixture = nullptr;
+		auto* renderer = getRenderer(state, &fixture, static_cast<uint32_t>(state.range(2)));
+		if(!renderer)
+			return;
+
+		const auto drawCount = static_cast<uint32_t>(state.range(0));
+		const auto chunks = static_cast<uint32_t>(state.range(1));
+		const auto renderPass = renderer->getOffscreenRenderPass();
+		const auto framebuffer = renderer->getOffscreenFramebuffer();
+
+		DrawQueue queue;
+		queue.reserve(drawCount);
+		for(auto _: state) {
+			state.PauseTiming();
+			auto commandBuffer = renderer->beginFrame();
+			state.ResumeTiming();
+
+			queue.clear();
+			for(uint32_t i = 0; i < drawCount; ++i) {
+				const auto pipeline = fixture->pipelines[i % pipelineCount];
+				const auto material = i % 64;
+
+				DrawCommand command;
+				command.pipeline = pipeline;
+				command.vertexBuffer = fixture->vertexBuffer;
+				command.indexBuffer = fixture->indexBuffer;
+				command.indexBufferOffset = uint64_t(material) * 192;
+				command.count = 96;
+
+				const float tint[4] = {1, 1, 1, 1};
+				queue.add(getDrawKey(0, DrawOrder::STATE, pipeline, material, 0, static_cast<float>(i % 100)), command, tint, sizeof(tint));
+			}
+			queue.sort(&renderer->getJobSystem());
+
+			if(chunks) {
+				const auto chunkSize = (queue.size() + chunks - 1) / chunks;
+				renderer->recordParallel(renderPass, framebuffer, chunks, [&](vk::CommandBuffer secondary, uint32_t chunk) {
+					queue.record(*renderer, secondary, chunk * chunkSize, (chunk + 1) * chunkSize);
+				});
+			} else {
+				renderer->beginRenderPass(commandBuffer, renderPass, framebuffer);
+				queue.record(*renderer, commandBuffer);
+				commandBuffer.endRenderPass();
+			}
+
+			state.PauseTiming();
+			renderer->endFrame();
+			state.ResumeTiming();
+		}
+		state.SetItemsProcessed(state.iterations() * drawCount);
+	}
+	// 1, 2, 4, ... up to one per hardware thread.
+	void getWorkerCounts(benchmark::internal::Benchmark* benchmark) {
+		const auto hardwareThreads = std::max(std::thread::hardware_concurrency(), 1u);
+		std::vector<int64_t> workers;
+		for(uint32_t count = 1; count < hardwareThreads; count *= 2)
+			workers.emplace_back(count);
+		workers.emplace_back(hardwareThreads);
+
+		for(int64_t draws: {1000, 10000, 100000})
+			for(int64_t chunks: {0, 8})
+				for(auto count: workers)
+					benchmark->Args({draws, chunks, count});
+	}
+	// Draws, secondary command buffers recorded in parallel (0 records on the calling thread), worker threads of the
+	// renderer's job system, which sorts and records the chunks.
+	BENCHMARK(BM_RecordDraws)->ArgNames({"draws", "chunks", "workers"})
+	->Apply(getWorkerCounts)->Unit(benchmark::kMicrosecond)->UseRealTime();
+
+	// Copying into a device local buffer through the staging ring and waiting for the transfer queue.
+	void BM_UploadBuffer(benchmark::State& state) {
+		auto* renderer = getRenderer(state);
+		if(!renderer)
+			return;
+
+		const auto size = static_cast<uint64_t>(state.range(0));
+		std::vector<uint8_t> data(size, 0x5a);
+
+		BufferDescriptor descriptor;
+		descriptor.size = size;
+		descriptor.usage = BufferUsage::STORAGE;
+		const auto buffer = renderer->createBuffer(descriptor);
+
+		uint64_t uploaded = 0;
+		for(auto _: state) {
+			renderer->waitForUpload(renderer->uploadBuffer(buffer, data.data(), size));
+			// The graphics queue acquires what was uploaded in the next frame.
+			if(++uploaded % 64 == 0)
+				runEmptyFrame(state, *renderer);
+		}
+		state.SetBytesProcessed(state.iterations() * size);
+
+		renderer->destroyBuffer(buffer);
+		runEmptyFrame(state, *renderer);
+	}
+	BENCHMARK(BM_UploadBuffer)->Arg(64 << 10)->Arg(1 << 20)->Arg(16 << 20)->Arg(64 << 20)->Unit(benchmark::kMicrosecond)->UseRealTime();
+}
@@ -0,0 +1,24 @@
+# Runs every benchmark executable in BENCHMARK_FILES (separated by commas) and writes its results to
+# OUTPUT_DIRECTORY/<name>.json. The commit of SOURCE_DIRECTORY ends up in the context of every result.
+
+execute_process(COMMAND git rev-parse HEAD
+	WORKING_DIRECTORY ${SOURCE_DIRECTORY}
+	OUTPUT_VARIABLE COMMIT
+	OUTPUT_STRIP_TRAILING_WHITESPACE
+	ERROR_QUIET)
+if(NOT COMMIT)
+	set(COMMIT unknown)
+endif()
+
+string(REPLACE "," ";" BENCHMARK_FILES "${BENCHMARK_FILES}")
+foreach(FILE ${BENCHMARK_FILES})
+	get_filename_component(NAME ${FILE} NAME_WE)
+	execute_process(COMMAND ${FILE}
+		--benchmark_out=${OUTPUT_DIRECTORY}/${NAME}.json
+		--benchmark_out_format=json
+		--benchmark_context=commit=${COMMIT}
+		RESULT_VARIABLE RESULT)
+	if(NOT RESULT EQUAL 0)
+		message(FATAL_ERROR "${NAME} failed: ${RESULT}")
+	endif()
+endforeach()
@@ -0,0 +1,325 @@
+//
+//  scene_benchmarks.cpp
+//  benchmarks
+//
+//  Created by Danny on 17/10/2026.
+//  Copyright © 2026 Danny. All rights reserved.
+//
+
+#include <benchmark/benchmark.h>
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "frustum_culling.hpp"
+#include "frustum_culling_avx2.hpp"
+#include "gltf_loader.hpp"
+#include "gltf_writer.hpp"
+#include "job_system.hpp"
+#include "scene_transforms.hpp"
+#include "scene_transforms_avx2.hpp"
+
+// The per frame cpu work on a scene that doesn't need a device: transform updates and culling, and loading the scene.
+namespace {
+
+	// The simd path culling and the transform updates take, chosen the same way they choose it.
+	const char* getSimdPath() {
+		if(hasFrustumCullingAvx2() && hasSceneTransformsAvx2())
+			return "avx2+fma";
+#if defined(__SSE__) || defined(_M_X64)
+		return "sse";
+#elif defined(__ARM_NEON)
+		return "neon";
+#else
+		return "scalar";
+#endif
+	}
+
+	// Written to the context of the results before the benchmark library's main runs.
+	const bool simdContext = (benchmark::AddCustomContext("simd", getSimdPath()), true);
+
+	JobSystem& getJobSystem() {
+		static JobSystem jobSystem;
+		return jobSystem;
+	}
+
+	// A tree with 8 children per node, every node offset and rotated a little from its parent.
+	std::vector<NodeResourceDescriptor> buildNodes(uint32_t nodeCount) {
+		std::vector<NodeResourceDescriptor> nodes(nodeCount);
+		for(uint32_t i = 0; i < nodeCount; ++i) {
+			nodes[i].translation[0] = static_cast<float>(i % 8) - 3.5f;
+			nodes[i].translation[2] = 1;
+			nodes[i].rotation[1] = std::sin(0.05f);
+			nodes[i].rotation[3] = std::cos(0.05f);
+			if(i)
+				nodes[(i - 1) / 8].children.emplace_back(static_cast<int32_t>(i));
+		}
+		return nodes;
+	}
+
+	void buildScene(SceneTransforms& transforms, uint32_t nodeCount) {
+		transforms.build(buildNodes(nodeCount), {0});
+		transforms.update();
+	}
+
+	// Moves every stride-th node, which dirties it and its subtree.
+	void moveNodes(SceneTransforms& transforms, uint32_t stride, float time) {
+		const float translation[3] = {std::sin(time), 0, std::cos(time)};
+		for(uint32_t i = 0; i < transforms.size(); i += stride)
+			transforms.setTranslation(i, translation);
+	}
+
+	// A camera at the origin looking down +z with a 90 degree field of view, column major with [0, 1] depth.
+	void getViewProjection(float viewProjection[16], float yaw) {
+		const float c = std::cos(yaw), s = std::sin(yaw);
+		const float nearPlane = 0.1f, farPlane = 1000.0f;
+		const float a = farPlane / (farPlane - nearPlane), b = -nearPlane * farPlane / (farPlane - nearPlane);
+		// Projection times a rotation about y.
+		const float m[16] = {
+			c, 0, s * a, s,
+			0, -1, 0, 0,
+			-s, 0, c * a, c,
+			0, 0, b, 0
+		};
+		for(int i = 0; i < 16; ++i)
+			viewProjection[i] = m[i];
+	}
+
+	void BM_SceneTransformsUpdate(benchmark::State& state) {
+		SceneTransforms transforms;
+		buildScene(transforms, static_cast<uint32_t>(state.range(0)));
+		const auto stride = static_cast<uint32_t>(state.range(1));
+		auto* jobSystem = state.range(2) ? &getJobSystem() : nullptr;
+
+		float time = 0;
+		for(auto _: state) {
+			moveNodes(transforms, stride, time += 0.01f);
+			transforms.update(jobSystem);
+			benchmark::DoNotOptimize(transforms.getWorldMatrices());
+		}
+		state.SetItemsProcessed(state.iterations() * transforms.size());
+	}
+	// Nodes, every how many-th node moves (1 moves all of them), on the job system.
+	BENCHMARK(BM_SceneTransformsUpdate)->ArgNames({"nodes", "stride", "jobs"})
+	->ArgsProduct({{1000, 10000, 100000}, {1, 100}, {0, 1}})->Unit(benchmark::kMicrosecond)->UseRealTime();
+
+	// What SceneTransforms replaces: a walk down the node descriptors that recomputes every matrix, every frame.
+	void composeLocalMatrix(const NodeResourceDescriptor& node, float m[16]) {
+		const float x = node.rotation[0], y = node.rotation[1], z = node.rotation[2], w = node.rotation[3];
+		const float* s = node.scale;
+		const float* t = node.translation;
+		const float r[16] = {
+			1 - 2 * (y * y + z * z), 2 * (x * y + z * w), 2 * (x * z - y * w), 0,
+			2 * (x * y - z * w), 1 - 2 * (x * x + z * z), 2 * (y * z + x * w), 0,
+			2 * (x * z + y * w), 2 * (y * z - x * w), 1 - 2 * (x * x + y * y), 0,
+			0, 0, 0, 1
+		};
+		for(int column = 0; column < 3; ++column)
+			for(int row = 0; row < 4; ++row)
+				m[column * 4 + row] = r[column * 4 + row] * s[column];
+		m[12] = t[0];
+		m[13] = t[1];
+		m[14] = t[2];
+		m[15] = 1;
+	}
+
+	void updateNaive(const std::vector<NodeResourceDescriptor>& nodes, int32_t index, const float parent[16], std::vector<float>& worldMatrices) {
+		float local[16];
+		composeLocalMatrix(nodes[index], local);
+
+		float* world = &worldMatrices[index * 16];
+		for(int column = 0; column < 4; ++column)
+			for(int row = 0; row < 4; ++row) {
+				float sum = 0;
+				for(int k = 0; k < 4; ++k)
+					sum += parent[k * 4 + row] * local[column * 4 + k];
+				world[column * 4 + row] = sum;
+			}
+
+		for(const auto child: nodes[index].children)
+			updateNaive(nodes, child, world, worldMatrices);
+	}
+
+	// The baseline for BM_SceneTransformsUpdate, at the same node counts. Moving nodes doesn't matter to it.
+	void BM_SceneTransformsNaive(benchmark::State& state) {
+		auto nodes = buildNodes(static_cast<uint32_t>(state.range(0)));
+		std::vector<float> worldMatrices(nodes.size() * 16);
+		const float identity[16] = {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1};
+
+		float time = 0;
+		for(auto _: state) {
+			time += 0.01f;
+			nodes[0].translation[0] = std::sin(time);
+			nodes[0].translation[2] = std::cos(time);
+			updateNaive(nodes, 0, identity, worldMatrices);
+			benchmark::DoNotOptimize(worldMatrices.data());
+		}
+		state.SetItemsProcessed(state.iterations() * nodes.size());
+	}
+	// Nodes.
+	BENCHMARK(BM_SceneTransformsNaive)->ArgNames({"nodes"})->Arg(1000)->Arg(10000)->Arg(100000)->Unit(benchmark::kMicrosecond)->UseRealTime();
+
+	void BM_FrustumCull(benchmark::State& state) {
+		SceneTransforms transforms;
+		buildScene(transforms, static_cast<uint32_t>(state.range(0)));
+
+		FrustumCuller culler;
+		const float localMin[3] = {-0.5f, -0.5f, -0.5f};
+		const float localMax[3] = {0.5f, 0.5f, 0.5f};
+		for(uint32_t i = 0; i < transforms.size(); ++i)
+			culler.addObject(localMin, localMax, i);
+		culler.updateBounds(transforms);
+
+		// The main camera plus shadow cascades, all looking in slightly different directions.
+		const auto viewCount = static_cast<uint32_t>(state.range(1));
+		std::vector<Frustum> frustums(viewCount);
+		for(uint32_t i = 0; i < viewCount; ++i) {
+			float viewProjection[16];
+			getViewProjection(viewProjection, 0.2f * static_cast<float>(i));
+			frustums[i] = getFrustum(viewProjection);
+		}
+
+		auto* jobSystem = state.range(2) ? &getJobSystem() : nullptr;
+		std::vector<std::vector<uint32_t>> visible;
+		for(auto _: state) {
+			culler.cull(frustums.data(), viewCount, visible, jobSystem);
+			benchmark::DoNotOptimize(visible.data());
+		}
+		state.SetItemsProcessed(state.iterations() * culler.size());
+		state.counters["visible"] = static_cast<double>(visible[0].size());
+	}
+	// Objects, views, on the job system.
+	BENCHMARK(BM_FrustumCull)->ArgNames({"objects", "views", "jobs"})
+	->ArgsProduct({{1000, 10000, 100000}, {1, 4}, {0, 1}})->Unit(benchmark::kMicrosecond)->UseRealTime();
+
+	// A .glb with a mesh per node, every mesh with positions, normals and indices of its own. The vertex data is
+	// shared, so the file stays small and loading is about the json.
+	bool writeScene(const std::string& path, uint32_t nodeCount) {
+		const uint32_t vertexCount = 1024;
+		std::vector<float> vertices(vertexCount * 6);
+		for(uint32_t i = 0; i < vertexCount; ++i) {
+			vertices[i * 6 + 0] = static_cast<float>(i % 32);
+			vertices[i * 6 + 1] = static_cast<float>(i / 32);
+			vertices[i * 6 + 5] = 1;
+		}
+		std::vector<uint16_t> indices(vertexCount * 3);
+		for(uint32_t i = 0; i < indices.size(); ++i)
+			indices[i] = static_cast<uint16_t>((i * 7) % vertexCount);
+
+		GltfScene scene;
+		scene.buffers.resize(2);
+		scene.buffers[0].byteLength = static_cast<int32_t>(vertices.size() * sizeof(float));
+		scene.buffers[0].data = vertices.data();
+		scene.buffers[1].byteLength = static_cast<int32_t>(indices.size() * sizeof(uint16_t));
+		scene.buffers[1].data = indices.data();
+
+		scene.bufferViews.resize(2);
+		scene.bufferViews[0].bufferId = 0;
+		scene.bufferViews[0].byteLength = scene.buffers[0].byteLength;
+		scene.bufferViews[0].byteStride = 6 * sizeof(float);
+		scene.bufferViews[0].target = 34962;
+		scene.bufferViews[1].bufferId = 1;
+		scene.bufferViews[1].byteLength = scene.buffers[1].byteLength;
+		scene.bufferViews[1].target = 34963;
+
+		scene.nodes.resize(nodeCount);
+		scene.meshes.resize(nodeCount);
+		scene.accessors.reserve(nodeCount * 3);
+		for(uint32_t i = 0; i < nodeCount; ++i) {
+			Accessor position;
+			position.bufferView = 0;
+			position.componentType = 5126;
+			position.count = vertexCount;
+			position.type = "VEC3";
+			position.min = {0, 0, 0};
+			position.max = {31, 31, 0};
+			Accessor normal = position;
+			normal.byteOffset = 3 * sizeof(float);
+			normal.min.clear();
+			normal.max.clear();
+			Accessor index;
+			index.bufferView = 1;
+			index.componentType = 5123;
+			index.count = static_cast<int32_t>(indices.size());
+			index.type = "SCALAR";
+
+			Primitive primitive;
+			primitive.attributes["POSITION"] = static_cast<int32_t>(scene.accessors.size());
+			primitive.attributes["NORMAL"] = static_cast<int32_t>(scene.accessors.size() + 1);
+			primitive.indices = static_cast<int32_t>(scene.accessors.size() + 2);
+			scene.accessors.emplace_back(position);
+			scene.accessors.emplace_back(normal);
+			scene.accessors.emplace_back(index);
+			scene.meshes[i].primitives.emplace_back(primitive);
+			scene.meshes[i].name = "mesh" + std::to_string(i);
+
+			auto& node = scene.nodes[i];
+			node.mesh = static_cast<int32_t>(i);
+			node.name = "node" + std::to_string(i);
+			node.translation[0] = static_cast<float>(i % 8) - 3.5f;
+			node.translation[2] = 1;
+			if(i)
+				scene.nodes[(i - 1) / 8].children.emplace_back(static_cast<int32_t>(i));
+		}
+		scene.scenes = {{0}};
+		scene.scene = 0;
+
+		return saveGlb(path, scene);
+	}
+
+	// Written by a child process, so building the scene doesn't count towards this process's peak memory.
+	bool writeSceneInChild(const std::string& path, uint32_t nodeCount) {
+		const auto child = fork();
+		if(child < 0)
+			return false;
+		if(child == 0)
+			_exit(writeScene(path, nodeCount) ? 0 : 1);
+
+		int status = 0;
+		return waitpid(child, &status, 0) == child && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+	}
+
+	// High water mark of the resident set of this process in bytes.
+	double getPeakResidentSize() {
+		rusage usage {};
+		getrusage(RUSAGE_SELF, &usage);
+#if defined(__APPLE__)
+		return static_cast<double>(usage.ru_maxrss);
+#else
+		return static_cast<double>(usage.ru_maxrss) * 1024;
+#endif
+	}
+
+	// Loading the .glb, which maps its binary chunk and parses the json. The peak resident size is the process's, so
+	// it also covers benchmarks that ran before, filter for this one to see the loader on its own.
+	void BM_LoadGltf(benchmark::State& state) {
+		const auto nodeCount = static_cast<uint32_t>(state.range(0));
+		const char* directory = std::getenv("TMPDIR");
+		const auto path = std::string(directory ? directory : "/tmp") + "/scene_benchmark_" + std::to_string(nodeCount) + ".glb";
+		if(!writeSceneInChild(path, nodeCount)) {
+			state.SkipWithError("failed to write the scene");
+			return;
+		}
+
+		for(auto _: state) {
+			GltfScene scene;
+			if(!loadGltf(path, scene)) {
+				state.SkipWithError("failed to load the scene");
+				break;
+			}
+			benchmark::DoNotOptimize(scene.nodes.data());
+		}
+		state.SetItemsProcessed(state.iterations() * nodeCount);
+		state.counters["peakRSS"] = getPeakResidentSize();
+		std::remove(path.c_str());
+	}
+	// Nodes, each with a mesh of its own.
+	BENCHMARK(BM_LoadGltf)->ArgNames({"nodes"})->Arg(1000)->Arg(10000)->Arg(100000)->Unit(benchmark::kMillisecond)->UseRealTime();
+}
@@ -0,0 +1,348 @@
+//
+//  main.cpp
+//  frame_benchmark
+//
+//  Created by Danny on 17/10/2026.
+//  Copyright © 2026 Danny. All rights reserved.
+//
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "draw_queue.hpp"
+#include "null_vulkan.hpp"
+#include "profiler.hpp"
+#include "vulkan_renderer.hpp"
+
+// What a frame costs the renderer on the cpu, on top of the null driver so it runs without a gpu. Every frame asks
+// for a descriptor set per draw, sorts and records the draws through a DrawQueue and submits.
+namespace {
+
+	const char* vertexShader = R"(
+		#version 450
+		layout(location = 0) in vec3 position;
+		layout(set = 0, binding = 0) uniform Object { mat4 transform; } object;
+		layout(push_constant) uniform Push { vec4 tint; } push;
+		layout(location = 0) out vec4 colour;
+		void main() {
+			colour = push.tint;
+			gl_Position = object.transform * vec4(position, 1.0);
+		}
+	)";
+
+	const char* fragmentShader = R"(
+		#version 450
+		layout(set = 0, binding = 1) readonly buffer Materials { vec4 albedo[]; } materials;
+		layout(location = 0) in vec4 colour;
+		layout(location = 0) out vec4 result;
+		void main() {
+			result = colour * materials.albedo[VARIANT];
+		}
+	)";
+
+	struct Options
+	{
+		uint32_t frames = 1000;
+		uint32_t warmup = 10;
+		uint32_t draws = 2000;
+		uint32_t pipelines = 8;
+		uint32_t materials = 64;
+		uint32_t chunks = 0;
+		bool transient = false;
+		bool commands = false;
+	};
+
+	// Milliseconds spent in each part of a frame.
+	struct FrameTimings
+	{
+		double descriptors = 0;
+		double record = 0;
+		double submit = 0;
+		double total = 0;
+	};
+
+	void printUsage() {
+		std::printf("usage: frame_benchmark [options]\n"
+					"  --frames <n>     frames to measure (1000)\n"
+					"  --warmup <n>     frames before measuring (10)\n"
+					"  --draws <n>      draws per frame (2000)\n"
+					"  --pipelines <n>  pipelines the draws are spread over (8)\n"
+					"  --materials <n>  materials the draws are spread over (64)\n"
+					"  --chunks <n>     record in parallel into n secondary command buffers, 0 records on the main thread (0)\n"
+					"  --threads <n>    worker threads, 0 for one per core (0)\n"
+					"  --transient      write a transient descriptor set per draw instead of going through the set cache\n"
+					"  --commands       print the commands of the last frame by type\n");
+	}
+
+	double getMilliseconds(uint64_t start, uint64_t end) {
+		return static_cast<double>(end - start) / 1e6;
+	}
+
+	double getMean(uint64_t value, size_t count) {
+		return count ? static_cast<double>(value) / static_cast<double>(count) : 0;
+	}
+}
+
+int main(int argc, const char* argv[]) {
+	Options options;
+	DeviceRequirements requirements;
+	requirements.graphicsQueueSupport = true;
+	requirements.headless = true;
+	requirements.offscreenColourTarget.width = 1280;
+	requirements.offscreenColourTarget.height = 720;
+	requirements.validation = false;
+
+	for(int i = 1; i < argc; ++i) {
+		const bool hasValue = i + 1 < argc;
+		auto value = [&] { return static_cast<uint32_t>(std::max(std::atoi(argv[++i]), 0)); };
+		if(!std::strcmp(argv[i], "--frames") && hasValue)
+			options.frames = std::max(value(), 1u);
+		else if(!std::strcmp(argv[i], "--warmup") && hasValue)
+			options.warmup = value();
+		else if(!std::strcmp(argv[i], "--draws") && hasValue)
+			options.draws = value();
+		else if(!std::strcmp(argv[i], "--pipelines") && hasValue)
+			options.pipelines = std::max(value(), 1u);
+		else if(!std::strcmp(argv[i], "--materials") && hasValue)
+			options.materials = std::max(value(), 1u);
+		else if(!std::strcmp(argv[i], "--chunks") && hasValue)
+			options.chunks = value();
+		else if(!std::strcmp(argv[i], "--threads") && hasValue)
+			requirements.workerThreads = value();
+		else if(!std::strcmp(argv[i], "--transient"))
+			options.transient = true;
+		else if(!std::strcmp(argv[i], "--commands"))
+			options.commands = true;
+		else {
+			printUsage();
+			return 1;
+		}
+	}
+
+	VulkanRenderer renderer(requirements);
+	const auto renderPass = renderer.getOffscreenRenderPass();
+	const auto framebuffer = renderer.getOffscreenFramebuffer();
+	if(renderPass == null_handle) {
+		std::fprintf(stderr, "frame_benchmark: no offscreen targets\n");
+		return 1;
+	}
+
+	// Variants of the fragment shader make pipelines that only differ in their modules.
+	ShaderSourceDescriptor vertexSource;
+	vertexSource.source = vertexShader;
+	vertexSource.path = "frame_benchmark.vert";
+	std::vector<ShaderSourceDescriptor> sources {vertexSource};
+	for(uint32_t i = 0; i < options.pipelines; ++i) {
+		ShaderSourceDescriptor fragmentSource;
+		fragmentSource.source = fragmentShader;
+		fragmentSource.path = "frame_benchmark.frag";
+		fragmentSource.stage = ShaderStageDescriptor::Type::FRAGMENT;
+		fragmentSource.defines["VARIANT"] = std::to_string(i);
+		sources.emplace_back(fragmentSource);
+	}
+
+	std::string errors;
+	const auto modules = renderer.createShaderModules(sources, &errors);
+	if(std::find(modules.begin(), modules.end(), null_handle) != modules.end()) {
+		std::fprintf(stderr, "frame_benchmark: %s\n", errors.c_str());
+		return 1;
+	}
+
+	std::vector<RenderPipelineDescriptor> pipelineDescriptors(options.pipelines);
+	for(uint32_t i = 0; i < options.pipelines; ++i) {
+		auto& descriptor = pipelineDescriptors[i];
+		descriptor.renderPass = renderPass;
+		descriptor.topology = PrimitiveTopology::TRIANGLES;
+		descriptor.shaderStages = {{"main", ShaderStageDescriptor::Type::VERTEX, modules[0]}, {"main", ShaderStageDescriptor::Type::FRAGMENT, modules[i + 1]}};
+
+		VertexAttributeDescriptor position;
+		position.type = DataType::FLOAT_32;
+		position.numElements = 3;
+		descriptor.vertexAttributeDescriptors = {position};
+	}
+	const auto pipelines = renderer.createRenderPipelines(pipelineDescriptors);
+	if(std::find(pipelines.begin(), pipelines.end(), null_handle) != pipelines.end()) {
+		std::fprintf(stderr, "frame_benchmark: failed to create the pipelines\n");
+		return 1;
+	}
+
+	// One slice of the object buffer per draw and one material buffer, like a scene would have.
+	const uint64_t objectStride = 256;
+	BufferDescriptor objectDescriptor;
+	objectDescriptor.size = std::max<uint64_t>(options.draws, 1) * objectStride;
+	objectDescriptor.usage = BufferUsage::UNIFORM;
+	objectDescriptor.storageMode = StorageMode::SHARED;
+	const auto objectBuffer = renderer.createBuffer(objectDescriptor);
+
+	BufferDescriptor materialDescriptor;
+	materialDescriptor.size = uint64_t(options.materials) * 16;
+	materialDescriptor.usage = BufferUsage::STORAGE;
+	const auto materialBuffer = renderer.createBuffer(materialDescriptor);
+
+	BufferDescriptor vertexDescriptor;
+	vertexDescriptor.size = 1 << 20;
+	vertexDescriptor.usage = BufferUsage::VERTEX;
+	const auto vertexBuffer = renderer.createBuffer(vertexDescriptor);
+
+	BufferDescriptor indexDescriptor;
+	indexDescriptor.size = 1 << 20;
+	indexDescriptor.usage = BufferUsage::INDEX;
+	const auto indexBuffer = renderer.createBuffer(indexDescriptor);
+
+	DrawQueue queue;
+	queue.reserve(options.draws);
+	std::vector<vk::DescriptorSet> sets(options.draws);
+	std::vector<ResourceBinding> bindings(2);
+	bindings[0].binding = 0;
+	bindings[0].type = BindingType::UNIFORM_BUFFER;
+	bindings[0].buffer = objectBuffer;
+	bindings[0].size = objectStride;
+	bindings[1].binding = 1;
+	bindings[1].type = BindingType::STORAGE_BUFFER;
+	bindings[1].buffer = materialBuffer;
+
+	auto& jobSystem = renderer.getJobSystem();
+	std::vector<FrameTimings> timings;
+
+	for(uint32_t frame = 0; frame < options.warmup + options.frames; ++frame) {
+		const bool measured = frame >= options.warmup;
+		if(frame == options.warmup)
+			resetNullVulkanStatistics();
+		if(options.commands && frame + 1 == options.warmup + options.frames)
+			setNullSubmissionCapture(true);
+
+		const auto start = Profiler::now();
+		auto commandBuffer = renderer.beginFrame();
+
+		for(uint32_t i = 0; i < options.draws; ++i) {
+			const auto pipeline = pipelines[i % options.pipelines];
+			bindings[0].offset = i * objectStride;
+			if(options.transient)
+				sets[i] = renderer.acquireTransientDescriptorSet(pipeline, bindings);
+			else
+				sets[i] = renderer.getDescriptorSet(pipeline, bindings);
+		}
+		const auto descriptorsEnd = Profiler::now();
+
+		queue.clear();
+		for(uint32_t i = 0; i < options.draws; ++i) {
+			const auto pipeline = pipelines[i % options.pipelines];
+			const auto material = i % options.materials;
+
+			DrawCommand command;
+			command.pipeline = pipeline;
+			command.descriptorSet = sets[i];
+			command.vertexBuffer = vertexBuffer;
+			command.indexBuffer = indexBuffer;
+			command.indexBufferOffset = uint64_t(material) * 1536;
+			command.count = 768;
+
+			const float tint[4] = {1, 1, 1, 1};
+			queue.add(getDrawKey(0, DrawOrder::STATE, pipeline, material, 0, static_cast<float>(i % 100)), command, tint, sizeof(tint));
+		}
+		queue.sort(&jobSystem);
+
+		if(options.chunks) {
+			const auto chunkSize = (queue.size() + options.chunks - 1) / options.chunks;
+			renderer.recordParallel(renderPass, framebuffer, options.chunks, [&](vk::CommandBuffer secondary, uint32_t chunk) {
+				queue.record(renderer, secondary, chunk * chunkSize, (chunk + 1) * chunkSize);
+			});
+		} else {
+			renderer.beginRenderPass(commandBuffer, renderPass, framebuffer);
+			queue.record(renderer, commandBuffer);
+			commandBuffer.endRenderPass();
+		}
+		const auto recordEnd = Profiler::now();
+
+		renderer.endFrame();
+		const auto end = Profiler::now();
+
+		if(measured) {
+			FrameTimings t;
+			t.descriptors = getMilliseconds(start, descriptorsEnd);
+			t.record = getMilliseconds(descriptorsEnd, recordEnd);
+			t.submit = getMilliseconds(recordEnd, end);
+			t.total = getMilliseconds(start, end);
+			timings.emplace_back(t);
+		}
+	}
+
+	// Headless frames end with the fenced submission of endFrame, so there is one driver frame per frame.
+	const auto driverFrames = getNullVulkanFrames();
+
+	FrameTimings mean;
+	for(const auto& t: timings) {
+		mean.descriptors += t.descriptors;
+		mean.record += t.record;
+		mean.submit += t.submit;
+		mean.total += t.total;
+	}
+	const double count = static_cast<double>(timings.size());
+	std::vector<double> totals;
+	for(const auto& t: timings)
+		totals.emplace_back(t.total);
+	std::sort(totals.begin(), totals.end());
+
+	std::printf("%u frames, %u draws, %u pipelines, %u materials, %s descriptor sets, %s\n", options.frames, options.draws, options.pipelines,
+				options.materials, options.transient ? "transient" : "cached",
+				options.chunks ? (std::to_string(options.chunks) + " chunks").c_str() : "main thread");
+	std::printf("\n%-12s %10s\n", "cpu ms", "mean");
+	std::printf("%-12s %10.3f\n", "descriptors", mean.descriptors / count);
+	std::printf("%-12s %10.3f\n", "record", mean.record / count);
+	std::printf("%-12s %10.3f\n", "submit", mean.submit / count);
+	std::printf("%-12s %10.3f (median %.3f, p99 %.3f)\n", "frame", mean.total / count, totals[totals.size() / 2], totals[totals.size() * 99 / 100]);
+
+	NullVulkanFrame sum;
+	for(const auto& f: driverFrames) {
+		sum.calls += f.calls;
+		sum.nanoseconds += f.nanoseconds;
+		sum.objectsCreated += f.objectsCreated;
+		sum.objectsDestroyed += f.objectsDestroyed;
+		sum.memoryAllocations += f.memoryAllocations;
+		sum.bytesAllocated += f.bytesAllocated;
+		sum.descriptorSetsAllocated += f.descriptorSetsAllocated;
+		sum.descriptorWrites += f.descriptorWrites;
+		sum.descriptors += f.descriptors;
+		sum.commands += f.commands;
+		sum.submits += f.submits;
+		sum.commandBuffersSubmitted += f.commandBuffersSubmitted;
+	}
+
+	const auto frames = driverFrames.size();
+	std::printf("\n%-24s %12s\n", "per frame", "mean");
+	std::printf("%-24s %12.1f\n", "api calls", getMean(sum.calls, frames));
+	std::printf("%-24s %12.3f\n", "driver ms", getMean(sum.nanoseconds, frames) / 1e6);
+	std::printf("%-24s %12.1f\n", "objects created", getMean(sum.objectsCreated, frames));
+	std::printf("%-24s %12.1f\n", "objects destroyed", getMean(sum.objectsDestroyed, frames));
+	std::printf("%-24s %12.1f\n", "memory allocations", getMean(sum.memoryAllocations, frames));
+	std::printf("%-24s %12.1f\n", "bytes allocated", getMean(sum.bytesAllocated, frames));
+	std::printf("%-24s %12.1f\n", "descriptor sets", getMean(sum.descriptorSetsAllocated, frames));
+	std::printf("%-24s %12.1f\n", "descriptor writes", getMean(sum.descriptorWrites, frames));
+	std::printf("%-24s %12.1f\n", "descriptors", getMean(sum.descriptors, frames));
+	std::printf("%-24s %12.1f\n", "commands", getMean(sum.commands, frames));
+	std::printf("%-24s %12.1f\n", "submits", getMean(sum.submits, frames));
+	std::printf("%-24s %12.1f\n", "command buffers", getMean(sum.commandBuffersSubmitted, frames));
+
+	std::printf("\n%-40s %12s %12s %10s\n", "entry point", "calls/frame", "total ms", "ns/call");
+	for(const auto& call: getNullVulkanCalls())
+		std::printf("%-40s %12.1f %12.3f %10.1f\n", call.name, getMean(call.count, frames), static_cast<double>(call.nanoseconds) / 1e6,
+					getMean(call.nanoseconds, call.count));
+
+	if(options.commands) {
+		std::map<std::string, uint64_t> histogram;
+		for(const auto& submission: takeNullSubmissions())
+			for(const auto& command: submission.commands)
+				++histogram[getNullCommandName(command.type)];
+
+		std::printf("\n%-28s %10s\n", "last frame", "commands");
+		for(const auto& entry: histogram)
+			std::printf("%-28s %10llu\n", entry.first.c_str(), static_cast<unsigned long long>(entry.second));
+	}
+
+	return 0;
+}
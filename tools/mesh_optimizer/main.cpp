@@ -0,0 +1,107 @@
+//
+//  main.cpp
+//  mesh_optimizer
+//
+//  Created by Danny on 17/10/2026.
+//  Copyright © 2026 Danny. All rights reserved.
+//
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "gltf_loader.hpp"
+#include "gltf_writer.hpp"
+#include "job_system.hpp"
+#include "mesh_optimizer.hpp"
+
+namespace {
+
+	void printUsage() {
+		std::printf("usage: mesh_optimizer input.gltf|glb output.glb [options]\n"
+					"  --cache <n>        vertex cache size (%u)\n"
+					"  --overdraw <t>     vertex cache efficiency overdraw ordering may give up (1.05)\n"
+					"  --lods <n>         levels of detail per primitive (4), 0 for none\n"
+					"  --lod-ratio <r>    triangles of a level relative to the one before (0.5)\n"
+					"  --lod-error <e>    largest error of a level relative to the mesh size (0.02)\n"
+					"  --threads <n>      worker threads, 0 for one per core (0)\n", vertex_cache_size);
+	}
+
+	void printReport(const MeshOptimizationReport& report) {
+		const auto name = report.name.empty() ? "mesh " + std::to_string(report.mesh) : report.name;
+		if(!report.optimizedPrimitives) {
+			std::printf("%-24s skipped (%u primitives that aren't triangle lists with float positions)\n", name.c_str(), report.skippedPrimitives);
+			return;
+		}
+
+		std::printf("%-24s %8u tris  %8u -> %8u verts  ACMR %.3f -> %.3f  ATVR %.3f -> %.3f", name.c_str(), report.after.triangles,
+					report.verticesBefore, report.verticesAfter, report.before.acmr, report.after.acmr, report.before.atvr, report.after.atvr);
+		for(size_t i = 0; i < report.lodTriangles.size(); ++i)
+			std::printf("  lod%zu %u (%.4f)", i + 1, report.lodTriangles[i], report.lodErrors[i]);
+		if(report.skippedPrimitives)
+			std::printf("  %u skipped", report.skippedPrimitives);
+		std::printf("\n");
+	}
+}
+
+int main(int argc, const char* argv[]) {
+	if(argc < 3) {
+		printUsage();
+		return 1;
+	}
+
+	MeshOptimizerSettings settings;
+	uint32_t threads = 0;
+	for(int i = 3; i < argc; ++i) {
+		const bool hasValue = i + 1 < argc;
+		if(!std::strcmp(argv[i], "--cache") && hasValue)
+			settings.cacheSize = static_cast<uint32_t>(std::atoi(argv[++i]));
+		else if(!std::strcmp(argv[i], "--overdraw") && hasValue)
+			settings.overdrawThreshold = static_cast<float>(std::atof(argv[++i]));
+		else if(!std::strcmp(argv[i], "--lods") && hasValue)
+			settings.maxLods = static_cast<uint32_t>(std::atoi(argv[++i]));
+		else if(!std::strcmp(argv[i], "--lod-ratio") && hasValue)
+			settings.lodRatio = static_cast<float>(std::atof(argv[++i]));
+		else if(!std::strcmp(argv[i], "--lod-error") && hasValue)
+			settings.maxLodError = static_cast<float>(std::atof(argv[++i]));
+		else if(!std::strcmp(argv[i], "--threads") && hasValue)
+			threads = static_cast<uint32_t>(std::atoi(argv[++i]));
+		else {
+			printUsage();
+			return 1;
+		}
+	}
+
+	GltfScene scene;
+	if(!loadGltf(argv[1], scene)) {
+		std::fprintf(stderr, "can't load %s\n", argv[1]);
+		return 1;
+	}
+
+	JobSystem jobSystem(threads);
+	const auto reports = optimizeGltfMeshes(scene, settings, &jobSystem);
+
+	VertexCacheStatistics before;
+	VertexCacheStatistics after;
+	for(const auto& report: reports) {
+		printReport(report);
+		before.transformed += report.before.transformed;
+		before.triangles += report.before.triangles;
+		before.vertices += report.before.vertices;
+		after.transformed += report.after.transformed;
+		after.triangles += report.after.triangles;
+		after.vertices += report.after.vertices;
+	}
+
+	if(before.triangles && before.vertices && after.vertices)
+		std::printf("total ACMR %.3f -> %.3f  ATVR %.3f -> %.3f\n", float(before.transformed) / before.triangles, float(after.transformed) / after.triangles,
+					float(before.transformed) / before.vertices, float(after.transformed) / after.vertices);
+
+	if(!saveGlb(argv[2], scene)) {
+		std::fprintf(stderr, "can't write %s\n", argv[2]);
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,239 @@
+//
+//  main.cpp
+//  startup_benchmark
+//
+//  Created by Danny on 17/10/2026.
+//  Copyright © 2026 Danny. All rights reserved.
+//
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "profiler.hpp"
+#include "vulkan_renderer.hpp"
+
+namespace {
+
+	const char* vertexShader = R"(
+		#version 450
+		layout(location = 0) in vec3 position;
+		layout(location = 1) in vec3 normal;
+		layout(location = 2) in vec2 uv;
+		layout(location = 0) out vec3 outNormal;
+		layout(location = 1) out vec2 outUV;
+		void main() {
+			outNormal = normal;
+			outUV = uv;
+			gl_Position = vec4(position, 1.0);
+		}
+	)";
+
+	// Variants by the number of lights, a procedural texture and alpha testing, like the permutations of a material.
+	const char* fragmentShader = R"(
+		#version 450
+		layout(location = 0) in vec3 normal;
+		layout(location = 1) in vec2 uv;
+		layout(location = 0) out vec4 result;
+		layout(push_constant) uniform Push { vec4 lights[4]; vec4 tint; } push;
+		void main() {
+			vec3 n = normalize(normal);
+			vec3 colour = push.tint.rgb;
+		#if TEXTURED
+			colour *= vec3(fract(uv * 8.0), 1.0);
+		#endif
+			float light = 0.1;
+			for(int i = 0; i < LIGHTS; ++i)
+				light += max(dot(n, normalize(push.lights[i].xyz)), 0.0) * push.lights[i].w;
+		#if ALPHA_TEST
+			if(push.tint.a < 0.5)
+				discard;
+		#endif
+			result = vec4(colour * light, push.tint.a);
+		}
+	)";
+
+	// Every fragment variant with and without depth writes, as triangles and as lines.
+	const uint32_t lightCounts = 4;
+	const uint32_t fragmentVariants = lightCounts * 2 * 2;
+
+	struct RunTimings
+	{
+		StartupTimings startup;
+		// Compiling the shaders from source and creating the pipelines from them, in milliseconds.
+		double shaders = 0;
+		double pipelines = 0;
+	};
+
+	double getMilliseconds(uint64_t start) {
+		return static_cast<double>(Profiler::now() - start) / 1e6;
+	}
+
+	// Empty if it worked.
+	std::string createPipelines(VulkanRenderer& renderer, RunTimings& timings) {
+		ShaderSourceDescriptor vertexSource;
+		vertexSource.source = vertexShader;
+		vertexSource.path = "startup.vert";
+		std::vector<ShaderSourceDescriptor> sources {vertexSource};
+		for(uint32_t i = 0; i < fragmentVariants; ++i) {
+			ShaderSourceDescriptor fragmentSource;
+			fragmentSource.source = fragmentShader;
+			fragmentSource.path = "startup.frag";
+			fragmentSource.stage = ShaderStageDescriptor::Type::FRAGMENT;
+			fragmentSource.defines["LIGHTS"] = std::to_string(i % lightCounts + 1);
+			fragmentSource.defines["TEXTURED"] = std::to_string(i / lightCounts % 2);
+			fragmentSource.defines["ALPHA_TEST"] = std::to_string(i / lightCounts / 2);
+			sources.emplace_back(fragmentSource);
+		}
+
+		std::string errors;
+		auto start = Profiler::now();
+		const auto modules = renderer.createShaderModules(sources, &errors);
+		timings.shaders = getMilliseconds(start);
+		if(std::find(modules.begin(), modules.end(), null_handle) != modules.end())
+			return "failed to compile the shaders: " + errors;
+
+		VertexAttributeDescriptor position;
+		position.type = DataType::FLOAT_32;
+		position.numElements = 3;
+		VertexAttributeDescriptor normal = position;
+		normal.offset = 12;
+		normal.location = 1;
+		VertexAttributeDescriptor uv = position;
+		uv.numElements = 2;
+		uv.offset = 24;
+		uv.location = 2;
+
+		std::vector<RenderPipelineDescriptor> descriptors;
+		for(uint32_t i = 0; i < fragmentVariants * 4; ++i) {
+			RenderPipelineDescriptor descriptor;
+			descriptor.renderPass = renderer.getOffscreenRenderPass();
+			descriptor.topology = i / fragmentVariants / 2 ? PrimitiveTopology::LINES : PrimitiveTopology::TRIANGLES;
+			descriptor.shaderStages = {{"main", ShaderStageDescriptor::Type::VERTEX, modules[0]},
+				{"main", ShaderStageDescriptor::Type::FRAGMENT, modules[i % fragmentVariants + 1]}};
+			descriptor.depthStencilState.test = 1;
+			descriptor.depthStencilState.write = i / fragmentVariants % 2;
+			descriptor.vertexAttributeDescriptors = {position, normal, uv};
+			descriptors.emplace_back(descriptor);
+		}
+
+		start = Profiler::now();
+		const auto pipelines = renderer.createRenderPipelines(descriptors);
+		timings.pipelines = getMilliseconds(start);
+		if(std::find(pipelines.begin(), pipelines.end(), null_handle) != pipelines.end())
+			return "failed to create the pipelines";
+
+		return std::string();
+	}
+
+	void printUsage() {
+		std::printf("usage: startup_benchmark [options]\n"
+					"  --runs <n>             renderers to create (5), the first one without a device or pipeline cache\n"
+					"  --device-cache <path>  device cache file (startup_benchmark.devicecache)\n"
+					"  --pipeline-cache <path> pipeline cache file (startup_benchmark.pipelinecache)\n"
+					"  --threads <n>          worker threads, 0 for one per core (0)\n"
+					"  --validation           enable the validation layer\n");
+	}
+
+	void printTimings(const char* name, const RunTimings& r) {
+		const auto& t = r.startup;
+		std::printf("%-8s %10.2f %10.2f %10.2f %10.2f %10.2f %10.2f %10.2f %10.2f  %s/%s\n", name, t.instance, t.deviceSelection, t.device,
+					t.objects, t.offscreenTargets, t.total, r.shaders, r.pipelines, t.deviceCacheHit ? "hit" : "miss", t.pipelineCacheHit ? "hit" : "miss");
+	}
+}
+
+int main(int argc, const char* argv[]) {
+	uint32_t runs = 5;
+	DeviceRequirements requirements;
+	requirements.graphicsQueueSupport = true;
+	requirements.headless = true;
+	requirements.offscreenColourTarget.width = 256;
+	requirements.offscreenColourTarget.height = 256;
+	requirements.createDepthBuffer = true;
+	requirements.deviceCachePath = "startup_benchmark.devicecache";
+	requirements.pipelineCachePath = "startup_benchmark.pipelinecache";
+	requirements.validation = false;
+
+	for(int i = 1; i < argc; ++i) {
+		const bool hasValue = i + 1 < argc;
+		if(!std::strcmp(argv[i], "--runs") && hasValue)
+			runs = static_cast<uint32_t>(std::max(std::atoi(argv[++i]), 1));
+		else if(!std::strcmp(argv[i], "--device-cache") && hasValue)
+			requirements.deviceCachePath = argv[++i];
+		else if(!std::strcmp(argv[i], "--pipeline-cache") && hasValue)
+			requirements.pipelineCachePath = argv[++i];
+		else if(!std::strcmp(argv[i], "--threads") && hasValue)
+			requirements.workerThreads = static_cast<uint32_t>(std::atoi(argv[++i]));
+		else if(!std::strcmp(argv[i], "--validation"))
+			requirements.validation = true;
+		else {
+			printUsage();
+			return 1;
+		}
+	}
+
+	// The first run probes every device and writes both caches, the others start from them.
+	std::remove(requirements.deviceCachePath.c_str());
+	std::remove(requirements.pipelineCachePath.c_str());
+
+	std::printf("%-8s %10s %10s %10s %10s %10s %10s %10s %10s  %s\n", "run", "instance", "selection", "device", "objects", "offscreen", "total",
+				"shaders", "pipelines", "cache");
+
+	std::vector<RunTimings> timings;
+	for(uint32_t i = 0; i < runs; ++i) {
+		VulkanRenderer renderer(requirements);
+		if(renderer.getOffscreenRenderPass() == null_handle) {
+			std::fprintf(stderr, "no device\n");
+			return 1;
+		}
+
+		RunTimings run;
+		run.startup = renderer.getStartupTimings();
+		const auto error = createPipelines(renderer, run);
+		if(!error.empty()) {
+			std::fprintf(stderr, "%s\n", error.c_str());
+			return 1;
+		}
+
+		// The renderer saves the cache when it's destroyed as well, saving the cold run's here reports failures.
+		if(i == 0 && !renderer.savePipelineCache())
+			std::fprintf(stderr, "failed to save the pipeline cache to %s\n", requirements.pipelineCachePath.c_str());
+
+		timings.emplace_back(run);
+		printTimings(i ? std::to_string(i).c_str() : "cold", run);
+	}
+
+	if(timings.size() > 1) {
+		RunTimings mean;
+		auto& m = mean.startup;
+		for(size_t i = 1; i < timings.size(); ++i) {
+			const auto& t = timings[i].startup;
+			m.instance += t.instance;
+			m.deviceSelection += t.deviceSelection;
+			m.device += t.device;
+			m.objects += t.objects;
+			m.offscreenTargets += t.offscreenTargets;
+			m.total += t.total;
+			mean.shaders += timings[i].shaders;
+			mean.pipelines += timings[i].pipelines;
+		}
+
+		const double count = static_cast<double>(timings.size() - 1);
+		m.instance /= count;
+		m.deviceSelection /= count;
+		m.device /= count;
+		m.objects /= count;
+		m.offscreenTargets /= count;
+		m.total /= count;
+		mean.shaders /= count;
+		mean.pipelines /= count;
+		m.deviceCacheHit = timings.back().startup.deviceCacheHit;
+		m.pipelineCacheHit = timings.back().startup.pipelineCacheHit;
+		printTimings("warm", mean);
+	}
+
+	return 0;
+}